@@ -22,8 +22,11 @@ src/autoroute/panelizer.h  \
 src/autoroute/cmrouter/tile.h  \
 src/autoroute/cmrouter/tileutils.h  \
 src/autoroute/mazerouter/mazerouter.h  \
+src/autoroute/mazerouter/routequeue.h  \
+src/autoroute/mazerouter/obstaclewindow.h  \
 src/autoroute/zoomcontrols.h \
 src/autoroute/drc.h \
+src/autoroute/drcgeometry.h \
 
 SOURCES += \
 src/autoroute/autorouter.cpp \
@@ -36,5 +39,8 @@ src/autoroute/cmrouter/DBcell.cpp \
 src/autoroute/cmrouter/search.cpp \
 src/autoroute/cmrouter/search2.cpp   \
 src/autoroute/mazerouter/mazerouter.cpp  \
+src/autoroute/mazerouter/routequeue.cpp  \
+src/autoroute/mazerouter/obstaclewindow.cpp  \
 src/autoroute/zoomcontrols.cpp \
 src/autoroute/drc.cpp \
+src/autoroute/drcgeometry.cpp \
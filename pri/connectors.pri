@@ -15,6 +15,7 @@
 
 HEADERS += \
 src/connectors/bus.h \
+src/connectors/connectivityindex.h \
 src/connectors/busshared.h \
 src/connectors/connector.h \
 src/connectors/connectoritem.h \
@@ -25,6 +26,7 @@ src/connectors/svgidlayer.h
 
 SOURCES += \
 src/connectors/bus.cpp \
+src/connectors/connectivityindex.cpp \
 src/connectors/busshared.cpp \
 src/connectors/connector.cpp \
 src/connectors/connectoritem.cpp \
@@ -16,6 +16,7 @@ HEADERS += \
     src/commands.h \
     src/debugdialog.h \
     src/fapplication.h \
+    src/fjobserver.h \
     src/fsplashscreen.h \
     src/fsvgrenderer.h \
     src/installedfonts.h \
@@ -32,6 +33,7 @@ SOURCES += \
     src/commands.cpp \
     src/debugdialog.cpp \
     src/fapplication.cpp \
+    src/fjobserver.cpp \
     src/fsplashscreen.cpp \
     src/fsvgrenderer.cpp \
     src/itemdrag.cpp \
@@ -17,6 +17,8 @@ HEADERS += \
     src/model/modelpart.h \
     src/model/modelpartshared.h \
     src/model/palettemodel.h \
+    src/model/partsindex.h \
+    src/model/partssearchindex.h \
     src/model/sketchmodel.h
 
 SOURCES += \
@@ -24,4 +26,6 @@ SOURCES += \
     src/model/modelpart.cpp \
     src/model/modelpartshared.cpp \
     src/model/palettemodel.cpp \
+    src/model/partsindex.cpp \
+    src/model/partssearchindex.cpp \
     src/model/sketchmodel.cpp
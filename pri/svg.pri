@@ -16,11 +16,12 @@ HEADERS += src/svg/svgfilesplitter.h \
     src/svg/svgpathparser.h \
     src/svg/svgpathgrammar_p.h \
     src/svg/svgpathlexer.h \
-    src/svg/svgpathrunner.h \
+    src/svg/svgpathtokenizer.h \
     src/svg/svg2gerber.h \
     src/svg/svgflattener.h \
     src/svg/gerbergenerator.h \
     src/svg/groundplanegenerator.h \
+    src/svg/pourgeometry.h \
     src/svg/x2svg.h \
     src/svg/kicad2svg.h \
     src/svg/kicadmodule2svg.h \
@@ -35,11 +36,12 @@ SOURCES += src/svg/svgfilesplitter.cpp \
     src/svg/svgpathparser.cpp \
     src/svg/svgpathgrammar.cpp \
     src/svg/svgpathlexer.cpp \
-    src/svg/svgpathrunner.cpp \
+    src/svg/svgpathtokenizer.cpp \
     src/svg/svg2gerber.cpp \
     src/svg/svgflattener.cpp \
     src/svg/gerbergenerator.cpp \
     src/svg/groundplanegenerator.cpp \
+    src/svg/pourgeometry.cpp \
     src/svg/x2svg.cpp \
     src/svg/kicad2svg.cpp \
     src/svg/kicadmodule2svg.cpp \
@@ -179,9 +179,12 @@ void Autorouter::initUndo(QUndoCommand * parentCommand)
 		}
 	}
 	else {
-		collidingItems = m_sketchWidget->scene()->items();
-		foreach (QGraphicsItem * item, collidingItems) {
-			auto netLabel = dynamic_cast<SymbolPaletteItem *>(item);
+		// only the traces are needed from here on
+		foreach (Wire * wire, m_sketchWidget->fgraphicsScene()->wires()) {
+			collidingItems.append(wire);
+		}
+		foreach (ItemBase * itemBase, m_sketchWidget->fgraphicsScene()->itemBases(ModelPart::Symbol)) {
+			auto netLabel = qobject_cast<SymbolPaletteItem *>(itemBase);
 			if (!netLabel) continue;
 			if (!netLabel->isOnlyNetLabel()) continue;
 
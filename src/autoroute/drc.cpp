@@ -19,6 +19,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 ********************************************************************/
 
 #include "drc.h"
+#include "drcgeometry.h"
 #include "../connectors/svgidlayer.h"
 #include "../sketch/pcbsketchwidget.h"
 #include "../debugdialog.h"
@@ -36,6 +37,9 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "../processeventblocker.h"
 
 #include <qmath.h>
+#include <qendian.h>
+#include <QtAlgorithms>
+#include <QtConcurrentRun>
 #include <QApplication>
 #include <QMessageBox>
 #include <QPixmap>
@@ -64,31 +68,74 @@ const QString DRC::Net = "net";
 
 const uchar DRC::BitTable[] = { 128, 64, 32, 16, 8, 4, 2, 1 };
 
-bool pixelsCollide(QImage * image1, QImage * image2, QImage * image3, int x1, int y1, int x2, int y2, uint clr, QList<QPointF> & points) {
+static const int CollisionTileRows = 128;
+
+struct CollisionTile {
+	const QImage * image1;
+	const QImage * image2;
+	QRect rect;
+};
+
+QVector<QPoint> collidingPixels(CollisionTile tile) {
+	// a set bit is white, so a collision is a pixel that is black in both images;
+	// test 32 pixels at a time and only walk the bits of words that have a collision
+	QVector<QPoint> pixels;
+	const uchar * bits1 = tile.image1->constBits();
+	const uchar * bits2 = tile.image2->constBits();
+	int bytesPerLine = tile.image1->bytesPerLine();
+	int x1 = tile.rect.left();
+	int x2 = tile.rect.right() + 1;
+	for (int y = tile.rect.top(); y <= tile.rect.bottom(); y++) {
+		const uchar * row1 = bits1 + y * bytesPerLine;
+		const uchar * row2 = bits2 + y * bytesPerLine;
+		for (int wx = x1 & ~31; wx < x2; wx += 32) {
+			// scanlines are 32-bit aligned, so a word never reads past the end of the line
+			quint32 word = ~(qFromBigEndian<quint32>(row1 + (wx >> 3)) | qFromBigEndian<quint32>(row2 + (wx >> 3)));
+			if (wx < x1) word &= 0xffffffffu >> (x1 - wx);
+			if (wx + 32 > x2) word &= ~(0xffffffffu >> (x2 - wx));
+			while (word) {
+				int bit = qCountLeadingZeroBits(word);
+				pixels.append(QPoint(wx + bit, y));
+				word &= ~(0x80000000u >> bit);
+			}
+		}
+	}
+
+	return pixels;
+}
+
+bool pixelsCollide(QImage * image1, QImage * image2, QImage * image3, int x1, int y1, int x2, int y2, uint clr, QList<QPointF> & points, const QPoint & offset = QPoint(0, 0), bool tiled = false) {
+	// image1 and image2 may be a window into image3; offset is the window's position in image3
+	QRect rect = QRect(QPoint(x1, y1), QPoint(x2 - 1, y2 - 1)).intersected(image1->rect());
+	if (rect.isEmpty()) return false;
+
+	QList< QFuture< QVector<QPoint> > > futures;
+	QList< QVector<QPoint> > results;
+	CollisionTile tile;
+	tile.image1 = image1;
+	tile.image2 = image2;
+	if (tiled && rect.height() > CollisionTileRows) {
+		for (int y = rect.top(); y <= rect.bottom(); y += CollisionTileRows) {
+			tile.rect = QRect(rect.left(), y, rect.width(), qMin(CollisionTileRows, rect.bottom() + 1 - y));
+			futures << QtConcurrent::run(collidingPixels, tile);
+		}
+		foreach (QFuture< QVector<QPoint> > future, futures) {
+			results << future.result();
+		}
+	}
+	else {
+		tile.rect = rect;
+		results << collidingPixels(tile);
+	}
+
 	bool result = false;
-	const uchar * bits1 = image1->constScanLine(0);
-	const uchar * bits2 = image2->constScanLine(0);
-	int bytesPerLine = image1->bytesPerLine();
-	for (int y = y1; y < y2; y++) {
-		int offset = y * bytesPerLine;
-		for (int x = x1; x < x2; x++) {
-			//QRgb p1 = image1->pixel(x, y);
-			//if (p1 == 0xffffffff) continue;
-
-			//QRgb p2 = image2->pixel(x, y);
-			//if (p2 == 0xffffffff) continue;
-
-			int byteOffset = (x >> 3) + offset;
-			uchar mask = DRC::BitTable[x & 7];
-
-			if (*(bits1 + byteOffset) & mask) continue;
-			if (*(bits2 + byteOffset) & mask) continue;
-
-			image3->setPixel(x, y, clr);
-			//DebugDialog::debug(QString("p1:%1 p2:%2").arg(p1, 0, 16).arg(p2, 0, 16));
+	foreach (QVector<QPoint> pixels, results) {
+		foreach (QPoint p, pixels) {
+			p += offset;
+			image3->setPixel(p, clr);
 			result = true;
 			if (points.count() < 1000) {
-				points.append(QPointF(x, y));
+				points.append(p);
 			}
 		}
 	}
@@ -122,6 +169,84 @@ void allGs(QDomElement & element) {
 	}
 }
 
+static const QStringList ShapeTags = QStringList() << "path" << "rect" << "circle" << "ellipse" << "line" << "polyline" << "polygon" << "text";
+
+void uncolorChildren(QDomElement & element) {
+	QDomElement child = element.firstChildElement();
+	while (!child.isNull()) {
+		child.removeAttribute("fill");
+		child.removeAttribute("stroke");
+		uncolorChildren(child);
+		child = child.nextSiblingElement();
+	}
+}
+
+void colorShapes(QDomElement & element, const QString & parentFill, const QString & parentStroke, QList<QDomElement> & shapes) {
+	// paint each shape element in a unique color so the vector DRC can map drawn outlines back to elements
+	QString fill = element.attribute("fill");
+	if (fill.isEmpty()) fill = parentFill;
+	QString stroke = element.attribute("stroke");
+	if (stroke.isEmpty()) stroke = parentStroke;
+
+	if (ShapeTags.contains(element.tagName())) {
+		QString color = QString("#%1").arg(shapes.count() + 1, 6, 16, QChar('0'));
+		element.setAttribute("drcindex", shapes.count());
+		element.setAttribute("fill", fill == "none" ? "none" : color);
+		element.setAttribute("stroke", stroke == "none" ? "none" : color);
+		uncolorChildren(element);           // tspans inherit from the text element
+		shapes << element;
+		return;
+	}
+
+	QDomElement child = element.firstChildElement();
+	while (!child.isNull()) {
+		colorShapes(child, fill, stroke, shapes);
+		child = child.nextSiblingElement();
+	}
+}
+
+void markPixels(QImage * displayImage, const QPointF & where, double radius, double dpi, QList<QPointF> & atPixels) {
+	// where and radius in mils
+	double scale = dpi / GraphicsUtils::StandardFritzingDPI;
+	QPointF center = where * scale;
+	int r = qMax(1, qCeil(radius * scale));
+	int x1 = qMax(0, qFloor(center.x()) - r);
+	int x2 = qMin(displayImage->width() - 1, qFloor(center.x()) + r);
+	int y1 = qMax(0, qFloor(center.y()) - r);
+	int y2 = qMin(displayImage->height() - 1, qFloor(center.y()) + r);
+	for (int y = y1; y <= y2; y++) {
+		for (int x = x1; x <= x2; x++) {
+			double dx = x - center.x();
+			double dy = y - center.y();
+			if (dx * dx + dy * dy > r * r) continue;
+
+			displayImage->setPixel(x, y, 1 /* 0x80ff0000 */);
+			if (atPixels.count() < 1000) {
+				atPixels.append(QPointF(x, y));
+			}
+		}
+	}
+}
+
+ConnectorItem * nearestConnector(const QList<ConnectorItem *> & connectorItems, const QList<QRectF> & rects, const QPointF & scenePoint) {
+	ConnectorItem * best = nullptr;
+	double bestDistance = 0;
+	for (int i = 0; i < connectorItems.count(); i++) {
+		QRectF rect = rects.at(i);
+		if (rect.contains(scenePoint)) return connectorItems.at(i);
+
+		double dx = qMax(0.0, qMax(rect.left() - scenePoint.x(), scenePoint.x() - rect.right()));
+		double dy = qMax(0.0, qMax(rect.top() - scenePoint.y(), scenePoint.y() - rect.bottom()));
+		double d = dx * dx + dy * dy;
+		if (best == nullptr || d < bestDistance) {
+			best = connectorItems.at(i);
+			bestDistance = d;
+		}
+	}
+
+	return best;
+}
+
 ///////////////////////////////////////////////
 
 DRCResultsDialog::DRCResultsDialog(const QString & message, const QStringList & messages, const QList<CollidingThing *> & collidingThings,
@@ -216,6 +341,9 @@ void DRCResultsDialog::releasedSlot(QListWidgetItem * item) {
 
 const QString DRC::KeepoutSettingName("DRC_Keepout");
 const double DRC::KeepoutDefaultMils = 10;
+const QString DRC::EngineSettingName("DRC_Engine");
+const QString DRC::VectorEngine("vector");
+const QString DRC::RasterEngine("raster");
 
 ///////////////////////////////////////////////
 
@@ -232,7 +360,8 @@ DRC::DRC(PCBSketchWidget * sketchWidget, ItemBase * board) :
     m_displayImage(nullptr),
     m_displayItem(nullptr),
     m_cancelled(false),
-    m_maxProgress(0)
+    m_maxProgress(0),
+    m_dpi(0)
 {
 	CancelledMessage = tr("DRC was cancelled.");
 }
@@ -298,23 +427,47 @@ QStringList DRC::start(bool showOkMessage, double keepoutMils) {
 	return messages;
 }
 
+bool DRC::check(double keepoutMils, QString & message, QList<DRCViolation> & violations) {
+	// no dialogs; used by the -drc service
+	QStringList messages;
+	QList<CollidingThing *> collidingThings;
+	bool result = startAux(message, messages, collidingThings, keepoutMils);
+
+	for (int i = 0; i < collidingThings.count(); i++) {
+		CollidingThing * collidingThing = collidingThings.at(i);
+		DRCViolation violation;
+		violation.message = messages.value(i);
+		violation.names = getNames(collidingThing);
+		if (collidingThing->atPixels.count() > 0 && m_dpi > 0) {
+			QRectF pixels(collidingThing->atPixels.first(), QSizeF(1, 1));
+			foreach (QPointF p, collidingThing->atPixels) {
+				pixels |= QRectF(p, QSizeF(1, 1));
+			}
+			double scale = GraphicsUtils::StandardFritzingDPI / m_dpi;
+			violation.location = QRectF(pixels.topLeft() * scale, pixels.size() * scale);
+		}
+		violations << violation;
+		delete collidingThing;
+	}
+
+	emit hideProgress();
+	return result;
+}
+
 bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThing *> & collidingThings, double keepoutMils) {
 	bool bothSidesNow = m_sketchWidget->boardLayers() == 2;
 
-	QList<ConnectorItem *> visited;
+	QSet<ConnectorItem *> visited;
 	QList< QList<ConnectorItem *> > equis;
 	QList< QList<ConnectorItem *> > singletons;
-	foreach (QGraphicsItem * item, m_sketchWidget->scene()->items()) {
-		ConnectorItem * connectorItem = dynamic_cast<ConnectorItem *>(item);
-		if (!connectorItem) continue;
+	ViewGeometry::WireFlags skipFlags = (ViewGeometry::RatsnestFlag | ViewGeometry::NormalFlag | ViewGeometry::PCBTraceFlag | ViewGeometry::SchematicTraceFlag) ^ m_sketchWidget->getTraceFlag();
+	foreach (ConnectorItem * connectorItem, m_sketchWidget->fgraphicsScene()->connectorItems()) {
 		if (!connectorItem->attachedTo()->isEverVisible()) continue;
 		if (connectorItem->attachedTo()->getRatsnest()) continue;
 		if (visited.contains(connectorItem)) continue;
 
-		QList<ConnectorItem *> equi;
-		equi.append(connectorItem);
-		ConnectorItem::collectEqualPotential(equi, bothSidesNow, (ViewGeometry::RatsnestFlag | ViewGeometry::NormalFlag | ViewGeometry::PCBTraceFlag | ViewGeometry::SchematicTraceFlag) ^ m_sketchWidget->getTraceFlag());
-		visited.append(equi);
+		QList<ConnectorItem *> equi = m_sketchWidget->connectivityIndex().equalPotential(connectorItem, bothSidesNow, skipFlags);
+		foreach (ConnectorItem * equ, equi) visited.insert(equ);
 
 		if (equi.count() == 1) {
 			singletons.append(equi);
@@ -346,6 +499,7 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 	ProcessEventBlocker::processEvents();
 
 	double dpi = qMax((double) 250, 1000 / keepoutMils);  // turns out making a variable dpi doesn't work due to vector-to-raster issues
+	m_dpi = dpi;
 	QRectF boardRect = m_board->sceneBoundingRect();
 	QRectF sourceRes(0, 0,
 					 boardRect.width() * dpi / GraphicsUtils::SVGDPI,
@@ -353,18 +507,35 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 
 	QSize imgSize(qCeil(sourceRes.width()), qCeil(sourceRes.height()));
 
-	m_plusImage = new QImage(imgSize, QImage::Format_Mono);
-	m_plusImage->fill(0xffffffff);
-
-	m_minusImage = new QImage(imgSize, QImage::Format_Mono);
-	m_minusImage->fill(0);
-
 	m_displayImage = new QImage(imgSize, QImage::Format_Indexed8);
 	m_displayImage->setColor(0, 0);
 	m_displayImage->setColor(1, 0x80ff0000);
 	m_displayImage->setColor(2, 0xffffff00);
 	m_displayImage->fill(0);
 
+	QList<ViewLayer::ViewLayerPlacement> layerSpecs;
+	layerSpecs << ViewLayer::NewBottom;
+	if (bothSidesNow) layerSpecs << ViewLayer::NewTop;
+
+	QSettings settings;
+	// the vector engine is opt-in until it has proven itself against the raster check
+	if (settings.value(EngineSettingName, RasterEngine).toString() == VectorEngine) {
+		combineSingletons(equis, singletons);
+		if (!startVector(message, messages, collidingThings, keepoutMils, dpi, equis, layerSpecs, progress)) {
+			return false;
+		}
+
+		checkHoles(messages, collidingThings, dpi);
+		checkCopperBoth(messages, collidingThings, dpi);
+		return true;
+	}
+
+	m_plusImage = new QImage(imgSize, QImage::Format_Mono);
+	m_plusImage->fill(0xffffffff);
+
+	m_minusImage = new QImage(imgSize, QImage::Format_Mono);
+	m_minusImage->fill(0);
+
 	if (!makeBoard(m_minusImage, sourceRes)) {
 		message = tr("Fritzing error: unable to render board svg.");
 		return false;
@@ -372,10 +543,6 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 
 	extendBorder(1, m_minusImage);   // since the resolution = keepout, extend by 1
 
-	QList<ViewLayer::ViewLayerPlacement> layerSpecs;
-	layerSpecs << ViewLayer::NewBottom;
-	if (bothSidesNow) layerSpecs << ViewLayer::NewTop;
-
 	int emptyMasterCount = 0;
 	foreach (ViewLayer::ViewLayerPlacement viewLayerPlacement, layerSpecs) {
 		if (viewLayerPlacement == ViewLayer::NewTop) {
@@ -387,12 +554,7 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 		LayerList viewLayerIDs = ViewLayer::copperLayers(viewLayerPlacement);
 		viewLayerIDs.removeOne(ViewLayer::GroundPlane0);
 		viewLayerIDs.removeOne(ViewLayer::GroundPlane1);
-		RenderThing renderThing;
-		renderThing.printerScale = GraphicsUtils::SVGDPI;
-		renderThing.blackOnly = true;
-		renderThing.dpi = GraphicsUtils::StandardFritzingDPI;
-		renderThing.hideTerminalPoints = renderThing.selectedItems = renderThing.renderBlocker = false;
-		QString master = m_sketchWidget->renderToSVG(renderThing, m_board, viewLayerIDs);
+		QString master = renderLayers(viewLayerIDs);
 		if (master.isEmpty()) {
 			if (++emptyMasterCount == layerSpecs.count()) {
 				message = tr("No traces or connectors to check");
@@ -432,7 +594,7 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 		}
 
 		QList<QPointF> atPixels;
-		if (pixelsCollide(m_plusImage, m_minusImage, m_displayImage, 0, 0, imgSize.width(), imgSize.height(), 1 /* 0x80ff0000 */, atPixels)) {
+		if (pixelsCollide(m_plusImage, m_minusImage, m_displayImage, 0, 0, imgSize.width(), imgSize.height(), 1 /* 0x80ff0000 */, atPixels, QPoint(0, 0), true)) {
 			CollidingThing * collidingThing = findItemsAt(atPixels, m_board, viewLayerIDs, keepoutMils, dpi, true, nullptr);
 			QString msg = tr("Too close to a border (%1 layer)")
 						  .arg(viewLayerPlacement == ViewLayer::NewTop ? ItemBase::TranslatedPropertyNames.value("top") : ItemBase::TranslatedPropertyNames.value("bottom"))
@@ -453,24 +615,7 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 
 	}
 
-	// we are checking all the singletons at once
-	// but the DRC will miss it if any of them overlap each other
-
-	while (singletons.count() > 0) {
-		QList<ConnectorItem *> combined;
-		QList<ConnectorItem *> singleton = singletons.takeFirst();
-		ItemBase * chief = singleton.at(0)->attachedTo()->layerKinChief();
-		combined.append(singleton);
-		for (int ix = singletons.count() - 1; ix >= 0; ix--) {
-			QList<ConnectorItem *> candidate = singletons.at(ix);
-			if (candidate.at(0)->attachedTo()->layerKinChief() == chief) {
-				combined.append(candidate);
-				singletons.removeAt(ix);
-			}
-		}
-
-		equis.append(combined);
-	}
+	combineSingletons(equis, singletons);
 
 	int index = 0;
 	foreach (ViewLayer::ViewLayerPlacement viewLayerPlacement, layerSpecs) {
@@ -498,10 +643,6 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 			}
 
 			// we have a net;
-			m_plusImage->fill(0xffffffff);
-			m_minusImage->fill(0xffffffff);
-			splitNet(masterDoc, equi, m_minusImage, m_plusImage, sourceRes, viewLayerPlacement, index++, keepoutMils);
-
 			QHash<ConnectorItem *, QRectF> rects;
 			QList<Wire *> wires;
 			foreach (ConnectorItem * equ, equi) {
@@ -520,6 +661,28 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 				}
 			}
 
+			// collisions are only looked for inside the connector rects, so only render that window
+			QRectF netRect;
+			foreach (QRectF rect, rects.values()) {
+				netRect |= rect;
+			}
+			netRect = netRect.intersected(boardRect);
+			QRect window(qFloor((netRect.left() - boardRect.left()) * dpi / GraphicsUtils::SVGDPI) - 1,
+						 qFloor((netRect.top() - boardRect.top()) * dpi / GraphicsUtils::SVGDPI) - 1,
+						 qCeil(netRect.width() * dpi / GraphicsUtils::SVGDPI) + 3,
+						 qCeil(netRect.height() * dpi / GraphicsUtils::SVGDPI) + 3);
+			window = window.intersected(QRect(QPoint(0, 0), imgSize));
+			if (window.isEmpty()) {
+				progress++;
+				continue;
+			}
+
+			QImage plusImage(window.size(), QImage::Format_Mono);
+			plusImage.fill(0xffffffff);
+			QImage minusImage(window.size(), QImage::Format_Mono);
+			minusImage.fill(0xffffffff);
+			splitNet(masterDoc, equi, &minusImage, &plusImage, sourceRes, window.topLeft(), viewLayerPlacement, index++, keepoutMils);
+
 			ProcessEventBlocker::processEvents();
 			if (m_cancelled) {
 				message = CancelledMessage;
@@ -528,17 +691,17 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 
 			foreach (ConnectorItem * equ, rects.keys()) {
 				QRectF rect = rects.value(equ).intersected(boardRect);
-				double l = (rect.left() - boardRect.left()) * dpi / GraphicsUtils::SVGDPI;
-				double t = (rect.top() - boardRect.top()) * dpi / GraphicsUtils::SVGDPI;
-				double r = (rect.right() - boardRect.left()) * dpi / GraphicsUtils::SVGDPI;
-				double b = (rect.bottom() - boardRect.top()) * dpi / GraphicsUtils::SVGDPI;
+				double l = (rect.left() - boardRect.left()) * dpi / GraphicsUtils::SVGDPI - window.left();
+				double t = (rect.top() - boardRect.top()) * dpi / GraphicsUtils::SVGDPI - window.top();
+				double r = (rect.right() - boardRect.left()) * dpi / GraphicsUtils::SVGDPI - window.left();
+				double b = (rect.bottom() - boardRect.top()) * dpi / GraphicsUtils::SVGDPI - window.top();
 				//DebugDialog::debug(QString("l:%1 t:%2 r:%3 b:%4").arg(l).arg(t).arg(r).arg(b));
 				QList<QPointF> atPixels;
-				if (pixelsCollide(m_plusImage, m_minusImage, m_displayImage, l, t, r, b, 1 /* 0x80ff0000 */, atPixels)) {
+				if (pixelsCollide(&plusImage, &minusImage, m_displayImage, l, t, r, b, 1 /* 0x80ff0000 */, atPixels, window.topLeft())) {
 
 #ifndef QT_NO_DEBUG
-					m_plusImage->save(FolderUtils::getTopLevelUserDataStorePath() + QString("/collidePlus%1_%2.png").arg(viewLayerPlacement).arg(index));
-					m_minusImage->save(FolderUtils::getTopLevelUserDataStorePath() + QString("/collideMinus%1_%2.png").arg(viewLayerPlacement).arg(index));
+					plusImage.save(FolderUtils::getTopLevelUserDataStorePath() + QString("/collidePlus%1_%2.png").arg(viewLayerPlacement).arg(index));
+					minusImage.save(FolderUtils::getTopLevelUserDataStorePath() + QString("/collideMinus%1_%2.png").arg(viewLayerPlacement).arg(index));
 #endif
 
 					CollidingThing * collidingThing = findItemsAt(atPixels, m_board, viewLayerIDs, keepoutMils, dpi, false, equ);
@@ -570,15 +733,242 @@ bool DRC::startAux(QString & message, QStringList & messages, QList<CollidingThi
 	return true;
 }
 
-bool DRC::makeBoard(QImage * image, QRectF & sourceRes) {
-	LayerList viewLayerIDs;
-	viewLayerIDs << ViewLayer::Board;
+bool DRC::startVector(QString & message, QStringList & messages, QList<CollidingThing *> & collidingThings, double keepoutMils, double dpi, QList< QList<ConnectorItem *> > & equis, const QList<ViewLayer::ViewLayerPlacement> & layerSpecs, int & progress)
+{
+	// works on the copper outlines themselves: shapes are recorded from the rendered svg,
+	// indexed in an R-tree, and only nearby pairs from different nets get an exact clearance test
+
+	QRectF boardRect = m_board->sceneBoundingRect();
+	QSizeF size(boardRect.width() * GraphicsUtils::StandardFritzingDPI / GraphicsUtils::SVGDPI,
+				boardRect.height() * GraphicsUtils::StandardFritzingDPI / GraphicsUtils::SVGDPI);
+
+	LayerList boardLayerIDs;
+	boardLayerIDs << ViewLayer::Board;
+	QString boardSvg = renderLayers(boardLayerIDs);
+	if (boardSvg.isEmpty()) {
+		message = tr("Fritzing error: unable to render board svg.");
+		return false;
+	}
+
+	QPainterPath boardPath;
+	foreach (DRCShape shape, ShapeRecorder::record(boardSvg.toUtf8(), size)) {
+		boardPath = boardPath.united(shape.path);
+	}
+	QList<QPolygonF> boardEdges = boardPath.toSubpathPolygons();
+
+	Markers markers;
+	markers.outID = AlsoNet;
+	markers.inTerminalID = markers.inSvgID = markers.inSvgAndID = markers.inNoID = Net;
+
+	int emptyMasterCount = 0;
+	foreach (ViewLayer::ViewLayerPlacement viewLayerPlacement, layerSpecs) {
+		if (viewLayerPlacement == ViewLayer::NewTop) emit wantTopVisible();
+		else emit wantBottomVisible();
+
+		QString layerName = (viewLayerPlacement == ViewLayer::NewTop ? ItemBase::TranslatedPropertyNames.value("top") : ItemBase::TranslatedPropertyNames.value("bottom"));
+
+		LayerList viewLayerIDs = ViewLayer::copperLayers(viewLayerPlacement);
+		viewLayerIDs.removeOne(ViewLayer::GroundPlane0);
+		viewLayerIDs.removeOne(ViewLayer::GroundPlane1);
+		QString master = renderLayers(viewLayerIDs);
+		if (master.isEmpty()) {
+			if (++emptyMasterCount == layerSpecs.count()) {
+				message = tr("No traces or connectors to check");
+				return false;
+			}
+
+			progress += equis.count() + 1;
+			continue;
+		}
+
+		QDomDocument * masterDoc = new QDomDocument();
+		m_masterDocs.insert(viewLayerPlacement, masterDoc);
+		if (!masterDoc->setContent(master)) {
+			message = tr("Unexpected SVG rendering failure--contact fritzing.org");
+			return false;
+		}
+
+		QDomElement root = masterDoc->documentElement();
+		SvgFileSplitter::fixStyleAttributeRecurse(root);
+		QList<QDomElement> shapeElements;
+		colorShapes(root, "black", "none", shapeElements);
+
+		// assign each shape element to the net that claims it; unclaimed copper is an obstacle to every net
+		QVector<int> owners(shapeElements.count(), -1);
+		QList< QList<ConnectorItem *> > netConnectorItems;
+		QList< QList<QRectF> > netRects;
+		for (int n = 0; n < equis.count(); n++) {
+			QList<ConnectorItem *> equi = equis.at(n);
+			QList<ConnectorItem *> connectorItems;
+			QList<QRectF> rects;
+			QList<Wire *> wires;
+			foreach (ConnectorItem * equ, equi) {
+				if (!viewLayerIDs.contains(equ->attachedToViewLayerID())) continue;
+
+				if (equ->attachedToItemType() == ModelPart::Wire) {
+					Wire * wire = qobject_cast<Wire *>(equ->attachedTo());
+					if (wires.contains(wire)) continue;
+
+					wires.append(wire);
+					connectorItems << equ;
+					rects << wire->sceneBoundingRect();
+				}
+				else {
+					connectorItems << equ;
+					rects << equ->sceneBoundingRect();
+				}
+			}
+			netConnectorItems << connectorItems;
+			netRects << rects;
+
+			if (connectorItems.isEmpty()) {
+				progress++;
+				continue;
+			}
+
+			QList<QDomElement> net;
+			QList<QDomElement> alsoNet;
+			QList<QDomElement> notNet;
+			splitNetPrep(masterDoc, equi, markers, net, alsoNet, notNet, true);
+			foreach (QDomElement element, net) {
+				bool ok;
+				int ix = element.attribute("drcindex").toInt(&ok);
+				if (ok && owners.at(ix) < 0) owners[ix] = n;
+			}
+
+			// leave the document clean for the next net
+			foreach (QDomElement element, net + alsoNet + notNet) {
+				element.removeAttribute("net");
+				element.removeAttribute("former");
+			}
+
+			emit setProgressValue(progress++);
+
+			ProcessEventBlocker::processEvents();
+			if (m_cancelled) {
+				message = CancelledMessage;
+				return false;
+			}
+		}
+
+		QList<DRCShape> shapes = ShapeRecorder::record(masterDoc->toByteArray(), size);
+		QList<int> shapeNets;
+		QList<QRectF> shapeBounds;
+		foreach (DRCShape shape, shapes) {
+			shapeNets << ((shape.element >= 0 && shape.element < owners.count()) ? owners.at(shape.element) : -1);
+			shapeBounds << shape.bounds;
+		}
+
+		QList<QPointF> borderPixels;
+		foreach (DRCShape shape, shapes) {
+			QPointF where;
+			if (DRCGeometry::tooCloseToBorder(shape, boardPath, boardEdges, keepoutMils, where)) {
+				markPixels(m_displayImage, where, keepoutMils, dpi, borderPixels);
+			}
+		}
+		if (borderPixels.count() > 0) {
+			CollidingThing * collidingThing = findItemsAt(borderPixels, m_board, viewLayerIDs, keepoutMils, dpi, true, nullptr);
+			QString msg = tr("Too close to a border (%1 layer)").arg(layerName);
+			emit setProgressMessage(msg);
+			messages << msg;
+			collidingThings << collidingThing;
+			updateDisplay();
+		}
+
+		ShapeTree tree;
+		tree.build(shapeBounds);
+
+		QList<ConnectorItem *> overlapping;
+		QHash<ConnectorItem *, CollidingThing *> overlaps;
+		for (int i = 0; i < shapes.count(); i++) {
+			const DRCShape & shape = shapes.at(i);
+			foreach (int j, tree.query(shape.bounds.adjusted(-keepoutMils, -keepoutMils, keepoutMils, keepoutMils))) {
+				if (j <= i) continue;
+				if (shapeNets.at(i) == shapeNets.at(j)) continue;       // same net, or two unclaimed shapes
+
+				QPointF where;
+				if (!DRCGeometry::tooClose(shape, shapes.at(j), keepoutMils, where)) continue;
+
+				QPointF scenePoint = boardRect.topLeft() + where * GraphicsUtils::SVGDPI / GraphicsUtils::StandardFritzingDPI;
+				QList<int> nets;
+				nets << shapeNets.at(i) << shapeNets.at(j);
+				foreach (int n, nets) {
+					if (n < 0) continue;
+
+					ConnectorItem * connectorItem = nearestConnector(netConnectorItems.at(n), netRects.at(n), scenePoint);
+					CollidingThing * collidingThing = overlaps.value(connectorItem, nullptr);
+					if (collidingThing == nullptr) {
+						QList<QPointF> atPixels;
+						collidingThing = findItemsAt(atPixels, m_board, viewLayerIDs, keepoutMils, dpi, false, connectorItem);
+						overlaps.insert(connectorItem, collidingThing);
+						overlapping << connectorItem;
+					}
+					markPixels(m_displayImage, where, keepoutMils, dpi, collidingThing->atPixels);
+				}
+			}
+
+			if ((i % 1000) == 999) {
+				ProcessEventBlocker::processEvents();
+				if (m_cancelled) {
+					message = CancelledMessage;
+					return false;
+				}
+			}
+		}
+
+		foreach (ConnectorItem * connectorItem, overlapping) {
+			CollidingThing * collidingThing = overlaps.value(connectorItem);
+			QStringList names = getNames(collidingThing);
+			QString msg = tr("%1 is overlapping (%2 layer)").arg(names.value(0)).arg(layerName);
+			messages << msg;
+			collidingThings << collidingThing;
+			emit setProgressMessage(msg);
+		}
+		if (overlapping.count() > 0) {
+			updateDisplay();
+		}
+
+		emit setProgressValue(progress++);
+	}
+
+	return true;
+}
+
+void DRC::combineSingletons(QList< QList<ConnectorItem *> > & equis, QList< QList<ConnectorItem *> > & singletons) {
+	// we are checking all the singletons at once
+	// but the DRC will miss it if any of them overlap each other
+
+	while (singletons.count() > 0) {
+		QList<ConnectorItem *> combined;
+		QList<ConnectorItem *> singleton = singletons.takeFirst();
+		ItemBase * chief = singleton.at(0)->attachedTo()->layerKinChief();
+		combined.append(singleton);
+		for (int ix = singletons.count() - 1; ix >= 0; ix--) {
+			QList<ConnectorItem *> candidate = singletons.at(ix);
+			if (candidate.at(0)->attachedTo()->layerKinChief() == chief) {
+				combined.append(candidate);
+				singletons.removeAt(ix);
+			}
+		}
+
+		equis.append(combined);
+	}
+}
+
+QString DRC::renderLayers(const LayerList & viewLayerIDs) {
+	// svg units come out in mils (StandardFritzingDPI), the same units as the keepout
 	RenderThing renderThing;
 	renderThing.printerScale = GraphicsUtils::SVGDPI;
 	renderThing.blackOnly = true;
 	renderThing.dpi = GraphicsUtils::StandardFritzingDPI;
 	renderThing.hideTerminalPoints = renderThing.selectedItems = renderThing.renderBlocker = false;
-	QString boardSvg = m_sketchWidget->renderToSVG(renderThing, m_board, viewLayerIDs);
+	return m_sketchWidget->renderToSVG(renderThing, m_board, viewLayerIDs);
+}
+
+bool DRC::makeBoard(QImage * image, QRectF & sourceRes) {
+	LayerList viewLayerIDs;
+	viewLayerIDs << ViewLayer::Board;
+	QString boardSvg = renderLayers(viewLayerIDs);
 	if (boardSvg.isEmpty()) {
 		return false;
 	}
@@ -608,7 +998,7 @@ bool DRC::makeBoard(QImage * image, QRectF & sourceRes) {
 	return true;
 }
 
-void DRC::splitNet(QDomDocument * masterDoc, QList<ConnectorItem *> & equi, QImage * minusImage, QImage * plusImage, QRectF & sourceRes, ViewLayer::ViewLayerPlacement viewLayerPlacement, int index, double keepoutMils) {
+void DRC::splitNet(QDomDocument * masterDoc, QList<ConnectorItem *> & equi, QImage * minusImage, QImage * plusImage, QRectF & sourceRes, const QPoint & windowOffset, ViewLayer::ViewLayerPlacement viewLayerPlacement, int index, double keepoutMils) {
 	// deal with connectors on the same part, even though they are not on the same net
 	// in other words, make sure there are no overlaps of connectors on the same part
 	QList<QDomElement> net;
@@ -625,7 +1015,7 @@ void DRC::splitNet(QDomDocument * masterDoc, QList<ConnectorItem *> & equi, QIma
 		SvgFileSplitter::forceStrokeWidth(element, -2 * keepoutMils, "#000000", false, false);
 	}
 
-	ItemBase::renderOne(masterDoc, plusImage, sourceRes);
+	renderWindow(masterDoc, plusImage, sourceRes, windowOffset);
 
 	foreach (QDomElement element, net) {
 		// restore to keepout size
@@ -653,7 +1043,7 @@ void DRC::splitNet(QDomDocument * masterDoc, QList<ConnectorItem *> & equi, QIma
 		element.removeAttribute("net");
 	}
 
-	ItemBase::renderOne(masterDoc, minusImage, sourceRes);
+	renderWindow(masterDoc, minusImage, sourceRes, windowOffset);
 #ifndef QT_NO_DEBUG
 	minusImage->save(FolderUtils::getTopLevelUserDataStorePath() + QString("/splitNetMinus%1_%2.png").arg(viewLayerPlacement).arg(index));
 #endif
@@ -665,19 +1055,36 @@ void DRC::splitNet(QDomDocument * masterDoc, QList<ConnectorItem *> & equi, QIma
 
 }
 
+void DRC::renderWindow(QDomDocument * masterDoc, QImage * image, const QRectF & sourceRes, const QPoint & windowOffset) {
+	// image covers only part of sourceRes, starting at windowOffset; the rest is clipped away
+	QByteArray byteArray = masterDoc->toByteArray();
+	QSvgRenderer renderer(byteArray);
+	QPainter painter;
+	painter.begin(image);
+	painter.setRenderHint(QPainter::Antialiasing, false);
+	painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+	painter.setClipRect(QRect(QPoint(0, 0), image->size()));
+	painter.translate(-windowOffset);
+	renderer.render(&painter, sourceRes);
+	painter.end();
+}
+
 void DRC::splitNetPrep(QDomDocument * masterDoc, QList<ConnectorItem *> & equi, const Markers & markers, QList<QDomElement> & net, QList<QDomElement> & alsoNet, QList<QDomElement> & notNet, bool checkIntersection)
 {
-	QMultiHash<QString, QString> partSvgIDs;
-	QMultiHash<QString, QString> partTerminalIDs;
-	QHash<QString, QString> bothIDs;
-	QMultiHash<QString, ItemBase *> itemBases;
-	QSet<QString> wireIDs;
+	SplitNetIDs ids;
+	collectSplitNetIDs(equi, checkIntersection, ids);
+	splitNetPrep(masterDoc, ids, markers, net, alsoNet, notNet, checkIntersection);
+}
+
+void DRC::collectSplitNetIDs(QList<ConnectorItem *> & equi, bool checkIntersection, SplitNetIDs & ids)
+{
+	QHash<QString, ItemBase *> itemBases;
 	foreach (ConnectorItem * equ, equi) {
 		ItemBase * itemBase = equ->attachedTo();
 		if (!itemBase) continue;
 
 		if (itemBase->itemType() == ModelPart::Wire) {
-			wireIDs.insert(QString::number(itemBase->id()));
+			ids.wireIDs.insert(QString::number(itemBase->id()));
 		}
 
 		if (!equ->connector()) {
@@ -689,14 +1096,42 @@ void DRC::splitNetPrep(QDomDocument * masterDoc, QList<ConnectorItem *> & equi,
 
 		QString sid = QString::number(itemBase->id());
 		SvgIdLayer * svgIdLayer = equ->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
-		partSvgIDs.insert(sid, svgIdLayer->m_svgId);
+		ids.partSvgIDs.insert(sid, svgIdLayer->m_svgId);
 		if (!svgIdLayer->m_terminalId.isEmpty()) {
-			partTerminalIDs.insert(sid, svgIdLayer->m_terminalId);
-			bothIDs.insert(sid + svgIdLayer->m_svgId, svgIdLayer->m_terminalId);
+			ids.partTerminalIDs.insert(sid, svgIdLayer->m_terminalId);
+			ids.bothIDs.insert(sid + svgIdLayer->m_svgId, svgIdLayer->m_terminalId);
 		}
-		itemBases.insert(sid, itemBase);
+		if (!itemBases.contains(sid)) itemBases.insert(sid, itemBase);
 	}
 
+	if (!checkIntersection) return;
+
+	foreach (QString sid, itemBases.keys()) {
+		if (ids.wireIDs.contains(sid)) continue;
+
+		ItemBase * itemBase = itemBases.value(sid);
+		QStringList svgIDs = ids.partSvgIDs.values(sid);
+		QStringList terminalIDs = ids.partTerminalIDs.values(sid);
+		QStringList notSvgIDs;
+		QStringList notTerminalIDs;
+		foreach (ConnectorItem * connectorItem, itemBase->cachedConnectorItems()) {
+			SvgIdLayer * svgIdLayer = connectorItem->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
+			if (!svgIDs.contains(svgIdLayer->m_svgId)) {
+				notSvgIDs.append(svgIdLayer->m_svgId);
+			}
+			if (!svgIdLayer->m_terminalId.isEmpty()) {
+				if (!terminalIDs.contains(svgIdLayer->m_terminalId)) {
+					notTerminalIDs.append(svgIdLayer->m_terminalId);
+				}
+			}
+		}
+		ids.notSvgIDs.insert(sid, notSvgIDs);
+		ids.notTerminalIDs.insert(sid, notTerminalIDs);
+	}
+}
+
+void DRC::splitNetPrep(QDomDocument * masterDoc, const SplitNetIDs & ids, const Markers & markers, QList<QDomElement> & net, QList<QDomElement> & alsoNet, QList<QDomElement> & notNet, bool checkIntersection)
+{
 	QList<QDomElement> todo;
 	todo << masterDoc->documentElement();
 	bool firstTime = true;
@@ -719,16 +1154,14 @@ void DRC::splitNetPrep(QDomDocument * masterDoc, QList<ConnectorItem *> & equi,
 
 		QString partID = element.attribute("partID");
 		if (!partID.isEmpty()) {
-			QStringList svgIDs = partSvgIDs.values(partID);
-			QStringList terminalIDs = partTerminalIDs.values(partID);
-			if (svgIDs.count() == 0) {
+			if (!ids.partSvgIDs.contains(partID)) {
 				markSubs(element, NotNet);
 			}
-			else if (wireIDs.contains(partID)) {
+			else if (ids.wireIDs.contains(partID)) {
 				markSubs(element, Net);
 			}
 			else {
-				splitSubs(masterDoc, element, partID, markers, svgIDs, terminalIDs, itemBases.values(partID), bothIDs, checkIntersection);
+				splitSubs(masterDoc, element, partID, markers, ids, checkIntersection);
 			}
 		}
 
@@ -765,28 +1198,16 @@ void DRC::markSubs(QDomElement & root, const QString & mark) {
 	}
 }
 
-void DRC::splitSubs(QDomDocument * doc, QDomElement & root, const QString & partID, const Markers & markers, const QStringList & svgIDs, const QStringList & terminalIDs, const QList<ItemBase *> & itemBases, QHash<QString, QString> & bothIDs, bool checkIntersection)
+void DRC::splitSubs(QDomDocument * doc, QDomElement & root, const QString & partID, const Markers & markers, const SplitNetIDs & ids, bool checkIntersection)
 {
 	//QString string;
 	//QTextStream stream(&string);
 	//root.save(stream, 0);
 
-	QStringList notSvgIDs;
-	QStringList notTerminalIDs;
-	if (checkIntersection && itemBases.count() > 0) {
-		ItemBase * itemBase = itemBases.at(0);
-		foreach (ConnectorItem * connectorItem, itemBase->cachedConnectorItems()) {
-			SvgIdLayer * svgIdLayer = connectorItem->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
-			if (!svgIDs.contains(svgIdLayer->m_svgId)) {
-				notSvgIDs.append(svgIdLayer->m_svgId);
-			}
-			if (!svgIdLayer->m_terminalId.isEmpty()) {
-				if (!terminalIDs.contains(svgIdLayer->m_terminalId)) {
-					notTerminalIDs.append(svgIdLayer->m_terminalId);
-				}
-			}
-		}
-	}
+	QStringList svgIDs = ids.partSvgIDs.values(partID);
+	QStringList terminalIDs = ids.partTerminalIDs.values(partID);
+	QStringList notSvgIDs = ids.notSvgIDs.value(partID);
+	QStringList notTerminalIDs = ids.notTerminalIDs.value(partID);
 
 	// split subelements of a part into separate nets
 	QList<QDomElement> todo;
@@ -797,7 +1218,7 @@ void DRC::splitSubs(QDomDocument * doc, QDomElement & root, const QString & part
 		QString svgID = element.attribute("id");
 		if (!svgID.isEmpty()) {
 			if (svgIDs.contains(svgID)) {
-				if (bothIDs.value(partID + svgID).isEmpty()) {
+				if (ids.bothIDs.value(partID + svgID).isEmpty()) {
 					// no terminal point
 					markSubs(element, markers.inSvgID);
 				}
@@ -1031,9 +1452,8 @@ void DRC::checkHoles(QStringList & messages, QList<CollidingThing *> & colliding
 void DRC::checkCopperBoth(QStringList & messages, QList<CollidingThing *> & collidingThings, double dpi) {
 	QRectF boardRect = m_board->sceneBoundingRect();
 	QList<ItemBase *> visited;
-	foreach (QGraphicsItem * item, m_sketchWidget->scene()->items()) {
-		ItemBase * itemBase = dynamic_cast<ItemBase *>(item);
-		if (!itemBase) continue;
+	foreach (ItemBase * item, m_sketchWidget->fgraphicsScene()->itemBases()) {
+		ItemBase * itemBase = item;
 		if (!itemBase->isEverVisible()) continue;
 		if (itemBase->modelPart()->isCore()) continue;
 
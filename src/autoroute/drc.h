@@ -31,6 +31,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QRadioButton>
 #include <QListWidgetItem>
 #include <QPointer>
+#include <QHash>
+#include <QSet>
 
 #include "../svg/svgfilesplitter.h"
 #include "../viewlayer.h"
@@ -40,6 +42,12 @@ struct CollidingThing {
 	QList<QPointF> atPixels;
 };
 
+struct DRCViolation {
+	QString message;
+	QStringList names;
+	QRectF location;            // in mils, relative to the top left of the board
+};
+
 struct Markers {
 	QString inSvgID;
 	QString inSvgAndID;
@@ -48,6 +56,16 @@ struct Markers {
 	QString outID;
 };
 
+struct SplitNetIDs {
+	// what splitNetPrep needs from a net's connectors, collected up front so the split itself only touches the document
+	QMultiHash<QString, QString> partSvgIDs;
+	QMultiHash<QString, QString> partTerminalIDs;
+	QHash<QString, QString> bothIDs;
+	QSet<QString> wireIDs;
+	QHash<QString, QStringList> notSvgIDs;			// per part: connectors not in the net
+	QHash<QString, QStringList> notTerminalIDs;
+};
+
 class PCBSketchWidget;
 class ItemBase;
 class ConnectorItem;
@@ -60,9 +78,12 @@ public:
 	virtual ~DRC();
 
 	QStringList start(bool showOkMessage, double keepoutMils);
+	bool check(double keepoutMils, QString & message, QList<DRCViolation> &);
 
 public:
 	static void splitNetPrep(QDomDocument * masterDoc, QList<ConnectorItem *> & equi, const Markers &, QList<QDomElement> & net, QList<QDomElement> & alsoNet, QList<QDomElement> & notNet, bool checkIntersection);
+	static void splitNetPrep(QDomDocument * masterDoc, const SplitNetIDs &, const Markers &, QList<QDomElement> & net, QList<QDomElement> & alsoNet, QList<QDomElement> & notNet, bool checkIntersection);
+	static void collectSplitNetIDs(QList<ConnectorItem *> & equi, bool checkIntersection, SplitNetIDs &);
 	static void extendBorder(double keepoutImagePixels, QImage * image);
 
 public slots:
@@ -84,20 +105,27 @@ public:
 	static const uchar BitTable[];
 	static const QString KeepoutSettingName;
 	static const double KeepoutDefaultMils;
+	static const QString EngineSettingName;
+	static const QString VectorEngine;
+	static const QString RasterEngine;
 
 protected:
+	QString renderLayers(const LayerList &);
 	bool makeBoard(QImage *, QRectF & sourceRes);
-	void splitNet(QDomDocument *, QList<ConnectorItem *> &, QImage * minusImage, QImage * plusImage, QRectF & sourceRes, ViewLayer::ViewLayerPlacement viewLayerPlacement, int index, double keepoutMils);
+	void splitNet(QDomDocument *, QList<ConnectorItem *> &, QImage * minusImage, QImage * plusImage, QRectF & sourceRes, const QPoint & windowOffset, ViewLayer::ViewLayerPlacement viewLayerPlacement, int index, double keepoutMils);
 	void updateDisplay();
 	bool startAux(QString & message, QStringList & messages, QList<CollidingThing *> &, double keepoutMils);
+	bool startVector(QString & message, QStringList & messages, QList<CollidingThing *> &, double keepoutMils, double dpi, QList< QList<ConnectorItem *> > & equis, const QList<ViewLayer::ViewLayerPlacement> & layerSpecs, int & progress);
 	CollidingThing * findItemsAt(QList<QPointF> &, ItemBase * board, const LayerList & viewLayerIDs, double keepout, double dpi, bool skipHoles, ConnectorItem * already);
 	void checkHoles(QStringList & messages, QList<CollidingThing *> & collidingThings, double dpi);
 	void checkCopperBoth(QStringList & messages, QList<CollidingThing *> & collidingThings, double dpi);
 	QList<ConnectorItem *> missingCopper(const QString & layerName, ViewLayer::ViewLayerID, ItemBase *, const QDomElement & svgRoot);
 
 protected:
+	static void renderWindow(QDomDocument *, QImage *, const QRectF & sourceRes, const QPoint & windowOffset);
+	static void combineSingletons(QList< QList<ConnectorItem *> > & equis, QList< QList<ConnectorItem *> > & singletons);
 	static void markSubs(QDomElement & root, const QString & mark);
-	static void splitSubs(QDomDocument *, QDomElement & root, const QString & partID, const Markers &, const QStringList & svgIDs,  const QStringList & terminalIDs, const QList<ItemBase *> &, QHash<QString, QString> & both, bool checkIntersection);
+	static void splitSubs(QDomDocument *, QDomElement & root, const QString & partID, const Markers &, const SplitNetIDs &, bool checkIntersection);
 
 protected:
 	PCBSketchWidget * m_sketchWidget;
@@ -110,6 +138,7 @@ protected:
 	QHash<ViewLayer::ViewLayerPlacement, QDomDocument *> m_masterDocs;
 	bool m_cancelled;
 	int m_maxProgress;
+	double m_dpi;
 };
 
 class DRCResultsDialog : public QDialog
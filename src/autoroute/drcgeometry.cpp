@@ -0,0 +1,497 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "drcgeometry.h"
+
+#include <qmath.h>
+#include <QPainter>
+#include <QPainterPathStroker>
+#include <QPixmap>
+#include <QSvgRenderer>
+
+#include <algorithm>
+
+const int DRCGeometry::TreeNodeSize = 16;
+const double DRCGeometry::Tolerance = 0.1;          // in the units of the keepout; absorbs flattening error
+
+///////////////////////////////////////////
+
+struct CenterLess {
+	const QVector<QRectF> * boxes;
+	bool byX;
+
+	bool operator()(int a, int b) const {
+		if (byX) return boxes->at(a).center().x() < boxes->at(b).center().x();
+		return boxes->at(a).center().y() < boxes->at(b).center().y();
+	}
+};
+
+static inline bool boxesNear(const QPointF & p1, const QPointF & p2, const QPointF & q1, const QPointF & q2, double keepout) {
+	if (qMin(p1.x(), p2.x()) - keepout > qMax(q1.x(), q2.x())) return false;
+	if (qMin(q1.x(), q2.x()) - keepout > qMax(p1.x(), p2.x())) return false;
+	if (qMin(p1.y(), p2.y()) - keepout > qMax(q1.y(), q2.y())) return false;
+	if (qMin(q1.y(), q2.y()) - keepout > qMax(p1.y(), p2.y())) return false;
+	return true;
+}
+
+static inline bool nearBox(const QPointF & p1, const QPointF & p2, const QRectF & box, double keepout) {
+	if (qMin(p1.x(), p2.x()) - keepout > box.right()) return false;
+	if (qMax(p1.x(), p2.x()) + keepout < box.left()) return false;
+	if (qMin(p1.y(), p2.y()) - keepout > box.bottom()) return false;
+	if (qMax(p1.y(), p2.y()) + keepout < box.top()) return false;
+	return true;
+}
+
+static inline double cross(const QPointF & o, const QPointF & a, const QPointF & b) {
+	return (a.x() - o.x()) * (b.y() - o.y()) - (a.y() - o.y()) * (b.x() - o.x());
+}
+
+static double pointSegmentDistance(const QPointF & p, const QPointF & a, const QPointF & b, QPointF & nearest) {
+	double dx = b.x() - a.x();
+	double dy = b.y() - a.y();
+	double len2 = dx * dx + dy * dy;
+	double t = 0;
+	if (len2 > 0) {
+		t = ((p.x() - a.x()) * dx + (p.y() - a.y()) * dy) / len2;
+		t = qBound(0.0, t, 1.0);
+	}
+	nearest = QPointF(a.x() + t * dx, a.y() + t * dy);
+	return QLineF(p, nearest).length();
+}
+
+///////////////////////////////////////////
+
+ShapeRecorderEngine::ShapeRecorderEngine(QList<DRCShape> & shapes) :
+	QPaintEngine(QPaintEngine::AllFeatures),
+	m_shapes(shapes),
+	m_opacity(1)
+{
+}
+
+bool ShapeRecorderEngine::begin(QPaintDevice *) {
+	m_transform.reset();
+	m_pen = QPen();
+	m_brush = QBrush();
+	m_opacity = 1;
+	return true;
+}
+
+bool ShapeRecorderEngine::end() {
+	return true;
+}
+
+QPaintEngine::Type ShapeRecorderEngine::type() const {
+	return QPaintEngine::User;
+}
+
+void ShapeRecorderEngine::updateState(const QPaintEngineState & state) {
+	QPaintEngine::DirtyFlags flags = state.state();
+	if (flags & QPaintEngine::DirtyTransform) m_transform = state.transform();
+	if (flags & QPaintEngine::DirtyPen) m_pen = state.pen();
+	if (flags & QPaintEngine::DirtyBrush) m_brush = state.brush();
+	if (flags & QPaintEngine::DirtyOpacity) m_opacity = state.opacity();
+}
+
+void ShapeRecorderEngine::drawPath(const QPainterPath & path) {
+	if (m_opacity <= 0) return;
+
+	if (m_brush.style() != Qt::NoBrush && m_brush.color().alpha() > 0) {
+		addShape(m_transform.map(path), m_brush.color());
+	}
+
+	if (m_pen.style() != Qt::NoPen && m_pen.widthF() > 0 && m_pen.color().alpha() > 0) {
+		QPainterPathStroker stroker;
+		stroker.setWidth(m_pen.widthF());
+		stroker.setCapStyle(m_pen.capStyle());
+		stroker.setJoinStyle(m_pen.joinStyle());
+		stroker.setMiterLimit(m_pen.miterLimit());
+		if (m_pen.style() != Qt::SolidLine) {
+			stroker.setDashPattern(m_pen.dashPattern());
+			stroker.setDashOffset(m_pen.dashOffset());
+		}
+		QPainterPath stroke = stroker.createStroke(path);
+		stroke.setFillRule(Qt::WindingFill);
+		addShape(m_transform.map(stroke), m_pen.color());
+	}
+}
+
+void ShapeRecorderEngine::drawPolygon(const QPointF * points, int pointCount, PolygonDrawMode mode) {
+	if (pointCount <= 0) return;
+
+	QPainterPath path;
+	path.moveTo(points[0]);
+	for (int i = 1; i < pointCount; i++) {
+		path.lineTo(points[i]);
+	}
+
+	if (mode == QPaintEngine::PolylineMode) {
+		QBrush brush = m_brush;
+		m_brush = QBrush();
+		drawPath(path);
+		m_brush = brush;
+		return;
+	}
+
+	path.closeSubpath();
+	path.setFillRule(mode == QPaintEngine::OddEvenMode ? Qt::OddEvenFill : Qt::WindingFill);
+	drawPath(path);
+}
+
+void ShapeRecorderEngine::drawPixmap(const QRectF & r, const QPixmap & pixmap, const QRectF & sr) {
+	drawImage(r, pixmap.toImage(), sr, Qt::AutoColor);
+}
+
+void ShapeRecorderEngine::drawImage(const QRectF & r, const QImage & image, const QRectF & sr, Qt::ImageConversionFlags) {
+	// a bitmap (a copper image logo, say) has no outline to record, so outline the pixels the raster check would count as copper;
+	// the color can't name an svg element, so the shape is an obstacle to every net
+	if (m_opacity <= 0) return;
+
+	QRect source = sr.toAlignedRect().intersected(image.rect());
+	if (source.isEmpty()) return;
+
+	QPainterPath path = darkPixels(image.copy(source));
+	if (path.isEmpty()) return;
+
+	QTransform toTarget;
+	toTarget.translate(r.left(), r.top());
+	toTarget.scale(r.width() / source.width(), r.height() / source.height());
+	addShape(m_transform.map(toTarget.map(path)), QColor(0, 0, 0));
+}
+
+QPainterPath ShapeRecorderEngine::darkPixels(const QImage & original) {
+	// runs of opaque dark pixels, row by row; rows with the same runs are merged before the outline is simplified
+	QImage image = original.convertToFormat(QImage::Format_ARGB32);
+	QPainterPath path;
+	QList<QRect> open;
+	for (int y = 0; y <= image.height(); y++) {
+		QList<QRect> runs;
+		if (y < image.height()) {
+			const QRgb * line = (const QRgb *) image.constScanLine(y);
+			int x = 0;
+			while (x < image.width()) {
+				if (qAlpha(line[x]) < 128 || qGray(line[x]) >= 128) {
+					x++;
+					continue;
+				}
+
+				int start = x;
+				while (x < image.width() && qAlpha(line[x]) >= 128 && qGray(line[x]) < 128) x++;
+				runs << QRect(start, y, x - start, 1);
+			}
+		}
+
+		QList<QRect> next;
+		foreach (QRect run, runs) {
+			bool extended = false;
+			for (int i = 0; i < open.count(); i++) {
+				if (open.at(i).left() == run.left() && open.at(i).right() == run.right()) {
+					QRect rect = open.takeAt(i);
+					rect.setBottom(y);
+					next << rect;
+					extended = true;
+					break;
+				}
+			}
+			if (!extended) next << run;
+		}
+		foreach (QRect rect, open) {
+			path.addRect(rect);
+		}
+		open = next;
+	}
+
+	path.setFillRule(Qt::WindingFill);
+	return path.simplified();
+}
+
+void ShapeRecorderEngine::addShape(const QPainterPath & path, const QColor & color) {
+	if (path.isEmpty()) return;
+
+	DRCShape shape;
+	shape.color = color.rgb();
+	shape.element = ((int) (shape.color & 0xffffff)) - 1;
+	shape.path = path;
+	DRCGeometry::flatten(shape);
+	if (shape.polygons.isEmpty()) return;
+
+	m_shapes.append(shape);
+}
+
+///////////////////////////////////////////
+
+ShapeRecorder::ShapeRecorder(const QSizeF & size) : QPaintDevice(), m_size(size)
+{
+	m_engine = new ShapeRecorderEngine(m_shapes);
+}
+
+ShapeRecorder::~ShapeRecorder() {
+	delete m_engine;
+}
+
+QPaintEngine * ShapeRecorder::paintEngine() const {
+	return m_engine;
+}
+
+const QList<DRCShape> & ShapeRecorder::shapes() const {
+	return m_shapes;
+}
+
+QList<DRCShape> ShapeRecorder::record(const QByteArray & svg, const QSizeF & size) {
+	ShapeRecorder recorder(size);
+	QSvgRenderer renderer(svg);
+	QPainter painter;
+	painter.begin(&recorder);
+	renderer.render(&painter, QRectF(QPointF(0, 0), size));
+	painter.end();
+	return recorder.shapes();
+}
+
+int ShapeRecorder::metric(PaintDeviceMetric metric) const {
+	switch (metric) {
+	case PdmWidth:
+		return qCeil(m_size.width());
+	case PdmHeight:
+		return qCeil(m_size.height());
+	case PdmWidthMM:
+		return qCeil(m_size.width() * 25.4 / 96);
+	case PdmHeightMM:
+		return qCeil(m_size.height() * 25.4 / 96);
+	case PdmNumColors:
+		return 0x7fffffff;
+	case PdmDepth:
+		return 32;
+	case PdmDpiX:
+	case PdmDpiY:
+	case PdmPhysicalDpiX:
+	case PdmPhysicalDpiY:
+		// same as a default QImage, so text renders at the size the raster DRC sees
+		return 96;
+	case PdmDevicePixelRatio:
+		return 1;
+	default:
+		return QPaintDevice::metric(metric);
+	}
+}
+
+///////////////////////////////////////////
+
+ShapeTree::ShapeTree() : m_root(-1)
+{
+}
+
+void ShapeTree::build(const QList<QRectF> & rects) {
+	m_nodes.clear();
+	m_entries.clear();
+	m_root = -1;
+	if (rects.isEmpty()) return;
+
+	QVector<QRectF> boxes = rects.toVector();
+	QList<int> ids;
+	for (int i = 0; i < boxes.count(); i++) ids << i;
+
+	QList<int> level = pack(ids, boxes, true);
+	while (level.count() > 1) {
+		QVector<QRectF> nodeBoxes(m_nodes.count());
+		foreach (int n, level) nodeBoxes[n] = m_nodes.at(n).bounds;
+		level = pack(level, nodeBoxes, false);
+	}
+
+	m_root = level.first();
+}
+
+QList<int> ShapeTree::pack(const QList<int> & ids, const QVector<QRectF> & boxes, bool leaf) {
+	// sort-tile-recursive: vertical slices by x, then runs of TreeNodeSize by y within each slice
+	int nodeCount = (ids.count() + DRCGeometry::TreeNodeSize - 1) / DRCGeometry::TreeNodeSize;
+	int sliceCount = qCeil(qSqrt(nodeCount));
+	int sliceSize = sliceCount * DRCGeometry::TreeNodeSize;
+
+	QVector<int> sorted = ids.toVector();
+	CenterLess less;
+	less.boxes = &boxes;
+	less.byX = true;
+	std::sort(sorted.begin(), sorted.end(), less);
+
+	less.byX = false;
+	for (int s = 0; s < sorted.count(); s += sliceSize) {
+		std::sort(sorted.begin() + s, sorted.begin() + qMin(s + sliceSize, sorted.count()), less);
+	}
+
+	QList<int> nodes;
+	for (int i = 0; i < sorted.count(); i += DRCGeometry::TreeNodeSize) {
+		Node node;
+		node.first = m_entries.count();
+		node.count = qMin(DRCGeometry::TreeNodeSize, sorted.count() - i);
+		node.leaf = leaf;
+		for (int j = 0; j < node.count; j++) {
+			int id = sorted.at(i + j);
+			m_entries.append(id);
+			node.bounds = (j == 0) ? boxes.at(id) : node.bounds.united(boxes.at(id));
+		}
+		nodes << m_nodes.count();
+		m_nodes.append(node);
+	}
+
+	return nodes;
+}
+
+QList<int> ShapeTree::query(const QRectF & rect) const {
+	QList<int> result;
+	if (m_root < 0) return result;
+
+	QList<int> todo;
+	todo << m_root;
+	while (!todo.isEmpty()) {
+		const Node & node = m_nodes.at(todo.takeLast());
+		for (int i = node.first; i < node.first + node.count; i++) {
+			int entry = m_entries.at(i);
+			if (node.leaf) {
+				// candidates only: callers test the items' own bounds
+				result << entry;
+				continue;
+			}
+
+			const QRectF & bounds = m_nodes.at(entry).bounds;
+			if (bounds.left() <= rect.right() && bounds.right() >= rect.left() && bounds.top() <= rect.bottom() && bounds.bottom() >= rect.top()) {
+				todo << entry;
+			}
+		}
+	}
+
+	return result;
+}
+
+///////////////////////////////////////////
+
+void DRCGeometry::flatten(DRCShape & shape) {
+	shape.polygons = shape.path.toFillPolygons();
+	for (int i = shape.polygons.count() - 1; i >= 0; i--) {
+		if (shape.polygons.at(i).count() < 2) shape.polygons.removeAt(i);
+	}
+	shape.bounds = shape.path.boundingRect();
+}
+
+double DRCGeometry::segmentDistance(const QPointF & p1, const QPointF & p2, const QPointF & q1, const QPointF & q2, QPointF & where) {
+	double d1 = cross(q1, q2, p1);
+	double d2 = cross(q1, q2, p2);
+	double d3 = cross(p1, p2, q1);
+	double d4 = cross(p1, p2, q2);
+	if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) {
+		// proper crossing
+		double t = d1 / (d1 - d2);
+		where = p1 + t * (p2 - p1);
+		return 0;
+	}
+
+	QPointF nearest;
+	double best = pointSegmentDistance(p1, q1, q2, nearest);
+	where = (p1 + nearest) / 2;
+	double d = pointSegmentDistance(p2, q1, q2, nearest);
+	if (d < best) {
+		best = d;
+		where = (p2 + nearest) / 2;
+	}
+	d = pointSegmentDistance(q1, p1, p2, nearest);
+	if (d < best) {
+		best = d;
+		where = (q1 + nearest) / 2;
+	}
+	d = pointSegmentDistance(q2, p1, p2, nearest);
+	if (d < best) {
+		best = d;
+		where = (q2 + nearest) / 2;
+	}
+
+	return best;
+}
+
+bool DRCGeometry::tooClose(const DRCShape & a, const DRCShape & b, double keepout, QPointF & where) {
+	if (!a.bounds.adjusted(-keepout, -keepout, keepout, keepout).intersects(b.bounds)) return false;
+
+	// if no edges come close, the shapes are either disjoint or one lies inside the other
+	foreach (QPolygonF polygon, a.polygons) {
+		if (b.bounds.contains(polygon.first()) && b.path.contains(polygon.first())) {
+			where = polygon.first();
+			return true;
+		}
+	}
+	foreach (QPolygonF polygon, b.polygons) {
+		if (a.bounds.contains(polygon.first()) && a.path.contains(polygon.first())) {
+			where = polygon.first();
+			return true;
+		}
+	}
+
+	double limit = keepout - Tolerance;
+	foreach (QPolygonF pa, a.polygons) {
+		for (int i = 0; i < pa.count(); i++) {
+			const QPointF & p1 = pa.at(i);
+			const QPointF & p2 = pa.at((i + 1) % pa.count());
+			if (!nearBox(p1, p2, b.bounds, keepout)) continue;
+
+			foreach (QPolygonF pb, b.polygons) {
+				for (int j = 0; j < pb.count(); j++) {
+					const QPointF & q1 = pb.at(j);
+					const QPointF & q2 = pb.at((j + 1) % pb.count());
+					if (!boxesNear(p1, p2, q1, q2, keepout)) continue;
+
+					if (segmentDistance(p1, p2, q1, q2, where) < limit) {
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+bool DRCGeometry::tooCloseToBorder(const DRCShape & shape, const QPainterPath & board, const QList<QPolygonF> & boardEdges, double keepout, QPointF & where) {
+	if (board.contains(shape.bounds.adjusted(-keepout, -keepout, keepout, keepout))) return false;
+
+	foreach (QPolygonF polygon, shape.polygons) {
+		foreach (QPointF p, polygon) {
+			if (!board.contains(p)) {
+				where = p;
+				return true;
+			}
+		}
+	}
+
+	double limit = keepout - Tolerance;
+	foreach (QPolygonF pa, shape.polygons) {
+		for (int i = 0; i < pa.count(); i++) {
+			const QPointF & p1 = pa.at(i);
+			const QPointF & p2 = pa.at((i + 1) % pa.count());
+			foreach (QPolygonF edges, boardEdges) {
+				for (int j = 0; j + 1 < edges.count(); j++) {
+					const QPointF & q1 = edges.at(j);
+					const QPointF & q2 = edges.at(j + 1);
+					if (!boxesNear(p1, p2, q1, q2, keepout)) continue;
+
+					if (segmentDistance(p1, p2, q1, q2, where) < limit) {
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
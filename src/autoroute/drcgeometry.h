@@ -0,0 +1,131 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef DRCGEOMETRY_H
+#define DRCGEOMETRY_H
+
+#include <QList>
+#include <QVector>
+#include <QRectF>
+#include <QPolygonF>
+#include <QPainterPath>
+#include <QImage>
+#include <QPaintDevice>
+#include <QPaintEngine>
+#include <QPen>
+#include <QBrush>
+#include <QTransform>
+
+struct DRCShape {
+	int element;                    // index of the svg element the shape was drawn from, -1 if unknown
+	QRgb color;                     // pen or brush color the shape was drawn with
+	QPainterPath path;              // filled outline in device coordinates
+	QList<QPolygonF> polygons;      // flattened edges of path
+	QRectF bounds;
+};
+
+class ShapeRecorderEngine : public QPaintEngine
+{
+public:
+	ShapeRecorderEngine(QList<DRCShape> & shapes);
+
+	bool begin(QPaintDevice *);
+	bool end();
+	void updateState(const QPaintEngineState &);
+	void drawPath(const QPainterPath &);
+	void drawPolygon(const QPointF * points, int pointCount, PolygonDrawMode);
+	void drawPixmap(const QRectF &, const QPixmap &, const QRectF &);
+	void drawImage(const QRectF &, const QImage &, const QRectF &, Qt::ImageConversionFlags);
+	Type type() const;
+
+	static QPainterPath darkPixels(const QImage &);
+
+protected:
+	void addShape(const QPainterPath &, const QColor &);
+
+protected:
+	QList<DRCShape> & m_shapes;
+	QTransform m_transform;
+	QPen m_pen;
+	QBrush m_brush;
+	double m_opacity;
+};
+
+// a paint device which turns whatever is painted on it into a list of filled outlines,
+// so that QSvgRenderer can be used to extract copper geometry instead of pixels
+class ShapeRecorder : public QPaintDevice
+{
+public:
+	ShapeRecorder(const QSizeF & size);
+	~ShapeRecorder();
+
+	QPaintEngine * paintEngine() const;
+	const QList<DRCShape> & shapes() const;
+
+	static QList<DRCShape> record(const QByteArray & svg, const QSizeF & size);
+
+protected:
+	int metric(PaintDeviceMetric) const;
+
+protected:
+	QSizeF m_size;
+	QList<DRCShape> m_shapes;
+	ShapeRecorderEngine * m_engine;
+};
+
+// static R-tree, bulk loaded with sort-tile-recursive packing
+class ShapeTree
+{
+public:
+	ShapeTree();
+
+	void build(const QList<QRectF> & rects);
+	QList<int> query(const QRectF &) const;
+
+protected:
+	struct Node {
+		QRectF bounds;
+		int first;          // first entry in m_entries: child nodes, or items for a leaf
+		int count;
+		bool leaf;
+	};
+
+	QList<int> pack(const QList<int> & ids, const QVector<QRectF> & boxes, bool leaf);
+
+protected:
+	QVector<Node> m_nodes;
+	QVector<int> m_entries;
+	int m_root;
+};
+
+class DRCGeometry
+{
+public:
+	static void flatten(DRCShape &);
+	static bool tooClose(const DRCShape &, const DRCShape &, double keepout, QPointF & where);
+	static bool tooCloseToBorder(const DRCShape &, const QPainterPath & board, const QList<QPolygonF> & boardEdges, double keepout, QPointF & where);
+	static double segmentDistance(const QPointF & p1, const QPointF & p2, const QPointF & q1, const QPointF & q2, QPointF & where);
+
+public:
+	static const int TreeNodeSize;
+	static const double Tolerance;
+};
+
+#endif
@@ -74,9 +74,17 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QApplication>
 #include <QMessageBox>
 #include <QSettings>
+#include <QThread>
+#include <QFuture>
+#include <QtConcurrentRun>
+
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QSvgRenderer>
 
 #include <qmath.h>
 #include <limits>
+#include <new>
 
 //////////////////////////////////////
 
@@ -88,6 +96,12 @@ static QString CancelledMessage;
 
 static const int DefaultMaxCycles = 100;
 
+static const QString LaneCountName("mazerouter/threads");
+static const int OrderingsPerRound = 8;					// fixed, so the search for a given seed doesn't depend on the core count
+static const int MaxLanes = OrderingsPerRound;			// more lanes than orderings in a round would sit idle
+
+static const qint64 SparseGridCells = 4 * 1024 * 1024;		// above this, only allocate grid tiles that get written
+
 static const GridValue GridBoardObstacle = std::numeric_limits<GridValue>::max();
 static const GridValue GridPartObstacle = GridBoardObstacle - 1;
 static const GridValue GridSource = GridBoardObstacle - 2;
@@ -224,6 +238,14 @@ bool byOrder(Trace & t1, Trace & t2) {
 	return (t1.order < t2.order);
 }
 
+bool containsOrdering(const QList<NetOrdering> & orderings, const QList<int> & order) {
+	foreach (NetOrdering ordering, orderings) {
+		if (ordering.order == order) return true;
+	}
+
+	return false;
+}
+
 /*
 inline double initialCost(QPoint p1, QPoint p2) {
     //return qAbs(p1.x() - p2.x()) + qAbs(p1.y() - p2.y());
@@ -239,6 +261,26 @@ inline double manhattanCost(const QPoint & p1, const QPoint & p2) {
 	return qMax(qAbs(p1.x() - p2.x()), qAbs(p1.y() - p2.y()));
 }
 
+// search heuristics: a lower bound on the cost from p to the nearest cell inside bounds.
+// Every step costs at least 1 and changes the distance to a box by at most 1, so both are consistent.
+inline int boundsDx(const QPoint & p, const QRect & bounds) {
+	return qMax(0, qMax(bounds.left() - p.x(), p.x() - bounds.right()));
+}
+
+inline int boundsDy(const QPoint & p, const QRect & bounds) {
+	return qMax(0, qMax(bounds.top() - p.y(), p.y() - bounds.bottom()));
+}
+
+inline quint32 distanceHeuristic(const QPoint & p, const QRect & bounds) {
+	int dx = boundsDx(p, bounds);
+	int dy = boundsDy(p, bounds);
+	return (quint32) qCeil(qSqrt((double) dx * dx + (double) dy * dy));
+}
+
+inline quint32 manhattanHeuristic(const QPoint & p, const QRect & bounds) {
+	return (quint32) (boundsDx(p, bounds) + boundsDy(p, bounds));
+}
+
 inline int gridPointInt(Grid * grid, GridPoint & gp) {
 	return (gp.z * grid->x * grid->y) + (gp.y * grid->x) + gp.x;
 }
@@ -312,28 +354,123 @@ void initMarkers(Markers & markers, bool pcbType) {
 
 ////////////////////////////////////////////////////////////////////
 
-bool GridPoint::operator<(const GridPoint& other) const {
-	// make sure lower cost is first
-	return qCost > other.qCost;
+Grid::Grid(int sx, int sy, int sz, bool sparseTiles) :
+	x(sx), y(sy), z(sz),
+	tilesX((sx + TileMask) >> TileShift),
+	tilesY((sy + TileMask) >> TileShift),
+	sparse(sparseTiles)
+{
+	tiles.resize(tilesX * tilesY * sz);
+	if (sparse) return;
+
+	int count = tiles.count();
+	markBlock = new (std::nothrow) uchar[count * TileCells];
+	costBlock = new (std::nothrow) quint32[count * TileCells];
+	if (!isValid()) return;
+
+	bytes = (qint64) count * TileCells * (sizeof(uchar) + sizeof(quint32));
+	for (int i = 0; i < count; i++) {
+		tiles[i].marks = markBlock + (i * TileCells);
+		tiles[i].costs = costBlock + (i * TileCells);
+	}
 }
-////////////////////////////////////////////////////////////////////
 
-Grid::Grid(int sx, int sy, int sz) : 
-	data(new GridValue[sx * sy * sz]()), // initialize to zero
-	x(sx), y(sy), z(sz) { }
+bool Grid::isValid() const {
+	return sparse || (markBlock != nullptr && costBlock != nullptr);
+}
+
+static inline int tileIndex(const Grid * grid, int sx, int sy, int sz) {
+	return (((sz * grid->tilesY) + (sy >> Grid::TileShift)) * grid->tilesX) + (sx >> Grid::TileShift);
+}
+
+static inline int cellIndex(int sx, int sy) {
+	return ((sy & Grid::TileMask) << Grid::TileShift) | (sx & Grid::TileMask);
+}
+
+// markers: 0 is empty, 1..6 are GridBoardObstacle down to GridTempObstacle, CostMark means "look in costs"
+static const uchar CostMark = 7;
+static const quint32 CostSourceBit = 0x80000000;
+static const quint32 CostClosedBit = 0x40000000;		// the cell has been expanded and its cost is final
+static const GridValue MaxPathCost = CostClosedBit - 1;	// costs share a word with the two bits above
 
 GridValue Grid::at(int sx, int sy, int sz) const {
     Q_ASSERT (sx < x);
     Q_ASSERT (sy < y);
     Q_ASSERT (sz < z);
-	return *(data + (sz * y * x) + (sy * x) + sx);
+	const GridTile & tile = tiles.at(tileIndex(this, sx, sy, sz));
+	if (tile.uniform) {
+		return (tile.fill == 0) ? 0 : GridBoardObstacle - (tile.fill - 1);
+	}
+
+	int cell = cellIndex(sx, sy);
+	uchar mark = tile.marks[cell];
+	if (mark == 0) return 0;
+	if (mark != CostMark) return GridBoardObstacle - (mark - 1);
+
+	quint32 cost = tile.costs[cell] & ~CostClosedBit;
+	if (cost & CostSourceBit) return (cost ^ CostSourceBit) | GridSourceFlag;
+	return cost;
 }
 
 void Grid::setAt(int sx, int sy, int sz, GridValue value) {
     Q_ASSERT (sx < x);
     Q_ASSERT (sy < y);
     Q_ASSERT (sz < z);
-	*(data + (sz * y * x) + (sy * x) + sx) = value;
+	uchar mark;
+	quint32 cost = 0;
+	if (value == 0) mark = 0;
+	else if (value >= GridTempObstacle) mark = (uchar) (GridBoardObstacle - value) + 1;
+	else {
+		Q_ASSERT((value & ~GridSourceFlag) <= MaxPathCost);
+		mark = CostMark;
+		cost = (value & GridSourceFlag) ? (quint32) (value ^ GridSourceFlag) | CostSourceBit : (quint32) value;
+	}
+
+	GridTile & tile = tiles[tileIndex(this, sx, sy, sz)];
+	if (tile.uniform) {
+		// a uniform tile never holds costs, so this can only skip a marker write
+		if (mark == tile.fill) return;
+
+		split(tile);
+	}
+
+	int cell = cellIndex(sx, sy);
+	tile.marks[cell] = mark;
+	if (mark == CostMark) {
+		if (tile.costs == nullptr) allocateCosts(tile);
+		tile.costs[cell] = cost;
+	}
+}
+
+bool Grid::closed(int sx, int sy, int sz) const {
+	const GridTile & tile = tiles.at(tileIndex(this, sx, sy, sz));
+	if (tile.uniform) return false;
+
+	int cell = cellIndex(sx, sy);
+	return tile.marks[cell] == CostMark && (tile.costs[cell] & CostClosedBit) != 0;
+}
+
+void Grid::close(int sx, int sy, int sz) {
+	// only expansion cells carry a cost; source and target markers are never pushed twice
+	GridTile & tile = tiles[tileIndex(this, sx, sy, sz)];
+	if (tile.uniform) return;
+
+	int cell = cellIndex(sx, sy);
+	if (tile.marks[cell] == CostMark) tile.costs[cell] |= CostClosedBit;
+}
+
+void Grid::split(GridTile & tile) {
+	if (tile.marks == nullptr) {
+		tile.marks = new uchar[TileCells];
+		bytes += TileCells * sizeof(uchar);
+	}
+	memset(tile.marks, tile.fill, TileCells);
+	tile.uniform = false;
+}
+
+void Grid::allocateCosts(GridTile & tile) {
+	tile.costs = new quint32[TileCells];
+	bytes += TileCells * sizeof(quint32);
 }
 
 QList<QPoint> Grid::init(int sx, int sy, int sz, int width, int height, const QImage & image, GridValue value, bool collectPoints) {
@@ -396,18 +533,63 @@ QList<QPoint> Grid::init4(int sx, int sy, int sz, int width, int height, const Q
 }
 
 void Grid::copy(int fromIndex, int toIndex) {
-	memcpy(((uchar *) data) + toIndex * x * y * sizeof(GridValue), ((uchar *) data) + fromIndex * x * y * sizeof(GridValue), x * y * sizeof(GridValue));
+	int perLayer = tilesX * tilesY;
+	for (int i = 0; i < perLayer; i++) {
+		const GridTile & from = tiles.at((fromIndex * perLayer) + i);
+		GridTile & to = tiles[(toIndex * perLayer) + i];
+		to.fill = from.fill;
+		to.uniform = from.uniform;
+		if (from.uniform) continue;
+
+		if (to.marks == nullptr) {
+			to.marks = new uchar[TileCells];
+			bytes += TileCells * sizeof(uchar);
+		}
+		memcpy(to.marks, from.marks, TileCells);
+		if (from.costs == nullptr) continue;
+
+		if (to.costs == nullptr) allocateCosts(to);
+		memcpy(to.costs, from.costs, TileCells * sizeof(quint32));
+	}
 }
 
 void Grid::clear() {
-	// memset can be very dangerous, clear out memory this way
-	std::fill_n(data, x * y * z, 0);
+	// tiles keep their memory; they are just marked empty
+	for (int i = 0; i < tiles.count(); i++) {
+		GridTile & tile = tiles[i];
+		tile.fill = 0;
+		tile.uniform = true;
+	}
+}
+
+void Grid::clearExpansion() {
+	// drop everything except obstacles
+	static const uchar PartMark = (uchar) (GridBoardObstacle - GridPartObstacle) + 1;
+	static const uchar BoardMark = 1;
+	for (int i = 0; i < tiles.count(); i++) {
+		GridTile & tile = tiles[i];
+		if (tile.uniform) {
+			if (tile.fill != PartMark && tile.fill != BoardMark) tile.fill = 0;
+			continue;
+		}
+
+		for (int c = 0; c < TileCells; c++) {
+			uchar mark = tile.marks[c];
+			if (mark != PartMark && mark != BoardMark) tile.marks[c] = 0;
+		}
+	}
 }
 
 Grid::~Grid() {
-	if (data) {
-		delete [] data;
-		data = nullptr;
+	if (sparse) {
+		for (int i = 0; i < tiles.count(); i++) {
+			delete [] tiles[i].marks;
+			delete [] tiles[i].costs;
+		}
+	}
+	else {
+		delete [] markBlock;
+		delete [] costBlock;
 	}
 }
 
@@ -417,25 +599,53 @@ Grid::~Grid() {
 void Score::setOrdering(const NetOrdering & _ordering) {
 	reorderNet = -1;
 	if (ordering.order.count() > 0) {
-		bool remove = false;
+		// nets before the first change keep their traces; nets after it keep them provisionally,
+		// and are only ripped up when a net now routed ahead of them needs the same space
+		bool changed = false;
 		for (int i = 0; i < ordering.order.count(); i++) {
-			if (!remove && (ordering.order.at(i) == _ordering.order.at(i))) continue;
+			if (!changed && (ordering.order.at(i) == _ordering.order.at(i))) continue;
 
-			remove = true;
+			changed = true;
 			int netIndex = ordering.order.at(i);
-			traces.remove(netIndex);
-			int c = routedCount.value(netIndex);
-			routedCount.remove(netIndex);
-			totalRoutedCount -= c;
-			c = viaCount.value(netIndex);
-			viaCount.remove(netIndex);
-			totalViaCount -= c;
+			if (!traces.contains(netIndex) || provisional.contains(netIndex)) continue;
+
+			provisional.insert(netIndex);
+			totalRoutedCount -= routedCount.value(netIndex);
+			totalViaCount -= viaCount.value(netIndex);
 		}
 	}
 	ordering = _ordering;
 	//printOrder("new  ", ordering.order);
 }
 
+void Score::ripUp(int netIndex) {
+	traces.remove(netIndex);
+	int routed = routedCount.take(netIndex);
+	int vias = viaCount.take(netIndex);
+	if (provisional.remove(netIndex)) return;
+
+	totalRoutedCount -= routed;
+	totalViaCount -= vias;
+}
+
+void Score::confirm(int netIndex) {
+	// routing has reached this net and nothing ahead of it took its space, so its traces count again
+	if (!provisional.remove(netIndex)) return;
+
+	totalRoutedCount += routedCount.value(netIndex);
+	totalViaCount += viaCount.value(netIndex);
+}
+
+QList<Trace> Score::committedTraces() const {
+	if (provisional.isEmpty()) return traces.values();
+
+	QList<Trace> result;
+	foreach (Trace trace, traces) {
+		if (!provisional.contains(trace.netIndex)) result << trace;
+	}
+	return result;
+}
+
 ////////////////////////////////////////////////////////////////////
 
 static const long IDs[] = { 1452191, 9781580, 9781600, 9781620, 9781640, 9781660, 9781680, 9781700 };
@@ -512,6 +722,7 @@ MazeRouter::MazeRouter(PCBSketchWidget * sketchWidget, QGraphicsItem * board, bo
     m_spareImage2(nullptr),
     m_temporaryBoard(false),
     m_costFunction(nullptr),
+    m_heuristicFunction(nullptr),
     m_jumperWillFitFunction(nullptr),
     m_grid(nullptr),
     m_cleanupCount(0),
@@ -576,6 +787,7 @@ MazeRouter::~MazeRouter()
 {
     /// @todo replace explicit deletes with std::shared_ptr and std::unique_ptr
     /// where it makes sense. 
+	deleteLanes();
 	foreach (QDomDocument * doc, m_masterDocs) {
 		delete doc;
 	}
@@ -617,12 +829,14 @@ void MazeRouter::start()
 		}
 		m_jumperWillFitFunction = jumperWillFit;
 		m_costFunction = distanceCost;
+		m_heuristicFunction = distanceHeuristic;
 		m_traceColors[0] = 0xa0F28A00;
 		m_traceColors[1] = 0xa0FFCB33;
 	}
 	else {
 		m_jumperWillFitFunction = schematicJumperWillFit;
 		m_costFunction = manhattanCost;
+		m_heuristicFunction = manhattanHeuristic;
 		m_traceColors[0] = m_traceColors[1] = 0xa0303030;
 	}
 
@@ -677,17 +891,15 @@ void MazeRouter::start()
 		//    connectorItem->debugInfo("all parts");
 		//}
 
-		QList<ConnectorItem *> todo;
-		todo.append(*(net->net));
-		while (todo.count() > 0) {
-			auto first = todo.takeFirst();
-			QList<ConnectorItem *> equi;
-			equi.append(first);
-			ConnectorItem::collectEqualPotential(equi, m_bothSidesNow, (ViewGeometry::RatsnestFlag | ViewGeometry::NormalFlag | ViewGeometry::PCBTraceFlag | ViewGeometry::SchematicTraceFlag) ^ m_sketchWidget->getTraceFlag());
-            foreach (ConnectorItem * equ, equi) {
-                todo.removeOne(equ);
-                //equ->debugInfo("equi");
-            }
+		QSet<ConnectorItem *> done;
+		foreach (ConnectorItem * first, *(net->net)) {
+			if (done.contains(first)) continue;
+
+			QList<ConnectorItem *> equi = m_sketchWidget->connectivityIndex().equalPotential(first, m_bothSidesNow, (ViewGeometry::RatsnestFlag | ViewGeometry::NormalFlag | ViewGeometry::PCBTraceFlag | ViewGeometry::SchematicTraceFlag) ^ m_sketchWidget->getTraceFlag());
+			foreach (ConnectorItem * equ, equi) {
+				done.insert(equ);
+				//equ->debugInfo("equi");
+			}
 			net->subnets.append(equi);
 		}
 
@@ -723,8 +935,10 @@ void MazeRouter::start()
 
 	QSizeF gridSize(m_maxRect.width() / m_gridPixels, m_maxRect.height() / m_gridPixels);
 	QSize boardImageSize(qCeil(gridSize.width()), qCeil(gridSize.height()));
-	m_grid = new Grid(boardImageSize.width(), boardImageSize.height(), m_bothSidesNow ? 2 : 1);
-	if (!m_grid->data) {
+	int layers = m_bothSidesNow ? 2 : 1;
+	bool sparse = (qint64) boardImageSize.width() * boardImageSize.height() * layers > SparseGridCells;
+	m_grid = new Grid(boardImageSize.width(), boardImageSize.height(), layers, sparse);
+	if (!m_grid->isValid()) {
 		QMessageBox::information(nullptr, QObject::tr("Fritzing"), "Out of memory--unable to proceed");
 		restoreOriginalState(parentCommand);
 		cleanUpNets(netList);
@@ -763,12 +977,19 @@ void MazeRouter::start()
 		return;
 	}
 
+	snapshotNets(netList);
+	makeLanes();
+
+	QElapsedTimer routingTimer;
+	routingTimer.start();
+
 	QList<NetOrdering> allOrderings;
 	allOrderings << initialOrdering;
+	QList<Score> parentScores;			// for each ordering, the routing it was derived from; its unaffected traces are reused
+	parentScores << Score();
 	Score bestScore;
-	Score currentScore;
 	auto run = 0;
-	for (; run < m_maxCycles && run < allOrderings.count(); run++) {
+	while (run < m_maxCycles && run < allOrderings.count()) {
 		QString msg= tr("best so far: %1 of %2 routed").arg(bestScore.totalRoutedCount).arg(totalToRoute);
 		if (m_pcbType) {
 			msg +=  tr(" with %n vias", "", bestScore.totalViaCount);
@@ -777,20 +998,69 @@ void MazeRouter::start()
 		emit setCycleMessage(tr("round %1 of:").arg(run + 1));
 		emit setProgressValue(run);
 		ProcessEventBlocker::processEvents();
-		currentScore.setOrdering(allOrderings.at(run));
-		currentScore.anyUnrouted = false;
-		routeNets(netList, false, currentScore, gridSize, allOrderings);
-		if (bestScore.ordering.order.count() == 0) {
-			bestScore = currentScore;
-		}
-		else {
-			if (currentScore.totalRoutedCount > bestScore.totalRoutedCount) {
-				bestScore = currentScore;
+
+		// route a round of pending orderings; the lanes only share out the work,
+		// so which orderings make up a round doesn't depend on how many lanes there are
+		int roundCount = qMin(OrderingsPerRound, qMin(m_maxCycles, allOrderings.count()) - run);
+		QList<Score> roundScores;
+		QList< QList<NetOrdering> > roundOrderings;
+		bool roundComplete = false;
+		for (int start = 0; start < roundCount && !roundComplete; start += m_lanes.count()) {
+			int laneCount = qMin(m_lanes.count(), roundCount - start);
+			for (int i = 0; i < laneCount; i++) {
+				RouteLane * lane = m_lanes.at(i);
+				lane->score = parentScores.at(run + start + i);
+				parentScores[run + start + i] = Score();
+				lane->score.setOrdering(allOrderings.at(run + start + i));
+				lane->score.anyUnrouted = false;
+				lane->newOrderings.clear();
+			}
+			routeBatch(laneCount, netList, gridSize, allOrderings);
+			for (int i = 0; i < laneCount; i++) {
+				RouteLane * lane = m_lanes.at(i);
+				roundScores << lane->score;
+				roundOrderings << lane->newOrderings;
+				// the merge below stops at a complete routing, so the rest of the round wouldn't be used
+				if (!lane->score.anyUnrouted) roundComplete = true;
+			}
+			if (m_cancelled || m_stopTracing) break;
+		}
+
+		// merge results in ordering order, so the outcome doesn't depend on which thread finished first,
+		// and stop at the first complete routing, as routing the orderings one at a time would
+		for (int i = 0; i < roundScores.count(); i++) {
+			run++;
+			foreach (NetOrdering ordering, roundOrderings.at(i)) {
+				if (!containsOrdering(allOrderings, ordering.order)) {
+					allOrderings.append(ordering);
+					parentScores.append(roundScores.at(i));
+				}
 			}
-			else if (currentScore.totalRoutedCount == bestScore.totalRoutedCount && currentScore.totalViaCount < bestScore.totalViaCount) {
+
+			const Score & currentScore = roundScores.at(i);
+			if (bestScore.ordering.order.count() == 0) {
 				bestScore = currentScore;
 			}
+			else {
+				if (currentScore.totalRoutedCount > bestScore.totalRoutedCount) {
+					bestScore = currentScore;
+				}
+				else if (currentScore.totalRoutedCount == bestScore.totalRoutedCount && currentScore.totalViaCount < bestScore.totalViaCount) {
+					bestScore = currentScore;
+				}
+			}
+			if (!bestScore.anyUnrouted) break;
+		}
+
+		if (m_lanes.count() > 1) {
+			initTraceDisplay();
+			foreach (Trace trace, bestScore.committedTraces()) {
+				displayTrace(trace);
+			}
+			updateDisplay(0);
+			if (m_bothSidesNow) updateDisplay(1);
 		}
+
 		if (m_cancelled || bestScore.anyUnrouted == false || m_stopTracing) break;
 	}
 
@@ -810,7 +1080,7 @@ void MazeRouter::start()
 		if (m_useBest) msg += tr("Use best so far...");
 		emit setProgressMessage(msg);
 		if (m_useBest) {
-			routeNets(netList, true, bestScore, gridSize, allOrderings);
+			routeNets(*m_lanes.at(0), netList, true, bestScore, gridSize, allOrderings);
 		}
 	}
 	else if (!bestScore.anyUnrouted) {
@@ -826,11 +1096,25 @@ void MazeRouter::start()
 		msg += tr("Use best so far...");
 		emit setProgressMessage(msg);
 		printOrder("best ", bestScore.ordering.order);
-		routeNets(netList, true, bestScore, gridSize, allOrderings);
+		routeNets(*m_lanes.at(0), netList, true, bestScore, gridSize, allOrderings);
 		emit setProgressValue(m_maxCycles);
 	}
 	ProcessEventBlocker::processEvents();
 
+	qint64 gridBytes = 0;
+	qint64 expanded = 0;
+	foreach (RouteLane * lane, m_lanes) {
+		gridBytes += lane->grid->bytes;
+		expanded += lane->expanded;
+	}
+	qint64 routingTime = qMax((qint64) 1, routingTimer.elapsed());
+	qint64 flatBytes = (qint64) m_grid->x * m_grid->y * m_grid->z * sizeof(GridValue) * m_lanes.count();
+	DebugDialog::debug(QString("maze grid %1x%2x%3 %4, %5 lanes: peak %6 KB (flat layout %7 KB), %8 cells expanded in %9 ms, %10 cells/s")
+		.arg(m_grid->x).arg(m_grid->y).arg(m_grid->z).arg(m_grid->sparse ? "sparse" : "dense").arg(m_lanes.count())
+		.arg(gridBytes / 1024).arg(flatBytes / 1024)
+		.arg(expanded).arg(routingTime).arg(expanded * 1000 / routingTime));
+
+	deleteLanes();
 	if (m_grid) {
 		delete m_grid;
 		m_grid = nullptr;
@@ -991,9 +1275,137 @@ bool MazeRouter::makeMasters(QString & message) {
 	return true;
 }
 
-bool MazeRouter::routeNets(NetList & netList, bool makeJumper, Score & currentScore, const QSizeF gridSize, QList<NetOrdering> & allOrderings)
+void MazeRouter::makeLanes() {
+	// every part as an obstacle; routing a net copies this and redraws only the window around the net's own items
+	QSizeF gridSize(m_maxRect.width() / m_gridPixels, m_maxRect.height() / m_gridPixels);
+	QRectF r4(QPointF(0, 0), gridSize * 4);			// the same as RouteThing::r4
+	foreach (ViewLayer::ViewLayerPlacement viewLayerPlacement, m_masterDocs.keys()) {
+		QImage * image = new QImage(m_spareImage->width(), m_spareImage->height(), QImage::Format_Mono);
+		image->fill(0xffffffff);
+		ItemBase::renderOne(m_masterDocs.value(viewLayerPlacement), image, r4);
+		m_obstacleImages.insert(viewLayerPlacement, image);
+	}
+
+	// the first lane borrows the router's own grid and masters, since it also does the final jumper pass
+	RouteLane * mainLane = new RouteLane;
+	mainLane->grid = m_grid;
+	mainLane->spareImage = m_spareImage;
+	mainLane->masterDocs = m_masterDocs;
+	mainLane->display = true;
+	m_lanes << mainLane;
+
+	QSettings settings;
+	int laneCount = qBound(1, settings.value(LaneCountName, QThread::idealThreadCount()).toInt(), MaxLanes);
+	for (int i = 1; i < laneCount; i++) {
+		RouteLane * lane = new RouteLane;
+		lane->ownsData = true;
+		lane->grid = new Grid(m_grid->x, m_grid->y, m_grid->z, m_grid->sparse);
+		lane->spareImage = new QImage(m_spareImage->width(), m_spareImage->height(), QImage::Format_Mono);
+		foreach (ViewLayer::ViewLayerPlacement viewLayerPlacement, m_masterDocs.keys()) {
+			// routing marks up the master documents, so every lane needs its own copy
+			QDomDocument * masterDoc = new QDomDocument();
+			masterDoc->setContent(m_masterDocs.value(viewLayerPlacement)->toByteArray());
+			lane->masterDocs.insert(viewLayerPlacement, masterDoc);
+		}
+		m_lanes << lane;
+	}
+}
+
+void MazeRouter::snapshotNets(NetList & netList) {
+	// the scene may change while the lanes run (the GUI thread keeps processing events),
+	// so everything routing reads from the items is copied here first
+	m_connectorSnapshots.clear();
+	foreach (Net * net, netList.nets) {
+		DRC::collectSplitNetIDs(*(net->net), true, net->splitIDs);
+
+		QList<ConnectorItem *> connectorItems(*(net->net));
+		foreach (QList<ConnectorItem *> subnet, net->subnets) {
+			connectorItems.append(subnet);
+		}
+		foreach (ConnectorItem * connectorItem, connectorItems) {
+			// the subnets bring in the traces already in the net, which can run well outside its parts
+			ItemBase * itemBase = connectorItem->attachedTo();
+			QString partID = QString::number(itemBase->id());
+			net->itemRects[partID] |= itemBase->sceneBoundingRect();
+			ConnectorItem * crossLayer = connectorItem->getCrossLayerConnectorItem();
+			if (crossLayer) {
+				net->itemRects[partID] |= crossLayer->attachedTo()->sceneBoundingRect();
+			}
+
+			if (m_connectorSnapshots.contains(connectorItem)) continue;
+
+			ConnectorSnapshot snapshot;
+			snapshot.terminalPoint = connectorItem->sceneAdjustedTerminalPoint(nullptr);
+			snapshot.sceneRect = connectorItem->sceneBoundingRect();
+			snapshot.attachedToRect = itemBase->sceneBoundingRect();
+			snapshot.partID = partID;
+			SvgIdLayer * svgIdLayer = connectorItem->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
+			if (svgIdLayer) {
+				snapshot.svgID = svgIdLayer->m_svgId;
+				snapshot.terminalID = svgIdLayer->m_terminalId;
+			}
+			snapshot.viewLayerID = connectorItem->attachedToViewLayerID();
+			snapshot.viewLayerPlacement = ViewLayer::specFromID(itemBase->viewLayerID());
+			snapshot.crossLayer = connectorItem->getCrossLayerConnectorItem();
+			m_connectorSnapshots.insert(connectorItem, snapshot);
+		}
+	}
+}
+
+void MazeRouter::deleteLanes() {
+	foreach (RouteLane * lane, m_lanes) {
+		if (lane->ownsData) {
+			delete lane->grid;
+			delete lane->spareImage;
+			foreach (QDomDocument * doc, lane->masterDocs) {
+				delete doc;
+			}
+		}
+		delete lane;
+	}
+	m_lanes.clear();
+
+	foreach (QImage * image, m_obstacleImages) {
+		delete image;
+	}
+	m_obstacleImages.clear();
+}
+
+QRect MazeRouter::imageWindow(const QRectF & sceneRect, const QImage * image) {
+	return ObstacleWindow::imageWindow(sceneRect, m_maxRect, m_gridPixels, m_keepoutPixels, image);
+}
+
+void MazeRouter::routeBatch(int laneCount, NetList & netList, const QSizeF & gridSize, const QList<NetOrdering> & allOrderings)
+{
+	if (m_lanes.count() == 1) {
+		// nothing to run in parallel: stay on the GUI thread so the display follows each net
+		routeNets(*m_lanes.at(0), netList, false, m_lanes.at(0)->score, gridSize, allOrderings);
+		return;
+	}
+
+	QList< QFuture<bool> > futures;
+	for (int i = 0; i < laneCount; i++) {
+		RouteLane * lane = m_lanes.at(i);
+		lane->display = false;
+		futures << QtConcurrent::run(this, &MazeRouter::routeLane, lane, &netList, gridSize, &allOrderings);
+	}
+	foreach (QFuture<bool> future, futures) {
+		while (!future.isFinished()) {
+			ProcessEventBlocker::processEvents(200);
+		}
+	}
+	m_lanes.at(0)->display = true;
+}
+
+bool MazeRouter::routeLane(RouteLane * lane, NetList * netList, QSizeF gridSize, const QList<NetOrdering> * allOrderings)
+{
+	return routeNets(*lane, *netList, false, lane->score, gridSize, *allOrderings);
+}
+
+bool MazeRouter::routeNets(RouteLane & lane, NetList & netList, bool makeJumper, Score & currentScore, const QSizeF gridSize, const QList<NetOrdering> & allOrderings)
 {
 	RouteThing routeThing;
+	routeThing.lane = &lane;
 	routeThing.netElements[0] = NetElements();
 	routeThing.netElements[1] = NetElements();
 	routeThing.r = QRectF(QPointF(0, 0), gridSize);
@@ -1003,7 +1415,7 @@ bool MazeRouter::routeNets(NetList & netList, bool makeJumper, Score & currentSc
 
 	auto result = true;
 
-	initTraceDisplay();
+	if (lane.display) initTraceDisplay();
 	auto previousTraces = false;
 	foreach (int netIndex, currentScore.ordering.order) {
 		if (m_cancelled || m_stopTracing) {
@@ -1020,16 +1432,19 @@ bool MazeRouter::routeNets(NetList & netList, bool makeJumper, Score & currentSc
 		    );
 		*/
 
+		currentScore.confirm(netIndex);
 		if (currentScore.routedCount.value(netIndex) == net->subnets.count() - 1) {
-			// this net was fully routed in a previous run
-			foreach (Trace trace, currentScore.traces.values(netIndex)) {
-				displayTrace(trace);
+			// this net was fully routed in a previous run, and nothing routed since has ripped it up
+			if (lane.display) {
+				foreach (Trace trace, currentScore.traces.values(netIndex)) {
+					displayTrace(trace);
+				}
 			}
 			previousTraces = true;
 			continue;
 		}
 
-		if (previousTraces) {
+		if (previousTraces && lane.display) {
 			updateDisplay(0);
 			if (m_bothSidesNow) updateDisplay(1);
 		}
@@ -1038,11 +1453,7 @@ bool MazeRouter::routeNets(NetList & netList, bool makeJumper, Score & currentSc
 			// should only be here when makeJumpers = true
 			// remove the set of routed traces for this net--the net was not completely routed
 			// we didn't get all the way through before
-			currentScore.totalRoutedCount -= currentScore.routedCount.value(netIndex);
-			currentScore.routedCount.insert(netIndex, 0);
-			currentScore.totalViaCount -= currentScore.viaCount.value(netIndex);
-			currentScore.viaCount.insert(netIndex, 0);
-			currentScore.traces.remove(netIndex);
+			currentScore.ripUp(netIndex);
 		}
 
 		//foreach (ConnectorItem * connectorItem, *(net->net)) {
@@ -1061,20 +1472,20 @@ bool MazeRouter::routeNets(NetList & netList, bool makeJumper, Score & currentSc
 		//DebugDialog::debug("find nearest pair");
 
 		findNearestPair(subnets, routeThing.nearest);
-		auto ip = routeThing.nearest.ic->sceneAdjustedTerminalPoint(nullptr) - m_maxRect.topLeft();
+		auto ip = m_connectorSnapshots.value(routeThing.nearest.ic).terminalPoint - m_maxRect.topLeft();
 		routeThing.gridSourcePoint = QPoint(ip.x() / m_gridPixels, ip.y() / m_gridPixels);
-		auto jp = routeThing.nearest.jc->sceneAdjustedTerminalPoint(nullptr) - m_maxRect.topLeft();
+		auto jp = m_connectorSnapshots.value(routeThing.nearest.jc).terminalPoint - m_maxRect.topLeft();
 		routeThing.gridTargetPoint = QPoint(jp.x() / m_gridPixels, jp.y() / m_gridPixels);
 
-		m_grid->clear();
-		m_grid->init4(0, 0, 0, m_grid->x, m_grid->y, m_boardImage, GridBoardObstacle, false);
+		lane.grid->clear();
+		lane.grid->init4(0, 0, 0, lane.grid->x, lane.grid->y, m_boardImage, GridBoardObstacle, false);
 		if (m_bothSidesNow) {
-			m_grid->copy(0, 1);
+			lane.grid->copy(0, 1);
 		}
 
-		QList<Trace> traces = currentScore.traces.values();
+		QList<Trace> traces = currentScore.committedTraces();
 		if (m_pcbType) {
-			traceObstacles(traces, netIndex, m_grid, m_keepoutGridInt);
+			traceObstacles(traces, netIndex, lane.grid, m_keepoutGridInt);
 		}
 		else {
 			traceAvoids(traces, netIndex, routeThing);
@@ -1083,29 +1494,37 @@ bool MazeRouter::routeNets(NetList & netList, bool makeJumper, Score & currentSc
 		foreach (ViewLayer::ViewLayerPlacement viewLayerPlacement, routeThing.layerSpecs) {
 			int z = viewLayerPlacement == ViewLayer::NewBottom ? 0 : 1;
 
-			QDomDocument * masterDoc = m_masterDocs.value(viewLayerPlacement);
+			QDomDocument * masterDoc = lane.masterDocs.value(viewLayerPlacement);
 
 			//QString before = masterDoc->toString();
 
 			Markers markers;
 			initMarkers(markers, m_pcbType);
-			DRC::splitNetPrep(masterDoc, *(net->net), markers, routeThing.netElements[z].net, routeThing.netElements[z].alsoNet, routeThing.netElements[z].notNet, true);
+			DRC::splitNetPrep(masterDoc, net->splitIDs, markers, routeThing.netElements[z].net, routeThing.netElements[z].alsoNet, routeThing.netElements[z].notNet, true);
+			QList<QDomElement> cleared;
 			foreach (QDomElement element, routeThing.netElements[z].net) {
 				element.setTagName("g");
+				cleared << element;
 			}
 			foreach (QDomElement element, routeThing.netElements[z].alsoNet) {
 				element.setTagName("g");
+				cleared << element;
 			}
 
 			//QString after = masterDoc->toString();
 
 			//DebugDialog::debug("obstacles from board");
-			m_spareImage->fill(0xffffffff);
-			ItemBase::renderOne(masterDoc, m_spareImage, routeThing.r4);
+			fastCopy(m_obstacleImages.value(viewLayerPlacement), lane.spareImage);
+			QRectF clearedRect;
+			QRect window = lane.spareImage->rect();		// an element from an item the net doesn't know about: redraw everything
+			if (ObstacleWindow::elementsRect(cleared, net->itemRects, clearedRect)) {
+				window = clearedRect.isNull() ? QRect() : imageWindow(clearedRect, lane.spareImage);
+			}
+			ObstacleWindow::render(masterDoc, lane.spareImage, routeThing.r4, window);
 #ifndef QT_NO_DEBUG
-			//m_spareImage->save(FolderUtils::getUserDataStorePath("") + QString("/obstacles%1_%2.png").arg(netIndex, 2, 10, QChar('0')).arg(viewLayerPlacement));
+			//lane.spareImage->save(FolderUtils::getUserDataStorePath("") + QString("/obstacles%1_%2.png").arg(netIndex, 2, 10, QChar('0')).arg(viewLayerPlacement));
 #endif
-			m_grid->init4(0, 0, z, m_grid->x, m_grid->y, m_spareImage, GridPartObstacle, false);
+			lane.grid->init4(0, 0, z, lane.grid->x, lane.grid->y, lane.spareImage, GridPartObstacle, false);
 			//DebugDialog::debug("obstacles from board done");
 
 			prepSourceAndTarget(masterDoc, routeThing, subnets, z, viewLayerPlacement);
@@ -1146,8 +1565,9 @@ bool MazeRouter::routeNets(NetList & netList, bool makeJumper, Score & currentSc
 		routeThing.netElements[1].net.clear();
 		routeThing.netElements[1].notNet.clear();
 		routeThing.netElements[1].alsoNet.clear();
-		routeThing.sourceQ = std::priority_queue<GridPoint>();
-		routeThing.targetQ = std::priority_queue<GridPoint>();
+		routeThing.sourceQ.clear();
+		routeThing.targetQ.clear();
+		routeThing.sourceBounds = routeThing.targetBounds = QRect();
 
 		if (!result) break;
 	}
@@ -1155,7 +1575,7 @@ bool MazeRouter::routeNets(NetList & netList, bool makeJumper, Score & currentSc
 	return result;
 }
 
-bool MazeRouter::routeOne(bool makeJumper, Score & currentScore, int netIndex, RouteThing & routeThing, QList<NetOrdering> & allOrderings) {
+bool MazeRouter::routeOne(bool makeJumper, Score & currentScore, int netIndex, RouteThing & routeThing, const QList<NetOrdering> & allOrderings) {
 
 	//DebugDialog::debug("start route()");
 	Trace newTrace;
@@ -1180,7 +1600,7 @@ bool MazeRouter::routeOne(bool makeJumper, Score & currentScore, int netIndex, R
 			if (currentScore.reorderNet < 0) {
 				for (int i = 0; i < currentScore.ordering.order.count(); i++) {
 					if (currentScore.ordering.order.at(i) == netIndex) {
-						if (moveBack(currentScore, i, allOrderings)) {
+						if (moveBack(currentScore, i, allOrderings, routeThing.lane->newOrderings)) {
 							currentScore.reorderNet = netIndex;
 						}
 						break;
@@ -1198,8 +1618,11 @@ bool MazeRouter::routeOne(bool makeJumper, Score & currentScore, int netIndex, R
 	}
 	else {
 		insertTrace(newTrace, netIndex, currentScore, viaCount, true);
-		updateDisplay(0);
-		if (m_bothSidesNow) updateDisplay(1);
+		if (routeThing.lane->display) {
+			displayTrace(newTrace);
+			updateDisplay(0);
+			if (m_bothSidesNow) updateDisplay(1);
+		}
 	}
 
 	//DebugDialog::debug("end routeOne()");
@@ -1208,7 +1631,7 @@ bool MazeRouter::routeOne(bool makeJumper, Score & currentScore, int netIndex, R
 	return true;
 }
 
-bool MazeRouter::routeNext(bool makeJumper, RouteThing & routeThing, QList< QList<ConnectorItem *> > & subnets, Score & currentScore, int netIndex, QList<NetOrdering> & allOrderings)
+bool MazeRouter::routeNext(bool makeJumper, RouteThing & routeThing, QList< QList<ConnectorItem *> > & subnets, Score & currentScore, int netIndex, const QList<NetOrdering> & allOrderings)
 {
 	auto result = true;
 
@@ -1240,33 +1663,34 @@ bool MazeRouter::routeNext(bool makeJumper, RouteThing & routeThing, QList< QLis
 	routeThing.nearest.j = -1;
 	routeThing.nearest.distance = std::numeric_limits<double>::max();
 	findNearestPair(subnets, 0, combined, routeThing.nearest);
-	auto ip = routeThing.nearest.ic->sceneAdjustedTerminalPoint(nullptr) - m_maxRect.topLeft();
+	auto ip = m_connectorSnapshots.value(routeThing.nearest.ic).terminalPoint - m_maxRect.topLeft();
 	routeThing.gridSourcePoint = QPoint(ip.x() / m_gridPixels, ip.y() / m_gridPixels);
-	auto jp = routeThing.nearest.jc->sceneAdjustedTerminalPoint(nullptr) - m_maxRect.topLeft();
+	auto jp = m_connectorSnapshots.value(routeThing.nearest.jc).terminalPoint - m_maxRect.topLeft();
 	routeThing.gridTargetPoint = QPoint(jp.x() / m_gridPixels, jp.y() / m_gridPixels);
 
-	routeThing.sourceQ = std::priority_queue<GridPoint>();
-	routeThing.targetQ = std::priority_queue<GridPoint>();
+	routeThing.sourceQ.clear();
+	routeThing.targetQ.clear();
+	routeThing.sourceBounds = routeThing.targetBounds = QRect();
 
 	if (!m_pcbType) {
-		QList<Trace> traces = currentScore.traces.values();
+		QList<Trace> traces = currentScore.committedTraces();
 		traceAvoids(traces, netIndex, routeThing);
 	}
 
 	foreach (ViewLayer::ViewLayerPlacement viewLayerPlacement, routeThing.layerSpecs) {
 		int z = viewLayerPlacement == ViewLayer::NewBottom ? 0 : 1;
-		QDomDocument * masterDoc = m_masterDocs.value(viewLayerPlacement);
+		QDomDocument * masterDoc = routeThing.lane->masterDocs.value(viewLayerPlacement);
 		prepSourceAndTarget(masterDoc, routeThing, subnets, z, viewLayerPlacement);
 	}
 
 	// redraw traces from this net
 	foreach (Trace trace, currentScore.traces.values(netIndex)) {
 		foreach (GridPoint gridPoint, trace.gridPoints) {
-			m_grid->setAt(gridPoint.x, gridPoint.y, gridPoint.z, GridSource);
+			routeThing.lane->grid->setAt(gridPoint.x, gridPoint.y, gridPoint.z, GridSource);
 			gridPoint.qCost = gridPoint.baseCost = /* initialCost(QPoint(gridPoint.x, gridPoint.y), routeThing.gridTarget) + */ 0;
 			gridPoint.flags = 0;
 			//DebugDialog::debug(QString("pushing trace %1 %2 %3, %4, %5").arg(gridPoint.x).arg(gridPoint.y).arg(gridPoint.z).arg(gridPoint.qCost).arg(routeThing.pq.size()));
-			routeThing.sourceQ.push(gridPoint);
+			addSeed(routeThing, gridPoint, true);
 		}
 	}
 
@@ -1279,59 +1703,26 @@ bool MazeRouter::routeNext(bool makeJumper, RouteThing & routeThing, QList< QLis
 	return result;
 }
 
-bool MazeRouter::moveBack(Score & currentScore, int index, QList<NetOrdering> & allOrderings) {
+bool MazeRouter::moveBack(Score & currentScore, int index, const QList<NetOrdering> & allOrderings, QList<NetOrdering> & newOrderings) {
 	if (index == 0) {
 		return false;  // nowhere to move back to
 	}
 
+	// propose up to a round's worth of new orderings: move the net back by one place, then by two, and so on
 	QList<int> order(currentScore.ordering.order);
-	//printOrder("start", order);
 	int netIndex = order.takeAt(index);
-	//printOrder("minus", order);
-	for (int i = index - 1; i >= 0; i--) {
-		bool done = true;
+	for (int i = index - 1; i >= 0 && newOrderings.count() < OrderingsPerRound; i--) {
 		order.insert(i, netIndex);
-		//printOrder("plus ", order);
-		foreach (NetOrdering ordering, allOrderings) {
-			bool gotOne = true;
-			for (int j = 0; j < order.count(); j++) {
-				if (order.at(j) != ordering.order.at(j)) {
-					gotOne = false;
-					break;
-				}
-			}
-			if (gotOne) {
-				done = false;
-				break;
-			}
-		}
-		if (done == true) {
+		if (!containsOrdering(allOrderings, order) && !containsOrdering(newOrderings, order)) {
 			NetOrdering newOrdering;
 			newOrdering.order = order;
-			allOrderings.append(newOrdering);
+			newOrderings.append(newOrdering);
 			//printOrder("done ", newOrdering.order);
-
-			/*
-			const static int watch[] = { 0, 1, 2, 3, 6, 12, 14, 4, 5, 7, 8, 9, 10, 11, 13, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64 };
-			// {0, 1, 2, 4, 3, 12, 6, 14, 5, 7, 8, 9, 10, 11, 13, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64};
-
-			bool matches = true;
-			for (int i = 0; i < order.count(); i++) {
-			    if (order.at(i) != watch[i]) {
-			        matches = false;
-			        break;
-			    }
-			}
-			if (matches) {
-			    DebugDialog::debug("order matches");
-			}
-			*/
-			return true;
 		}
 		order.removeAt(i);
 	}
 
-	return false;
+	return newOrderings.count() > 0;
 }
 
 void MazeRouter::prepSourceAndTarget(QDomDocument * masterDoc, RouteThing & routeThing, QList< QList<ConnectorItem *> > & subnets, int z, ViewLayer::ViewLayerPlacement viewLayerPlacement)
@@ -1354,22 +1745,22 @@ void MazeRouter::prepSourceAndTarget(QDomDocument * masterDoc, RouteThing & rout
 	}
 
 	QList<ConnectorItem *> li = subnets.at(routeThing.nearest.i);
-	QList<QPoint> sourcePoints = renderSource(masterDoc, z, viewLayerPlacement, m_grid, routeThing.netElements[z].net, li, GridSource, true, routeThing.r4);
+	QList<QPoint> sourcePoints = renderSource(masterDoc, z, viewLayerPlacement, routeThing.lane->grid, routeThing.lane->spareImage, routeThing.netElements[z].net, li, GridSource, true, routeThing.r4);
 
 	foreach (QPoint p, sourcePoints) {
 		GridPoint gridPoint(p, z);
 		gridPoint.qCost = gridPoint.baseCost = /* initialCost(p, routeThing.gridTarget) + */ 0;
 		//DebugDialog::debug(QString("pushing source %1 %2 %3, %4, %5").arg(gridPoint.x).arg(gridPoint.y).arg(gridPoint.z).arg(gridPoint.qCost).arg(routeThing.pq.size()));
-		routeThing.sourceQ.push(gridPoint);
+		addSeed(routeThing, gridPoint, true);
 	}
 
 	QList<ConnectorItem *> lj = subnets.at(routeThing.nearest.j);
-	QList<QPoint> targetPoints = renderSource(masterDoc, z, viewLayerPlacement, m_grid, routeThing.netElements[z].net, lj, GridTarget, true, routeThing.r4);
+	QList<QPoint> targetPoints = renderSource(masterDoc, z, viewLayerPlacement, routeThing.lane->grid, routeThing.lane->spareImage, routeThing.netElements[z].net, lj, GridTarget, true, routeThing.r4);
 	foreach (QPoint p, targetPoints) {
 		GridPoint gridPoint(p, z);
 		gridPoint.qCost = gridPoint.baseCost = /* initialCost(p, routeThing.gridTarget) + */ 0;
 		//DebugDialog::debug(QString("pushing source %1 %2 %3, %4, %5").arg(gridPoint.x).arg(gridPoint.y).arg(gridPoint.z).arg(gridPoint.qCost).arg(routeThing.pq.size()));
-		routeThing.targetQ.push(gridPoint);
+		addSeed(routeThing, gridPoint, false);
 	}
 
 	foreach (QDomElement element, routeThing.netElements[z].net) {
@@ -1405,15 +1796,15 @@ void MazeRouter::findNearestPair(QList< QList<ConnectorItem *> > & subnets, int
 	for (int j = inetix + 1; j < subnets.count(); j++) {
 		QList<ConnectorItem *> jnet = subnets.at(j);
 		foreach (ConnectorItem * ic, inet) {
-			QPointF ip = ic->sceneAdjustedTerminalPoint(nullptr);
-			ConnectorItem * icc = ic->getCrossLayerConnectorItem();
+			const ConnectorSnapshot is = m_connectorSnapshots.value(ic);
+			ConnectorItem * icc = is.crossLayer;
 			foreach (ConnectorItem * jc, jnet) {
-				ConnectorItem * jcc = jc->getCrossLayerConnectorItem();
+				const ConnectorSnapshot js = m_connectorSnapshots.value(jc);
+				ConnectorItem * jcc = js.crossLayer;
 				if (jc == ic || jcc == ic) continue;
 
-				QPointF jp = jc->sceneAdjustedTerminalPoint(nullptr);
-				double d = qSqrt(GraphicsUtils::distanceSqd(ip, jp)) / m_gridPixels;
-				if (ic->attachedToViewLayerID() != jc->attachedToViewLayerID()) {
+				double d = qSqrt(GraphicsUtils::distanceSqd(is.terminalPoint, js.terminalPoint)) / m_gridPixels;
+				if (is.viewLayerID != js.viewLayerID) {
 					if (jcc != nullptr || icc != nullptr) {
 						// may not need a via
 						d += CrossLayerCost;
@@ -1424,7 +1815,7 @@ void MazeRouter::findNearestPair(QList< QList<ConnectorItem *> > & subnets, int
 					}
 				}
 				else {
-					if (jcc != nullptr && icc != nullptr && ic->attachedToViewLayerID() == ViewLayer::Copper1) {
+					if (jcc != nullptr && icc != nullptr && is.viewLayerID == ViewLayer::Copper1) {
 						// route on the bottom when possible
 						d += Layer1Cost;
 					}
@@ -1441,27 +1832,25 @@ void MazeRouter::findNearestPair(QList< QList<ConnectorItem *> > & subnets, int
 	}
 }
 
-QList<QPoint> MazeRouter::renderSource(QDomDocument * masterDoc, int z, ViewLayer::ViewLayerPlacement viewLayerPlacement, Grid * grid, QList<QDomElement> & netElements, QList<ConnectorItem *> & subnet, GridValue value, bool clearElements, const QRectF & renderRect) {
+QList<QPoint> MazeRouter::renderSource(QDomDocument * masterDoc, int z, ViewLayer::ViewLayerPlacement viewLayerPlacement, Grid * grid, QImage * spareImage, QList<QDomElement> & netElements, QList<ConnectorItem *> & subnet, GridValue value, bool clearElements, const QRectF & renderRect) {
 	if (clearElements) {
 		foreach (QDomElement element, netElements) {
 			element.setTagName("g");
 		}
 	}
 
-	m_spareImage->fill(0xffffffff);
 	QMultiHash<QString, QString> partIDs;
 	QMultiHash<QString, QString> terminalIDs;
 	QList<ConnectorItem *> terminalPoints;
 	QRectF itemsBoundingRect;
 	foreach (ConnectorItem * connectorItem, subnet) {
-		ItemBase * itemBase = connectorItem->attachedTo();
-		SvgIdLayer * svgIdLayer = connectorItem->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
-		partIDs.insert(QString::number(itemBase->id()), svgIdLayer->m_svgId);
-		if (!svgIdLayer->m_terminalId.isEmpty()) {
-			terminalIDs.insert(QString::number(itemBase->id()), svgIdLayer->m_terminalId);
+		const ConnectorSnapshot snapshot = m_connectorSnapshots.value(connectorItem);
+		partIDs.insert(snapshot.partID, snapshot.svgID);
+		if (!snapshot.terminalID.isEmpty()) {
+			terminalIDs.insert(snapshot.partID, snapshot.terminalID);
 			terminalPoints << connectorItem;
 		}
-		itemsBoundingRect |= connectorItem->sceneBoundingRect();
+		itemsBoundingRect |= snapshot.sceneRect;
 	}
 	foreach (QDomElement element, netElements) {
 		if (idsMatch(element, partIDs)) {
@@ -1482,23 +1871,25 @@ QList<QPoint> MazeRouter::renderSource(QDomDocument * masterDoc, int z, ViewLaye
 	int x2 = qCeil((itemsBoundingRect.right() - m_maxRect.left()) / m_gridPixels);
 	int y2 = qCeil((itemsBoundingRect.bottom() - m_maxRect.top()) / m_gridPixels);
 
-	ItemBase::renderOne(masterDoc, m_spareImage, renderRect);
+	// only the grid window below is read back, so only that much is drawn
+	ObstacleWindow::render(masterDoc, spareImage, renderRect, imageWindow(itemsBoundingRect, spareImage));
 #ifndef QT_NO_DEBUG
 	//static int rsi = 0;
-	//m_spareImage->save(FolderUtils::getUserDataStorePath("") + QString("/rendersource%1_%2.png").arg(rsi++,3,10,QChar('0')).arg(z));
+	//spareImage->save(FolderUtils::getUserDataStorePath("") + QString("/rendersource%1_%2.png").arg(rsi++,3,10,QChar('0')).arg(z));
 #endif
-	QList<QPoint> points = grid->init4(x1, y1, z, x2 - x1, y2 - y1, m_spareImage, value, true);
+	QList<QPoint> points = grid->init4(x1, y1, z, x2 - x1, y2 - y1, spareImage, value, true);
 
 
 
 	// terminal point hack (mostly for schematic view)
 	foreach (ConnectorItem * connectorItem, terminalPoints) {
-		if (ViewLayer::specFromID(connectorItem->attachedTo()->viewLayerID()) != viewLayerPlacement) {
+		const ConnectorSnapshot snapshot = m_connectorSnapshots.value(connectorItem);
+		if (snapshot.viewLayerPlacement != viewLayerPlacement) {
 			continue;
 		}
 
-		QPointF p = connectorItem->sceneAdjustedTerminalPoint(nullptr);
-		QRectF r = connectorItem->attachedTo()->sceneBoundingRect().adjusted(-m_keepoutPixels, -m_keepoutPixels, m_keepoutPixels, m_keepoutPixels);
+		QPointF p = snapshot.terminalPoint;
+		QRectF r = snapshot.attachedToRect.adjusted(-m_keepoutPixels, -m_keepoutPixels, m_keepoutPixels, m_keepoutPixels);
 		QPointF closest(p.x(), r.top());
 		double d = qAbs(p.y() - r.top());
 		int dx = 0;
@@ -1580,33 +1971,66 @@ QList<QPoint> MazeRouter::renderSource(QDomDocument * masterDoc, int z, ViewLaye
 	return points;
 }
 
+void MazeRouter::addSeed(RouteThing & routeThing, const GridPoint & gridPoint, bool source) {
+	// seeds are queued by route(), once both bounding boxes are known
+	QRect r(gridPoint.x, gridPoint.y, 1, 1);
+	if (source) {
+		routeThing.sourceSeeds.append(gridPoint);
+		routeThing.sourceBounds |= r;
+	}
+	else {
+		routeThing.targetSeeds.append(gridPoint);
+		routeThing.targetBounds |= r;
+	}
+}
+
 QList<GridPoint> MazeRouter::route(RouteThing & routeThing, int & viaCount)
 {
 	//DebugDialog::debug(QString("start route() %1").arg(routeNumber++));
+	foreach (GridPoint gridPoint, routeThing.sourceSeeds) {
+		routeThing.sourceQ.push(gridPoint, (m_heuristicFunction)(QPoint(gridPoint.x, gridPoint.y), routeThing.targetBounds));
+	}
+	foreach (GridPoint gridPoint, routeThing.targetSeeds) {
+		routeThing.targetQ.push(gridPoint, (m_heuristicFunction)(QPoint(gridPoint.x, gridPoint.y), routeThing.sourceBounds));
+	}
+	routeThing.sourceSeeds.clear();
+	routeThing.targetSeeds.clear();
+
 	viaCount = 0;
 	GridPoint done;
 	bool result = false;
-	while (!routeThing.sourceQ.empty() && !routeThing.targetQ.empty()) {
-		GridPoint gp = routeThing.sourceQ.top();
-		GridPoint gpt = routeThing.targetQ.top();
-		if (gpt.qCost < gp.qCost) {
-			gp = gpt;
-			routeThing.targetQ.pop();
+	Grid * grid = routeThing.lane->grid;
+	while (!routeThing.sourceQ.isEmpty() && !routeThing.targetQ.isEmpty()) {
+		GridPoint gp;
+		if (routeThing.targetQ.topKey() < routeThing.sourceQ.topKey()) {
+			gp = routeThing.targetQ.pop();
 			routeThing.targetValue = GridSource;
 			routeThing.sourceValue = GridTarget;
 		}
 		else {
-			routeThing.sourceQ.pop();
+			gp = routeThing.sourceQ.pop();
 			routeThing.targetValue = GridTarget;
 			routeThing.sourceValue = GridSource;
 		}
 
 		if (gp.flags & GridPointDone) {
+			// meeting points are keyed on the full path cost, so nothing left in either queue can beat this one
 			done = gp;
 			result = true;
 			break;
 		}
 
+		if (gp.baseCost > 0) {
+			// skip entries superseded by a cheaper push, and cells that were already expanded
+			if (grid->closed(gp.x, gp.y, gp.z)) continue;
+
+			GridValue current = grid->at(gp.x, gp.y, gp.z);
+			if (routeThing.sourceValue == GridSource) current ^= GridSourceFlag;
+			if (gp.baseCost > current) continue;
+
+			grid->close(gp.x, gp.y, gp.z);
+		}
+
 		expand(gp, routeThing);
 		if (m_cancelled || m_stopTracing) {
 			break;
@@ -1622,8 +2046,8 @@ QList<GridPoint> MazeRouter::route(RouteThing & routeThing, int & viaCount)
 		return points;
 	}
 	done.baseCost = std::numeric_limits<GridValue>::max();  // make sure this is the largest value for either traceback
-	QList<GridPoint> sourcePoints = traceBack(done, m_grid, viaCount, GridTarget, GridSource);      // trace back to source
-	QList<GridPoint> targetPoints = traceBack(done, m_grid, viaCount, GridSource, GridTarget);      // trace back to target
+	QList<GridPoint> sourcePoints = traceBack(done, routeThing.lane->grid, viaCount, GridTarget, GridSource);      // trace back to source
+	QList<GridPoint> targetPoints = traceBack(done, routeThing.lane->grid, viaCount, GridSource, GridTarget);      // trace back to target
 	if (sourcePoints.count() == 0 || targetPoints.count() == 0) {
 		DebugDialog::debug("traceback zero points");
 		return points;
@@ -1634,7 +2058,7 @@ QList<GridPoint> MazeRouter::route(RouteThing & routeThing, int & viaCount)
 		points.append(sourcePoints);
 	}
 
-	clearExpansion(m_grid);
+	clearExpansion(routeThing.lane->grid);
 
 	//DebugDialog::debug(QString("done with route() %1").arg(points.count()));
 
@@ -1743,13 +2167,15 @@ void MazeRouter::expand(GridPoint & gridPoint, RouteThing & routeThing)
 	//if (debugit) {
 	//    DebugDialog::debug(QString("expand %1 %2 %3, %4").arg(gridPoint.x).arg(gridPoint.y).arg(gridPoint.z).arg(routeThing.pq.size()));
 	//}
+	Grid * grid = routeThing.lane->grid;
+	routeThing.lane->expanded++;
 	if (gridPoint.x > 0) expandOne(gridPoint, routeThing, -1, 0, 0, false);
-	if (gridPoint.x < m_grid->x - 1) expandOne(gridPoint, routeThing, 1, 0, 0, false);
+	if (gridPoint.x < grid->x - 1) expandOne(gridPoint, routeThing, 1, 0, 0, false);
 	if (gridPoint.y > 0) expandOne(gridPoint, routeThing, 0, -1, 0, false);
-	if (gridPoint.y < m_grid->y - 1) expandOne(gridPoint, routeThing, 0, 1, 0, false);
+	if (gridPoint.y < grid->y - 1) expandOne(gridPoint, routeThing, 0, 1, 0, false);
 	if (m_bothSidesNow) {
 		if (gridPoint.z > 0) expandOne(gridPoint, routeThing, 0, 0, -1, true);
-		if (gridPoint.z < m_grid->z - 1) expandOne(gridPoint, routeThing, 0, 0, 1, true);
+		if (gridPoint.z < grid->z - 1) expandOne(gridPoint, routeThing, 0, 0, 1, true);
 	}
 	//if (debugit) {
 	//    DebugDialog::debug("expand done");
@@ -1761,12 +2187,15 @@ void MazeRouter::expandOne(GridPoint & gridPoint, RouteThing & routeThing, int d
 	next.x = gridPoint.x + dx;
 	next.y = gridPoint.y + dy;
 	next.z = gridPoint.z + dz;
+	Grid * grid = routeThing.lane->grid;
 
 	//DebugDialog::debug(QString("expand one %1,%2,%3 cl:%4").arg(next.x).arg(next.y).arg(next.z).arg(crossLayer));
 
 	bool writeable = false;
 	bool avoid = false;
-	GridValue nextval = m_grid->at(next.x, next.y, next.z);
+	GridValue ownCost = GridBoardObstacle;
+	GridValue otherCost = 0;
+	GridValue nextval = grid->at(next.x, next.y, next.z);
 	if (nextval == GridPartObstacle || nextval == GridBoardObstacle || nextval == routeThing.sourceValue || nextval == GridTempObstacle) {
 		//DebugDialog::debug("exit expand one");
 		return;
@@ -1782,7 +2211,7 @@ void MazeRouter::expandOne(GridPoint & gridPoint, RouteThing & routeThing, int d
 	else if (nextval == GridAvoid) {
 		bool contains = true;
 		for (int i = 1; i <= 3; i++) {
-			if (!routeThing.avoids.contains(((next.y - (i * dy)) * m_grid->x) + next.x - (i * dx))) {
+			if (!routeThing.avoids.contains(((next.y - (i * dy)) * grid->x) + next.x - (i * dx))) {
 				contains = false;
 				break;
 			}
@@ -1794,39 +2223,40 @@ void MazeRouter::expandOne(GridPoint & gridPoint, RouteThing & routeThing, int d
 		}
 		avoid = writeable = true;
 		if (dx == 0) {
-			if (m_grid->at(next.x - 1, next.y, next.z) == GridAvoid) {
-				m_grid->setAt(next.x - 1, next.y, next.z, GridTempObstacle);
+			if (grid->at(next.x - 1, next.y, next.z) == GridAvoid) {
+				grid->setAt(next.x - 1, next.y, next.z, GridTempObstacle);
 			}
-			if (m_grid->at(next.x + 1, next.y, next.z) == GridAvoid) {
-				m_grid->setAt(next.x + 1, next.y, next.z, GridTempObstacle);
+			if (grid->at(next.x + 1, next.y, next.z) == GridAvoid) {
+				grid->setAt(next.x + 1, next.y, next.z, GridTempObstacle);
 			}
 		}
 		else {
-			if (m_grid->at(next.x, next.y - 1, next.z) == GridAvoid) {
-				m_grid->setAt(next.x, next.y - 1, next.z, GridTempObstacle);
+			if (grid->at(next.x, next.y - 1, next.z) == GridAvoid) {
+				grid->setAt(next.x, next.y - 1, next.z, GridTempObstacle);
 			}
-			if (m_grid->at(next.x, next.y + 1, next.z) == GridAvoid) {
-				m_grid->setAt(next.x, next.y + 1, next.z, GridTempObstacle);
+			if (grid->at(next.x, next.y + 1, next.z) == GridAvoid) {
+				grid->setAt(next.x, next.y + 1, next.z, GridTempObstacle);
 			}
 		}
 	}
 	else {
-		// already been here: see if source and target expansions have intersected
-		if (routeThing.sourceValue == GridSource) {
-			if (nextval & GridSourceFlag) return;
+		// already been here: either a cheaper way into our own expansion, or source and target expansions have intersected
+		bool own = (routeThing.sourceValue == GridSource) == ((nextval & GridSourceFlag) != 0);
+		if (own) {
+			if (grid->closed(next.x, next.y, next.z)) return;
 
-			next.flags |= GridPointDone;
+			writeable = true;
+			ownCost = nextval & ~GridSourceFlag;
 		}
 		else {
-			if ((nextval & GridSourceFlag) == 0) return;
-
 			next.flags |= GridPointDone;
+			otherCost = nextval & ~GridSourceFlag;
 		}
 	}
 
 	// any way to skip viaWillFit or put it off until actually needed?
 	if (crossLayer) {
-		if (!viaWillFit(next, m_grid)) return;
+		if (!viaWillFit(next, grid)) return;
 
 		// only way to cross layers is with a via
 		//QPointF center = getPixelCenter(next, m_maxRect.topLeft(), m_gridPixels);
@@ -1841,6 +2271,11 @@ void MazeRouter::expandOne(GridPoint & gridPoint, RouteThing & routeThing, int d
 		next.baseCost += AvoidCost;
 	}
 	next.baseCost++;
+	if (next.baseCost >= ownCost) return;
+	if (next.baseCost > MaxPathCost) {
+		// the grid can't store the cost, and the queue keys would wrap; no useful route costs this much anyway
+		return;
+	}
 
 
 	/*
@@ -1882,12 +2317,14 @@ void MazeRouter::expandOne(GridPoint & gridPoint, RouteThing & routeThing, int d
 	*/
 
 
-	if (nextval == routeThing.targetValue) {
-		next.qCost = next.baseCost;
+	quint32 key;
+	if (next.flags & GridPointDone) {
+		// key a meeting point on the cost of the whole path through it
+		key = (quint32) (next.baseCost + otherCost);
 	}
 	else {
+		key = (quint32) next.baseCost + (m_heuristicFunction)(QPoint(next.x, next.y), (routeThing.sourceValue == GridSource) ? routeThing.targetBounds : routeThing.sourceBounds);
 		double d = (m_costFunction)(QPoint(next.x, next.y), (routeThing.sourceValue == GridSource) ? routeThing.gridTargetPoint : routeThing.gridSourcePoint);
-		next.qCost = next.baseCost + d;
 		if (routeThing.sourceValue == GridSource) {
 			if (d < routeThing.bestDistanceToTarget) {
 				//DebugDialog::debug(QString("best d target %1, %2,%3").arg(d).arg(next.x).arg(next.y));
@@ -1906,12 +2343,12 @@ void MazeRouter::expandOne(GridPoint & gridPoint, RouteThing & routeThing, int d
 
 	// can think about pushing multiple points here
 	//DebugDialog::debug(QString("pushing next %1 %2 %3, %4, %5").arg(gridPoint.x).arg(gridPoint.y).arg(gridPoint.z).arg(gridPoint.qCost).arg(routeThing.pq.size()));
-	if (routeThing.sourceValue == GridSource) routeThing.sourceQ.push(next);
-	else routeThing.targetQ.push(next);
+	if (routeThing.sourceValue == GridSource) routeThing.sourceQ.push(next, key);
+	else routeThing.targetQ.push(next, key);
 
 	if (writeable) {
 		GridValue flag = (routeThing.sourceValue == GridSource) ? GridSourceFlag : 0;
-		m_grid->setAt(next.x, next.y, next.z, next.baseCost | flag);
+		grid->setAt(next.x, next.y, next.z, next.baseCost | flag);
 	}
 
 	//DebugDialog::debug("done expand one");
@@ -1986,17 +2423,7 @@ void MazeRouter::updateDisplay(GridPoint & gridPoint) {
 }
 
 void MazeRouter::clearExpansion(Grid * grid) {
-	// TODO: keep a list of expansion points instead?
-
-	for (int z = 0; z < grid->z; z++) {
-		for (int y = 0; y < grid->y; y++) {
-			for (int x = 0; x < grid->x; x++) {
-				GridValue val = grid->at(x, y, z);
-				if (val == 0 || val == GridPartObstacle || val == GridBoardObstacle) ;
-				else grid->setAt(x, y, z, 0);
-			}
-		}
-	}
+	grid->clearExpansion();
 }
 
 void MazeRouter::initTraceDisplay() {
@@ -2091,6 +2518,7 @@ void MazeRouter::traceObstacles(QList<Trace> & traces, int netIndex, Grid * grid
 
 void MazeRouter::traceAvoids(QList<Trace> & traces, int netIndex, RouteThing & routeThing) {
 	// treat traces from previous nets as semi-obstacles
+	Grid * grid = routeThing.lane->grid;
 	routeThing.avoids.clear();
 	foreach (Trace trace, traces) {
 		if (trace.netIndex == netIndex) continue;
@@ -2098,11 +2526,11 @@ void MazeRouter::traceAvoids(QList<Trace> & traces, int netIndex, RouteThing & r
 		foreach (GridPoint gridPoint, trace.gridPoints) {
 			for (int y = -m_keepoutGridInt; y <= m_keepoutGridInt; y++) {
 				for (int x = -m_keepoutGridInt; x <= m_keepoutGridInt; x++) {
-					GridValue val = m_grid->at(gridPoint.x + x, gridPoint.y + y, 0);
+					GridValue val = grid->at(gridPoint.x + x, gridPoint.y + y, 0);
 					if (val == GridPartObstacle || val == GridBoardObstacle || val == GridSource || val == GridTarget) continue;
 
-					m_grid->setAt(gridPoint.x + x, gridPoint.y + y, 0, GridAvoid);
-					routeThing.avoids.insert(((gridPoint.y + y) * m_grid->x) + x + gridPoint.x);
+					grid->setAt(gridPoint.x + x, gridPoint.y + y, 0, GridAvoid);
+					routeThing.avoids.insert(((gridPoint.y + y) * grid->x) + x + gridPoint.x);
 				}
 			}
 		}
@@ -2121,9 +2549,87 @@ void MazeRouter::traceAvoids(QList<Trace> & traces, int netIndex, RouteThing & r
 
 			for (int y = -m_halfGridJumperSize; y <= m_halfGridJumperSize; y++) {
 				for (int x = xl; x <= xr; x++) {
-					m_grid->setAt(gridPoint.x + x, gridPoint.y + y, 0, GridBoardObstacle);
+					grid->setAt(gridPoint.x + x, gridPoint.y + y, 0, GridBoardObstacle);
+				}
+			}
+		}
+	}
+}
+
+static void addFootprintSquare(QSet<qint64> & cells, const Grid * grid, int cx, int cy, int cz, int half) {
+	for (int y = cy - half; y <= cy + half; y++) {
+		if (y < 0 || y >= grid->y) continue;
+		for (int x = cx - half; x <= cx + half; x++) {
+			if (x < 0 || x >= grid->x) continue;
+			cells.insert((((qint64) cz * grid->y) + y) * grid->x + x);
+		}
+	}
+}
+
+QSet<qint64> MazeRouter::traceFootprint(const Trace & trace) {
+	// the cells traceObstacles() would block for this trace
+	QSet<qint64> cells;
+	int lastZ = trace.gridPoints.at(0).z;
+	foreach (GridPoint gridPoint, trace.gridPoints) {
+		if (gridPoint.z != lastZ) {
+			addFootprintSquare(cells, m_grid, gridPoint.x, gridPoint.y, 0, m_halfGridViaSize);
+			addFootprintSquare(cells, m_grid, gridPoint.x, gridPoint.y, 1, m_halfGridViaSize);
+			lastZ = gridPoint.z;
+		}
+		else {
+			addFootprintSquare(cells, m_grid, gridPoint.x, gridPoint.y, gridPoint.z, m_keepoutGridInt);
+		}
+	}
+
+	if (trace.flags) {
+		GridPoint gridPoint = trace.gridPoints.first();
+		addFootprintSquare(cells, m_grid, gridPoint.x, gridPoint.y, 0, m_halfGridJumperSize);
+		if (m_bothSidesNow) addFootprintSquare(cells, m_grid, gridPoint.x, gridPoint.y, 1, m_halfGridJumperSize);
+	}
+
+	return cells;
+}
+
+void MazeRouter::ripUpConflicts(const Trace & newTrace, Score & currentScore) {
+	// provisional traces were not obstacles while newTrace was routed, so rip up any that are now in its way
+	if (currentScore.provisional.isEmpty()) return;
+
+	QSet<qint64> newCells = traceFootprint(newTrace);
+	QSet<qint64> newPoints;
+	QRect newBounds;
+	foreach (GridPoint gridPoint, newTrace.gridPoints) {
+		newPoints.insert((((qint64) gridPoint.z * m_grid->y) + gridPoint.y) * m_grid->x + gridPoint.x);
+		newBounds |= QRect(gridPoint.x, gridPoint.y, 1, 1);
+	}
+	int margin = qMax(m_keepoutGridInt, qMax(m_halfGridViaSize, m_halfGridJumperSize));
+	newBounds.adjust(-2 * margin, -2 * margin, 2 * margin, 2 * margin);
+
+	foreach (int netIndex, currentScore.provisional.values()) {
+		bool conflict = false;
+		foreach (Trace trace, currentScore.traces.values(netIndex)) {
+			bool near = false;
+			foreach (GridPoint gridPoint, trace.gridPoints) {
+				if (newBounds.contains(gridPoint.x, gridPoint.y)) {
+					near = true;
+					break;
 				}
 			}
+			if (!near) continue;
+
+			foreach (GridPoint gridPoint, trace.gridPoints) {
+				if (newCells.contains((((qint64) gridPoint.z * m_grid->y) + gridPoint.y) * m_grid->x + gridPoint.x)) {
+					conflict = true;
+					break;
+				}
+			}
+			if (conflict || traceFootprint(trace).intersects(newPoints)) {
+				conflict = true;
+				break;
+			}
+		}
+
+		if (conflict) {
+			currentScore.ripUp(netIndex);
 		}
 	}
 }
@@ -2151,6 +2657,11 @@ void MazeRouter::createTraces(NetList & netList, Score & bestScore, QUndoCommand
 	foreach (int netIndex, bestScore.ordering.order) {
 		emit setProgressValue(progress++);
 		//DebugDialog::debug(QString("tracing net %1").arg(netIndex));
+		if (bestScore.provisional.contains(netIndex)) {
+			// never checked against the ordering that produced bestScore
+			continue;
+		}
+
 		QList<Trace> traces = bestScore.traces.values(netIndex);
 		qSort(traces.begin(), traces.end(), byOrder);
 
@@ -2752,7 +3263,7 @@ void MazeRouter::insertTrace(Trace & newTrace, int netIndex, Score & currentScor
 	}
 	currentScore.viaCount.insert(netIndex, currentScore.viaCount.value(netIndex, 0) + viaCount);
 	currentScore.totalViaCount += viaCount;
-	displayTrace(newTrace);
+	ripUpConflicts(newTrace, currentScore);
 
 	//DebugDialog::debug(QString("done insert trace"));
 
@@ -2779,8 +3290,8 @@ SymbolPaletteItem * MazeRouter::makeNetLabel(GridPoint & center, SymbolPaletteIt
 
 	if (m_netLabelIndex < 0) {
 		m_netLabelIndex = 0;
-		foreach (QGraphicsItem * item, m_sketchWidget->scene()->items()) {
-			SymbolPaletteItem * netLabel = dynamic_cast<SymbolPaletteItem *>(item);
+		foreach (ItemBase * itemBase, m_sketchWidget->fgraphicsScene()->itemBases(ModelPart::Symbol)) {
+			SymbolPaletteItem * netLabel = qobject_cast<SymbolPaletteItem *>(itemBase);
 			if (netLabel == nullptr || !netLabel->isOnlyNetLabel()) continue;
 
 			bool ok;
@@ -2855,7 +3366,7 @@ void MazeRouter::routeJumper(int netIndex, RouteThing & routeThing, Score & curr
 		sourceTrace.flags = JumperStart;
 		if (gp1.flags & GridPointJumperLeft) sourceTrace.flags |= JumperLeft;
 		else if (gp1.flags & GridPointJumperRight) sourceTrace.flags |= JumperRight;
-		sourceTrace.gridPoints = traceBack(gp1, m_grid, sourceViaCount, GridTarget, GridSource);   // trace back to source
+		sourceTrace.gridPoints = traceBack(gp1, routeThing.lane->grid, sourceViaCount, GridTarget, GridSource);   // trace back to source
 	}
 
 	Trace destTrace;
@@ -2863,16 +3374,18 @@ void MazeRouter::routeJumper(int netIndex, RouteThing & routeThing, Score & curr
 	if (gp2.flags & GridPointJumperLeft) destTrace.flags |= JumperLeft;
 	else if (gp2.flags & GridPointJumperRight) destTrace.flags |= JumperRight;
 	int targetViaCount;
-	destTrace.gridPoints = traceBack(gp2, m_grid, targetViaCount, GridSource, GridTarget);          // trace back to target
+	destTrace.gridPoints = traceBack(gp2, routeThing.lane->grid, targetViaCount, GridSource, GridTarget);          // trace back to target
 
 	if (routeBothEnds) {
 		insertTrace(sourceTrace, netIndex, currentScore, sourceViaCount, false);
+		displayTrace(sourceTrace);
 	}
 	insertTrace(destTrace, netIndex, currentScore, targetViaCount, true);
+	displayTrace(destTrace);
 	updateDisplay(0);
 	if (m_bothSidesNow) updateDisplay(1);
 
-	clearExpansion(m_grid);
+	clearExpansion(routeThing.lane->grid);
 }
 
 GridPoint MazeRouter::lookForJumper(GridPoint initial, GridValue targetValue, QPoint targetLocation) {
@@ -40,19 +40,9 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "../../viewlayer.h"
 #include "../../commands.h"
 #include "../autorouter.h"
-
-typedef quint64 GridValue;
-
-struct GridPoint {
-	int x, y, z;
-	GridValue baseCost = 0;
-	double qCost = 0.0;
-	uchar flags = 0;
-
-	bool operator<(const GridPoint&) const;
-	GridPoint(QPoint p, int zed) : x(p.x()), y(p.y()), z(zed) { }
-	constexpr GridPoint() : x(0), y(0), z(0) { }
-};
+#include "../drc.h"
+#include "routequeue.h"
+#include "obstaclewindow.h"
 
 struct PointZ {
 	QPointF p;
@@ -64,10 +54,25 @@ struct PointZ {
 struct Net {
 	QList<class ConnectorItem *>* net = nullptr;
 	QList< QList<ConnectorItem *> > subnets;
+	SplitNetIDs splitIDs;
+	QHash<QString, QRectF> itemRects;	// by partID: every part and trace the net touches, so routing it only changes obstacles inside
 	int pinsWithin = 0;
 	int id = 0;
 };
 
+struct ConnectorSnapshot {
+	// what routing reads from a ConnectorItem, copied on the GUI thread so the lanes never touch the scene
+	QPointF terminalPoint;
+	QRectF sceneRect;
+	QRectF attachedToRect;
+	QString partID;
+	QString svgID;
+	QString terminalID;
+	ViewLayer::ViewLayerID viewLayerID = ViewLayer::UnknownLayer;
+	ViewLayer::ViewLayerPlacement viewLayerPlacement = ViewLayer::NewTop;
+	ConnectorItem * crossLayer = nullptr;
+};
+
 struct NetList {
 	QList<Net *> nets;
 };
@@ -90,13 +95,17 @@ struct Score {
 	QMultiHash<int, Trace> traces;
 	QHash<int, int> routedCount;
 	QHash<int, int> viaCount;
-	int totalRoutedCount = 0;
+	QSet<int> provisional;			// nets whose traces are kept from an earlier ordering until something routed ahead of them needs the space
+	int totalRoutedCount = 0;		// totals leave out provisional nets until routing reaches them with their traces intact
 	int totalViaCount = 0;
 	int reorderNet = -1;
 	bool anyUnrouted = false;
 
 	Score() = default;
 	void setOrdering(const NetOrdering &);
+	void ripUp(int netIndex);
+	void confirm(int netIndex);
+	QList<Trace> committedTraces() const;
 };
 
 struct Nearest {
@@ -106,22 +115,51 @@ struct Nearest {
 	ConnectorItem * jc = nullptr;
 };
 
+struct GridTile {
+	uchar * marks = nullptr;		// one marker per cell; not allocated until the tile stops being uniform
+	quint32 * costs = nullptr;		// expansion costs, only meaningful where the marker says so
+	uchar fill = 0;					// the marker of every cell while the tile is uniform
+	bool uniform = true;
+};
+
 struct Grid {
-	/// @todo replace this with std::unique_ptr<GridValue[]>
-	GridValue * data = nullptr;
+	// cells are stored in square tiles, so neighbors usually share a cache line;
+	// obstacle/source/target markers take a byte per cell and costs live in a separate array
+	static const int TileShift = 3;
+	static const int TileSize = 1 << TileShift;
+	static const int TileMask = TileSize - 1;
+	static const int TileCells = TileSize * TileSize;
+
 	int x = 0;
 	int y = 0;
 	int z = 0;
-
-	Grid(int x, int y, int layers);
-    ~Grid();
-
+	int tilesX = 0;
+	int tilesY = 0;
+	bool sparse = false;			// allocate tiles on first write instead of up front
+	QVector<GridTile> tiles;
+	uchar * markBlock = nullptr;
+	quint32 * costBlock = nullptr;
+	qint64 bytes = 0;
+
+	Grid(int x, int y, int layers, bool sparse);
+	Grid(const Grid &) = delete;
+	Grid & operator=(const Grid &) = delete;
+	~Grid();
+
+	bool isValid() const;
 	GridValue at(int x, int y, int z) const;
 	void setAt(int x, int y, int z, GridValue value);
+	bool closed(int x, int y, int z) const;
+	void close(int x, int y, int z);
 	QList<QPoint> init(int x, int y, int z, int width, int height, const QImage &, GridValue value, bool collectPoints);
 	QList<QPoint> init4(int x, int y, int z, int width, int height, const QImage *, GridValue value, bool collectPoints);
 	void clear();
+	void clearExpansion();
 	void copy(int fromIndex, int toIndex);
+
+protected:
+	void split(GridTile &);
+	void allocateCosts(GridTile &);
 };
 
 
@@ -131,13 +169,30 @@ struct NetElements {
 	QList<QDomElement> notNet;
 };
 
+struct RouteLane {
+	// routing state for one NetOrdering; lanes other than the first run on worker threads
+	Grid * grid = nullptr;
+	QImage * spareImage = nullptr;
+	QHash<ViewLayer::ViewLayerPlacement, QDomDocument *> masterDocs;
+	Score score;
+	QList<NetOrdering> newOrderings;
+	qint64 expanded = 0;
+	bool display = false;
+	bool ownsData = false;
+};
+
 struct RouteThing {
+	RouteLane * lane = nullptr;
 	QRectF r;
 	QRectF r4;
 	QList<ViewLayer::ViewLayerPlacement> layerSpecs;
 	Nearest nearest;
-	std::priority_queue<GridPoint> sourceQ;
-	std::priority_queue<GridPoint> targetQ;
+	QList<GridPoint> sourceSeeds;
+	QList<GridPoint> targetSeeds;
+	QRect sourceBounds;				// bounding box of the source seeds; the target-side heuristic aims here
+	QRect targetBounds;
+	RouteQueue sourceQ;
+	RouteQueue targetQ;
 	QPoint gridSourcePoint;
 	QPoint gridTargetPoint;
 	GridValue sourceValue;
@@ -174,6 +229,7 @@ struct ConnectionThing {
 
 typedef bool (*JumperWillFitFunction)(GridPoint &, const Grid *, int halfSize);
 typedef double (*CostFunction)(const QPoint & p1, const QPoint & p2);
+typedef quint32 (*HeuristicFunction)(const QPoint & p, const QRect & bounds);
 
 ////////////////////////////////////
 
@@ -192,13 +248,20 @@ protected:
 	int findPinsWithin(QList<ConnectorItem *> * net);
 	bool makeBoard(QImage *, double keepout, const QRectF & r);
 	bool makeMasters(QString &);
-	bool routeNets(NetList &, bool makeJumper, Score & currentScore, const QSizeF gridSize, QList<NetOrdering> & allOrderings);
-	bool routeOne(bool makeJumper, Score & currentScore, int netIndex, RouteThing &, QList<NetOrdering> & allOrderings);
+	bool routeNets(RouteLane &, NetList &, bool makeJumper, Score & currentScore, const QSizeF gridSize, const QList<NetOrdering> & allOrderings);
+	bool routeLane(RouteLane *, NetList *, QSizeF gridSize, const QList<NetOrdering> * allOrderings);
+	void routeBatch(int laneCount, NetList &, const QSizeF & gridSize, const QList<NetOrdering> & allOrderings);
+	void makeLanes();
+	void snapshotNets(NetList &);
+	QRect imageWindow(const QRectF & sceneRect, const QImage *);
+	void deleteLanes();
+	bool routeOne(bool makeJumper, Score & currentScore, int netIndex, RouteThing &, const QList<NetOrdering> & allOrderings);
 	void findNearestPair(QList< QList<ConnectorItem *> > & subnets, Nearest &);
 	void findNearestPair(QList< QList<ConnectorItem *> > & subnets, int i, QList<ConnectorItem *> & inet, Nearest &);
-	QList<QPoint> renderSource(QDomDocument * masterDoc, int z, ViewLayer::ViewLayerPlacement, Grid * grid, QList<QDomElement> & netElements, QList<ConnectorItem *> & subnet, GridValue value, bool clearElements, const QRectF & r);
+	QList<QPoint> renderSource(QDomDocument * masterDoc, int z, ViewLayer::ViewLayerPlacement, Grid * grid, QImage * spareImage, QList<QDomElement> & netElements, QList<ConnectorItem *> & subnet, GridValue value, bool clearElements, const QRectF & r);
 	QList<GridPoint> route(RouteThing &, int & viaCount);
 	void expand(GridPoint &, RouteThing &);
+	void addSeed(RouteThing &, const GridPoint &, bool source);
 	void expandOne(GridPoint &, RouteThing &, int dx, int dy, int dz, bool crossLayer);
 	bool viaWillFit(GridPoint &, Grid * grid);
 	QList<GridPoint> traceBack(GridPoint, Grid *, int & viaCount, GridValue sourceValue, GridValue targetValue);
@@ -208,12 +271,14 @@ protected:
 	void updateDisplay(GridPoint &);
 	void clearExpansion(Grid * grid);
 	void prepSourceAndTarget(QDomDocument * masterdoc, RouteThing &, QList< QList<ConnectorItem *> > & subnets, int z, ViewLayer::ViewLayerPlacement);
-	bool moveBack(Score & currentScore, int index, QList<NetOrdering> & allOrderings);
+	bool moveBack(Score & currentScore, int index, const QList<NetOrdering> & allOrderings, QList<NetOrdering> & newOrderings);
 	void displayTrace(Trace &);
 	void initTraceDisplay();
 	void traceObstacles(QList<Trace> & traces, int netIndex, Grid * grid, int ikeepout);
 	void traceAvoids(QList<Trace> & traces, int netIndex, RouteThing & routeThing);
-	bool routeNext(bool makeJumper, RouteThing &, QList< QList<ConnectorItem *> > & subnets, Score & currentScore, int netIndex, QList<NetOrdering> & allOrderings);
+	QSet<qint64> traceFootprint(const Trace &);
+	void ripUpConflicts(const Trace & newTrace, Score & currentScore);
+	bool routeNext(bool makeJumper, RouteThing &, QList< QList<ConnectorItem *> > & subnets, Score & currentScore, int netIndex, const QList<NetOrdering> & allOrderings);
 	void cleanUpNets(NetList &);
 	void createTraces(NetList & netList, Score & bestScore, QUndoCommand * parentCommand);
 	void createTrace(Trace &, QList<GridPoint> &, TraceThing &, ConnectionThing &, Net *);
@@ -256,9 +321,13 @@ protected:
 	QGraphicsPixmapItem * m_displayItem[2] = { nullptr, nullptr };
 	bool m_temporaryBoard;
 	CostFunction m_costFunction;
+	HeuristicFunction m_heuristicFunction;
 	JumperWillFitFunction m_jumperWillFitFunction;
 	uint m_traceColors[2] = { 0 };
 	Grid * m_grid;
+	QList<RouteLane *> m_lanes;
+	QHash<ConnectorItem *, ConnectorSnapshot> m_connectorSnapshots;
+	QHash<ViewLayer::ViewLayerPlacement, QImage *> m_obstacleImages;
 	int m_cleanupCount;
 	int m_netLabelIndex;
 	int m_commandCount;
@@ -0,0 +1,93 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "obstaclewindow.h"
+
+#include <QPainter>
+#include <QSet>
+#include <QSvgRenderer>
+#include <qmath.h>
+
+#include <string.h>
+
+bool ObstacleWindow::elementsRect(const QList<QDomElement> & elements, const QHash<QString, QRectF> & itemRects, QRectF & sceneRect)
+{
+	// the union of the items the elements were drawn from; false if one of them isn't known,
+	// in which case the window can't be trusted and everything has to be redrawn
+	sceneRect = QRectF();
+	QSet<QString> done;
+	foreach (QDomElement element, elements) {
+		QDomNode node = element;
+		QString partID;
+		while (!node.isNull() && node.isElement()) {
+			partID = node.toElement().attribute("partID");
+			if (!partID.isEmpty()) break;
+
+			node = node.parentNode();
+		}
+		if (partID.isEmpty()) return false;
+		if (done.contains(partID)) continue;
+
+		QHash<QString, QRectF>::const_iterator it = itemRects.constFind(partID);
+		if (it == itemRects.constEnd()) return false;
+
+		sceneRect |= it.value();
+		done.insert(partID);
+	}
+
+	return true;
+}
+
+QRect ObstacleWindow::imageWindow(const QRectF & sceneRect, const QRectF & maxRect, double gridPixels, double keepoutPixels, const QImage * image)
+{
+	// the part of a 4x routing image that sceneRect (plus keepout) can touch, widened to whole bytes
+	double scale = 4 / gridPixels;
+	double margin = (2 * keepoutPixels) + gridPixels;
+	QRectF r = sceneRect.adjusted(-margin, -margin, margin, margin).translated(-maxRect.topLeft());
+	int x1 = qMax(0, (qFloor(r.left() * scale) / 8) * 8);
+	int y1 = qMax(0, qFloor(r.top() * scale));
+	int x2 = qMin(image->width(), ((qCeil(r.right() * scale) + 7) / 8) * 8);
+	int y2 = qMin(image->height(), qCeil(r.bottom() * scale));
+	if (x2 <= x1 || y2 <= y1) return QRect();
+
+	return QRect(x1, y1, x2 - x1, y2 - y1);
+}
+
+void ObstacleWindow::render(QDomDocument * masterDoc, QImage * image, const QRectF & renderRect, const QRect & window)
+{
+	// like ItemBase::renderOne, but only the window is cleared and drawn; the rest of the image is left alone
+	if (window.isEmpty()) return;
+
+	int left = window.left() / 8;
+	int bytes = (window.right() / 8) - left + 1;
+	for (int y = window.top(); y <= window.bottom(); y++) {
+		memset(image->scanLine(y) + left, 0xff, bytes);
+	}
+
+	QByteArray byteArray = masterDoc->toByteArray();
+	QSvgRenderer renderer(byteArray);
+	QPainter painter;
+	painter.begin(image);
+	painter.setRenderHint(QPainter::Antialiasing, false);
+	painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+	painter.setClipRect(window);
+	renderer.render(&painter, renderRect);
+	painter.end();
+}
@@ -0,0 +1,43 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef OBSTACLEWINDOW_H
+#define OBSTACLEWINDOW_H
+
+#include <QDomDocument>
+#include <QDomElement>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QRect>
+#include <QRectF>
+#include <QString>
+
+// routing a net starts from a copy of the image with every obstacle drawn, and redraws only
+// the window the net's own elements could have covered once they are turned into <g>
+class ObstacleWindow
+{
+public:
+	static bool elementsRect(const QList<QDomElement> &, const QHash<QString, QRectF> & itemRects, QRectF & sceneRect);
+	static QRect imageWindow(const QRectF & sceneRect, const QRectF & maxRect, double gridPixels, double keepoutPixels, const QImage *);
+	static void render(QDomDocument *, QImage *, const QRectF & renderRect, const QRect & window);
+};
+
+#endif
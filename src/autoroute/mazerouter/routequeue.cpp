@@ -0,0 +1,102 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "routequeue.h"
+
+bool GridPoint::operator<(const GridPoint& other) const {
+	// make sure lower cost is first
+	return qCost > other.qCost;
+}
+////////////////////////////////////////////////////////////////////
+
+static inline int radixBucket(quint32 key, quint32 last) {
+	quint32 diff = key ^ last;
+	int bucket = 0;
+	while (diff) {
+		bucket++;
+		diff >>= 1;
+	}
+	return bucket;
+}
+
+void RouteQueue::push(const GridPoint & gridPoint, quint32 key) {
+	// a consistent heuristic never yields a key below the last one popped; clamp in case it does
+	if (key < m_last) key = m_last;
+
+	RouteQueueEntry entry;
+	entry.key = key;
+	entry.baseCost = (quint32) gridPoint.baseCost;
+	entry.x = gridPoint.x;
+	entry.y = gridPoint.y;
+	entry.z = (quint8) gridPoint.z;
+	entry.flags = gridPoint.flags;
+	m_buckets[radixBucket(key, m_last)].append(entry);
+	m_count++;
+}
+
+quint32 RouteQueue::topKey() {
+	Q_ASSERT(m_count > 0);
+	if (m_buckets[0].isEmpty()) {
+		int i = 1;
+		while (m_buckets[i].isEmpty()) i++;
+
+		// the smallest key in the first non-empty bucket becomes the new base; everything else in that bucket moves down
+		QVector<RouteQueueEntry> & bucket = m_buckets[i];
+		quint32 minKey = bucket.at(0).key;
+		foreach (const RouteQueueEntry & entry, bucket) {
+			if (entry.key < minKey) minKey = entry.key;
+		}
+		m_last = minKey;
+		foreach (const RouteQueueEntry & entry, bucket) {
+			m_buckets[radixBucket(entry.key, m_last)].append(entry);
+		}
+		bucket.clear();
+	}
+
+	return m_last;
+}
+
+GridPoint RouteQueue::pop() {
+	topKey();
+	// last in, first out among equal keys, which favors the deeper of two equally promising cells
+	RouteQueueEntry entry = m_buckets[0].takeLast();
+	m_count--;
+
+	GridPoint gridPoint;
+	gridPoint.x = entry.x;
+	gridPoint.y = entry.y;
+	gridPoint.z = entry.z;
+	gridPoint.baseCost = entry.baseCost;
+	gridPoint.qCost = entry.key;
+	gridPoint.flags = entry.flags;
+	return gridPoint;
+}
+
+bool RouteQueue::isEmpty() const {
+	return m_count == 0;
+}
+
+void RouteQueue::clear() {
+	for (int i = 0; i < BucketCount; i++) {
+		m_buckets[i].clear();
+	}
+	m_last = 0;
+	m_count = 0;
+}
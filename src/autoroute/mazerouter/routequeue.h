@@ -0,0 +1,66 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef ROUTEQUEUE_H
+#define ROUTEQUEUE_H
+
+#include <QPoint>
+#include <QVector>
+
+typedef quint64 GridValue;
+
+struct GridPoint {
+	int x, y, z;
+	GridValue baseCost = 0;
+	double qCost = 0.0;
+	uchar flags = 0;
+
+	bool operator<(const GridPoint&) const;
+	GridPoint(QPoint p, int zed) : x(p.x()), y(p.y()), z(zed) { }
+	constexpr GridPoint() : x(0), y(0), z(0) { }
+};
+
+struct RouteQueueEntry {
+	quint32 key;
+	quint32 baseCost;
+	qint32 x, y;
+	quint8 z;
+	quint8 flags;
+};
+
+class RouteQueue {
+	// monotone radix heap keyed on integer cost: entries live in buckets by the highest bit
+	// in which their key differs from the last key popped, so push is O(1) and pop amortized O(log C)
+public:
+	void push(const GridPoint &, quint32 key);
+	GridPoint pop();
+	quint32 topKey();
+	bool isEmpty() const;
+	void clear();
+
+protected:
+	static const int BucketCount = 33;
+
+	QVector<RouteQueueEntry> m_buckets[BucketCount];
+	quint32 m_last = 0;
+	int m_count = 0;
+};
+
+#endif
@@ -1473,7 +1473,7 @@ void Panelizer::makeSVGs(MainWindow * mainWindow, ItemBase * board, const QStrin
 		QString maskTop;
 		QString maskBottom;
 		QStringList texts;
-		QMultiHash<long, ConnectorItem *> treatAsCircle;
+		QMultiHash<long, DonutConnector> treatAsCircle;
 
 		bool needsRedo = false;
 		int missing = 0;
@@ -1561,14 +1561,7 @@ void Panelizer::makeSVGs(MainWindow * mainWindow, ItemBase * board, const QStrin
 			case SVG2gerber::ForCopper:
 			case SVG2gerber::ForDrill:
 				treatAsCircle.clear();
-				foreach (QGraphicsItem * item, mainWindow->pcbView()->scene()->collidingItems(board)) {
-					ConnectorItem * connectorItem = dynamic_cast<ConnectorItem *>(item);
-					if (connectorItem == NULL) continue;
-					if (!connectorItem->isPath()) continue;
-					if (connectorItem->radius() == 0) continue;
-
-					treatAsCircle.insert(connectorItem->attachedToID(), connectorItem);
-				}
+				GerberGenerator::collectTreatAsCircle(board, mainWindow->pcbView(), treatAsCircle);
 				wantText = true;
 				break;
 			default:
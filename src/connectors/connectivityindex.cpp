@@ -0,0 +1,390 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+
+#include "connectivityindex.h"
+#include "connectoritem.h"
+#include "bus.h"
+#include "../items/itembase.h"
+#include "../items/wire.h"
+#include "../sketch/fgraphicsscene.h"
+
+ConnectivityIndex::ConnectivityIndex() : m_nextSerial(1)
+{
+}
+
+ConnectivityIndex::~ConnectivityIndex()
+{
+	if (m_scene && m_scene->connectivityIndex() == this) {
+		m_scene->setConnectivityIndex(nullptr);
+	}
+}
+
+void ConnectivityIndex::setScene(FGraphicsScene * scene) {
+	if (m_scene && m_scene->connectivityIndex() == this) {
+		m_scene->setConnectivityIndex(nullptr);
+	}
+	m_scene = scene;
+	if (m_scene) {
+		m_scene->setConnectivityIndex(this);
+	}
+	m_partitions.clear();
+}
+
+ConnectivityIndex * ConnectivityIndex::indexOf(ConnectorItem * connectorItem) {
+	// while the scene itself is being deleted it is no longer an FGraphicsScene, so this comes back null
+	FGraphicsScene * scene = qobject_cast<FGraphicsScene *>(connectorItem->scene());
+	if (scene == nullptr) return nullptr;
+
+	return scene->connectivityIndex();
+}
+
+void ConnectivityIndex::invalidate() {
+	for (QHash<int, Partition>::iterator it = m_partitions.begin(); it != m_partitions.end(); ++it) {
+		it.value().valid = false;
+	}
+}
+
+void ConnectivityIndex::connected(ConnectorItem * from, ConnectorItem * to) {
+	ConnectivityIndex * index = indexOf(from);
+	if (index == nullptr) index = indexOf(to);
+	if (index == nullptr) return;
+
+	for (QHash<int, Partition>::iterator it = index->m_partitions.begin(); it != index->m_partitions.end(); ++it) {
+		Partition & p = it.value();
+		if (!p.valid) {
+			index->drop(p, from);
+			index->drop(p, to);
+			continue;
+		}
+
+		int i = p.ids.value(from, -1);
+		int j = p.ids.value(to, -1);
+		if (i < 0 || j < 0) {
+			// a skipped wire is never linked; a connector the partition hasn't seen yet means it is out of date
+			if ((i < 0 && !skipped(from, p.skipFlags)) || (j < 0 && !skipped(to, p.skipFlags))) {
+				index->drop(p, from);
+				index->drop(p, to);
+			}
+			continue;
+		}
+
+		if ((p.skipFlags & ViewGeometry::NormalFlag) && (from->attachedToItemType() != ModelPart::Wire) && (to->attachedToItemType() != ModelPart::Wire)) {
+			continue;
+		}
+
+		// a new net, or a new connection on the same net: either way its serial changes
+		p.serials.insert(unite(p, i, j), index->m_nextSerial++);
+	}
+}
+
+void ConnectivityIndex::disconnected(ConnectorItem * from, ConnectorItem * to) {
+	ConnectivityIndex * index = indexOf(from);
+	if (index == nullptr) index = indexOf(to);
+	if (index == nullptr) return;
+
+	for (QHash<int, Partition>::iterator it = index->m_partitions.begin(); it != index->m_partitions.end(); ++it) {
+		Partition & p = it.value();
+		if (p.valid && (!p.ids.contains(from) || !p.ids.contains(to))) {
+			// never linked in this partition
+			continue;
+		}
+
+		// a set can't be split in place, so the partition is rebuilt on the next query
+		index->drop(p, from);
+		index->drop(p, to);
+	}
+}
+
+void ConnectivityIndex::removed(ConnectorItem * connectorItem) {
+	// only compares pointers: this is called from ~ConnectorItem
+	ConnectivityIndex * index = indexOf(connectorItem);
+	if (index == nullptr) return;
+
+	for (QHash<int, Partition>::iterator it = index->m_partitions.begin(); it != index->m_partitions.end(); ++it) {
+		Partition & p = it.value();
+		if (p.valid && !p.ids.contains(connectorItem)) {
+			p.skipped.removeOne(connectorItem);
+			continue;
+		}
+
+		index->drop(p, connectorItem);
+	}
+}
+
+void ConnectivityIndex::changed(ConnectorItem * connectorItem) {
+	ConnectivityIndex * index = indexOf(connectorItem);
+	if (index == nullptr) return;
+
+	index->touch(connectorItem);
+}
+
+void ConnectivityIndex::netChanged(ConnectorItem * connectorItem) {
+	// the net is the same, but something callers cache under its serial is not
+	ConnectivityIndex * index = indexOf(connectorItem);
+	if (index == nullptr) return;
+
+	for (QHash<int, Partition>::iterator it = index->m_partitions.begin(); it != index->m_partitions.end(); ++it) {
+		Partition & p = it.value();
+		if (!p.valid) {
+			index->drop(p, connectorItem);
+			continue;
+		}
+
+		int i = p.ids.value(connectorItem, -1);
+		if (i >= 0) {
+			p.serials.insert(findRoot(p.parents, i), index->m_nextSerial++);
+		}
+	}
+}
+
+void ConnectivityIndex::itemAdded(ItemBase * itemBase) {
+	QList<ConnectorItem *> connectorItems = itemBase->cachedConnectorItems();
+	if (connectorItems.isEmpty()) return;
+
+	for (QHash<int, Partition>::iterator it = m_partitions.begin(); it != m_partitions.end(); ++it) {
+		Partition & p = it.value();
+		if (!p.valid) continue;
+
+		QList<int> added;
+		foreach (ConnectorItem * connectorItem, connectorItems) {
+			if (p.ids.contains(connectorItem)) continue;
+
+			if (skipped(connectorItem, p.skipFlags)) {
+				p.skipped.append(connectorItem);
+				continue;
+			}
+
+			added.append(add(p, connectorItem));
+		}
+
+		foreach (int i, added) link(p, i);
+		foreach (int i, added) {
+			p.serials.insert(findRoot(p.parents, i), m_nextSerial++);
+		}
+	}
+}
+
+void ConnectivityIndex::itemRemoved(ItemBase * itemBase) {
+	foreach (ConnectorItem * connectorItem, itemBase->cachedConnectorItems()) {
+		for (QHash<int, Partition>::iterator it = m_partitions.begin(); it != m_partitions.end(); ++it) {
+			Partition & p = it.value();
+			if (p.valid && !p.ids.contains(connectorItem)) {
+				p.skipped.removeOne(connectorItem);
+				continue;
+			}
+
+			drop(p, connectorItem);
+		}
+	}
+}
+
+void ConnectivityIndex::touch(ConnectorItem * connectorItem) {
+	for (QHash<int, Partition>::iterator it = m_partitions.begin(); it != m_partitions.end(); ++it) {
+		drop(it.value(), connectorItem);
+	}
+}
+
+void ConnectivityIndex::drop(Partition & p, ConnectorItem * connectorItem) {
+	p.valid = false;
+	p.touched.insert(connectorItem);
+	if (p.touched.count() > p.ids.count()) {
+		// not worth comparing against any more: every net gets a new serial on the rebuild
+		p.ids.clear();
+		p.touched.clear();
+	}
+}
+
+bool ConnectivityIndex::skipped(ConnectorItem * connectorItem, ViewGeometry::WireFlags skipFlags) {
+	if (connectorItem->attachedToItemType() != ModelPart::Wire) return false;
+
+	Wire * wire = qobject_cast<Wire *>(connectorItem->attachedTo());
+	return (wire != nullptr && wire->hasAnyFlag(skipFlags));
+}
+
+QList<ConnectorItem *> ConnectivityIndex::equalPotential(ConnectorItem * connectorItem, bool crossLayers, ViewGeometry::WireFlags skipFlags)
+{
+	QList<ConnectorItem *> connectorItems;
+	if (skipped(connectorItem, skipFlags)) return connectorItems;
+
+	Partition & p = partition(crossLayers, skipFlags);
+	int i = p.ids.value(connectorItem, -1);
+	if (i < 0) {
+		// not in the scene yet (or any more)
+		connectorItems.append(connectorItem);
+		ConnectorItem::collectEqualPotential(connectorItems, crossLayers, skipFlags);
+		return connectorItems;
+	}
+
+	// callers expect the seed to come first
+	connectorItems = p.nets.value(findRoot(p.parents, i));
+	connectorItems.removeOne(connectorItem);
+	connectorItems.prepend(connectorItem);
+	return connectorItems;
+}
+
+const QMap<int, QList<ConnectorItem *> > & ConnectivityIndex::nets(bool crossLayers, ViewGeometry::WireFlags skipFlags)
+{
+	return partition(crossLayers, skipFlags).nets;
+}
+
+int ConnectivityIndex::netRoot(ConnectorItem * connectorItem, bool crossLayers, ViewGeometry::WireFlags skipFlags)
+{
+	Partition & p = partition(crossLayers, skipFlags);
+	int i = p.ids.value(connectorItem, -1);
+	if (i < 0) return -1;
+
+	return findRoot(p.parents, i);
+}
+
+quint64 ConnectivityIndex::netSerial(int root, bool crossLayers, ViewGeometry::WireFlags skipFlags)
+{
+	return partition(crossLayers, skipFlags).serials.value(root, 0);
+}
+
+const QList<ConnectorItem *> & ConnectivityIndex::skippedConnectors(bool crossLayers, ViewGeometry::WireFlags skipFlags)
+{
+	return partition(crossLayers, skipFlags).skipped;
+}
+
+ConnectivityIndex::Partition & ConnectivityIndex::partition(bool crossLayers, ViewGeometry::WireFlags skipFlags)
+{
+	int key = (((int) skipFlags) << 1) | (crossLayers ? 1 : 0);
+	Partition & p = m_partitions[key];
+	if (!p.valid) {
+		p.crossLayers = crossLayers;
+		p.skipFlags = skipFlags;
+		build(p);
+	}
+	return p;
+}
+
+void ConnectivityIndex::build(Partition & p)
+{
+	// the nets as they were before, so a net that comes out the same keeps its serial
+	QHash<ConnectorItem *, int> oldIds;
+	oldIds.swap(p.ids);
+	QVector<int> oldParents;
+	oldParents.swap(p.parents);
+	QMap<int, QList<ConnectorItem *> > oldNets;
+	oldNets.swap(p.nets);
+	QHash<int, quint64> oldSerials;
+	oldSerials.swap(p.serials);
+	QSet<ConnectorItem *> touched;
+	touched.swap(p.touched);
+
+	p.connectorItems.clear();
+	p.skipped.clear();
+	p.valid = true;
+	if (m_scene == nullptr) return;
+
+	foreach (ConnectorItem * connectorItem, m_scene->connectorItems()) {
+		if (skipped(connectorItem, p.skipFlags)) {
+			p.skipped.append(connectorItem);
+			continue;
+		}
+
+		add(p, connectorItem);
+	}
+
+	for (int i = 0; i < p.connectorItems.count(); i++) link(p, i);
+
+	for (QMap<int, QList<ConnectorItem *> >::const_iterator it = p.nets.constBegin(); it != p.nets.constEnd(); ++it) {
+		const QList<ConnectorItem *> & net = it.value();
+		int oldRoot = -1;
+		int j = oldIds.value(net.first(), -1);
+		if (j >= 0) oldRoot = findRoot(oldParents, j);
+
+		bool same = (oldRoot >= 0) && (oldNets.value(oldRoot).count() == net.count());
+		foreach (ConnectorItem * connectorItem, net) {
+			if (!same) break;
+
+			j = oldIds.value(connectorItem, -1);
+			same = !touched.contains(connectorItem) && (j >= 0) && (findRoot(oldParents, j) == oldRoot);
+		}
+
+		p.serials.insert(it.key(), same ? oldSerials.value(oldRoot) : m_nextSerial++);
+	}
+}
+
+int ConnectivityIndex::add(Partition & p, ConnectorItem * connectorItem)
+{
+	int i = p.connectorItems.count();
+	p.ids.insert(connectorItem, i);
+	p.connectorItems.append(connectorItem);
+	p.parents.append(i);
+	p.nets.insert(i, QList<ConnectorItem *>() << connectorItem);
+	return i;
+}
+
+void ConnectivityIndex::link(Partition & p, int i)
+{
+	// the same links collectEqualPotential follows
+	ConnectorItem * connectorItem = p.connectorItems.at(i);
+	bool fromWire = (connectorItem->attachedToItemType() == ModelPart::Wire);
+	if (p.crossLayers && !fromWire) {
+		int j = p.ids.value(connectorItem->getCrossLayerConnectorItem(), -1);
+		if (j >= 0) unite(p, i, j);
+	}
+
+	foreach (ConnectorItem * cto, connectorItem->connectedToItems()) {
+		int j = p.ids.value(cto, -1);
+		if (j < 0) continue;
+
+		if ((p.skipFlags & ViewGeometry::NormalFlag) && !fromWire && (cto->attachedToItemType() != ModelPart::Wire)) {
+			// direct (part-to-part) connections not allowed
+			continue;
+		}
+
+		unite(p, i, j);
+	}
+
+	Bus * bus = connectorItem->bus();
+	if (bus) {
+		QList<ConnectorItem *> busConnectedItems;
+		connectorItem->attachedTo()->busConnectorItems(bus, connectorItem, busConnectedItems);
+		foreach (ConnectorItem * busConnectedItem, busConnectedItems) {
+			int j = p.ids.value(busConnectedItem, -1);
+			if (j >= 0) unite(p, i, j);
+		}
+	}
+}
+
+int ConnectivityIndex::findRoot(QVector<int> & parents, int i) {
+	while (parents.at(i) != i) {
+		parents[i] = parents.at(parents.at(i));         // path halving
+		i = parents.at(i);
+	}
+	return i;
+}
+
+int ConnectivityIndex::unite(Partition & p, int i, int j) {
+	i = findRoot(p.parents, i);
+	j = findRoot(p.parents, j);
+	if (i == j) return i;
+
+	// union by size, so the smaller net is the one that gets copied
+	if (p.nets.value(i).count() < p.nets.value(j).count()) qSwap(i, j);
+	p.parents[j] = i;
+	QList<ConnectorItem *> absorbed = p.nets.take(j);
+	p.nets[i].append(absorbed);
+	p.serials.remove(j);
+	return i;
+}
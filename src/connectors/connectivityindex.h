@@ -0,0 +1,101 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+
+#ifndef CONNECTIVITYINDEX_H
+#define CONNECTIVITYINDEX_H
+
+#include <QList>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QVector>
+#include <QPointer>
+#include "../viewgeometry.h"
+
+class ConnectorItem;
+class ItemBase;
+class FGraphicsScene;
+
+// disjoint-set index of the nets in one view; it gives the same answer as ConnectorItem::collectEqualPotential,
+// but after one linear pass over the scene every net query is a hash lookup.
+// Connecting two connectors (or adding an item) unites their sets in place; disconnecting, removing a
+// connector that is on a net, or changing what a connector is, drops that view's partitions,
+// which are rebuilt on the next query.
+// Each net carries a serial that changes whenever the net or a connection on it changes,
+// so callers can cache per-net results under it.
+class ConnectivityIndex
+{
+public:
+	ConnectivityIndex();
+	~ConnectivityIndex();
+
+	void setScene(FGraphicsScene *);
+	QList<ConnectorItem *> equalPotential(ConnectorItem *, bool crossLayers, ViewGeometry::WireFlags skipFlags);
+	const QMap<int, QList<ConnectorItem *> > & nets(bool crossLayers, ViewGeometry::WireFlags skipFlags);
+	int netRoot(ConnectorItem *, bool crossLayers, ViewGeometry::WireFlags skipFlags);
+	quint64 netSerial(int root, bool crossLayers, ViewGeometry::WireFlags skipFlags);
+	const QList<ConnectorItem *> & skippedConnectors(bool crossLayers, ViewGeometry::WireFlags skipFlags);
+
+	void itemAdded(ItemBase *);
+	void itemRemoved(ItemBase *);
+	void invalidate();
+
+	static void connected(ConnectorItem *, ConnectorItem *);
+	static void disconnected(ConnectorItem *, ConnectorItem *);
+	static void removed(ConnectorItem *);
+	static void changed(ConnectorItem *);
+	static void netChanged(ConnectorItem *);
+	static bool skipped(ConnectorItem *, ViewGeometry::WireFlags skipFlags);
+
+protected:
+	struct Partition {
+		Partition() : valid(false), crossLayers(false), skipFlags(ViewGeometry::NoFlag) {}
+
+		bool valid;
+		bool crossLayers;
+		ViewGeometry::WireFlags skipFlags;
+		QHash<ConnectorItem *, int> ids;                // connector => element
+		QVector<ConnectorItem *> connectorItems;        // element => connector
+		QVector<int> parents;
+		QMap<int, QList<ConnectorItem *> > nets;        // root element => connectors on the net
+		QHash<int, quint64> serials;                    // root element => serial of the net
+		QList<ConnectorItem *> skipped;                 // connectors on wires filtered out by skipFlags
+		QSet<ConnectorItem *> touched;                  // connectors whose nets changed since the partition was dropped
+	};
+
+	Partition & partition(bool crossLayers, ViewGeometry::WireFlags skipFlags);
+	void build(Partition &);
+	int add(Partition &, ConnectorItem *);
+	void link(Partition &, int);
+	void drop(Partition &, ConnectorItem *);
+	void touch(ConnectorItem *);
+
+	static ConnectivityIndex * indexOf(ConnectorItem *);
+	static int findRoot(QVector<int> & parents, int);
+	static int unite(Partition &, int, int);
+
+protected:
+	QPointer<FGraphicsScene> m_scene;
+	QHash<int, Partition> m_partitions;
+	quint64 m_nextSerial;
+};
+
+#endif
@@ -21,6 +21,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "connector.h"
 #include "connectorshared.h"
 #include "connectoritem.h"
+#include "connectivityindex.h"
 #include "../debugdialog.h"
 #include "../model/modelpart.h"
 #include "bus.h"
@@ -170,8 +171,11 @@ ConnectorItem * Connector::connectorItemByViewLayerID(ViewLayer::ViewID viewID,
 }
 
 ConnectorItem * Connector::connectorItem(ViewLayer::ViewID viewID) {
-	foreach (ConnectorItem * connectorItem, m_connectorItems.values()) {
-		if (connectorItem->attachedToViewID() == viewID) return connectorItem;
+	// called for every connector lookup by id, so walk the hash in place rather than copying values()
+	QHash< int, QPointer<ConnectorItem> >::const_iterator it;
+	for (it = m_connectorItems.constBegin(); it != m_connectorItems.constEnd(); ++it) {
+		ConnectorItem * connectorItem = it.value();
+		if (connectorItem && connectorItem->attachedToViewID() == viewID) return connectorItem;
 	}
 
 	return NULL;
@@ -236,6 +240,9 @@ Bus * Connector::bus() {
 
 void Connector::setBus(Bus * bus) {
 	m_bus = bus;
+	foreach (ConnectorItem * connectorItem, viewItems()) {
+		if (connectorItem) ConnectivityIndex::changed(connectorItem);
+	}
 }
 
 void Connector::unprocess(ViewLayer::ViewID viewID, ViewLayer::ViewLayerID viewLayerID) {
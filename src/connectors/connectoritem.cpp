@@ -225,6 +225,7 @@ parts editor support
 #include "../utils/bezierdisplay.h"
 #include "../utils/cursormaster.h"
 #include "ercdata.h"
+#include "connectivityindex.h"
 
 /////////////////////////////////////////////////////////
 
@@ -317,6 +318,7 @@ ConnectorItem::ConnectorItem( Connector * connector, ItemBase * attachedTo )
 	if (connector) {
 		connector->addViewItem(this);
 	}
+	ConnectivityIndex::changed(this);
 	setAcceptHoverEvents(true);
 	this->setCursor((attachedTo && attachedTo->itemType() == ModelPart::Wire) ? *CursorMaster::BendpointCursor : *CursorMaster::MakeWireCursor);
 
@@ -326,6 +328,7 @@ ConnectorItem::ConnectorItem( Connector * connector, ItemBase * attachedTo )
 }
 
 ConnectorItem::~ConnectorItem() {
+	ConnectivityIndex::removed(this);
 	m_equalPotentialDisplayItems.removeOne(this);
 	//DebugDialog::debug(QString("deleting connectorItem %1").arg((long) this, 0, 16));
 	foreach (ConnectorItem * connectorItem, m_connectedTo) {
@@ -456,6 +459,7 @@ void ConnectorItem::connectTo(ConnectorItem * connected) {
 	if (m_connectedTo.contains(connected)) return;
 
 	m_connectedTo.append(connected);
+	ConnectivityIndex::connected(this, connected);
 	//DebugDialog::debug(QString("connect to cc:%4 this:%1 to:%2 %3").arg((long) this, 0, 16).arg((long) connected, 0, 16).arg(connected->attachedTo()->modelPartShared()->title()).arg(m_connectedTo.count()) );
 	QList<ConnectorItem *> visited;
 	restoreColor(visited);
@@ -470,6 +474,7 @@ ConnectorItem * ConnectorItem::removeConnection(ItemBase * itemBase) {
 		if (m_connectedTo[i]->attachedTo() == itemBase) {
 			ConnectorItem * removed = m_connectedTo[i];
 			m_connectedTo.removeAt(i);
+			ConnectivityIndex::disconnected(this, removed);
 			if (m_attachedTo) {
 				m_attachedTo->connectionChange(this, removed, false);
 			}
@@ -489,6 +494,7 @@ void ConnectorItem::removeConnection(ConnectorItem * connectedItem, bool emitCha
 	if (!connectedItem) return;
 
 	m_connectedTo.removeOne(connectedItem);
+	ConnectivityIndex::disconnected(this, connectedItem);
 	QList<ConnectorItem *> visited;
 	restoreColor(visited);
 	if (emitChange) {
@@ -498,6 +504,7 @@ void ConnectorItem::removeConnection(ConnectorItem * connectedItem, bool emitCha
 
 void ConnectorItem::tempConnectTo(ConnectorItem * item, bool applyColor) {
 	if (!m_connectedTo.contains(item)) m_connectedTo.append(item);
+	ConnectivityIndex::connected(this, item);
 
 	if(applyColor) {
 		QList<ConnectorItem *> visited;
@@ -507,6 +514,7 @@ void ConnectorItem::tempConnectTo(ConnectorItem * item, bool applyColor) {
 
 void ConnectorItem::tempRemove(ConnectorItem * item, bool applyColor) {
 	m_connectedTo.removeOne(item);
+	ConnectivityIndex::disconnected(this, item);
 
 	if(applyColor) {
 		QList<ConnectorItem *> visited;
@@ -1319,6 +1327,7 @@ void ConnectorItem::collectEqualPotential(QList<ConnectorItem *> &connectorItems
 {
 	// take a local (temporary working) copy of the supplied list, and wipe the original
 	QList<ConnectorItem *> tempItems = connectorItems;
+	QSet<ConnectorItem *> queued = QSet<ConnectorItem *>::fromList(tempItems);
 	connectorItems.clear();
 
 	for (int i = 0; i < tempItems.count(); i++) {
@@ -1336,7 +1345,8 @@ void ConnectorItem::collectEqualPotential(QList<ConnectorItem *> &connectorItems
 			if (crossLayers) {
 				ConnectorItem *crossConnectorItem = connectorItem->getCrossLayerConnectorItem();
 				if (crossConnectorItem) {
-					if (!tempItems.contains(crossConnectorItem)) {
+					if (!queued.contains(crossConnectorItem)) {
+						queued.insert(crossConnectorItem);
 						tempItems.append(crossConnectorItem);
 					}
 				}
@@ -1347,7 +1357,7 @@ void ConnectorItem::collectEqualPotential(QList<ConnectorItem *> &connectorItems
 		connectorItems.append(connectorItem);
 
 		foreach (ConnectorItem *cto, connectorItem->connectedToItems()) {
-			if (tempItems.contains(cto)) {
+			if (queued.contains(cto)) {
 				continue;
 			}
 
@@ -1359,6 +1369,7 @@ void ConnectorItem::collectEqualPotential(QList<ConnectorItem *> &connectorItems
 			}
 
 			// add `approved` connected items to the list being processed
+			queued.insert(cto);
 			tempItems.append(cto);
 		} // end foreach (ConnectorItem *cto, connectorItem->connectedToItems())
 
@@ -1376,7 +1387,8 @@ void ConnectorItem::collectEqualPotential(QList<ConnectorItem *> &connectorItems
 			}
 #endif
 			foreach (ConnectorItem *busConnectedItem, busConnectedItems) {
-				if (!tempItems.contains(busConnectedItem)) {
+				if (!queued.contains(busConnectedItem)) {
+					queued.insert(busConnectedItem);
 					tempItems.append(busConnectedItem);
 				}
 			}
@@ -1538,6 +1550,7 @@ void ConnectorItem::updateTooltip() {
 
 void ConnectorItem::clearConnector() {
 	m_connector = nullptr;
+	ConnectivityIndex::changed(this);
 }
 
 
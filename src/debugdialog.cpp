@@ -29,9 +29,12 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDir>
 #include <QtDebug>
 #include <QIcon>
+#include <QMutex>
+#include <QMutexLocker>
 
 DebugDialog* DebugDialog::singleton = NULL;
 QFile DebugDialog::m_file;
+static QMutex FileMutex;            // debug() is also called from worker threads
 
 #ifdef QT_NO_DEBUG
 bool DebugDialog::m_enabled = false;
@@ -144,12 +147,14 @@ void DebugDialog::debug(QString message, DebugLevel debugLevel, QObject * ancest
 
 	qDebug() << message;
 
+	FileMutex.lock();
 	if (m_file.open(QIODevice::Append | QIODevice::Text)) {
 		QTextStream out(&m_file);
 		out.setCodec("UTF-8");
 		out << message << "\n";
 		m_file.close();
 	}
+	FileMutex.unlock();
 	DebugEvent* de = new DebugEvent(message, debugLevel, ancestor);
 	QCoreApplication::postEvent(singleton, de);
 }
@@ -19,6 +19,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 ********************************************************************/
 
 #include "fapplication.h"
+#include "fjobserver.h"
 #include "debugdialog.h"
 #include "utils/misc.h"
 #include "mainwindow/mainwindow.h"
@@ -57,6 +58,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "dialogs/recoverydialog.h"
 #include "processeventblocker.h"
 #include "autoroute/panelizer.h"
+#include "autoroute/drc.h"
+#include "utils/graphutils.h"
 #include "sketch/sketchwidget.h"
 #include "sketch/pcbsketchwidget.h"
 #include "help/firsttimehelpdialog.h"
@@ -83,6 +86,13 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QMultiHash>
 #include <QTemporaryFile>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QLineF>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <time.h>
 
 #ifdef LINUX_32
@@ -127,162 +137,6 @@ void FServer::incomingConnection(qintptr socketDescriptor)
 
 ////////////////////////////////////////////////////
 
-QMutex FServerThread::m_busy;
-
-FServerThread::FServerThread(qintptr socketDescriptor, QObject *parent) : QThread(parent), m_socketDescriptor(socketDescriptor)
-{
-}
-
-void FServerThread::run()
-{
-	QTcpSocket * socket = new QTcpSocket();
-	if (!socket->setSocketDescriptor(m_socketDescriptor)) {
-		emit error(socket->error());
-		DebugDialog::debug(QString("Socket error %1 %2").arg(socket->error()).arg(socket->errorString()));
-		socket->deleteLater();
-		return;
-	}
-
-	socket->waitForReadyRead();
-	QString header;
-	while (socket->canReadLine()) {
-		header += socket->readLine();
-	}
-
-	DebugDialog::debug("header " + header);
-
-	QStringList tokens = header.split(QRegExp("[ \r\n][ \r\n]*"), Qt::SplitBehaviorFlags::SkipEmptyParts);
-	if (tokens.count() <= 0) {
-		writeResponse(socket, 400, "Bad Request", "", "");
-		return;
-	}
-
-	if (tokens[0] != "GET") {
-		writeResponse(socket, 405, "Method Not Allowed", "", "");
-		return;
-	}
-
-	if (tokens.count() < 2) {
-		writeResponse(socket, 400, "Bad Request", "", "");
-		return;
-	}
-
-	QStringList params = tokens.at(1).split("/", Qt::SplitBehaviorFlags::SkipEmptyParts);
-	QString command = params.takeFirst();
-	if (params.count() == 0) {
-		writeResponse(socket, 400, "Bad Request", "", "");
-		return;
-	}
-
-	QString subFolder = params.join("/");
-	bool fixSubFolder = false;
-	QString mimeType;
-	if (command == "svg") {
-		mimeType = "image/svg+xml";
-	}
-	else if (command == "gerber") {
-	}
-	else if (command == "svg-tcp") {
-		fixSubFolder = true;
-	}
-	else if (command == "gerber-tcp") {
-		fixSubFolder = true;
-	}
-	else {
-		writeResponse(socket, 400, "Bad Request", "", "");
-		return;
-	}
-
-	if (fixSubFolder) {
-		// replace "/" that was removed from "http:/blah" above
-		int ix = subFolder.indexOf(":/");
-		if (ix >= 0) {
-			subFolder.insert(ix + 1, "/");
-		}
-	}
-
-	int waitInterval = 100;     // 100ms to wait
-	int timeoutSeconds = 2 * 60;    // timeout after 2 minutes
-	int attempts = timeoutSeconds * 1000 / waitInterval;  // timeout a
-	bool gotLock = false;
-	for (int i = 0; i < attempts; i++) {
-		if (m_busy.tryLock()) {
-			gotLock = true;
-			break;
-		}
-	}
-
-	if (!gotLock) {
-		writeResponse(socket, 503, "Service Unavailable", "", "Server busy.");
-		return;
-	}
-
-	DebugDialog::debug(QString("emitting do command %1 %2").arg(command).arg(subFolder));
-	QString result;
-	int status;
-	emit doCommand(command, subFolder, result, status);
-
-	m_busy.unlock();
-
-	if (status != 200) {
-		writeResponse(socket, status, "failed", "", result);
-	}
-	else if (command.endsWith("tcp")) {
-		QString filename = result;
-		mimeType = "application/zip";
-		QFile file(filename);
-		if (file.open(QFile::ReadOnly)) {
-			QString response = QString("HTTP/1.0 %1 %2\r\n").arg(200).arg("ok");
-			response += QString("Content-Type: %1; charset=\"utf-8\"\r\n").arg(mimeType);
-			response += QString("Content-Length: %1\r\n").arg(file.size());
-			response += QString("\r\n");
-			socket->write(response.toUtf8());
-			int buffersize = 8192;
-			long remaining = file.size();
-			while (remaining >= buffersize) {
-				QByteArray bytes = file.read(buffersize);
-				socket->write(bytes);
-				remaining -= buffersize;
-			}
-			if (remaining > 0) {
-				QByteArray bytes = file.read(remaining);
-				socket->write(bytes);
-			}
-			socket->disconnectFromHost();
-			socket->waitForDisconnected();
-			socket->deleteLater();
-			file.close();
-		}
-		else {
-			writeResponse(socket, 500, "failed", "", "local zip failure (2)");
-		}
-
-		QFileInfo info(filename);
-		QDir dir = info.dir();
-		FolderUtils::rmdir(dir);
-	}
-	else {
-		writeResponse(socket, 200, "Ok", mimeType, result);
-	}
-}
-
-void FServerThread::writeResponse(QTcpSocket * socket, int code, const QString & codeString, const QString & mimeType, const QString & message)
-{
-	QString type = mimeType;
-	if (type.isEmpty()) type = "text/plain";
-	QString response = QString("HTTP/1.0 %1 %2\r\n").arg(code).arg(codeString);
-	response += QString("Content-Type: %1; charset=\"utf-8\"\r\n").arg(type);
-	response += QString("Content-Length: %1\r\n").arg(message.count());
-	response += QString("\r\n%1").arg(message);
-
-	socket->write(response.toUtf8());
-	socket->disconnectFromHost();
-	socket->waitForDisconnected();
-	socket->deleteLater();
-}
-
-////////////////////////////////////////////////////
-
 RegenerateDatabaseThread::RegenerateDatabaseThread(const QString & dbFileName, QDialog * progressDialog, ReferenceModel * referenceModel) {
 	m_dbFileName = dbFileName;
 	m_referenceModel = referenceModel;
@@ -374,6 +228,26 @@ int FApplication::init() {
 			toRemove << i;
 		}
 
+		if ((m_arguments[i].compare("-ratsnestbench", Qt::CaseInsensitive) == 0) ||
+		        (m_arguments[i].compare("--ratsnestbench", Qt::CaseInsensitive) == 0)) {
+			m_serviceType = RatsnestBenchService;
+			m_outputFolder = " ";					// otherwise program will bail out
+			toRemove << i;
+		}
+
+		if ((m_arguments[i].compare("-gerberforce", Qt::CaseInsensitive) == 0) ||
+		        (m_arguments[i].compare("--gerberforce", Qt::CaseInsensitive) == 0)) {
+			m_gerberForce = true;
+			toRemove << i;
+		}
+
+		if (m_arguments[i].compare("-portworker", Qt::CaseInsensitive) == 0) {
+			// internal: a worker process started by the -port service's FJobServer
+			m_serviceType = PortWorkerService;
+			m_outputFolder = " ";					// otherwise program will bail out
+			toRemove << i;
+		}
+
 		if ((m_arguments[i].compare("-d", Qt::CaseInsensitive) == 0) ||
 		        (m_arguments[i].compare("-debug", Qt::CaseInsensitive) == 0)||
 		        (m_arguments[i].compare("--debug", Qt::CaseInsensitive) == 0)) {
@@ -388,6 +262,7 @@ int FApplication::init() {
 		        (m_arguments[i].compare("--folder", Qt::CaseInsensitive) == 0))
 		{
 			FolderUtils::setApplicationPath(m_arguments[i + 1]);
+			m_forwardArguments << m_arguments[i] << m_arguments[i + 1];
 			// delete these so we don't try to process them as files later
 			toRemove << i << i + 1;
 		}
@@ -399,6 +274,7 @@ int FApplication::init() {
 		        (m_arguments[i].compare("--partsparent", Qt::CaseInsensitive) == 0))
 		{
 			FolderUtils::setAppPartsPath(m_arguments[i + 1]);
+			m_forwardArguments << m_arguments[i] << m_arguments[i + 1];
 			// delete these so we don't try to process them as files later
 			toRemove << i << i + 1;
 		}
@@ -413,6 +289,7 @@ int FApplication::init() {
 		   )
 		{
 			PaletteModel::setFzpOverrideFolder(m_arguments[i + 1]);
+			m_forwardArguments << m_arguments[i] << m_arguments[i + 1];
 			// delete these so we don't try to process them as files later
 			toRemove << i << i + 1;
 		}
@@ -424,12 +301,49 @@ int FApplication::init() {
 			toRemove << i << i + 1;
 		}
 
-		//if ((m_arguments[i].compare("-drc", Qt::CaseInsensitive) == 0) ||
-		//	(m_arguments[i].compare("--drc", Qt::CaseInsensitive) == 0)) {
-		//	m_serviceType = DRCService;
-		//	m_outputFolder = m_arguments[i + 1];
-		//	toRemove << i << i + 1;
-		//}
+		if ((m_arguments[i].compare("-drc", Qt::CaseInsensitive) == 0) ||
+		        (m_arguments[i].compare("--drc", Qt::CaseInsensitive) == 0)) {
+			m_serviceType = DRCService;
+			m_outputFolder = m_arguments[i + 1];
+			toRemove << i << i + 1;
+		}
+
+		if ((m_arguments[i].compare("-drckeepout", Qt::CaseInsensitive) == 0) ||
+		        (m_arguments[i].compare("--drckeepout", Qt::CaseInsensitive) == 0)) {
+			m_drcKeepoutMils = m_arguments[i + 1].toDouble();
+			toRemove << i << i + 1;
+		}
+
+		if ((m_arguments[i].compare("-drcjobs", Qt::CaseInsensitive) == 0) ||
+		        (m_arguments[i].compare("--drcjobs", Qt::CaseInsensitive) == 0)) {
+			m_drcJobs = m_arguments[i + 1].toInt();
+			toRemove << i << i + 1;
+		}
+
+		if ((m_arguments[i].compare("-workertimeout", Qt::CaseInsensitive) == 0) ||
+		        (m_arguments[i].compare("--workertimeout", Qt::CaseInsensitive) == 0)) {
+			m_workerTimeoutSeconds = m_arguments[i + 1].toInt();
+			toRemove << i << i + 1;
+		}
+
+		if ((m_arguments[i].compare("-drcreport", Qt::CaseInsensitive) == 0) ||
+		        (m_arguments[i].compare("--drcreport", Qt::CaseInsensitive) == 0)) {
+			m_drcReport = m_arguments[i + 1];
+			toRemove << i << i + 1;
+		}
+
+		if (m_arguments[i].compare("-drcfile", Qt::CaseInsensitive) == 0) {
+			// internal: a single sketch, handed to a worker process by runServiceWorkers
+			m_drcFile = m_arguments[i + 1];
+			toRemove << i << i + 1;
+		}
+
+		if (m_arguments[i].compare("-autoroutebench", Qt::CaseInsensitive) == 0 ||
+		        m_arguments[i].compare("--autoroutebench", Qt::CaseInsensitive) == 0) {
+			m_serviceType = AutorouteBenchService;
+			m_outputFolder = m_arguments[i + 1];
+			toRemove << i << i + 1;
+		}
 
 		if ((m_arguments[i].compare("-db", Qt::CaseInsensitive) == 0) ||
 		        (m_arguments[i].compare("-database", Qt::CaseInsensitive) == 0) ||
@@ -483,7 +397,17 @@ int FApplication::init() {
 			m_outputFolder = m_arguments[i + 1];
 		}
 
+		if ((m_arguments[i].compare("-portjobs", Qt::CaseInsensitive) == 0) ||
+		        (m_arguments[i].compare("--portjobs", Qt::CaseInsensitive) == 0)) {
+			m_portJobs = m_arguments[i + 1].toInt();
+			toRemove << i << i + 1;
+		}
 
+		if ((m_arguments[i].compare("-porttimeout", Qt::CaseInsensitive) == 0) ||
+		        (m_arguments[i].compare("--porttimeout", Qt::CaseInsensitive) == 0)) {
+			m_portTimeoutSeconds = m_arguments[i + 1].toInt();
+			toRemove << i << i + 1;
+		}
 
 		if ((m_arguments[i].compare("-g", Qt::CaseInsensitive) == 0) ||
 		        (m_arguments[i].compare("-gerber", Qt::CaseInsensitive) == 0)||
@@ -494,6 +418,24 @@ int FApplication::init() {
 			toRemove << i << i + 1;
 		}
 
+		if ((m_arguments[i].compare("-gerberjobs", Qt::CaseInsensitive) == 0) ||
+		        (m_arguments[i].compare("--gerberjobs", Qt::CaseInsensitive) == 0)) {
+			m_gerberJobs = m_arguments[i + 1].toInt();
+			toRemove << i << i + 1;
+		}
+
+		if ((m_arguments[i].compare("-gerberreport", Qt::CaseInsensitive) == 0) ||
+		        (m_arguments[i].compare("--gerberreport", Qt::CaseInsensitive) == 0)) {
+			m_gerberReport = m_arguments[i + 1];
+			toRemove << i << i + 1;
+		}
+
+		if (m_arguments[i].compare("-gerberfile", Qt::CaseInsensitive) == 0) {
+			// internal: a single sketch, handed to a worker process by runServiceWorkers
+			m_gerberFile = m_arguments[i + 1];
+			toRemove << i << i + 1;
+		}
+
 		if ((m_arguments[i].compare("-p", Qt::CaseInsensitive) == 0) ||
 		        (m_arguments[i].compare("-panel", Qt::CaseInsensitive) == 0)||
 		        (m_arguments[i].compare("--panel", Qt::CaseInsensitive) == 0)) {
@@ -833,6 +775,10 @@ int FApplication::serviceStartup() {
 		}
 		return 1;
 
+	case PortWorkerService:
+		runPortWorkerService();
+		return 0;
+
 	case GedaService:
 		runGedaService();
 		return 0;
@@ -841,6 +787,14 @@ int FApplication::serviceStartup() {
 		runDRCService();
 		return 0;
 
+	case AutorouteBenchService:
+		runAutorouteBenchService();
+		return 0;
+
+	case RatsnestBenchService:
+		runRatsnestBenchService();
+		return 0;
+
 	case DatabaseService:
 		runDatabaseService();
 		return 0;
@@ -879,10 +833,204 @@ int FApplication::serviceStartup() {
 	}
 }
 
+static bool writeJson(const QString & path, const QJsonObject & object) {
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly)) return false;
+
+	file.write(QJsonDocument(object).toJson());
+	file.close();
+	return true;
+}
+
+static QJsonObject readJson(const QString & path) {
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly)) return QJsonObject();
+
+	return QJsonDocument::fromJson(file.readAll()).object();
+}
+
 void FApplication::runGerberService()
 {
-	initService();
-	runGerberServiceAux();
+	// export every sketch in the folder, skipping sketches unchanged since the last run, and write a json summary;
+	// set QT_QPA_PLATFORM=offscreen when there is no display
+	m_started = true;
+
+	if (!m_gerberFile.isEmpty()) {
+		// a worker process started by runServiceWorkers
+		initService();
+		writeJson(m_gerberReport, runGerberOne(m_gerberFile));
+		return;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	QDir dir(m_outputFolder);
+	QString reportPath = m_gerberReport.isEmpty() ? dir.absoluteFilePath("gerber.json") : m_gerberReport;
+
+	// the previous summary doubles as the manifest: a sketch is skipped if its content hash is unchanged,
+	// it exported cleanly last time, its outputs are all still there, and this is the same Fritzing version
+	QHash<QString, QString> previousHashes;
+	QHash<QString, QJsonObject> previousResults;
+	QJsonObject previous = readJson(reportPath);
+	if (!m_gerberForce && previous.value("version").toString() == Version::versionString()) {
+		foreach (QJsonValue value, previous.value("files").toArray()) {
+			QJsonObject result = value.toObject();
+			if (result.contains("error")) continue;
+
+			bool intact = true;
+			foreach (QJsonValue output, result.value("outputs").toArray()) {
+				if (!dir.exists(output.toString())) {
+					intact = false;
+					break;
+				}
+			}
+			if (!intact) continue;
+
+			previousHashes.insert(result.value("file").toString(), result.value("sha1").toString());
+			previousResults.insert(result.value("file").toString(), result);
+		}
+	}
+
+	QStringList filters;
+	filters << "*" + FritzingBundleExtension;
+	QStringList filepaths;
+	QStringList todo;
+	QHash<QString, QString> hashes;
+	foreach (QString filename, dir.entryList(filters, QDir::Files)) {
+		QString filepath = dir.absoluteFilePath(filename);
+		filepaths << filepath;
+
+		QFile file(filepath);
+		if (file.open(QIODevice::ReadOnly)) {
+			QCryptographicHash hash(QCryptographicHash::Sha1);
+			hash.addData(&file);
+			hashes.insert(filepath, QString(hash.result().toHex()));
+		}
+
+		if (!hashes.value(filepath).isEmpty() && previousHashes.value(filename) == hashes.value(filepath)) continue;
+
+		todo << filepath;
+	}
+
+	QJsonArray exported;
+	int jobs = m_gerberJobs > 0 ? m_gerberJobs : QThread::idealThreadCount();
+	if (jobs > 1 && todo.count() > 1) {
+		QStringList serviceArgs;
+		serviceArgs << "-gerber" << m_outputFolder;
+		runServiceWorkers(todo, serviceArgs, "-gerberfile", "-gerberreport", jobs, exported);
+	}
+	else if (todo.count() > 0) {
+		initService();
+		foreach (QString filepath, todo) {
+			exported.append(runGerberOne(filepath));
+		}
+	}
+
+	QHash<QString, QJsonObject> exportedResults;
+	foreach (QJsonValue value, exported) {
+		QJsonObject result = value.toObject();
+		exportedResults.insert(result.value("file").toString(), result);
+	}
+
+	QJsonArray results;
+	int skippedCount = 0;
+	int errorCount = 0;
+	foreach (QString filepath, filepaths) {
+		QString filename = QFileInfo(filepath).fileName();
+		QJsonObject result;
+		if (exportedResults.contains(filename)) {
+			result = exportedResults.value(filename);
+			result.insert("sha1", hashes.value(filepath));
+		}
+		else {
+			result = previousResults.value(filename);
+			result.insert("skipped", true);
+			skippedCount++;
+		}
+		if (result.contains("error")) errorCount++;
+		results.append(result);
+	}
+
+	QJsonObject report;
+	report.insert("folder", dir.absolutePath());
+	report.insert("version", Version::versionString());
+	report.insert("files", results);
+	report.insert("skippedCount", skippedCount);
+	report.insert("errorCount", errorCount);
+	report.insert("elapsedMs", (double) timer.elapsed());
+
+	if (!writeJson(reportPath, report)) {
+		DebugDialog::debug(QString("gerber: unable to write report '%1'").arg(reportPath));
+		return;
+	}
+
+	DebugDialog::debug(QString("gerber: %1 sketches, %2 skipped, %3 errors in %4 ms; report in '%5'")
+	                   .arg(filepaths.count()).arg(skippedCount).arg(errorCount).arg(timer.elapsed()).arg(reportPath));
+}
+
+QJsonObject FApplication::runGerberOne(const QString & filepath) {
+	QElapsedTimer timer;
+	timer.start();
+
+	QFileInfo info(filepath);
+	QJsonObject result;
+	result.insert("file", info.fileName());
+
+	try {
+		MainWindow * mainWindow = openWindowForService(false, 3);
+		if (mainWindow == NULL) {
+			result.insert("error", QString("unable to open a window"));
+			return result;
+		}
+
+		mainWindow->setCloseSilently(true);
+		FolderUtils::setOpenSaveFolderAux(m_outputFolder);
+		if (!mainWindow->loadWhich(filepath, false, false, false, "")) {
+			DebugDialog::debug(QString("failed to load '%1'").arg(filepath));
+			result.insert("error", QString("failed to load"));
+		}
+		else {
+			result.insert("loadMs", (double) timer.elapsed());
+
+			int boardCount;
+			ItemBase * board = mainWindow->pcbView()->findSelectedBoard(boardCount);
+			if (boardCount == 0) {
+				result.insert("error", QString("board not found"));
+			}
+			else if (board == NULL) {
+				result.insert("error", QString("multiple boards found"));
+			}
+			else {
+				QElapsedTimer exportTimer;
+				exportTimer.start();
+				// the generator only logs its failures, so report what actually got written
+				QStringList outputs;
+				foreach (QString output, GerberGenerator::exportToGerber(info.completeBaseName(), m_outputFolder, board, mainWindow->pcbView(), false)) {
+					outputs << QFileInfo(output).fileName();
+				}
+				result.insert("exportMs", (double) exportTimer.elapsed());
+				result.insert("outputs", QJsonArray::fromStringList(outputs));
+				if (outputs.isEmpty()) {
+					result.insert("error", QString("no gerber files written"));
+				}
+			}
+		}
+
+		mainWindow->close();
+		delete mainWindow;
+	}
+	catch (const QString & msg) {
+		DebugDialog::debug(msg);
+		result.insert("error", msg);
+	}
+	catch (...) {
+		DebugDialog::debug("who knows");
+		result.insert("error", QString("unknown error"));
+	}
+
+	result.insert("elapsedMs", (double) timer.elapsed());
+	return result;
 }
 
 void FApplication::runGerberServiceAux()
@@ -921,6 +1069,51 @@ void FApplication::runSvgService()
 	runSvgServiceAux();
 }
 
+void FApplication::runPortWorkerService()
+{
+	// a worker process started by FJobServer: each line on stdin is a conversion and a folder;
+	// the parts database is loaded once, and each result is reported on stdout
+	initService();
+
+	QFile input;
+	QFile output;
+	if (!input.open(stdin, QIODevice::ReadOnly) || !output.open(stdout, QIODevice::WriteOnly)) {
+		DebugDialog::debug("port worker: unable to open stdin or stdout");
+		return;
+	}
+
+	while (true) {
+		QByteArray line = input.readLine();
+		if (line.isEmpty()) break;			// the server closed the pipe
+
+		QStringList job = QString::fromUtf8(line).trimmed().split('\t');
+		int status = 400;
+		if (job.count() == 2) {
+			m_outputFolder = job.at(1);
+			try {
+				if (job.at(0) == "svg") {
+					runSvgServiceAux();
+					status = 200;
+				}
+				else if (job.at(0) == "gerber") {
+					runGerberServiceAux();
+					status = 200;
+				}
+			}
+			catch (...) {
+				DebugDialog::debug(QString("port worker: %1 failed for '%2'").arg(job.at(0)).arg(job.at(1)));
+				status = 500;
+			}
+		}
+
+		// windows closed by the conversion are deleted later, and there is no event loop here
+		QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+
+		output.write(QString("%1 %2\n").arg(FJobServer::WorkerDone).arg(status).toUtf8());
+		output.flush();
+	}
+}
+
 void FApplication::runSvgServiceAux()
 {
 	QDir dir(m_outputFolder);
@@ -987,57 +1180,330 @@ void FApplication::runGedaService() {
 
 
 void FApplication::runDRCService() {
+	// design rule check every sketch in the folder without any dialogs and write a json report;
+	// set QT_QPA_PLATFORM=offscreen when there is no display
 	m_started = true;
-	initService();
 	DebugDialog::setEnabled(true);
 
-	try {
-		QDir dir(m_outputFolder);
-		QStringList filters;
-		filters << "*.fzz";
-		QStringList filenames = dir.entryList(filters, QDir::Files);
-		foreach (QString filename, filenames) {
-			QString filepath = dir.absoluteFilePath(filename);
-			MainWindow * mainWindow = openWindowForService(false, 3);
-			if (mainWindow == NULL) continue;
+	if (!m_drcFile.isEmpty()) {
+		// a worker process started by runServiceWorkers
+		initService();
+		writeJson(m_drcReport, runDRCOne(m_drcFile));
+		return;
+	}
 
-			mainWindow->setCloseSilently(true);
+	QElapsedTimer timer;
+	timer.start();
 
-			if (!mainWindow->loadWhich(filepath, false, false, false, "")) {
-				DebugDialog::debug(QString("failed to load '%1'").arg(filepath));
-				mainWindow->close();
-				delete mainWindow;
-				continue;
-			}
+	QDir dir(m_outputFolder);
+	QStringList filters;
+	filters << "*.fzz";
+	QStringList filepaths;
+	foreach (QString filename, dir.entryList(filters, QDir::Files)) {
+		filepaths << dir.absoluteFilePath(filename);
+	}
 
-			mainWindow->showPCBView();
+	QJsonArray results;
+	int jobs = m_drcJobs > 0 ? m_drcJobs : QThread::idealThreadCount();
+	if (jobs > 1 && filepaths.count() > 1) {
+		QStringList serviceArgs;
+		serviceArgs << "-drc" << m_outputFolder;
+		if (m_drcKeepoutMils > 0) {
+			serviceArgs << "-drckeepout" << QString::number(m_drcKeepoutMils);
+		}
+		runServiceWorkers(filepaths, serviceArgs, "-drcfile", "-drcreport", jobs, results);
+	}
+	else {
+		initService();
+		foreach (QString filepath, filepaths) {
+			results.append(runDRCOne(filepath));
+		}
+	}
 
-			int moved = mainWindow->pcbView()->checkLoadedTraces();
-			if (moved > 0) {
-				QMessageBox::warning(NULL, QObject::tr("Fritzing"), QObject::tr("%1 wires moved from their saved position in %2.").arg(moved).arg(filepath));
-				DebugDialog::debug(QString("\ncheckloadedtraces %1\n").arg(filepath));
-			}
+	int violationCount = 0;
+	int errorCount = 0;
+	foreach (QJsonValue value, results) {
+		QJsonObject result = value.toObject();
+		violationCount += result.value("violationCount").toInt();
+		if (result.contains("error")) errorCount++;
+	}
 
+	QJsonObject report;
+	report.insert("folder", dir.absolutePath());
+	report.insert("units", QString("mils"));
+	report.insert("files", results);
+	report.insert("violationCount", violationCount);
+	report.insert("errorCount", errorCount);
+	report.insert("elapsedMs", (double) timer.elapsed());
 
-			Panelizer::checkDonuts(mainWindow, true);
-			Panelizer::checkText(mainWindow, true);
+	QString reportPath = m_drcReport.isEmpty() ? dir.absoluteFilePath("drc.json") : m_drcReport;
+	if (!writeJson(reportPath, report)) {
+		DebugDialog::debug(QString("drc: unable to write report '%1'").arg(reportPath));
+		return;
+	}
+
+	DebugDialog::debug(QString("drc: %1 sketches, %2 violations, %3 errors in %4 ms; report in '%5'")
+	                   .arg(filepaths.count()).arg(violationCount).arg(errorCount).arg(timer.elapsed()).arg(reportPath));
+}
+
+void FApplication::runServiceWorkers(const QStringList & filepaths, const QStringList & serviceArgs, const QString & fileOption, const QString & reportOption, int jobs, QJsonArray & results) {
+	// sketches can't be loaded concurrently within one process, so each one is handled by a separate Fritzing process
+	// which writes its json result to reportOption
+	QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+	if (!environment.contains("QT_QPA_PLATFORM")) {
+		environment.insert("QT_QPA_PLATFORM", "offscreen");
+	}
+
+	QTemporaryDir tempDir;
+	QStringList todo = filepaths;
+	QList<QProcess *> running;
+	QHash<QProcess *, QString> runningFiles;
+	QHash<QProcess *, QString> runningReports;
+	QHash<QProcess *, QElapsedTimer> runningTimers;
+	QHash<QString, QJsonObject> done;
+	int index = 0;
+	while (!todo.isEmpty() || !running.isEmpty()) {
+		while (!todo.isEmpty() && running.count() < jobs) {
+			QString filepath = todo.takeFirst();
+			QString reportPath = tempDir.filePath(QString("job%1.json").arg(index++));
+			QStringList args = m_forwardArguments;
+			args << serviceArgs << fileOption << filepath << reportOption << reportPath;
+
+			QProcess * process = new QProcess;
+			process->setProcessEnvironment(environment);
+			process->setProcessChannelMode(QProcess::ForwardedChannels);
+			process->start(QCoreApplication::applicationFilePath(), args);
+			running << process;
+			runningFiles.insert(process, filepath);
+			runningReports.insert(process, reportPath);
+			runningTimers[process].start();
+		}
+
+		for (int i = running.count() - 1; i >= 0; i--) {
+			QProcess * process = running.at(i);
+			bool timedOut = false;
+			if (process->state() != QProcess::NotRunning && !process->waitForFinished(50)) {
+				// a sketch that hangs its worker must not hold up the whole run
+				if (m_workerTimeoutSeconds <= 0 || runningTimers.value(process).elapsed() < m_workerTimeoutSeconds * 1000LL) continue;
+
+				DebugDialog::debug(QString("killing the worker for '%1' after %2 seconds").arg(runningFiles.value(process)).arg(m_workerTimeoutSeconds));
+				process->kill();
+				process->waitForFinished(5000);
+				timedOut = true;
+			}
 
-			QList<ItemBase *> boards = mainWindow->pcbView()->findBoard();
-			foreach (ItemBase * boardItem, boards) {
-				mainWindow->pcbView()->selectAllItems(false, false);
-				boardItem->setSelected(true);
-				mainWindow->newDesignRulesCheck(false);
+			running.removeAt(i);
+			runningTimers.remove(process);
+			QString filepath = runningFiles.take(process);
+			QString reportPath = runningReports.take(process);
+			QJsonObject result;
+			if (timedOut) {
+				result.insert("file", QFileInfo(filepath).fileName());
+				result.insert("error", QString("worker timed out after %1 seconds").arg(m_workerTimeoutSeconds));
+			}
+			else {
+				result = readJson(reportPath);
+				if (result.isEmpty()) {
+					result.insert("file", QFileInfo(filepath).fileName());
+					result.insert("error", QString("worker exited with code %1").arg(process->exitCode()));
+				}
 			}
+			done.insert(filepath, result);
+			delete process;
+		}
+	}
+
+	foreach (QString filepath, filepaths) {
+		results.append(done.value(filepath));
+	}
+}
+
+QJsonObject FApplication::runDRCOne(const QString & filepath) {
+	QElapsedTimer timer;
+	timer.start();
+
+	QJsonObject result;
+	result.insert("file", QFileInfo(filepath).fileName());
+
+	try {
+		MainWindow * mainWindow = openWindowForService(false, 3);
+		if (mainWindow == NULL) {
+			result.insert("error", QString("unable to open a window"));
+			return result;
+		}
 
+		mainWindow->setCloseSilently(true);
+
+		if (!mainWindow->loadWhich(filepath, false, false, false, "")) {
+			DebugDialog::debug(QString("failed to load '%1'").arg(filepath));
+			result.insert("error", QString("failed to load"));
 			mainWindow->close();
 			delete mainWindow;
+			result.insert("elapsedMs", (double) timer.elapsed());
+			return result;
+		}
+
+		mainWindow->showPCBView();
+
+		PCBSketchWidget * pcbView = mainWindow->pcbView();
+		int moved = pcbView->checkLoadedTraces();
+		if (moved > 0) {
+			DebugDialog::debug(QString("%1 wires moved from their saved position in %2").arg(moved).arg(filepath));
+		}
+
+		Panelizer::checkDonuts(mainWindow, false);
+		Panelizer::checkText(mainWindow, false);
+
+		QJsonArray boards;
+		int violationCount = 0;
+		foreach (ItemBase * boardItem, pcbView->findBoard()) {
+			QElapsedTimer boardTimer;
+			boardTimer.start();
+
+			pcbView->selectAllItems(false, false);
+			boardItem->setSelected(true);
+
+			double keepoutMils = m_drcKeepoutMils > 0 ? m_drcKeepoutMils : pcbView->getKeepout() * 1000 / GraphicsUtils::SVGDPI;     // pixels to mils
+			DRC drc(pcbView, boardItem);
+			connect(&drc, SIGNAL(wantTopVisible()), mainWindow, SLOT(activeLayerTop()), Qt::DirectConnection);
+			connect(&drc, SIGNAL(wantBottomVisible()), mainWindow, SLOT(activeLayerBottom()), Qt::DirectConnection);
+			connect(&drc, SIGNAL(wantBothVisible()), mainWindow, SLOT(activeLayerBoth()), Qt::DirectConnection);
+
+			QString message;
+			QList<DRCViolation> violations;
+			bool ok = drc.check(keepoutMils, message, violations);
+
+			QJsonArray violationList;
+			foreach (DRCViolation violation, violations) {
+				QJsonObject object;
+				object.insert("message", violation.message);
+				object.insert("parts", QJsonArray::fromStringList(violation.names));
+				object.insert("x", violation.location.x());
+				object.insert("y", violation.location.y());
+				object.insert("width", violation.location.width());
+				object.insert("height", violation.location.height());
+				violationList.append(object);
+			}
+
+			QJsonObject board;
+			board.insert("board", boardItem->instanceTitle());
+			board.insert("id", QString::number(boardItem->id()));
+			board.insert("keepoutMils", keepoutMils);
+			if (!ok) board.insert("error", message);
+			board.insert("violations", violationList);
+			board.insert("elapsedMs", (double) boardTimer.elapsed());
+			boards.append(board);
+			violationCount += violations.count();
 		}
+
+		result.insert("boards", boards);
+		result.insert("violationCount", violationCount);
+
+		mainWindow->close();
+		delete mainWindow;
 	}
 	catch (const QString & msg) {
 		DebugDialog::debug(msg);
+		result.insert("error", msg);
 	}
 	catch (...) {
 		DebugDialog::debug("who knows");
+		result.insert("error", QString("unknown error"));
+	}
+
+	result.insert("elapsedMs", (double) timer.elapsed());
+	return result;
+}
+
+void FApplication::runAutorouteBenchService() {
+	// autoroute every board of every sketch in the folder and log the timings;
+	// the maze router logs its own grid size and expanded cell count alongside
+	m_started = true;
+	initService();
+	DebugDialog::setEnabled(true);
+
+	QDir dir(m_outputFolder);
+	QStringList filters;
+	filters << "*.fzz";
+	QStringList filenames = dir.entryList(filters, QDir::Files);
+	qint64 totalTime = 0;
+	foreach (QString filename, filenames) {
+		QString filepath = dir.absoluteFilePath(filename);
+		MainWindow * mainWindow = openWindowForService(false, 3);
+		if (mainWindow == NULL) continue;
+
+		mainWindow->setCloseSilently(true);
+
+		if (!mainWindow->loadWhich(filepath, false, false, false, "")) {
+			DebugDialog::debug(QString("failed to load '%1'").arg(filepath));
+			mainWindow->close();
+			delete mainWindow;
+			continue;
+		}
+
+		mainWindow->showPCBView();
+
+		PCBSketchWidget * pcbView = mainWindow->pcbView();
+		QList<ItemBase *> boards = pcbView->findBoard();
+		foreach (ItemBase * boardItem, boards) {
+			pcbView->selectAllItems(false, false);
+			boardItem->setSelected(true);
+
+			QElapsedTimer timer;
+			timer.start();
+			mainWindow->newAutoroute();
+			qint64 elapsed = timer.elapsed();
+			totalTime += elapsed;
+
+			RoutingStatus routingStatus;
+			routingStatus.zero();
+			pcbView->updateRoutingStatus(NULL, routingStatus, true);
+			DebugDialog::debug(QString("autoroute bench %1 board %2: %3 ms, %4 of %5 nets routed, %6 connectors left, %7 jumpers")
+			                   .arg(filename).arg(boardItem->id()).arg(elapsed)
+			                   .arg(routingStatus.m_netRoutedCount).arg(routingStatus.m_netCount)
+			                   .arg(routingStatus.m_connectorsLeftToRoute).arg(routingStatus.m_jumperItemCount));
+		}
+
+		mainWindow->close();
+		delete mainWindow;
+	}
+
+	DebugDialog::debug(QString("autoroute bench: %1 sketches in %2 ms").arg(filenames.count()).arg(totalTime));
+}
+
+void FApplication::runRatsnestBenchService() {
+	// time the grid spanning tree against the complete-graph one on random nets,
+	// with every tenth connector on a bus with its neighbor, and check they agree on length
+	DebugDialog::setEnabled(true);
+
+	QList<int> sizes;
+	sizes << 10 << 30 << 100 << 300 << 1000 << 2000 << 5000;
+	qsrand(1);
+	foreach (int size, sizes) {
+		QList<QPointF> locs;
+		QVector<int> groups(size);
+		for (int i = 0; i < size; i++) {
+			locs << QPointF(qrand() % 10000, qrand() % 10000);
+			groups[i] = (i % 10 == 9) ? groups.at(i - 1) : i;
+		}
+
+		QList<qint64> times;
+		QList<double> lengths;
+		for (int engine = 0; engine < 2; engine++) {
+			QElapsedTimer timer;
+			timer.start();
+			QList< QPair<int, int> > tree = (engine == 0) ? GraphUtils::spanningTree(locs, groups) : GraphUtils::denseSpanningTree(locs, groups);
+			times << timer.nsecsElapsed() / 1000;
+
+			double length = 0;
+			for (int i = 0; i < tree.count(); i++) {
+				length += QLineF(locs.at(tree.at(i).first), locs.at(tree.at(i).second)).length();
+			}
+			lengths << length;
+		}
+
+		DebugDialog::debug(QString("ratsnest bench %1 pins: grid %2 us, complete graph %3 us, lengths %4 %5")
+		                   .arg(size).arg(times.at(0)).arg(times.at(1)).arg(lengths.at(0), 0, 'f', 1).arg(lengths.at(1), 0, 'f', 1));
 	}
 }
 
@@ -1878,6 +2344,13 @@ void FApplication::cleanFzzs() {
 
 void FApplication::initServer() {
 	FMessageBox::BlockMessages = true;
+
+	// conversions run in persistent worker processes, so requests no longer wait on the gui thread or on each other
+	QStringList workerArgs = m_forwardArguments;
+	workerArgs << "-portworker";
+	int jobs = m_portJobs > 0 ? m_portJobs : QThread::idealThreadCount();
+	m_jobServer = new FJobServer(m_portRootFolder, workerArgs, jobs, m_portTimeoutSeconds, this);
+
 	m_fServer = new FServer(this);
 	connect(m_fServer, SIGNAL(newConnection(qintptr)), this, SLOT(newConnection(qintptr)));
 	DebugDialog::debug("Server active");
@@ -1885,124 +2358,11 @@ void FApplication::initServer() {
 }
 
 void FApplication::newConnection(qintptr socketDescription) {
-	FServerThread *thread = new FServerThread(socketDescription, this);
-	connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
-	connect(thread, SIGNAL(doCommand(const QString &, const QString &, QString &, int &)),
-	        this, SLOT(doCommand(const QString &, const QString &, QString &, int &)), Qt::BlockingQueuedConnection);
-	thread->start();
+	// deletes itself once the reply is written or the client goes away
+	new FServerConnection(socketDescription, m_jobServer, this);
 }
 
 
-void FApplication::doCommand(const QString & command, const QString & params, QString & result, int & status) {
-	status = 200;
-	result = "";
-
-	QDir dir(m_portRootFolder);
-
-	QString subfolder = params;
-	if (command.endsWith("tcp")) {
-		subfolder = TextUtils::getRandText();
-		dir.mkdir(subfolder);
-	}
-
-	dir.cd(subfolder);
-	m_outputFolder = dir.absolutePath();
-
-	if (command.endsWith("tcp")) {
-		QEventLoop loop;
-		QNetworkAccessManager networkManager;
-		QObject::connect(&networkManager, SIGNAL(finished(QNetworkReply*)), &loop, SLOT(quit()));
-
-		QUrl url = params;
-		QNetworkReply* reply = networkManager.get(QNetworkRequest(url));
-
-		loop.exec();
-
-		status = 404;
-
-		if (reply->error() == QNetworkReply::NoError) {
-			if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toUInt() == 200) {
-				if (reply->isReadable()) {
-					int buffersize = 8192;
-					QStringList components = params.split("/");
-					QString filename = components.last();
-					QFile file(dir.absoluteFilePath(filename));
-					if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-						status = 200;
-						while (reply->bytesAvailable() >= buffersize) {
-							QByteArray bytes = reply->read(buffersize);
-							file.write(bytes);
-						}
-						if (reply->bytesAvailable() > 0) {
-							file.write(reply->readAll());
-						}
-						file.close();
-					}
-					else {
-						result = "unable to save to local file";
-					}
-				}
-				else {
-					result = "response unreadable";
-				}
-			}
-			else {
-				result = QString("bad response from url server %1").arg(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toUInt());
-			}
-		}
-		else {
-			result = QString("url get failed %1").arg(reply->error());
-		}
-
-		reply->deleteLater();
-	}
-
-	if (!result.isEmpty()) {
-		// network problem
-		return;
-	}
-
-	if (command.startsWith("svg")) {
-		runSvgServiceAux();
-		QStringList nameFilters;
-		nameFilters << ("*.svg");
-		QFileInfoList fileList = dir.entryInfoList(nameFilters, QDir::Files | QDir::NoSymLinks);
-		if (fileList.count() > 0) {
-			QFile file(fileList.at(0).absoluteFilePath());
-			if (file.open(QFile::ReadOnly)) {
-				result = file.readAll();
-			}
-		}
-	}
-	else if (command.startsWith("gerber")) {
-		runGerberServiceAux();
-		QStringList nameFilters;
-		nameFilters << ("*.txt");
-		QFileInfoList fileList = dir.entryInfoList(nameFilters, QDir::Files | QDir::NoSymLinks);
-		if (fileList.count() > 0) {
-			QFile file(fileList.at(0).absoluteFilePath());
-			if (file.open(QFile::ReadOnly)) {
-				result = file.readAll();
-			}
-		}
-	}
-
-
-	if (command.endsWith("tcp")) {
-		QStringList skipSuffixes(".zip");
-		skipSuffixes << ".fzz";
-		QString filename = dir.absoluteFilePath(subfolder + ".zip");
-		if (FolderUtils::createZipAndSaveTo(dir, filename, skipSuffixes)) {
-			status = 200;
-			result = filename;
-		}
-		else {
-			status = 500;
-			result = "local zip failure";
-		}
-	}
-}
-
 void FApplication::regeneratePartsDatabase() {
 	QMessageBox messageBox(NULL);
 	messageBox.setWindowTitle(tr("Regenerate parts database?"));
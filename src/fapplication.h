@@ -34,10 +34,13 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QThread>
 #include <QNetworkReply>
 #include <QNetworkAccessManager>
+#include <QJsonObject>
+#include <QJsonArray>
 
 #include "referencemodel/referencemodel.h"
 
 class FileProgressDialog;
+class FJobServer;
 
 class FServer : public QTcpServer
 {
@@ -53,32 +56,6 @@ protected:
 	void incomingConnection(qintptr socketDescriptor);
 };
 
-class FServerThread : public QThread
-{
-	Q_OBJECT
-
-public:
-	FServerThread(qintptr socketDescriptor, QObject *parent);
-
-	void run();
-	void setDone();
-
-signals:
-	void error(QTcpSocket::SocketError socketError);
-	void doCommand(const QString & command, const QString & params, QString & result, int & status);
-
-protected:
-	void writeResponse(QTcpSocket *, int code, const QString & codeString, const QString & mimeType, const QString & message);
-
-protected:
-	int m_socketDescriptor = 0;
-	bool m_done = false;
-
-protected:
-	static QMutex m_busy;
-
-};
-
 ////////////////////////////////////////////////////
 
 class RegenerateDatabaseThread : public QThread
@@ -143,7 +120,6 @@ public slots:
 	void externalProcessSlot(QString & name, QString & path, QStringList & args);
 	void gotOrderFab(QNetworkReply *);
 	void newConnection(qintptr socketDescriptor);
-	void doCommand(const QString & command, const QString & params, QString & result, int & status);
 	void regeneratePartsDatabase();
 	void regenerateDatabaseFinished();
 	void installNewParts();
@@ -161,14 +137,20 @@ protected:
 	bool notify(QObject *receiver, QEvent *e);
 	void initService();
 	void runDRCService();
+	QJsonObject runDRCOne(const QString & filepath);
+	void runServiceWorkers(const QStringList & filepaths, const QStringList & serviceArgs, const QString & fileOption, const QString & reportOption, int jobs, QJsonArray & results);
+	void runAutorouteBenchService();
+	void runRatsnestBenchService();
 	void runGedaService();
 	void runDatabaseService();
 	void runKicadFootprintService();
 	void runKicadSchematicService();
 	void runGerberService();
 	void runGerberServiceAux();
+	QJsonObject runGerberOne(const QString & filepath);
 	void runSvgService();
 	void runSvgServiceAux();
+	void runPortWorkerService();
 	void runPanelizerService();
 	void runInscriptionService();
 	void runExampleService();
@@ -198,7 +180,10 @@ protected:
 		DatabaseService,
 		SvgService,
 		PortService,
+		PortWorkerService,
 		DRCService,
+		AutorouteBenchService,
+		RatsnestBenchService,
 		NoService
 	};
 
@@ -225,10 +210,23 @@ protected:
 	QString m_outputFolder;
 	QString m_portRootFolder;
 	QString m_panelFilename;
+	QStringList m_forwardArguments;
+	double m_drcKeepoutMils = 0;
+	int m_drcJobs = 0;
+	QString m_drcFile;
+	QString m_drcReport;
+	int m_gerberJobs = 0;
+	int m_workerTimeoutSeconds = 10 * 60;
+	QString m_gerberFile;
+	QString m_gerberReport;
+	bool m_gerberForce = false;
 	QHash<QString, struct LockedFile *> m_lockedFiles;
 	bool m_panelizerCustom = false;
 	int m_portNumber = 0;
+	int m_portJobs = 0;
+	int m_portTimeoutSeconds = 2 * 60;
 	FServer * m_fServer = nullptr;
+	FJobServer * m_jobServer = nullptr;
 	QString m_buildType;
 };
 
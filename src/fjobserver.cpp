@@ -0,0 +1,692 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "fjobserver.h"
+#include "debugdialog.h"
+#include "utils/misc.h"
+#include "utils/folderutils.h"
+#include "utils/textutils.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QNetworkRequest>
+#include <QRegExp>
+#include <QUrl>
+
+#include <algorithm>
+
+const QString FJobServer::WorkerDone("fritzing-port-job-done");
+const int FJobServer::QueueLimit = 64;
+const int FJobServer::CacheBytes = 64 * 1024 * 1024;
+
+static const int MaxHeaderBytes = 16 * 1024;
+static const int RequestTimeoutMs = 30 * 1000;         // for the client to send its request
+static const int LatencySamples = 256;
+
+static void recordLatency(QVector<qint64> & samples, int & next, qint64 ms) {
+	if (samples.count() < LatencySamples) {
+		samples.append(ms);
+		return;
+	}
+
+	samples[next] = ms;
+	next = (next + 1) % LatencySamples;
+}
+
+static QJsonObject latencyStats(const QVector<qint64> & samples) {
+	QJsonObject stats;
+	stats.insert("count", samples.count());
+	if (samples.isEmpty()) return stats;
+
+	QVector<qint64> sorted = samples;
+	std::sort(sorted.begin(), sorted.end());
+	qint64 total = 0;
+	foreach (qint64 ms, sorted) total += ms;
+
+	stats.insert("mean", (double) total / sorted.count());
+	stats.insert("p50", (double) sorted.at(sorted.count() / 2));
+	stats.insert("p95", (double) sorted.at(qMin(sorted.count() - 1, sorted.count() * 95 / 100)));
+	stats.insert("max", (double) sorted.last());
+	return stats;
+}
+
+////////////////////////////////////////////////////
+
+FServerConnection::FServerConnection(qintptr socketDescriptor, FJobServer * jobServer, QObject * parent)
+	: QObject(parent), m_jobServer(jobServer)
+{
+	m_socket = new QTcpSocket(this);
+	connect(m_socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+	connect(m_socket, SIGNAL(bytesWritten(qint64)), this, SLOT(bytesWritten()));
+	connect(m_socket, SIGNAL(disconnected()), this, SLOT(deleteLater()));
+
+	m_requestTimer.setSingleShot(true);
+	connect(&m_requestTimer, SIGNAL(timeout()), this, SLOT(requestTimedOut()));
+
+	if (!m_socket->setSocketDescriptor(socketDescriptor)) {
+		DebugDialog::debug(QString("Socket error %1 %2").arg(m_socket->error()).arg(m_socket->errorString()));
+		deleteLater();
+		return;
+	}
+
+	m_requestTimer.start(RequestTimeoutMs);
+}
+
+void FServerConnection::readRequest()
+{
+	if (m_requestRead) {
+		// GET has no body; ignore anything else the client sends
+		m_socket->readAll();
+		return;
+	}
+
+	m_header += m_socket->readAll();
+	int end = m_header.indexOf("\r\n\r\n");
+	if (end < 0) end = m_header.indexOf("\n\n");
+	if (end < 0) {
+		if (m_header.size() > MaxHeaderBytes) {
+			m_requestRead = true;
+			respond(431, "Request Header Fields Too Large", "", "");
+		}
+		return;
+	}
+
+	m_requestRead = true;
+	m_requestTimer.stop();
+
+	QString header = QString::fromUtf8(m_header.left(end));
+	DebugDialog::debug("header " + header);
+
+	QStringList tokens = header.split(QRegExp("[ \r\n][ \r\n]*"), Qt::SplitBehaviorFlags::SkipEmptyParts);
+	if (tokens.count() <= 0) {
+		respond(400, "Bad Request", "", "");
+		return;
+	}
+
+	if (tokens[0] != "GET") {
+		respond(405, "Method Not Allowed", "", "");
+		return;
+	}
+
+	if (tokens.count() < 2) {
+		respond(400, "Bad Request", "", "");
+		return;
+	}
+
+	QStringList params = tokens.at(1).split("/", Qt::SplitBehaviorFlags::SkipEmptyParts);
+	if (params.count() == 0) {
+		respond(400, "Bad Request", "", "");
+		return;
+	}
+
+	if (m_jobServer.isNull()) {
+		respond(503, "Service Unavailable", "", "Server shutting down.");
+		return;
+	}
+
+	QString command = params.takeFirst();
+	m_jobServer->request(this, command, params.join("/"));
+}
+
+void FServerConnection::respond(int code, const QString & codeString, const QString & mimeType, const QByteArray & body)
+{
+	if (m_responded) return;
+
+	m_responded = true;
+	m_requestTimer.stop();
+
+	QString type = mimeType;
+	if (type.isEmpty()) type = "text/plain";
+	QString header = QString("HTTP/1.0 %1 %2\r\n").arg(code).arg(codeString);
+	header += QString("Content-Type: %1; charset=\"utf-8\"\r\n").arg(type);
+	header += QString("Content-Length: %1\r\n").arg(body.size());
+	header += QString("\r\n");
+
+	// the socket is closed from bytesWritten once the whole reply has gone out
+	m_socket->write(header.toUtf8());
+	m_socket->write(body);
+}
+
+void FServerConnection::bytesWritten()
+{
+	if (m_responded && m_socket->bytesToWrite() == 0) {
+		m_socket->disconnectFromHost();
+	}
+}
+
+void FServerConnection::requestTimedOut()
+{
+	m_requestRead = true;
+	respond(408, "Request Timeout", "", "");
+}
+
+////////////////////////////////////////////////////
+
+FServerWorker::FServerWorker(const QStringList & args, QObject * parent) : QObject(parent), m_args(args)
+{
+	startProcess();
+}
+
+FServerWorker::~FServerWorker()
+{
+	if (m_process != nullptr && m_process->state() != QProcess::NotRunning) {
+		m_process->kill();
+		m_process->waitForFinished(1000);
+	}
+}
+
+void FServerWorker::startProcess()
+{
+	if (m_process != nullptr) {
+		m_process->disconnect(this);
+		m_process->deleteLater();
+	}
+
+	QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+	if (!environment.contains("QT_QPA_PLATFORM")) {
+		environment.insert("QT_QPA_PLATFORM", "offscreen");
+	}
+
+	// stdout carries the job protocol, so only stderr is forwarded
+	m_process = new QProcess(this);
+	m_process->setProcessEnvironment(environment);
+	m_process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+	connect(m_process, SIGNAL(readyReadStandardOutput()), this, SLOT(readOutput()));
+	connect(m_process, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(processFinished()));
+	connect(m_process, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(processError(QProcess::ProcessError)));
+	m_process->start(QCoreApplication::applicationFilePath(), m_args);
+}
+
+bool FServerWorker::isRunning() const {
+	return m_process != nullptr && m_process->state() != QProcess::NotRunning;
+}
+
+FServerJob * FServerWorker::job() const {
+	return m_job;
+}
+
+FServerJob * FServerWorker::takeJob() {
+	FServerJob * job = m_job;
+	if (job != nullptr) job->worker = nullptr;
+	m_job = nullptr;
+	return job;
+}
+
+void FServerWorker::start(FServerJob * job)
+{
+	if (!isRunning()) {
+		// replaces a worker which crashed or was killed after a timeout; it has to load the parts database again
+		startProcess();
+	}
+
+	m_job = job;
+	job->worker = this;
+	QString command = job->command;
+	if (job->tcp) command.chop(4);          // "-tcp"
+	m_process->write(QString("%1\t%2\n").arg(command).arg(job->folder).toUtf8());
+}
+
+void FServerWorker::kill()
+{
+	takeJob();
+	if (m_process == nullptr) return;
+
+	// drop the process now, so the next job starts a fresh one instead of going to this one
+	m_process->disconnect(this);
+	if (m_process->state() != QProcess::NotRunning) {
+		m_process->kill();
+		m_process->waitForFinished(1000);
+	}
+	m_process->deleteLater();
+	m_process = nullptr;
+}
+
+void FServerWorker::readOutput()
+{
+	while (m_process->canReadLine()) {
+		QString line = QString::fromUtf8(m_process->readLine()).trimmed();
+		if (!line.startsWith(FJobServer::WorkerDone)) continue;
+
+		int status = line.mid(FJobServer::WorkerDone.length()).trimmed().toInt();
+		if (m_job != nullptr) {
+			emit jobFinished(this, status);
+		}
+	}
+}
+
+void FServerWorker::processFinished()
+{
+	DebugDialog::debug(QString("port worker exited with code %1").arg(m_process->exitCode()));
+	if (m_job != nullptr) {
+		emit jobFinished(this, -1);
+	}
+}
+
+void FServerWorker::processError(QProcess::ProcessError error)
+{
+	// a process which fails to start never emits finished()
+	if (error == QProcess::FailedToStart) {
+		processFinished();
+	}
+}
+
+////////////////////////////////////////////////////
+
+FJobServer::FJobServer(const QString & rootFolder, const QStringList & workerArgs, int workerCount, int timeoutSeconds, QObject * parent)
+	: QObject(parent), m_rootFolder(rootFolder), m_timeoutSeconds(timeoutSeconds), m_cache(CacheBytes)
+{
+	m_uptime.start();
+
+	for (int i = 0; i < qMax(1, workerCount); i++) {
+		FServerWorker * worker = new FServerWorker(workerArgs, this);
+		connect(worker, SIGNAL(jobFinished(FServerWorker *, int)), this, SLOT(jobFinished(FServerWorker *, int)));
+		m_workers << worker;
+	}
+
+	connect(&m_networkManager, SIGNAL(finished(QNetworkReply *)), this, SLOT(downloadFinished(QNetworkReply *)));
+	connect(&m_timeoutTimer, SIGNAL(timeout()), this, SLOT(checkTimeouts()));
+	m_timeoutTimer.start(1000);
+
+	DebugDialog::debug(QString("port service: %1 workers, %2 second timeout").arg(m_workers.count()).arg(m_timeoutSeconds));
+}
+
+FJobServer::~FJobServer()
+{
+	foreach (FServerWorker * worker, m_workers) {
+		worker->takeJob();
+	}
+	qDeleteAll(m_jobs);
+	m_jobs.clear();
+	m_queue.clear();
+}
+
+void FJobServer::request(FServerConnection * connection, const QString & command, const QString & params)
+{
+	m_requestCount++;
+
+	if (command == "status") {
+		connection->respond(200, "Ok", "application/json", QJsonDocument(status()).toJson());
+		return;
+	}
+
+	bool tcp = command.endsWith("-tcp");
+	QString conversion = tcp ? command.left(command.length() - 4) : command;
+	if ((conversion != "svg" && conversion != "gerber") || params.isEmpty()) {
+		connection->respond(400, "Bad Request", "", "");
+		return;
+	}
+
+	if (!tcp) {
+		QDir root(m_rootFolder);
+		QString rootPath = QDir::cleanPath(root.absolutePath());
+		QString folder = QDir::cleanPath(root.absoluteFilePath(params));
+		if (!folder.startsWith(rootPath + "/") || !QFileInfo(folder).isDir()) {
+			connection->respond(404, "Not Found", "", "");
+			return;
+		}
+
+		submit(connection, command, folder, false);
+		return;
+	}
+
+	if (m_queue.count() + m_downloads.count() >= QueueLimit) {
+		m_rejected++;
+		connection->respond(503, "Service Unavailable", "", "Server busy.");
+		return;
+	}
+
+	// replace "/" that was removed from "http:/blah" when the path was split
+	QString url = params;
+	int ix = url.indexOf(":/");
+	if (ix >= 0) {
+		url.insert(ix + 1, "/");
+	}
+
+	QNetworkReply * reply = m_networkManager.get(QNetworkRequest(QUrl(url)));
+	FServerDownload download;
+	download.connection = connection;
+	download.command = command;
+	download.elapsed.start();
+	m_downloads.insert(reply, download);
+}
+
+void FJobServer::downloadFinished(QNetworkReply * reply)
+{
+	reply->deleteLater();
+	if (!m_downloads.contains(reply)) return;           // already timed out
+
+	FServerDownload download = m_downloads.take(reply);
+
+	QString error;
+	if (reply->error() != QNetworkReply::NoError) {
+		error = QString("url get failed %1").arg(reply->error());
+	}
+	else if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toUInt() != 200) {
+		error = QString("bad response from url server %1").arg(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toUInt());
+	}
+
+	QDir dir(m_rootFolder);
+	QString subfolder = TextUtils::getRandText();
+	if (error.isEmpty() && !(dir.mkdir(subfolder) && dir.cd(subfolder))) {
+		error = "unable to create local folder";
+	}
+
+	if (error.isEmpty()) {
+		QString filename = QFileInfo(reply->url().path()).fileName();
+		if (filename.isEmpty()) filename = "sketch" + FritzingBundleExtension;
+		QFile file(dir.absoluteFilePath(filename));
+		if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			file.write(reply->readAll());
+			file.close();
+		}
+		else {
+			error = "unable to save to local file";
+			FolderUtils::rmdir(dir);
+		}
+	}
+
+	if (!error.isEmpty()) {
+		m_failed++;
+		if (!download.connection.isNull()) {
+			download.connection->respond(404, "failed", "", error.toUtf8());
+		}
+		return;
+	}
+
+	if (download.connection.isNull()) {
+		// nobody is waiting for the result any more
+		FolderUtils::rmdir(dir);
+		return;
+	}
+
+	submit(download.connection, download.command, dir.absolutePath(), true);
+}
+
+QString FJobServer::folderKey(const QString & command, const QString & folder, bool tcp)
+{
+	// output file names follow the sketch file names, so they are part of the key along with the contents;
+	// a local job also leaves its output in the folder, so the same sketch in another folder is another job
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	QDir dir(folder);
+	if (!tcp) {
+		hash.addData(dir.absolutePath().toUtf8());
+	}
+	QStringList filters;
+	filters << "*" + FritzingBundleExtension;
+	foreach (QString filename, dir.entryList(filters, QDir::Files, QDir::Name)) {
+		hash.addData(filename.toUtf8());
+		QFile file(dir.absoluteFilePath(filename));
+		if (file.open(QIODevice::ReadOnly)) {
+			hash.addData(&file);
+		}
+	}
+
+	return command + ":" + QString(hash.result().toHex());
+}
+
+bool FJobServer::outputsIntact(const FServerResult & result)
+{
+	for (QHash<QString, QDateTime>::const_iterator it = result.outputs.constBegin(); it != result.outputs.constEnd(); ++it) {
+		QFileInfo info(it.key());
+		if (!info.exists() || info.lastModified() != it.value()) return false;
+	}
+
+	return true;
+}
+
+void FJobServer::submit(FServerConnection * connection, const QString & command, const QString & folder, bool tcp)
+{
+	QString key = folderKey(command, folder, tcp);
+
+	FServerResult * cached = m_cache.object(key);
+	if (cached != nullptr && !outputsIntact(*cached)) {
+		// the output was removed or changed since, so the local folder has to be converted again
+		m_cache.remove(key);
+		cached = nullptr;
+	}
+	if (cached != nullptr) {
+		m_cacheHits++;
+		if (tcp) FolderUtils::rmdir(folder);
+		connection->respond(cached->status, "Ok", cached->mimeType, cached->body);
+		return;
+	}
+
+	FServerJob * job = m_jobs.value(key, nullptr);
+	if (job != nullptr) {
+		// the same input is already queued or running
+		m_sharedJobs++;
+		if (tcp) FolderUtils::rmdir(folder);
+		job->waiters << connection;
+		return;
+	}
+
+	if (m_queue.count() >= QueueLimit) {
+		m_rejected++;
+		if (tcp) FolderUtils::rmdir(folder);
+		connection->respond(503, "Service Unavailable", "", "Server busy.");
+		return;
+	}
+
+	job = new FServerJob;
+	job->key = key;
+	job->command = command;
+	job->folder = folder;
+	job->tcp = tcp;
+	job->waiters << connection;
+	job->elapsed.start();
+	m_jobs.insert(key, job);
+	m_queue.enqueue(job);
+	m_maxQueueDepth = qMax(m_maxQueueDepth, m_queue.count());
+
+	dispatch();
+}
+
+void FJobServer::dispatch()
+{
+	foreach (FServerWorker * worker, m_workers) {
+		if (m_queue.isEmpty()) return;
+		if (worker->job() != nullptr) continue;
+
+		FServerJob * job = m_queue.dequeue();
+		job->waitMs = job->elapsed.elapsed();
+		recordLatency(m_waits, m_nextWait, job->waitMs);
+		DebugDialog::debug(QString("port job %1 %2 after %3 ms in the queue").arg(job->command).arg(job->folder).arg(job->waitMs));
+		worker->start(job);
+	}
+}
+
+void FJobServer::jobFinished(FServerWorker * worker, int status)
+{
+	FServerJob * job = worker->takeJob();
+	if (job == nullptr) return;
+
+	finish(job, collectResult(job, status));
+	dispatch();
+}
+
+FServerResult FJobServer::collectResult(FServerJob * job, int status)
+{
+	FServerResult result;
+	result.status = 200;
+
+	if (status != 200) {
+		result.status = 500;
+		result.body = (status < 0) ? QByteArray("worker exited") : QString("conversion failed %1").arg(status).toUtf8();
+		return result;
+	}
+
+	QDir dir(job->folder);
+	if (job->tcp) {
+		QStringList skipSuffixes(".zip");
+		skipSuffixes << FritzingBundleExtension;
+		QString filename = dir.absoluteFilePath(dir.dirName() + ".zip");
+		if (FolderUtils::createZipAndSaveTo(dir, filename, skipSuffixes)) {
+			QFile file(filename);
+			if (file.open(QFile::ReadOnly)) {
+				result.mimeType = "application/zip";
+				result.body = file.readAll();
+				return result;
+			}
+		}
+
+		result.status = 500;
+		result.body = "local zip failure";
+		return result;
+	}
+
+	foreach (QFileInfo info, dir.entryInfoList(QDir::Files | QDir::NoSymLinks)) {
+		if (info.fileName().endsWith(FritzingBundleExtension)) continue;
+
+		result.outputs.insert(info.absoluteFilePath(), info.lastModified());
+	}
+
+	QStringList nameFilters;
+	if (job->command == "svg") {
+		result.mimeType = "image/svg+xml";
+		nameFilters << "*.svg";
+	}
+	else {
+		nameFilters << "*.txt";
+	}
+
+	QFileInfoList fileList = dir.entryInfoList(nameFilters, QDir::Files | QDir::NoSymLinks);
+	if (fileList.count() > 0) {
+		QFile file(fileList.at(0).absoluteFilePath());
+		if (file.open(QFile::ReadOnly)) {
+			result.body = file.readAll();
+		}
+	}
+
+	return result;
+}
+
+void FJobServer::finish(FServerJob * job, const FServerResult & result)
+{
+	m_jobs.remove(job->key);
+	m_queue.removeOne(job);
+
+	QString codeString = "Ok";
+	if (result.status == 200) {
+		m_completed++;
+		m_cache.insert(job->key, new FServerResult(result), qMax(1, result.body.size()));
+	}
+	else if (result.status == 504) {
+		m_timedOut++;
+		codeString = "Gateway Timeout";
+	}
+	else {
+		m_failed++;
+		codeString = "failed";
+	}
+
+	recordLatency(m_latencies, m_nextLatency, job->elapsed.elapsed());
+
+	foreach (QPointer<FServerConnection> connection, job->waiters) {
+		if (!connection.isNull()) {
+			connection->respond(result.status, codeString, result.mimeType, result.body);
+		}
+	}
+
+	if (job->tcp) {
+		FolderUtils::rmdir(job->folder);
+	}
+
+	delete job;
+}
+
+void FJobServer::checkTimeouts()
+{
+	if (m_timeoutSeconds <= 0) return;
+
+	qint64 limit = m_timeoutSeconds * 1000LL;
+	QByteArray message = QString("timed out after %1 seconds").arg(m_timeoutSeconds).toUtf8();
+
+	QList<QNetworkReply *> expiredDownloads;
+	foreach (QNetworkReply * reply, m_downloads.keys()) {
+		if (m_downloads.value(reply).elapsed.elapsed() > limit) {
+			expiredDownloads << reply;
+		}
+	}
+	foreach (QNetworkReply * reply, expiredDownloads) {
+		FServerDownload download = m_downloads.take(reply);
+		m_timedOut++;
+		if (!download.connection.isNull()) {
+			download.connection->respond(504, "Gateway Timeout", "", message);
+		}
+		reply->abort();
+	}
+
+	QList<FServerJob *> expired;
+	foreach (FServerJob * job, m_jobs) {
+		if (job->elapsed.elapsed() > limit) {
+			expired << job;
+		}
+	}
+	if (expired.isEmpty()) return;
+
+	foreach (FServerJob * job, expired) {
+		DebugDialog::debug(QString("port job %1 %2 timed out").arg(job->command).arg(job->folder));
+		if (job->worker != nullptr) {
+			// the worker may be stuck, so it is replaced rather than reused
+			job->worker->kill();
+		}
+
+		FServerResult result;
+		result.status = 504;
+		result.body = message;
+		finish(job, result);
+	}
+
+	dispatch();
+}
+
+QJsonObject FJobServer::status() const
+{
+	int busyWorkers = 0;
+	foreach (FServerWorker * worker, m_workers) {
+		if (worker->job() != nullptr) busyWorkers++;
+	}
+
+	QJsonObject status;
+	status.insert("uptimeSeconds", (double) m_uptime.elapsed() / 1000);
+	status.insert("workers", m_workers.count());
+	status.insert("busyWorkers", busyWorkers);
+	status.insert("queueDepth", m_queue.count());
+	status.insert("maxQueueDepth", m_maxQueueDepth);
+	status.insert("queueLimit", QueueLimit);
+	status.insert("downloads", m_downloads.count());
+	status.insert("timeoutSeconds", m_timeoutSeconds);
+	status.insert("requests", (double) m_requestCount);
+	status.insert("cacheHits", (double) m_cacheHits);
+	status.insert("sharedJobs", (double) m_sharedJobs);
+	status.insert("completed", (double) m_completed);
+	status.insert("failed", (double) m_failed);
+	status.insert("timedOut", (double) m_timedOut);
+	status.insert("rejected", (double) m_rejected);
+	status.insert("cacheEntries", m_cache.count());
+	status.insert("cacheBytes", m_cache.totalCost());
+	status.insert("waitMs", latencyStats(m_waits));
+	status.insert("latencyMs", latencyStats(m_latencies));
+	return status;
+}
@@ -0,0 +1,176 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef FJOBSERVER_H
+#define FJOBSERVER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QTcpSocket>
+#include <QProcess>
+#include <QTimer>
+#include <QQueue>
+#include <QCache>
+#include <QHash>
+#include <QDateTime>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+
+class FJobServer;
+
+// one http request on the --port service; reads the request and writes the reply without blocking
+class FServerConnection : public QObject
+{
+	Q_OBJECT
+
+public:
+	FServerConnection(qintptr socketDescriptor, FJobServer *, QObject * parent);
+
+	void respond(int code, const QString & codeString, const QString & mimeType, const QByteArray & body);
+
+protected slots:
+	void readRequest();
+	void bytesWritten();
+	void requestTimedOut();
+
+protected:
+	QTcpSocket * m_socket = nullptr;
+	QPointer<FJobServer> m_jobServer;
+	QByteArray m_header;
+	QTimer m_requestTimer;
+	bool m_requestRead = false;
+	bool m_responded = false;
+};
+
+struct FServerResult {
+	int status;
+	QString mimeType;
+	QByteArray body;
+	QHash<QString, QDateTime> outputs;      // local jobs: the files the worker left in the folder, with their modification times
+};
+
+struct FServerJob {
+	QString key;                    // command plus the sha1 of the input sketches, and the folder for local jobs
+	QString command;
+	QString folder;                 // the worker converts every sketch in this folder
+	bool tcp = false;               // the input was downloaded: reply with a zip of folder, then remove it
+	QList<QPointer<FServerConnection>> waiters;
+	QElapsedTimer elapsed;          // since the first request for this job arrived
+	qint64 waitMs = 0;              // time spent in the queue
+	class FServerWorker * worker = nullptr;
+};
+
+// a persistent Fritzing process started with -portworker; it loads the parts database once
+// and then converts one job folder at a time, as sent over stdin
+class FServerWorker : public QObject
+{
+	Q_OBJECT
+
+public:
+	FServerWorker(const QStringList & args, QObject * parent);
+	~FServerWorker();
+
+	bool isRunning() const;
+	void start(FServerJob *);
+	void kill();
+	FServerJob * job() const;
+	FServerJob * takeJob();
+
+signals:
+	void jobFinished(FServerWorker *, int status);
+
+protected slots:
+	void readOutput();
+	void processFinished();
+	void processError(QProcess::ProcessError);
+
+protected:
+	void startProcess();
+
+protected:
+	QStringList m_args;
+	QProcess * m_process = nullptr;
+	FServerJob * m_job = nullptr;
+};
+
+struct FServerDownload {
+	QPointer<FServerConnection> connection;
+	QString command;
+	QElapsedTimer elapsed;
+};
+
+class FJobServer : public QObject
+{
+	Q_OBJECT
+
+public:
+	FJobServer(const QString & rootFolder, const QStringList & workerArgs, int workerCount, int timeoutSeconds, QObject * parent);
+	~FJobServer();
+
+	void request(FServerConnection *, const QString & command, const QString & params);
+	QJsonObject status() const;
+
+public:
+	static const QString WorkerDone;
+	static const int QueueLimit;
+	static const int CacheBytes;
+
+protected slots:
+	void downloadFinished(QNetworkReply *);
+	void jobFinished(FServerWorker *, int status);
+	void checkTimeouts();
+
+protected:
+	void submit(FServerConnection *, const QString & command, const QString & folder, bool tcp);
+	void dispatch();
+	void finish(FServerJob *, const FServerResult &);
+	FServerResult collectResult(FServerJob *, int status);
+	QString folderKey(const QString & command, const QString & folder, bool tcp);
+	bool outputsIntact(const FServerResult &);
+
+protected:
+	QString m_rootFolder;
+	int m_timeoutSeconds;
+	QList<FServerWorker *> m_workers;
+	QQueue<FServerJob *> m_queue;
+	QHash<QString, FServerJob *> m_jobs;        // queued and running jobs, by key, so identical requests share one job
+	QCache<QString, FServerResult> m_cache;     // finished results by key, cost in bytes
+	QNetworkAccessManager m_networkManager;
+	QHash<QNetworkReply *, FServerDownload> m_downloads;
+	QTimer m_timeoutTimer;
+	QElapsedTimer m_uptime;
+	int m_maxQueueDepth = 0;
+	qint64 m_requestCount = 0;
+	qint64 m_cacheHits = 0;
+	qint64 m_sharedJobs = 0;
+	qint64 m_completed = 0;
+	qint64 m_failed = 0;
+	qint64 m_timedOut = 0;
+	qint64 m_rejected = 0;
+	QVector<qint64> m_latencies;                // ring buffers of the most recent jobs
+	QVector<qint64> m_waits;
+	int m_nextLatency = 0;
+	int m_nextWait = 0;
+};
+
+#endif
@@ -32,6 +32,11 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QCoreApplication>
 #include <QGraphicsSvgItem>
 #include <qnumeric.h>
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QCryptographicHash>
+#include <QAtomicInt>
 
 /////////////////////////////////////////////
 
@@ -39,9 +44,44 @@ QString FSvgRenderer::NonConnectorName("nonconn");
 
 static ConnectorInfo VanillaConnectorInfo;
 
+// the outcome of loadAux for a given svg and LoadInfo, shared by every instance of a part:
+// identical parts then skip the cleanup, recoloring and connector parsing, and only QSvgRenderer::load is repeated
+struct LoadedSvg {
+	QByteArray contents;
+	QHash<QString, ConnectorInfo> connectorInfo;
+	QHash<QString, ConnectorInfo> nonConnectorInfo;
+};
+
+static QAtomicInt NextSerial(1);
+
+static QCache<QByteArray, LoadedSvg> LoadedSvgCache(64 * 1024 * 1024);      // cost is in bytes
+static QMutex LoadedSvgMutex;
+
+static QByteArray loadedSvgKey(const QByteArray & contents, const LoadInfo & loadInfo) {
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(contents);
+	QStringList fields;
+	fields << loadInfo.filename << loadInfo.connectorIDs.join(",") << loadInfo.terminalIDs.join(",") << loadInfo.legIDs.join(",")
+	       << loadInfo.setColor << loadInfo.colorElementID << QString::number(loadInfo.findNonConnectors) << QString::number(loadInfo.parsePaths);
+	hash.addData(fields.join("\n").toUtf8());
+	return hash.result();
+}
+
 FSvgRenderer::FSvgRenderer(QObject * parent) : QSvgRenderer(parent)
 {
 	m_defaultSizeF = QSizeF(0,0);
+	newSerial();
+	// QSvgRenderer emits repaintNeeded whenever new contents are loaded
+	connect(this, SIGNAL(repaintNeeded()), this, SLOT(newSerial()));
+}
+
+void FSvgRenderer::newSerial() {
+	m_serial = NextSerial.fetchAndAddRelaxed(1);
+}
+
+int FSvgRenderer::serial() const {
+	// unique across all renderers for each loaded svg, so it can key cached renderings
+	return m_serial;
 }
 
 FSvgRenderer::~FSvgRenderer()
@@ -62,7 +102,8 @@ void FSvgRenderer::clearConnectorInfoHash(QHash<QString, ConnectorInfo *> & hash
 }
 
 void FSvgRenderer::cleanup() {
-
+	QMutexLocker locker(&LoadedSvgMutex);
+	LoadedSvgCache.clear();
 }
 
 QByteArray FSvgRenderer::loadSvg(const QString & filename) {
@@ -113,6 +154,32 @@ QByteArray FSvgRenderer::loadSvg(const QByteArray & contents, const LoadInfo & l
 
 QByteArray FSvgRenderer::loadAux(const QByteArray & theContents, const LoadInfo & loadInfo)
 {
+	QByteArray key = loadedSvgKey(theContents, loadInfo);
+	LoadedSvg loaded;
+	bool cached = false;
+	LoadedSvgMutex.lock();
+	if (LoadedSvgCache.contains(key)) {
+		loaded = *LoadedSvgCache.object(key);
+		cached = true;
+	}
+	LoadedSvgMutex.unlock();
+
+	if (cached) {
+		if (loadInfo.connectorIDs.count() > 0) {
+			clearConnectorInfoHash(m_connectorInfoHash);
+			foreach (QString id, loaded.connectorInfo.keys()) {
+				m_connectorInfoHash.insert(id, new ConnectorInfo(loaded.connectorInfo.value(id)));
+			}
+		}
+		if (loadInfo.findNonConnectors) {
+			clearConnectorInfoHash(m_nonConnectorInfoHash);
+			foreach (QString id, loaded.nonConnectorInfo.keys()) {
+				m_nonConnectorInfoHash.insert(id, new ConnectorInfo(loaded.nonConnectorInfo.value(id)));
+			}
+		}
+		return finalLoad(loaded.contents, loadInfo.filename);
+	}
+
 	QByteArray cleanContents(theContents);
 	bool cleaned = false;
 
@@ -176,7 +243,25 @@ QByteArray FSvgRenderer::loadAux(const QByteArray & theContents, const LoadInfo
 
 	//DebugDialog::debug(cleanContents.data());
 
-	return finalLoad(cleanContents, loadInfo.filename);
+	QByteArray result = finalLoad(cleanContents, loadInfo.filename);
+	if (!result.isEmpty()) {
+		LoadedSvg * entry = new LoadedSvg;
+		entry->contents = cleanContents;
+		if (loadInfo.connectorIDs.count() > 0) {
+			foreach (QString id, m_connectorInfoHash.keys()) {
+				entry->connectorInfo.insert(id, *m_connectorInfoHash.value(id));
+			}
+		}
+		if (loadInfo.findNonConnectors) {
+			foreach (QString id, m_nonConnectorInfoHash.keys()) {
+				entry->nonConnectorInfo.insert(id, *m_nonConnectorInfoHash.value(id));
+			}
+		}
+		QMutexLocker locker(&LoadedSvgMutex);
+		LoadedSvgCache.insert(key, entry, cleanContents.size());
+	}
+
+	return result;
 }
 
 QByteArray FSvgRenderer::finalLoad(QByteArray & cleanContents, const QString & filename) {
@@ -79,6 +79,7 @@ public:
 	QSizeF defaultSizeF();
 	bool setUpConnector(class SvgIdLayer * svgIdLayer, bool ignoreTerminalPoint, ViewLayer::ViewLayerPlacement);
 	QList<SvgIdLayer *> setUpNonConnectors(ViewLayer::ViewLayerPlacement);
+	int serial() const;
 
 public:
 	static void cleanup();
@@ -105,11 +106,15 @@ protected:
 	ConnectorInfo * getConnectorInfo(const QString & connectorID);
 	void clearConnectorInfoHash(QHash<QString, ConnectorInfo *> & hash);
 
+protected slots:
+	void newSerial();
+
 protected:
 	QString m_filename;
 	QSizeF m_defaultSizeF;
 	QHash<QString, ConnectorInfo *> m_connectorInfoHash;
 	QHash<QString, ConnectorInfo *> m_nonConnectorInfoHash;
+	int m_serial;
 
 public:
 	static QString NonConnectorName;
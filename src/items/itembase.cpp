@@ -26,8 +26,10 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "../connectors/connectoritem.h"
 #include "../connectors/connectorshared.h"
 #include "../sketch/infographicsview.h"
+#include "../sketch/fgraphicsscene.h"
 #include "../connectors/connector.h"
 #include "../connectors/bus.h"
+#include "../connectors/connectivityindex.h"
 #include "partlabel.h"
 #include "../layerattributes.h"
 #include "../fsvgrenderer.h"
@@ -50,6 +52,12 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QBitmap>
 #include <QApplication>
 #include <QClipboard>
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QPixmapCache>
 #include <qmath.h>
 
 /////////////////////////////////
@@ -58,6 +66,7 @@ static QRegExp NumberMatcher;
 static QHash<QString, double> NumberMatcherValues;
 
 static constexpr double InactiveOpacity = 0.4;
+static constexpr int MaxSvgFragments = 32;		// a few layers times a few export settings; zooming through dpi keys shouldn't grow it without end
 
 bool numberValueLessThan(QString v1, QString v2)
 {
@@ -84,6 +93,12 @@ const double ItemBase::HoverOpacity = .20;
 const QColor ItemBase::ConnectorHoverColor(0,0,255);
 const double ItemBase::ConnectorHoverOpacity = .40;
 
+const QString ItemBase::RenderCacheSettingName("RenderCache");
+bool ItemBase::RenderCacheEnabled = true;
+const double ItemBase::OutlinePixels = 6;
+const int ItemBase::MaxCachedPixels = 2048;
+const QColor ItemBase::OutlineColor(128, 128, 128, 160);
+
 const QColor StandardConnectedColor(0, 255, 0);
 const QColor StandardUnconnectedColor(255, 0, 0);
 
@@ -124,6 +139,12 @@ ItemBase::ItemBase( ModelPart* modelPart, ViewLayer::ViewID viewID, const ViewGe
 
 ItemBase::~ItemBase() {
 	//DebugDialog::debug(QString("deleting itembase %1 %2 %3").arg((long) this, 0, 16).arg(m_id).arg((long) m_modelPart, 0, 16));
+	// ~QGraphicsItem removes us from the scene, but by then itemChange() no longer reaches ItemBase
+	FGraphicsScene * fscene = qobject_cast<FGraphicsScene *>(scene());
+	if (fscene) {
+		fscene->unindexItem(this);
+	}
+
 	if (m_partLabel) {
 		delete m_partLabel;
 		m_partLabel = nullptr;
@@ -183,7 +204,20 @@ qint64 ItemBase::getNextID(qint64 index) {
 }
 
 void ItemBase::resetID() {
-	m_id = m_modelPart->modelIndex() * ModelPart::indexMultiplier;
+	setID(m_modelPart->modelIndex() * ModelPart::indexMultiplier);
+}
+
+void ItemBase::setID(qint64 id) {
+	FGraphicsScene * fscene = qobject_cast<FGraphicsScene *>(scene());
+	if (fscene) {
+		fscene->unindexItem(this);
+	}
+
+	m_id = id;
+
+	if (fscene) {
+		fscene->indexItem(this);
+	}
 }
 
 double ItemBase::z() {
@@ -275,6 +309,12 @@ void ItemBase::initNames() {
 		setUnconnectedColor(color);
 	}
 
+	RenderCacheEnabled = settings.value(RenderCacheSettingName, true).toBool();
+	if (RenderCacheEnabled) {
+		// cache limit is in kilobytes; leave room for a few zoom levels of a dense sketch
+		QPixmapCache::setCacheLimit(qMax(QPixmapCache::cacheLimit(), 64 * 1024));
+	}
+
 }
 
 void ItemBase::saveInstance(QXmlStreamWriter & streamWriter) {
@@ -727,12 +767,60 @@ void ItemBase::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
 	}
 }
 
-void ItemBase::paintBody(QPainter *painter, const QStyleOptionGraphicsItem * /* option */, QWidget * /* widget */)
+void ItemBase::paintBody(QPainter *painter, const QStyleOptionGraphicsItem * option, QWidget * widget)
 {
+	if (paintCached(painter, option, widget)) return;
+
 	// Qt's SVG renderer's defaultSize is not correct when the svg has a fractional pixel size
 	fsvgRenderer()->render(painter, boundingRectWithoutLegs());
 }
 
+bool ItemBase::paintCached(QPainter *painter, const QStyleOptionGraphicsItem * option, QWidget * widget)
+{
+	// only cache on screen: printing and export go through QGraphicsScene::render, which passes no widget
+	if (!RenderCacheEnabled || widget == nullptr) return false;
+
+	FSvgRenderer * renderer = fsvgRenderer();
+	if (renderer == nullptr) return false;
+
+	QRectF rect = boundingRectWithoutLegs();
+	if (rect.isEmpty()) return false;
+
+	double scale = option->levelOfDetailFromTransform(painter->worldTransform()) * painter->device()->devicePixelRatioF();
+	if (scale <= 0) return false;
+
+	if (qMax(rect.width(), rect.height()) * scale < OutlinePixels) {
+		// too small to make out any detail: a plain outline is enough
+		painter->fillRect(rect, OutlineColor);
+		return true;
+	}
+
+	// round the scale up to the next half octave, so a pixmap is reused across small zoom steps
+	double bucket = qCeil(2 * log2(scale)) / 2.0;
+	double bucketScale = qPow(2, bucket);
+	QSize pixmapSize = (rect.size() * bucketScale).toSize().expandedTo(QSize(1, 1));
+	if (qMax(pixmapSize.width(), pixmapSize.height()) > MaxCachedPixels) return false;
+
+	// the renderer serial changes whenever the svg is (re)loaded, so property changes invalidate the entry
+	QString key = QString("fzitem_%1_%2_%3x%4").arg(renderer->serial()).arg(bucket).arg(rect.width()).arg(rect.height());
+	QPixmap pixmap;
+	if (!QPixmapCache::find(key, &pixmap)) {
+		pixmap = QPixmap(pixmapSize);
+		pixmap.fill(Qt::transparent);
+		QPainter pixmapPainter(&pixmap);
+		pixmapPainter.setRenderHint(QPainter::Antialiasing, true);
+		renderer->render(&pixmapPainter, QRectF(QPointF(0, 0), pixmapSize));
+		pixmapPainter.end();
+		QPixmapCache::insert(key, pixmap);
+	}
+
+	painter->save();
+	painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+	painter->drawPixmap(rect, pixmap, QRectF(QPointF(0, 0), pixmapSize));
+	painter->restore();
+	return true;
+}
+
 void ItemBase::paintHover(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
 	paintHover(painter, option, widget, hoverShape());
@@ -1178,6 +1266,26 @@ QVariant ItemBase::itemChange(QGraphicsItem::GraphicsItemChange change, const QV
 			m_partLabel->ownerSelected(value.toBool());
 		}
 
+		break;
+	case QGraphicsItem::ItemTransformHasChanged:
+		// the transform is part of the fragment key; drop the old entries rather than let them pile up
+		clearSvgFragments();
+		break;
+	case QGraphicsItem::ItemSceneChange:
+		{
+			FGraphicsScene * fscene = qobject_cast<FGraphicsScene *>(scene());
+			if (fscene) {
+				fscene->unindexItem(this);
+			}
+		}
+		break;
+	case QGraphicsItem::ItemSceneHasChanged:
+		{
+			FGraphicsScene * fscene = qobject_cast<FGraphicsScene *>(scene());
+			if (fscene) {
+				fscene->indexItem(this);
+			}
+		}
 		break;
 	default:
 		break;
@@ -1274,6 +1382,34 @@ void ItemBase::saveLocAndTransform(QXmlStreamWriter & streamWriter)
 	GraphicsUtils::saveTransform(streamWriter, m_viewGeometry.transform());
 }
 
+// per-layer svg bytes after flipping and splitting, before any per-instance local modifications;
+// every instance of a part placed the same way on the same layer starts from the same bytes
+struct LayerSvg {
+	QByteArray bytes;
+	bool hasText;
+};
+
+static QCache<QString, LayerSvg> LayerSvgCache(32 * 1024 * 1024);      // cost is in bytes
+static QMutex LayerSvgMutex;
+
+static QString layerSvgKey(ModelPart * modelPart, const QString & filename, const LayerAttributes & layerAttributes)
+{
+	QFileInfo info(filename);
+	QStringList fields;
+	fields << filename
+	       << QString::number(info.lastModified().toMSecsSinceEpoch())
+	       << QString::number(info.size())
+	       << QString::number(layerAttributes.viewID)
+	       << QString::number(layerAttributes.viewLayerID)
+	       << QString::number(layerAttributes.viewLayerPlacement)
+	       << QString::number(int(layerAttributes.orientation))
+	       << QString::number(modelPart->flippedSMD())
+	       << QString::number(modelPart->needsCopper1())
+	       << QString::number(modelPart->itemType())
+	       << QString::number(modelPart->modelPartShared()->hasMultipleLayers(layerAttributes.viewID));
+	return fields.join("|");
+}
+
 FSvgRenderer * ItemBase::setUpImage(ModelPart * modelPart, LayerAttributes & layerAttributes)
 {
 	// at this point "this" has not yet been added to the scene, so one cannot get back to the InfoGraphicsView
@@ -1340,48 +1476,33 @@ FSvgRenderer * ItemBase::setUpImage(ModelPart * modelPart, LayerAttributes & lay
 		break;
 	}
 
-	FSvgRenderer * newRenderer = new FSvgRenderer();
-	QDomDocument flipDoc;
-	getFlipDoc(modelPart, filename, layerAttributes.viewLayerID, layerAttributes.viewLayerPlacement, flipDoc, layerAttributes.orientation);
+	QString cacheKey = layerSvgKey(modelPart, filename, layerAttributes);
 	QByteArray bytesToLoad;
-	if (layerAttributes.viewLayerID == ViewLayer::Schematic) {
-		bytesToLoad = SvgFileSplitter::hideText(filename);
-	}
-	else if (layerAttributes.viewLayerID == ViewLayer::SchematicText) {
-		bool hasText = false;
-		bytesToLoad = SvgFileSplitter::showText(filename, hasText);
-		if (!hasText) {
-			return nullptr;
-		}
-	}
-	else if ((layerAttributes.viewID != ViewLayer::IconView) && modelPartShared->hasMultipleLayers(layerAttributes.viewID)) {
-		QString layerName = ViewLayer::viewLayerXmlNameFromID(layerAttributes.viewLayerID);
-		// need to treat create "virtual" svg file for each layer
-		SvgFileSplitter svgFileSplitter;
-		bool result;
-		if (flipDoc.isNull()) {
-			result = svgFileSplitter.split(filename, layerName);
-		}
-		else {
-			QString f = flipDoc.toString();
-			result = svgFileSplitter.splitString(f, layerName);
-		}
-		if (result) {
-			bytesToLoad = svgFileSplitter.byteArray();
-		}
-	}
-	else {
-		// only one layer, just load it directly
-		if (flipDoc.isNull()) {
-			QFile file(filename);
-			file.open(QFile::ReadOnly);
-			bytesToLoad = file.readAll();
-		}
-		else {
-			bytesToLoad = flipDoc.toByteArray();
-		}
+	bool hasText = true;
+	bool cached = false;
+	LayerSvgMutex.lock();
+	if (LayerSvgCache.contains(cacheKey)) {
+		LayerSvg * layerSvg = LayerSvgCache.object(cacheKey);
+		bytesToLoad = layerSvg->bytes;
+		hasText = layerSvg->hasText;
+		cached = true;
+	}
+	LayerSvgMutex.unlock();
+
+	if (!cached) {
+		bytesToLoad = loadLayerSvg(modelPart, filename, layerAttributes, hasText);
+		LayerSvg * layerSvg = new LayerSvg;
+		layerSvg->bytes = bytesToLoad;
+		layerSvg->hasText = hasText;
+		QMutexLocker locker(&LayerSvgMutex);
+		LayerSvgCache.insert(cacheKey, layerSvg, qMax(1, bytesToLoad.size()));
+	}
+
+	if (!hasText) {
+		return nullptr;
 	}
 
+	FSvgRenderer * newRenderer = new FSvgRenderer();
 	QByteArray resultBytes;
 	if (!bytesToLoad.isEmpty()) {
 		if (makeLocalModifications(bytesToLoad, filename)) {
@@ -1389,8 +1510,8 @@ FSvgRenderer * ItemBase::setUpImage(ModelPart * modelPart, LayerAttributes & lay
 				bytesToLoad = SvgFileSplitter::hideText2(bytesToLoad);
 			}
 			else if (layerAttributes.viewLayerID == ViewLayer::SchematicText) {
-				bool hasText;
-				bytesToLoad = SvgFileSplitter::showText2(bytesToLoad, hasText);
+				bool stillHasText;
+				bytesToLoad = SvgFileSplitter::showText2(bytesToLoad, stillHasText);
 			}
 		}
 
@@ -1421,6 +1542,51 @@ FSvgRenderer * ItemBase::setUpImage(ModelPart * modelPart, LayerAttributes & lay
 	return newRenderer;
 }
 
+QByteArray ItemBase::loadLayerSvg(ModelPart * modelPart, const QString & filename, const LayerAttributes & layerAttributes, bool & hasText)
+{
+	ModelPartShared * modelPartShared = modelPart->modelPartShared();
+	QDomDocument flipDoc;
+	getFlipDoc(modelPart, filename, layerAttributes.viewLayerID, layerAttributes.viewLayerPlacement, flipDoc, layerAttributes.orientation);
+	QByteArray bytesToLoad;
+	hasText = true;
+	if (layerAttributes.viewLayerID == ViewLayer::Schematic) {
+		bytesToLoad = SvgFileSplitter::hideText(filename);
+	}
+	else if (layerAttributes.viewLayerID == ViewLayer::SchematicText) {
+		hasText = false;
+		bytesToLoad = SvgFileSplitter::showText(filename, hasText);
+	}
+	else if ((layerAttributes.viewID != ViewLayer::IconView) && modelPartShared->hasMultipleLayers(layerAttributes.viewID)) {
+		QString layerName = ViewLayer::viewLayerXmlNameFromID(layerAttributes.viewLayerID);
+		// need to treat create "virtual" svg file for each layer
+		SvgFileSplitter svgFileSplitter;
+		bool result;
+		if (flipDoc.isNull()) {
+			result = svgFileSplitter.split(filename, layerName);
+		}
+		else {
+			QString f = flipDoc.toString();
+			result = svgFileSplitter.splitString(f, layerName);
+		}
+		if (result) {
+			bytesToLoad = svgFileSplitter.byteArray();
+		}
+	}
+	else {
+		// only one layer, just load it directly
+		if (flipDoc.isNull()) {
+			QFile file(filename);
+			file.open(QFile::ReadOnly);
+			bytesToLoad = file.readAll();
+		}
+		else {
+			bytesToLoad = flipDoc.toByteArray();
+		}
+	}
+
+	return bytesToLoad;
+}
+
 void ItemBase::updateConnectionsAux(bool includeRatsnest, QList<ConnectorItem *> & already) {
 	//DebugDialog::debug("update connections");
 	foreach (ConnectorItem * connectorItem, cachedConnectorItems()) {
@@ -1437,6 +1603,28 @@ QString ItemBase::retrieveSvg(ViewLayer::ViewLayerID /* viewLayerID */,  QHash<Q
 	return "";
 }
 
+bool ItemBase::svgFragment(const QString & key, QString & svg) const
+{
+	QHash<QString, QString>::const_iterator it = m_svgFragments.constFind(key);
+	if (it == m_svgFragments.constEnd()) return false;
+
+	svg = it.value();
+	return true;
+}
+
+void ItemBase::cacheSvgFragment(const QString & key, const QString & svg)
+{
+	if (m_svgFragments.count() >= MaxSvgFragments && !m_svgFragments.contains(key)) {
+		m_svgFragments.clear();
+	}
+	m_svgFragments.insert(key, svg);
+}
+
+void ItemBase::clearSvgFragments()
+{
+	m_svgFragments.clear();
+}
+
 bool ItemBase::hasConnections()
 {
 	foreach (ConnectorItem * connectorItem, cachedConnectorItems()) {
@@ -1497,7 +1685,13 @@ bool ItemBase::isEverVisible() {
 }
 
 void ItemBase::setEverVisible(bool v) {
+	if (m_everVisible == v) return;
+
 	m_everVisible = v;
+	// routing status leaves invisible parts out of a net
+	foreach (ConnectorItem * connectorItem, cachedConnectorItems()) {
+		ConnectivityIndex::netChanged(connectorItem);
+	}
 }
 
 bool ItemBase::connectionIsAllowed(ConnectorItem * other) {
@@ -1560,6 +1754,7 @@ void ItemBase::setProp(const QString & prop, const QString & value) {
 
 	//DebugDialog::debug(QString("setting prop %1 %2").arg(prop).arg(value));
 	m_modelPart->setLocalProp(prop, value);
+	clearSvgFragments();
 }
 
 QString ItemBase::prop(const QString & p)
@@ -1698,6 +1893,7 @@ ViewLayer::ViewLayerPlacement ItemBase::viewLayerPlacement() const {
 
 void ItemBase::setViewLayerPlacement(ViewLayer::ViewLayerPlacement viewLayerPlacement) {
 	m_viewLayerPlacement = viewLayerPlacement;
+	clearSvgFragments();
 }
 
 ViewLayer::ViewLayerID ItemBase::partLabelViewLayerID() {
@@ -2007,6 +2203,7 @@ FSvgRenderer * ItemBase::fsvgRenderer() const {
 }
 
 void ItemBase::setSharedRendererEx(FSvgRenderer * newRenderer) {
+	clearSvgFragments();
 	if (newRenderer != m_fsvgRenderer) {
 		setSharedRenderer(newRenderer);  // original renderer is deleted if it is not shared
 		if (m_fsvgRenderer) delete m_fsvgRenderer;
@@ -2023,6 +2220,7 @@ bool ItemBase::reloadRenderer(const QString & svg, bool fastLoad) {
 	if (!svg.isEmpty()) {
 		//DebugDialog::debug(svg);
 		prepareGeometryChange();
+		clearSvgFragments();
 		bool result = fastLoad ? fsvgRenderer()->fastLoad(svg.toUtf8()) : fsvgRenderer()->loadSvgString(svg.toUtf8());
 		if (result) {
 			update();
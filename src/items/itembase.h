@@ -167,12 +167,16 @@ public:
 	virtual bool collectFemaleConnectees(QSet<ItemBase *> & items);
 	void prepareGeometryChange();
 	virtual void resetID();
+	void setID(qint64 id);
 	void updateConnectionsAux(bool includeRatsnest, QList<ConnectorItem *> & already);
 	void hoverEnterEvent( QGraphicsSceneHoverEvent * event );
 	void hoverLeaveEvent( QGraphicsSceneHoverEvent * event );
 	void contextMenuEvent(QGraphicsSceneContextMenuEvent *event);
 	virtual void figureHover();
 	virtual QString retrieveSvg(ViewLayer::ViewLayerID, QHash<QString, QString> & svgHash, bool blackOnly, double dpi, double & factor);
+	bool svgFragment(const QString & key, QString & svg) const;
+	void cacheSvgFragment(const QString & key, const QString & svg);
+	void clearSvgFragments();
 	virtual void slamZ(double newZ);
 	bool isEverVisible();
 	void setEverVisible(bool);
@@ -339,11 +343,13 @@ protected:
 	QPixmap * getPixmap(ViewLayer::ViewID, bool swappingEnabled, QSize size);
 	virtual ViewLayer::ViewID useViewIDForPixmap(ViewLayer::ViewID, bool swappingEnabled);
 	virtual bool makeLocalModifications(QByteArray & svg, const QString & filename);
+	bool paintCached(QPainter *, const QStyleOptionGraphicsItem *, QWidget *);
 	void updateHidden();
 	void createShape(LayerAttributes & layerAttributes);
 
 protected:
 	static bool getFlipDoc(ModelPart * modelPart, const QString & filename, ViewLayer::ViewLayerID viewLayerID, ViewLayer::ViewLayerPlacement, QDomDocument &, Qt::Orientations);
+	static QByteArray loadLayerSvg(ModelPart *, const QString & filename, const LayerAttributes &, bool & hasText);
 	static bool fixCopper1(ModelPart * modelPart, const QString & filename, ViewLayer::ViewLayerID viewLayerID, ViewLayer::ViewLayerPlacement, QDomDocument &);
 
 protected:
@@ -386,6 +392,7 @@ protected:
 	QList< QPointer<ItemBase> > m_subparts;
 	bool m_squashShape = false;
 	QPainterPath m_selectionShape;
+	QHash<QString, QString> m_svgFragments;			// renderToSVG output, keyed by layer and render settings
 
 protected:
 	static long nextID;
@@ -401,6 +408,11 @@ public:
 	const static double HoverOpacity;
 	const static QColor ConnectorHoverColor;
 	const static double ConnectorHoverOpacity;
+	static const QString RenderCacheSettingName;
+	static bool RenderCacheEnabled;
+	const static double OutlinePixels;
+	const static int MaxCachedPixels;
+	const static QColor OutlineColor;
 
 public:
 	static void initNames();
@@ -348,6 +348,8 @@ void Note::positionGrip() {
 	m_resizeGrip->setPos(p);
 	m_graphicsTextItem->setPos(TriangleOffset / 2, TriangleOffset / 2);
 	m_graphicsTextItem->setTextWidth(sz.width() - TriangleOffset);
+	// every change to m_rect ends up here, and the rect and text layout are what retrieveSvg draws
+	clearSvgFragments();
 }
 
 void Note::mousePressEvent(QGraphicsSceneMouseEvent * event) {
@@ -433,6 +435,7 @@ void Note::forceFormat(int position, int charsAdded) {
 void Note::contentsChangedSlot() {
 
 	//DebugDialog::debug(QString("contents changed ") + m_graphicsTextItem->document()->toPlainText());
+	clearSvgFragments();
 	if (m_charsAdded > 0) {
 		forceFormat(m_charsPosition, m_charsAdded);
 	}
@@ -487,6 +490,7 @@ void Note::setText(const QString & text, bool check) {
 	QString oldText = text;
 	m_graphicsTextItem->document()->setHtml(text);
 	connectSlots();
+	clearSvgFragments();
 
 	if (check) {
 		QSizeF newSize;
@@ -64,6 +64,7 @@ later:
 #include "../debugdialog.h"
 #include "../sketch/infographicsview.h"
 #include "../connectors/connectoritem.h"
+#include "../connectors/connectivityindex.h"
 #include "../connectors/svgidlayer.h"
 #include "../fsvgrenderer.h"
 #include "partlabel.h"
@@ -1350,6 +1351,10 @@ Wire * Wire::findTraced(ViewGeometry::WireFlags flags, QList<ConnectorItem *>  &
 
 void Wire::setWireFlags(ViewGeometry::WireFlags wireFlags) {
 	m_viewGeometry.setWireFlags(wireFlags);
+	// the flags decide which nets skip the wire
+	foreach (ConnectorItem * connectorItem, cachedConnectorItems()) {
+		ConnectivityIndex::changed(connectorItem);
+	}
 }
 
 double Wire::opacity() {
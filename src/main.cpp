@@ -129,27 +129,41 @@ int main(int argc, char *argv[])
 			     "\n"
 			     "User options:\n"
 			     "  -d, -debug                    run Fritzing in debug mode, providing additional debug information\n"
-			     //" drc filename : runs a design rule check on the given sketch file\n"
+			     "  -drc FOLDER                   run a design rule check on all sketches in FOLDER and write a JSON report to FOLDER/drc.json\n"
+			     "  -drcjobs N                    with -drc, check up to N sketches at once in separate processes\n"
+			     "  -drckeepout MILS              with -drc, use a keepout of MILS instead of each sketch's own setting\n"
+			     "  -drcreport FILE               with -drc, write the JSON report to FILE\n"
 			     "  -f, -folder FOLDER            use Fritzing parts, sketches, bins and translations in folders under FOLDER\n"
 			     "  -geda FOLDER                  convert all gEDA footprint (.fp) files in FOLDER to Fritzing SVGs\n"
-			     "  -g, -gerber FOLDER            export all sketches in FOLDER to Gerber, in the same folder\n"
+			     "  -g, -gerber FOLDER            export all sketches in FOLDER to Gerber, in the same folder, skipping sketches\n"
+			     "                                unchanged since the last run; a JSON summary goes to FOLDER/gerber.json\n"
+			     "  -gerberforce                  with -gerber, export every sketch even if it is unchanged\n"
+			     "  -gerberjobs N                 with -gerber, export up to N sketches at once in separate processes\n"
+			     "  -gerberreport FILE            with -gerber, read and write the JSON summary at FILE\n"
 			     "  -h, -help                     print this help message\n"
 			     "  -kicad FOLDER                 convert all Kicad footprint (.mod) files in FOLDER to Fritzing SVGs\n"
 			     "  -kicadschematic FOLDER        convert all Kicad schematic (.lib) files in FOLDER to Fritzing SVGs\n"
-			     "  -port NUMBER                  run Fritzing as a server process on port NUMBER\n"
+			     "  -port NUMBER FOLDER           run Fritzing as a server process on port NUMBER, converting sketches under FOLDER;\n"
+			     "                                GET /status returns queue and latency statistics as JSON\n"
+			     "  -portjobs N                   with -port, run up to N conversions at once in separate processes\n"
+			     "  -porttimeout SECONDS          with -port, fail a request with 504 after SECONDS (default 120, 0 for none)\n"
 			     "  -svg FOLDER                   export all sketches in FOLDER to SVGs of all views, in the same folder\n"
+			     "  -workertimeout SECONDS        with -drcjobs or -gerberjobs, give up on a sketch after SECONDS (default 600, 0 for none)\n"
 			     "\n"
 			     "Administrator option:\n"
 			     "  -db, -database FILE           rebuild the internal parts database FILE\n"
 			     "\n"
 			     "Developer options:\n"
+			     "  -autoroutebench FOLDER        autoroute every sketch in FOLDER and log routing times and search statistics\n"
+			     "  -ratsnestbench                time ratsnest spanning trees on random nets of 10 to 5000 pins\n"
 			     "  -e, -examples FOLDER          prepare all sketches in FOLDER to be included as examples\n"
 			     "  -ep FILE                      add menu item for external process using executable FILE\n"
 			     "  -eparg ARGS                   with -ep, external process arguments ARGS\n"
 			     "  -epname NAME                  with -ep, external process menu item NAME\n"
 			     "\n"
-			     "The -geda, -kicad, -kicadschematic, -gerber SVG options all exit Fritzing after the conversion process is complete;\n"
+			     "The -drc, -geda, -kicad, -kicadschematic, -gerber SVG options all exit Fritzing after the conversion process is complete;\n"
 			     "these options are mutually exclusive.\n"
+			     "To run -drc on a machine without a display, set the environment variable QT_QPA_PLATFORM=offscreen.\n"
 			     "\n"
 #ifndef PKGDATADIR
 			     "Usually, the Fritzing executable is stored in the same folder that contains the parts/bins/sketches/translations folders,\n"
@@ -38,6 +38,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QStyle>
 #include <QFontMetrics>
 #include <QApplication>
+#include <QtConcurrentRun>
 
 
 #include "mainwindow.h"
@@ -287,6 +288,16 @@ QString MainWindow::BackupFolder;
 
 QRegExp MainWindow::GuidMatcher = QRegExp("[A-Fa-f0-9]{32}");
 
+static bool saveBackup(const QString & path, const QByteArray & bytes) {
+	// runs off the gui thread, so there is no one to show the error to
+	QString error;
+	bool result = FolderUtils::saveFile(path, bytes, error);
+	if (!result) {
+		DebugDialog::debug(QString("unable to save backup '%1': %2").arg(path).arg(error));
+	}
+	return result;
+}
+
 /////////////////////////////////////////////
 
 MainWindow::MainWindow(ReferenceModel *referenceModel, QWidget * parent) :
@@ -553,6 +564,7 @@ void MainWindow::init(ReferenceModel *referenceModel, bool lockFiles) {
 MainWindow::~MainWindow()
 {
 	// Delete backup of this sketch if one exists.
+	m_backupFuture.waitForFinished();
 	QFile::remove(m_backupFileNameAndPath);
 
 	delete m_sketchModel;
@@ -2694,9 +2706,12 @@ void  MainWindow::backupSketch() {
 		ProcessEventBlocker::processEvents();
 		m_backingUp = true;
 		connectStartSave(true);
-		m_sketchModel->save(m_backupFileNameAndPath, false);
+		// only the serialization needs the model; the disk write happens off the gui thread
+		QByteArray bytes = m_sketchModel->saveToByteArray(m_backupFileNameAndPath, false);
 		connectStartSave(false);
 		m_backingUp = false;
+		m_backupFuture.waitForFinished();
+		m_backupFuture = QtConcurrent::run(saveBackup, m_backupFileNameAndPath, bytes);
 	}
 }
 
@@ -2719,6 +2734,7 @@ void MainWindow::autosaveNeeded(int index) {
 void MainWindow::undoStackCleanChanged(bool isClean) {
 	// DebugDialog::debug(QString("Clean status changed to %1").arg(isClean));
 	if (isClean) {
+		m_backupFuture.waitForFinished();
 		QFile::remove(m_backupFileNameAndPath);
 	}
 }
@@ -38,6 +38,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QStyle>
 #include <QStylePainter>
 #include <QPrinter>
+#include <QFuture>
 
 #include "fritzingwindow.h"
 #include "sketchareawidget.h"
@@ -249,6 +250,7 @@ public slots:
 	void acceptAlienFiles();
 	void statusMessage(QString message, int timeout);
 	void showPCBView();
+	void newAutoroute();
 	void groundFill();
 	void removeGroundFill();
 	void copperFill();
@@ -364,7 +366,6 @@ protected slots:
 	void setInfoViewOnHover(bool infoViewOnHover);
 	void updateItemMenu();
 
-	void newAutoroute();
 	void orderFab();
 	void activeLayerTop();
 	void activeLayerBottom();
@@ -923,6 +924,7 @@ protected:
 	QTimer m_fireQuoteTimer;
 	bool m_autosaveNeeded = false;
 	bool m_backingUp = false;
+	QFuture<bool> m_backupFuture;
 	QString m_bundledSketchName;
 	RoutingStatus m_routingStatus;
 	bool m_orderFabEnabled = false;
@@ -49,6 +49,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "../sketch/schematicsketchwidget.h"
 #include "../sketch/pcbsketchwidget.h"
 #include "../partsbinpalette/binmanager/binmanager.h"
+#include "../model/palettemodel.h"
 #include "../utils/expandinglabel.h"
 #include "../infoview/htmlinfoview.h"
 #include "../utils/bendpointaction.h"
@@ -4500,9 +4501,7 @@ void MainWindow::findPartInSketch() {
 			continue;
 		}
 
-		QList<ModelPart *> modelParts;
-		m_referenceModel->search(itemBase->modelPart(), strings, modelParts, true);
-		if (modelParts.count() > 0) {
+		if (PartsSearchIndex::matches(PaletteModel::searchDocument(itemBase->modelPart()), strings)) {
 			matched << itemBase;
 		}
 	}
@@ -834,6 +834,38 @@ bool ModelPartShared::showInLabel(const QString & propertyName) {
 	return m_displayKeys.contains(propertyName, Qt::CaseInsensitive);
 }
 
+void ModelPartShared::writeIndex(QDataStream & stream) {
+	// everything setDomDocument reads from the fzp; connectors are still read from the file on demand by initConnectors
+	stream << m_moduleID << m_fritzingVersion << m_title << m_label << m_version << m_author << m_description
+	       << m_url << m_taxonomy << m_date << m_replacedby << m_spice << m_spiceModel
+	       << m_tags << m_displayKeys << m_properties;
+
+	stream << (qint32) m_viewImages.count();
+	foreach (ViewImage * viewImage, m_viewImages.values()) {
+		stream << (qint32) viewImage->viewID << viewImage->layers << viewImage->sticky << viewImage->flipped
+		       << viewImage->image << viewImage->canFlipHorizontal << viewImage->canFlipVertical;
+	}
+}
+
+bool ModelPartShared::readIndex(QDataStream & stream) {
+	stream >> m_moduleID >> m_fritzingVersion >> m_title >> m_label >> m_version >> m_author >> m_description
+	       >> m_url >> m_taxonomy >> m_date >> m_replacedby >> m_spice >> m_spiceModel
+	       >> m_tags >> m_displayKeys >> m_properties;
+
+	qint32 count = 0;
+	stream >> count;
+	for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+		qint32 viewID;
+		stream >> viewID;
+		ViewImage * viewImage = new ViewImage((ViewLayer::ViewID) viewID);
+		stream >> viewImage->layers >> viewImage->sticky >> viewImage->flipped
+		       >> viewImage->image >> viewImage->canFlipHorizontal >> viewImage->canFlipVertical;
+		m_viewImages.insert(viewImage->viewID, viewImage);
+	}
+
+	return stream.status() == QDataStream::Ok && !m_moduleID.isEmpty();
+}
+
 const QList< QPointer<ModelPartShared> > & ModelPartShared::subparts() {
 	return m_subparts;
 }
@@ -28,6 +28,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QHash>
 #include <QDate>
 #include <QPointer>
+#include <QDataStream>
 
 #include "../viewlayer.h"
 
@@ -149,6 +150,8 @@ public:
 	void addOwner(QObject *);
 	void setSubpartOffset(QPointF);
 	QPointF subpartOffset() const;
+	void writeIndex(QDataStream &);
+	bool readIndex(QDataStream &);
 
 protected:
 	void loadTagText(QDomElement parent, QString tagName, QString &field);
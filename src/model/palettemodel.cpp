@@ -19,6 +19,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 ********************************************************************/
 
 #include "palettemodel.h"
+#include "partsindex.h"
 #include <QFile>
 #include <QMessageBox>
 #include <QApplication>
@@ -36,6 +37,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "../items/partfactory.h"
 
 QString PaletteModel::s_fzpOverrideFolder;
+const QString PaletteModel::PartsIndexFileName("partsindex.dat");
 
 const static QString InstanceTemplate(
     "\t\t<instance moduleIdRef=\"%1\" path=\"%2\">\n"
@@ -61,12 +63,14 @@ PaletteModel::PaletteModel() : ModelBase(true) {
 	m_loadedFromFile = false;
 	m_loadingContrib = false;
 	m_fullLoad = false;
+	m_partsIndex = nullptr;
 }
 
 PaletteModel::PaletteModel(bool makeRoot, bool doInit) : ModelBase( makeRoot ) {
 	m_loadedFromFile = false;
 	m_loadingContrib = false;
 	m_fullLoad = false;
+	m_partsIndex = nullptr;
 
 	if (doInit) {
 		initParts(false);
@@ -110,84 +114,131 @@ void PaletteModel::loadParts(bool dbExists) {
 	QStringList nameFilters;
 	nameFilters << "*" + FritzingPartExtension;
 
-	int totalPartCount = 0;
-	emit loadedPart(0, totalPartCount);
+	emit loadedPart(0, 0);
 
 	QDir dir1 = FolderUtils::getAppPartsSubFolder("");
 	QDir dir2(FolderUtils::getUserPartsPath());
 	QDir dir3(":/resources/parts");
 	QDir dir4(s_fzpOverrideFolder);
 
+	// one walk of the folders collects the files, and the total comes for free
+	QList<QFileInfo> files;
+	QList<bool> contrib;
 	if (m_fullLoad || !dbExists) {
 		// otherwise these will already be in the database
-		countParts(dir1, nameFilters, totalPartCount);
-		countParts(dir3, nameFilters, totalPartCount);
+		collectParts(dir1, nameFilters, files, contrib);
+		collectParts(dir3, nameFilters, files, contrib);
 	}
 
 	if (!m_fullLoad) {
 		// don't include local parts when doing full load
-		countParts(dir2, nameFilters, totalPartCount);
+		collectParts(dir2, nameFilters, files, contrib);
 		if (!s_fzpOverrideFolder.isEmpty()) {
-			countParts(dir4, nameFilters, totalPartCount);
+			collectParts(dir4, nameFilters, files, contrib);
 		}
+
+		// the core parts come from the database, the rest is cached in the parts index
+		m_partsIndex = new PartsIndex(FolderUtils::getTopLevelUserDataStorePath() + "/" + PartsIndexFileName);
+		m_partsIndex->load();
 	}
 
-	emit partsToLoad(totalPartCount);
+	emit partsToLoad(files.count());
 
-	int loadingPart = 0;
-	if (m_fullLoad || !dbExists) {
-		// otherwise these will already be in the database
-		loadPartsAux(dir1, nameFilters, loadingPart, totalPartCount);
-		loadPartsAux(dir3, nameFilters, loadingPart, totalPartCount);
+	for (int i = 0; i < files.count(); i++) {
+		m_loadingContrib = contrib.at(i);
+		//DebugDialog::debug(QString("part path:%1 core? %2").arg(path).arg(m_loadingCore? "true" : "false"));
+		loadPart(files.at(i).absoluteFilePath(), false);
+		emit loadedPart(i + 1, files.count());
 	}
+	m_loadingContrib = false;
 
-	if (!m_fullLoad) {
-		loadPartsAux(dir2, nameFilters, loadingPart, totalPartCount);
-		if (!s_fzpOverrideFolder.isEmpty()) {
-			loadPartsAux(dir4, nameFilters, loadingPart, totalPartCount);
-		}
+	if (m_partsIndex) {
+		m_partsIndex->prune();
+		m_partsIndex->save();
+		delete m_partsIndex;
+		m_partsIndex = nullptr;
 	}
 }
 
-void PaletteModel::countParts(QDir & dir, QStringList & nameFilters, int & partCount) {
-	QStringList list = dir.entryList(nameFilters, QDir::Files | QDir::NoSymLinks);
-	partCount += list.size();
+void PaletteModel::collectParts(QDir & dir, QStringList & nameFilters, QList<QFileInfo> & files, QList<bool> & contrib) {
+	bool isContrib = (dir.dirName() == "contrib");
+	foreach (QFileInfo fileInfo, dir.entryInfoList(nameFilters, QDir::Files | QDir::NoSymLinks)) {
+		files << fileInfo;
+		contrib << isContrib;
+	}
 
 	QStringList dirs = dir.entryList(QDir::AllDirs | QDir::NoSymLinks | QDir::NoDotAndDotDot);
 	for (int i = 0; i < dirs.size(); ++i) {
 		QString temp2 = dirs[i];
 		dir.cd(temp2);
 
-		countParts(dir, nameFilters, partCount);
+		collectParts(dir, nameFilters, files, contrib);
 		dir.cdUp();
 	}
 }
 
-void PaletteModel::loadPartsAux(QDir & dir, QStringList & nameFilters, int & loadingPart, int totalPartCount) {
-	//QString temp = dir.absolutePath();
-	QFileInfoList list = dir.entryInfoList(nameFilters, QDir::Files | QDir::NoSymLinks);
-	for (int i = 0; i < list.size(); ++i) {
-		QFileInfo fileInfo = list.at(i);
-		QString path = fileInfo.absoluteFilePath ();
-		//DebugDialog::debug(QString("part path:%1 core? %2").arg(path).arg(m_loadingCore? "true" : "false"));
-		loadPart(path, false);
-		emit loadedPart(++loadingPart, totalPartCount);
-		//DebugDialog::debug("loadedok");
+ModelPart * PaletteModel::loadPart(const QString & path, bool update) {
+	QFileInfo info(path);
+	QDomDocument domDocument;
+	ModelPart * modelPart = (m_partsIndex == nullptr) ? nullptr : m_partsIndex->find(info);
+	if (modelPart == nullptr) {
+		modelPart = parsePart(path, domDocument);
+		if (modelPart == nullptr) return nullptr;
 	}
 
-	QStringList dirs = dir.entryList(QDir::AllDirs | QDir::NoSymLinks | QDir::NoDotAndDotDot);
-	for (int i = 0; i < dirs.size(); ++i) {
-		QString temp2 = dirs[i];
-		dir.cd(temp2);
+	QString moduleID = modelPart->moduleID();
+	if (path.startsWith(ResourcePath)) {
+		modelPart->setCore(true);
+	}
+	else if (onCoreList(moduleID)) {
+		// for database entries which have existing fzp files.
+		modelPart->setCore(true);
+	}
+
+	modelPart->setContrib(m_loadingContrib);
 
-		m_loadingContrib = (temp2 == "contrib");
+	bool hasSubparts = false;
+	QDomElement subparts = domDocument.documentElement().firstChildElement("schematic-subparts");
+	QDomElement subpart = subparts.firstChildElement("subpart");
+	while (!subpart.isNull()) {
+		hasSubparts = true;
+		ModelPart * subModelPart = makeSubpart(modelPart, subpart);
+		m_partHash.insert(subModelPart->moduleID(), subModelPart);
+		subpart = subpart.nextSiblingElement("subpart");
+	}
 
-		loadPartsAux(dir, nameFilters, loadingPart, totalPartCount);
-		dir.cdUp();
+	if (m_partsIndex && !domDocument.isNull() && !hasSubparts) {
+		// subparts are built from the dom, so those parts are always parsed
+		m_partsIndex->insert(info, modelPart);
 	}
+
+	if (m_partHash.value(moduleID, NULL)) {
+		if(!update) {
+			FMessageBox::warning(NULL, QObject::tr("Fritzing"),
+			                     QObject::tr("The part '%1' at '%2' does not have a unique module id '%3'.")
+			                     .arg(modelPart->title())
+			                     .arg(path)
+			                     .arg(moduleID));
+			return NULL;
+		} else {
+			m_partHash[moduleID]->copyStuff(modelPart);
+			m_searchIndex.clear();
+		}
+	} else {
+		m_partHash.insert(moduleID, modelPart);
+	}
+
+	if (m_root == NULL) {
+		m_root = modelPart;
+	}
+	else {
+		modelPart->setParent(m_root);
+	}
+
+	return modelPart;
 }
 
-ModelPart * PaletteModel::loadPart(const QString & path, bool update) {
+ModelPart * PaletteModel::parsePart(const QString & path, QDomDocument & domDocument) {
 
 	QFile file(path);
 	if (!file.open(QFile::ReadOnly | QFile::Text)) {
@@ -208,7 +259,6 @@ ModelPart * PaletteModel::loadPart(const QString & path, bool update) {
 	QString errorStr;
 	int errorLine;
 	int errorColumn;
-	QDomDocument domDocument;
 	if (!domDocument.setContent(&file, true, &errorStr, &errorLine, &errorColumn)) {
 		FMessageBox::information(NULL, QObject::tr("Fritzing"),
 		                         QObject::tr("Parse error (2) at line %1, column %2:\n%3\n%4")
@@ -309,50 +359,7 @@ ModelPart * PaletteModel::loadPart(const QString & path, bool update) {
 		}
 	}
 
-	ModelPart * modelPart = new ModelPart(domDocument, path, type);
-	if (!modelPart) return nullptr;
-
-	if (path.startsWith(ResourcePath)) {
-		modelPart->setCore(true);
-	}
-	else if (onCoreList(moduleID)) {
-		// for database entries which have existing fzp files.
-		modelPart->setCore(true);
-	}
-
-	modelPart->setContrib(m_loadingContrib);
-
-	QDomElement subparts = root.firstChildElement("schematic-subparts");
-	QDomElement subpart = subparts.firstChildElement("subpart");
-	while (!subpart.isNull()) {
-		ModelPart * subModelPart = makeSubpart(modelPart, subpart);
-		m_partHash.insert(subModelPart->moduleID(), subModelPart);
-		subpart = subpart.nextSiblingElement("subpart");
-	}
-
-	if (m_partHash.value(moduleID, NULL)) {
-		if(!update) {
-			FMessageBox::warning(NULL, QObject::tr("Fritzing"),
-			                     QObject::tr("The part '%1' at '%2' does not have a unique module id '%3'.")
-			                     .arg(modelPart->title())
-			                     .arg(path)
-			                     .arg(moduleID));
-			return NULL;
-		} else {
-			m_partHash[moduleID]->copyStuff(modelPart);
-		}
-	} else {
-		m_partHash.insert(moduleID, modelPart);
-	}
-
-	if (m_root == NULL) {
-		m_root = modelPart;
-	}
-	else {
-		modelPart->setParent(m_root);
-	}
-
-	return modelPart;
+	return new ModelPart(domDocument, path, type);
 }
 
 bool PaletteModel::loadFromFile(const QString & fileName, ModelBase * referenceModel, bool checkViews) {
@@ -409,6 +416,7 @@ void PaletteModel::removePart(const QString &moduleID) {
 	}
 	if(mpToRemove) {
 		mpToRemove->setParent(NULL);
+		m_searchIndex.clear();
 
 		delete mpToRemove;
 	}
@@ -426,6 +434,7 @@ void PaletteModel::removeParts() {
 		modelParts.append(modelPart);
 	}
 
+	m_searchIndex.clear();
 	foreach(ModelPart * modelPart, modelParts) {
 		modelPart->setParent(NULL);
 		m_partHash.remove(modelPart->moduleID());
@@ -434,6 +443,7 @@ void PaletteModel::removeParts() {
 }
 
 void PaletteModel::clearPartHash() {
+	m_searchIndex.clear();
 	foreach (ModelPart * modelPart, m_partHash.values()) {
 		ModelPartShared * modelPartShared = modelPart->modelPartShared();
 		if (modelPartShared) {
@@ -450,84 +460,46 @@ void PaletteModel::setOrdererChildren(QList<QObject*> children) {
 	m_root->setOrderedChildren(children);
 }
 
-QList<ModelPart *> PaletteModel::search(const QString & searchText, bool allowObsolete) {
+QList<ModelPart *> PaletteModel::search(const QString & searchText, bool allowObsolete, int limit) {
+	// parts can be added to or dropped from the tree behind our back, so compare what is indexed with what is there
 	QList<ModelPart *> modelParts;
-
-	QStringList strings = searchText.split(" ");
-	search(m_root, strings, modelParts, allowObsolete);
-	return modelParts;
-}
-
-void PaletteModel::search(ModelPart * modelPart, const QStringList & searchStrings, QList<ModelPart *> & modelParts, bool allowObsolete) {
-	// TODO: eventually move all this into the database?
-	// or use lucene
-	// or google search api
-
-	int count = 0;
-	foreach (QString searchString, searchStrings) {
-		bool gotOne = false;
-		if (modelPart->title().contains(searchString, Qt::CaseInsensitive)) {
-			gotOne = true;
-		}
-		else if (modelPart->description().contains(searchString, Qt::CaseInsensitive)) {
-			gotOne = true;
+	if (m_root) {
+		collectSearchable(m_root, modelParts);
+	}
+	if (!m_searchIndex.isBuiltFrom(modelParts)) {
+		QVector<PartsSearchIndex::Document> documents;
+		documents.reserve(modelParts.count());
+		foreach (ModelPart * modelPart, modelParts) {
+			documents.append(searchDocument(modelPart));
 		}
-		else if (modelPart->url().contains(searchString, Qt::CaseInsensitive)) {
-			gotOne = true;
-		}
-		else if (modelPart->author().contains(searchString, Qt::CaseInsensitive)) {
-			gotOne = true;
-		}
-		else if (modelPart->moduleID().contains(searchString, Qt::CaseInsensitive)) {
-			gotOne = true;
-		}
-		else {
-			foreach (QString string, modelPart->tags()) {
-				if (string.contains(searchString, Qt::CaseInsensitive)) {
-					gotOne = true;
-					break;
-				}
-			}
-		}
-		if (!gotOne) {
-			foreach (QString string, modelPart->properties().values()) {
-				if (string.contains(searchString, Qt::CaseInsensitive)) {
-					gotOne = true;
-					break;
-				}
-			}
-		}
-		if (!gotOne) {
-			foreach (QString string, modelPart->properties().keys()) {
-				if (string.contains(searchString, Qt::CaseInsensitive)) {
-					gotOne = true;
-					break;
-				}
-			}
-		}
-		if (!gotOne) break;
-
-		count++;
+		m_searchIndex.build(documents);
 	}
 
-	if ((count == searchStrings.count()) && !modelParts.contains(modelPart)) {
-		if (!allowObsolete && modelPart->isObsolete()) {
-		}
-		else
-		{
-			modelParts.append(modelPart);
-			emit addSearchMaximum(1);
-		}
-	}
+	return m_searchIndex.search(searchText, allowObsolete, limit);
+}
 
-	emit addSearchMaximum(modelPart->children().count());
+PartsSearchIndex::Document PaletteModel::searchDocument(ModelPart * modelPart) {
+	PartsSearchIndex::Document document;
+	document.modelPart = modelPart;
+	document.fields[PartsSearchIndex::Title] = modelPart->title();
+	document.fields[PartsSearchIndex::Tags] = modelPart->tags().join("\n");
+	document.fields[PartsSearchIndex::ModuleID] = modelPart->moduleID();
+	document.fields[PartsSearchIndex::PropertyValues] = QStringList(modelPart->properties().values()).join("\n");
+	document.fields[PartsSearchIndex::Description] = modelPart->description();
+	document.fields[PartsSearchIndex::PropertyKeys] = QStringList(modelPart->properties().keys()).join("\n");
+	document.fields[PartsSearchIndex::Author] = modelPart->author();
+	document.fields[PartsSearchIndex::Url] = modelPart->url();
+	document.obsolete = modelPart->isObsolete();
+	return document;
+}
 
+void PaletteModel::collectSearchable(ModelPart * modelPart, QList<ModelPart *> & modelParts) {
+	modelParts.append(modelPart);
 	foreach(QObject * child, modelPart->children()) {
 		ModelPart * mp = qobject_cast<ModelPart *>(child);
 		if (mp == NULL) continue;
 
-		search(mp, searchStrings, modelParts, allowObsolete);
-		emit incSearch();
+		collectSearchable(mp, modelParts);
 	}
 }
 
@@ -23,6 +23,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "modelpart.h"
 #include "modelbase.h"
+#include "partssearchindex.h"
 
 #include <QDomDocument>
 #include <QList>
@@ -47,14 +48,15 @@ public:
 	ModelPart * addPart(QString newPartPath, bool addToReference, bool updateIdAlreadyExists);
 	void removePart(const QString &moduleID);
 	void removeParts();
-	QList<ModelPart *> search(const QString & searchText, bool allowObsolete);
+	QList<ModelPart *> search(const QString & searchText, bool allowObsolete, int limit = -1);
 
 	void clearPartHash();
 	void setOrdererChildren(QList<QObject*> children);
-	void search(ModelPart * modelPart, const QStringList & searchStrings, QList<ModelPart *> & modelParts, bool allowObsolete);
 	QList<ModelPart *> findContribNoBin();
 	QList<ModelPart *> allParts();
 
+	static PartsSearchIndex::Document searchDocument(ModelPart *);
+
 protected:
 	QHash<QString, ModelPart *> m_partHash;
 	bool m_loadedFromFile;
@@ -62,24 +64,27 @@ protected:
 
 	bool m_loadingContrib;
 	bool m_fullLoad;
+	class PartsIndex * m_partsIndex;		// only while loadParts runs
+	PartsSearchIndex m_searchIndex;			// built on the first search after the parts change
 
 signals:
 	void loadedPart(int i, int total);
-	void incSearch();
-	void addSearchMaximum(int);
 	void partsToLoad(int total);
 
 protected:
 	virtual void initParts(bool dbExists);
 	void loadParts(bool dbExists);
-	void loadPartsAux(QDir & dir, QStringList & nameFilters, int & loadedPart, int totalParts);
-	void countParts(QDir & dir, QStringList & nameFilters, int & partCount);
+	void collectParts(QDir & dir, QStringList & nameFilters, QList<QFileInfo> & files, QList<bool> & contrib);
+	ModelPart * parsePart(const QString & path, QDomDocument &);
 	ModelPart * makeSubpart(ModelPart * originalModelPart, const QDomElement & originalSubparth);
+	void collectSearchable(ModelPart * modelPart, QList<ModelPart *> & modelParts);
 
 public:
 	static void initNames();
 	static void setFzpOverrideFolder(const QString &);
 
+	static const QString PartsIndexFileName;
+
 protected:
 	static QString s_fzpOverrideFolder;
 
@@ -0,0 +1,161 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+
+#include "partsindex.h"
+#include "modelpartshared.h"
+#include "../debugdialog.h"
+#include "../version/version.h"
+#include "../utils/folderutils.h"
+
+#include <QFile>
+#include <QDataStream>
+#include <QDateTime>
+
+const quint32 PartsIndex::Magic = 0x46505849;		// "FPXI"
+const qint32 PartsIndex::FormatVersion = 1;
+
+PartsIndex::PartsIndex(const QString & indexPath)
+{
+	m_indexPath = indexPath;
+	m_dirty = false;
+}
+
+bool PartsIndex::load()
+{
+	m_entries.clear();
+
+	QFile file(m_indexPath);
+	if (!file.open(QIODevice::ReadOnly)) return false;
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_0);
+
+	quint32 magic;
+	qint32 formatVersion;
+	QString appVersion;
+	stream >> magic >> formatVersion >> appVersion;
+	if (magic != Magic || formatVersion != FormatVersion || appVersion != Version::versionString()) {
+		// parse everything again after an upgrade, since the fzp loading code may have changed
+		m_dirty = true;
+		return false;
+	}
+
+	qint32 count;
+	stream >> count;
+	for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+		QString path;
+		Entry entry;
+		stream >> path >> entry.modified >> entry.size >> entry.data;
+		entry.used = false;
+		m_entries.insert(path, entry);
+	}
+
+	if (stream.status() != QDataStream::Ok) {
+		DebugDialog::debug(QString("parts index '%1' is corrupt").arg(m_indexPath));
+		m_entries.clear();
+		m_dirty = true;
+		return false;
+	}
+
+	return true;
+}
+
+bool PartsIndex::save()
+{
+	if (!m_dirty) return true;
+
+	QByteArray bytes;
+	QDataStream stream(&bytes, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_5_0);
+	stream << Magic << FormatVersion << Version::versionString();
+	stream << (qint32) m_entries.count();
+	foreach (QString path, m_entries.keys()) {
+		const Entry & entry = m_entries[path];
+		stream << path << entry.modified << entry.size << entry.data;
+	}
+
+	QString error;
+	if (!FolderUtils::saveFile(m_indexPath, bytes, error)) {
+		DebugDialog::debug(QString("unable to save parts index '%1': %2").arg(m_indexPath).arg(error));
+		return false;
+	}
+
+	m_dirty = false;
+	return true;
+}
+
+ModelPart * PartsIndex::find(const QFileInfo & info)
+{
+	QHash<QString, Entry>::iterator it = m_entries.find(info.absoluteFilePath());
+	if (it == m_entries.end()) return nullptr;
+
+	if (it->modified != info.lastModified().toMSecsSinceEpoch() || it->size != info.size()) return nullptr;
+
+	QDataStream stream(it->data);
+	stream.setVersion(QDataStream::Qt_5_0);
+	qint32 type;
+	stream >> type;
+
+	ModelPartShared * modelPartShared = new ModelPartShared();
+	if (!modelPartShared->readIndex(stream)) {
+		delete modelPartShared;
+		return nullptr;
+	}
+
+	modelPartShared->setPath(info.absoluteFilePath());
+	ModelPart * modelPart = new ModelPart((ModelPart::ItemType) type);
+	modelPart->setModelPartShared(modelPartShared);
+	it->used = true;
+	return modelPart;
+}
+
+void PartsIndex::insert(const QFileInfo & info, ModelPart * modelPart)
+{
+	ModelPartShared * modelPartShared = modelPart->modelPartShared();
+	if (modelPartShared == nullptr) return;
+
+	Entry entry;
+	entry.modified = info.lastModified().toMSecsSinceEpoch();
+	entry.size = info.size();
+	entry.used = true;
+	QDataStream stream(&entry.data, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_5_0);
+	stream << (qint32) modelPart->itemType();
+	modelPartShared->writeIndex(stream);
+
+	m_entries.insert(info.absoluteFilePath(), entry);
+	m_dirty = true;
+}
+
+void PartsIndex::prune()
+{
+	// drop entries for files that were deleted or moved
+	QHash<QString, Entry>::iterator it = m_entries.begin();
+	while (it != m_entries.end()) {
+		if (it->used) {
+			++it;
+			continue;
+		}
+
+		it = m_entries.erase(it);
+		m_dirty = true;
+	}
+}
@@ -18,39 +18,46 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 
 ********************************************************************/
 
-#ifndef SVGPATHRUNNER_H
-#define SVGPATHRUNNER_H
 
-#include <QVariant>
-#include <QVector>
+#ifndef PARTSINDEX_H
+#define PARTSINDEX_H
 
-struct PathCommand {
-	bool relative;
-	int argCount;
-	QChar command;
-};
-
-class SVGPathRunner : public QObject
-{
-	Q_OBJECT
+#include <QString>
+#include <QHash>
+#include <QByteArray>
+#include <QFileInfo>
 
-public:
-	SVGPathRunner();
-	~SVGPathRunner();
+#include "modelpart.h"
 
+// a binary cache of what PaletteModel::loadPart extracts from each .fzp, so that startup
+// only parses the files whose modification time or size changed since the last run
+class PartsIndex
+{
 public:
-	bool runPath(QVector<QVariant> & pathData, void * userData);
+	PartsIndex(const QString & indexPath);
 
-signals:
-	// note: must connect to this signal via Qt::DirectConnection since args is modified immediately after the signal
-	void commandSignal(QChar command, bool relative, QList<double> & args, void * userData);
+	bool load();
+	bool save();
+	ModelPart * find(const QFileInfo &);
+	void insert(const QFileInfo &, ModelPart *);
+	void prune();
 
 protected:
-	static void initStates();
+	struct Entry {
+		qint64 modified;
+		qint64 size;
+		QByteArray data;
+		bool used;
+	};
 
 protected:
-	static QHash<QChar, PathCommand *> pathCommands;
+	QString m_indexPath;
+	QHash<QString, Entry> m_entries;
+	bool m_dirty;
 
+public:
+	static const quint32 Magic;
+	static const qint32 FormatVersion;
 };
 
-#endif // SVGPATHRUNNER_H
+#endif
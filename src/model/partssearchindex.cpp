@@ -0,0 +1,241 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "partssearchindex.h"
+
+#include <QSet>
+#include <algorithm>
+#include <iterator>
+
+const double PartsSearchIndex::FieldWeights[PartsSearchIndex::FieldCount] = {
+	10,		// Title
+	6,		// Tags
+	4,		// ModuleID
+	4,		// PropertyValues
+	2,		// Description
+	1,		// PropertyKeys
+	1,		// Author
+	1		// Url
+};
+
+static const int GramSize = 3;
+
+struct ScoredDocument {
+	double score;
+	int index;
+	QString sortTitle;
+};
+
+static bool byScore(const ScoredDocument & sd1, const ScoredDocument & sd2) {
+	if (sd1.score != sd2.score) return sd1.score > sd2.score;
+
+	return sd1.sortTitle < sd2.sortTitle;
+}
+
+static bool byLongest(const QString & s1, const QString & s2) {
+	return s1.length() > s2.length();
+}
+
+static bool byShortest(const QVector<int> * v1, const QVector<int> * v2) {
+	return v1->count() < v2->count();
+}
+
+///////////////////////////////////////////////
+
+PartsSearchIndex::PartsSearchIndex()
+{
+}
+
+void PartsSearchIndex::clear() {
+	m_modelParts.clear();
+	m_documents.clear();
+	m_postings.clear();
+}
+
+bool PartsSearchIndex::isBuiltFrom(const QList<ModelPart *> & modelParts) const {
+	return !m_modelParts.isEmpty() && m_modelParts == modelParts;
+}
+
+void PartsSearchIndex::build(const QVector<Document> & documents) {
+	clear();
+	m_documents.reserve(documents.count());
+	foreach (Document document, documents) {
+		m_modelParts.append(document.modelPart);
+		addDocument(document);
+	}
+}
+
+void PartsSearchIndex::foldCase(Document & document) {
+	for (int f = 0; f < FieldCount; f++) {
+		document.fields[f] = document.fields[f].toCaseFolded();
+	}
+}
+
+void PartsSearchIndex::addDocument(Document document) {
+	foldCase(document);
+
+	int index = m_documents.count();
+	QSet<quint64> grams;
+	for (int f = 0; f < FieldCount; f++) {
+		const QString & text = document.fields[f];
+		for (int i = 0; i + GramSize <= text.length(); i++) {
+			grams.insert(trigram(text.constData() + i));
+		}
+	}
+	foreach (quint64 gram, grams) {
+		m_postings[gram].append(index);
+	}
+
+	m_documents.append(document);
+}
+
+QList<ModelPart *> PartsSearchIndex::search(const QString & searchText, bool allowObsolete, int limit) const {
+	QStringList terms = searchText.toCaseFolded().split(" ", QString::SkipEmptyParts);
+	terms.removeDuplicates();
+
+	// every term has to match somewhere, so narrow with the most selective (longest) terms first
+	QVector<int> matches;
+	bool narrowed = false;
+	QStringList byLength = terms;
+	std::sort(byLength.begin(), byLength.end(), byLongest);
+	foreach (QString term, byLength) {
+		if (term.length() < GramSize) break;
+
+		QVector<int> found = candidates(term);
+		if (narrowed) {
+			QVector<int> both;
+			std::set_intersection(matches.constBegin(), matches.constEnd(), found.constBegin(), found.constEnd(), std::back_inserter(both));
+			matches = both;
+		}
+		else {
+			matches = found;
+			narrowed = true;
+		}
+		if (matches.isEmpty()) return QList<ModelPart *>();
+	}
+
+	if (!narrowed) {
+		// short terms have no trigrams; check every part
+		matches.resize(m_documents.count());
+		for (int i = 0; i < matches.count(); i++) matches[i] = i;
+	}
+
+	QList<ScoredDocument> scored;
+	foreach (int index, matches) {
+		const Document & document = m_documents.at(index);
+		if (!allowObsolete && document.obsolete) continue;
+
+		// trigrams only propose candidates; the substring test decides
+		double total = 0;
+		foreach (QString term, terms) {
+			double s = score(document, term);
+			if (s == 0) {
+				total = -1;
+				break;
+			}
+			total += s;
+		}
+		if (total < 0) continue;
+
+		ScoredDocument sd;
+		sd.score = total;
+		sd.index = index;
+		sd.sortTitle = document.fields[Title];
+		scored.append(sd);
+	}
+
+	if (limit >= 0 && limit < scored.count()) {
+		// only the best few are shown while typing, so don't order the rest
+		std::partial_sort(scored.begin(), scored.begin() + limit, scored.end(), byScore);
+		scored.erase(scored.begin() + limit, scored.end());
+	}
+	else {
+		std::sort(scored.begin(), scored.end(), byScore);
+	}
+
+	QList<ModelPart *> modelParts;
+	foreach (ScoredDocument sd, scored) {
+		modelParts.append(m_documents.at(sd.index).modelPart);
+	}
+
+	return modelParts;
+}
+
+bool PartsSearchIndex::matches(const Document & unfolded, const QStringList & terms) {
+	// a single part needs no index: just the substring test search() verifies its candidates with
+	Document document = unfolded;
+	foldCase(document);
+	foreach (QString term, terms) {
+		if (score(document, term.toCaseFolded()) == 0) return false;
+	}
+
+	return true;
+}
+
+QVector<int> PartsSearchIndex::candidates(const QString & term) const {
+	QList<const QVector<int> *> lists;
+	for (int i = 0; i + GramSize <= term.length(); i++) {
+		QHash<quint64, QVector<int> >::const_iterator it = m_postings.constFind(trigram(term.constData() + i));
+		if (it == m_postings.constEnd()) return QVector<int>();
+
+		lists.append(&it.value());
+	}
+
+	std::sort(lists.begin(), lists.end(), byShortest);
+
+	QVector<int> result = *lists.first();
+	for (int i = 1; i < lists.count() && !result.isEmpty(); i++) {
+		QVector<int> both;
+		std::set_intersection(result.constBegin(), result.constEnd(), lists.at(i)->constBegin(), lists.at(i)->constEnd(), std::back_inserter(both));
+		result = both;
+	}
+
+	return result;
+}
+
+double PartsSearchIndex::score(const Document & document, const QString & term) {
+	// the field weight, tripled for a whole-word match and doubled for a match at the start of a word
+	double best = 0;
+	for (int f = 0; f < FieldCount; f++) {
+		const QString & text = document.fields[f];
+		int pos = text.indexOf(term);
+		if (pos < 0) continue;
+
+		int factor = 1;
+		while (pos >= 0 && factor < 3) {
+			bool starts = (pos == 0 || !isWordChar(text.at(pos - 1)));
+			bool ends = (pos + term.length() == text.length() || !isWordChar(text.at(pos + term.length())));
+			if (starts) factor = qMax(factor, ends ? 3 : 2);
+			pos = text.indexOf(term, pos + 1);
+		}
+
+		best = qMax(best, FieldWeights[f] * factor);
+	}
+
+	return best;
+}
+
+quint64 PartsSearchIndex::trigram(const QChar * chars) {
+	return (quint64(chars[0].unicode()) << 32) | (quint64(chars[1].unicode()) << 16) | quint64(chars[2].unicode());
+}
+
+bool PartsSearchIndex::isWordChar(QChar c) {
+	return c.isLetterOrNumber();
+}
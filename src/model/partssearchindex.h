@@ -0,0 +1,85 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef PARTSSEARCHINDEX_H
+#define PARTSSEARCHINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QHash>
+
+class ModelPart;
+
+// a trigram inverted index over the searchable text of the parts in a PaletteModel;
+// it matches terms the same way the old tree walk did (case-insensitive substring of any field),
+// but only verifies the parts whose text contains every trigram of the term, and ranks the results
+class PartsSearchIndex
+{
+public:
+	PartsSearchIndex();
+
+	enum Field {
+		Title,
+		Tags,
+		ModuleID,
+		PropertyValues,
+		Description,
+		PropertyKeys,
+		Author,
+		Url,
+		FieldCount
+	};
+
+	// the searchable text of one part; multi-valued fields are joined with newlines
+	struct Document {
+		ModelPart * modelPart;
+		QString fields[FieldCount];
+		bool obsolete;
+	};
+
+	void build(const QVector<Document> &);
+	void clear();
+	bool isBuiltFrom(const QList<ModelPart *> &) const;
+	QList<ModelPart *> search(const QString & searchText, bool allowObsolete, int limit = -1) const;		// limit < 0 returns every match
+
+	static bool matches(const Document &, const QStringList & terms);
+
+protected:
+	void addDocument(Document);
+	QVector<int> candidates(const QString & term) const;
+
+	static void foldCase(Document &);
+	static double score(const Document &, const QString & term);
+
+	static quint64 trigram(const QChar *);
+	static bool isWordChar(QChar);
+
+protected:
+	QList<ModelPart *> m_modelParts;
+	QVector<Document> m_documents;					// case folded
+	QHash<quint64, QVector<int> > m_postings;		// trigram => ascending document indexes
+
+public:
+	static const double FieldWeights[FieldCount];
+};
+
+#endif
@@ -901,18 +901,13 @@ void BinManager::initNames() {
 	StandardBinIcons.insert(BinManager::CorePartsBinLocation, "Core.png");
 }
 
-void BinManager::search(const QString & searchText) {
+void BinManager::search(const QString & searchText, int limit) {
 	PartsBinPaletteWidget * searchBin = getOrOpenSearchBin();
 	if (searchBin == NULL) return;
 
-	FileProgressDialog progress(tr("Searching..."), 0, this);
-	progress.setIncValueMod(10);
-	connect(m_referenceModel, SIGNAL(addSearchMaximum(int)), &progress, SLOT(addMaximum(int)));
-	connect(m_referenceModel, SIGNAL(incSearch()), &progress, SLOT(incValue()));
+	// the reference model answers from its search index, fast enough to run as the user types
+	QList<ModelPart *> modelParts = m_referenceModel->search(searchText, false, limit);
 
-	QList<ModelPart *> modelParts = m_referenceModel->search(searchText, false);
-
-	progress.setIncValueMod(1);
 	searchBin->removeParts();
 	foreach (ModelPart * modelPart, modelParts) {
 		//DebugDialog::debug(modelPart->title());
@@ -923,7 +918,6 @@ void BinManager::search(const QString & searchText) {
 		else {
 			this->addPartTo(searchBin, modelPart, false);
 		}
-		progress.incValue();
 	}
 
 	setDirtyTab(searchBin);
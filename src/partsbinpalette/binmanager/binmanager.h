@@ -93,7 +93,7 @@ public:
 	QList<QAction*> openedBinsActions(const QString &moduleId);
 
 	MainWindow* mainWindow();
-	void search(const QString & searchText);
+	void search(const QString & searchText, int limit = -1);
 	bool currentViewIsIconView();
 	void updateViewChecks(bool iconView);
 	QMenu * binContextMenu(PartsBinPaletteWidget *);
@@ -55,6 +55,10 @@ static QHash<QString, PaletteModel *> PaletteBinModels;
 
 static QIcon EmptyIcon;
 
+static const int LiveSearchDelay = 250;			// ms of typing pause before searching
+static const int LiveSearchMinimum = 3;			// shorter text only searches on return
+static const int LiveSearchLimit = 100;			// best matches shown while typing; return shows them all
+
 //////////////////////////////////////////////
 
 PartsBinPaletteWidget::PartsBinPaletteWidget(ReferenceModel *referenceModel, HtmlInfoView *infoView, WaitPushUndoStack *undoStack, BinManager* manager) :
@@ -186,6 +190,11 @@ void PartsBinPaletteWidget::setupHeader()
 	m_searchLineEdit = new SearchLineEdit(this);
 	m_searchLineEdit->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
 	connect(m_searchLineEdit, SIGNAL(returnPressed()), this, SLOT(search()));
+	connect(m_searchLineEdit, SIGNAL(textEdited(const QString &)), this, SLOT(searchTextEdited(const QString &)));
+
+	m_searchTimer.setSingleShot(true);
+	m_searchTimer.setInterval(LiveSearchDelay);
+	connect(&m_searchTimer, SIGNAL(timeout()), this, SLOT(search()));
 
 	m_searchStackedWidget = new QStackedWidget(this);
 	m_searchStackedWidget->setObjectName("searchStackedWidget");
@@ -778,19 +787,33 @@ void PartsBinPaletteWidget::setFilename(const QString &filename) {
 	m_listView->setAcceptDrops(acceptIt);
 }
 
+void PartsBinPaletteWidget::searchTextEdited(const QString & text) {
+	if (text.trimmed().length() < LiveSearchMinimum) {
+		m_searchTimer.stop();
+		return;
+	}
+
+	m_searchTimer.start();
+}
+
 void PartsBinPaletteWidget::search() {
-	SearchLineEdit * edit = qobject_cast<SearchLineEdit *>(sender());
-	if (edit == NULL) return;
+	if (m_searchLineEdit == NULL) return;
 
-	QString searchText = edit->text();
+	bool live = (sender() == &m_searchTimer);
+	m_searchTimer.stop();
+
+	QString searchText = m_searchLineEdit->text();
 	if (searchText.isEmpty()) return;
+	if (live && searchText == m_lastSearchText) return;
+
+	m_lastSearchText = searchText;
 
 	ModelPartSharedRoot * root = m_model->rootModelPartShared();
 	if (root) {
 		root->setSearchTerm(searchText);
 	}
 
-	m_manager->search(searchText);
+	m_manager->search(searchText, live ? LiveSearchLimit : -1);
 }
 
 bool PartsBinPaletteWidget::allowsChanges() {
@@ -26,6 +26,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QToolButton>
 #include <QLineEdit>
 #include <QStackedWidget>
+#include <QTimer>
 
 #include "../model/palettemodel.h"
 #include "../model/modelpart.h"
@@ -110,6 +111,7 @@ protected slots:
 	void undoStackCleanChanged(bool isClean);
 	void addSketchPartToMe();
 	void search();
+	void searchTextEdited(const QString &);
 	void focusSearchAfter();
 
 signals:
@@ -163,6 +165,8 @@ protected:
 	QLabel * m_binLabel;
 
 	class SearchLineEdit * m_searchLineEdit;
+	QTimer m_searchTimer;
+	QString m_lastSearchText;
 
 	QToolButton * m_combinedBinMenuButton;
 
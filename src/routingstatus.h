@@ -34,6 +34,14 @@ public:
 		m_netCount = m_netRoutedCount = m_connectorsLeftToRoute = m_jumperItemCount = 0;
 	}
 
+	RoutingStatus & operator+=(const RoutingStatus &other) {
+		m_netCount += other.m_netCount;
+		m_netRoutedCount += other.m_netRoutedCount;
+		m_connectorsLeftToRoute += other.m_connectorsLeftToRoute;
+		m_jumperItemCount += other.m_jumperItemCount;
+		return *this;
+	}
+
 	bool operator!=(const RoutingStatus &other) const {
 		return
 		    (m_netCount != other.m_netCount) ||
@@ -259,9 +259,7 @@ void BreadboardSketchWidget::colorWiresByLength(bool colorByLength) {
 
 	QList<Wire *> wires;
 	QList<Wire *> visited;
-	foreach (QGraphicsItem * item, scene()->items()) {
-		Wire * wire = dynamic_cast<Wire *>(item);
-		if (wire == NULL) continue;
+	foreach (Wire * wire, fgraphicsScene()->wires()) {
 		wire->colorByLength(colorByLength);
 	}
 }
@@ -21,7 +21,10 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "fgraphicsscene.h"
 #include "../items/paletteitembase.h"
 #include "../items/wire.h"
+#include "../items/resizableboard.h"
+#include "../model/modelpart.h"
 #include "../connectors/connectoritem.h"
+#include "../connectors/connectivityindex.h"
 #include "../sketch/infographicsview.h"
 
 #include <QToolTip>
@@ -29,6 +32,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 FGraphicsScene::FGraphicsScene( QObject * parent) : QGraphicsScene(parent)
 {
 	m_displayHandles = true;
+	m_nextSerial = 0;
+	m_connectivityIndex = nullptr;
 	//setItemIndexMethod(QGraphicsScene::NoIndex);
 }
 
@@ -90,3 +95,110 @@ QList<ItemBase *> FGraphicsScene::lockedSelectedItems() {
 	}
 	return items;
 }
+
+void FGraphicsScene::indexItem(ItemBase * itemBase) {
+	m_itemIndex.insert(itemBase->id(), itemBase);
+
+	if (!m_registrations.contains(itemBase)) {
+		Registration registration;
+		registration.itemType = itemBase->itemType();
+		registration.serial = m_nextSerial++;
+		m_registrations.insert(itemBase, registration);
+		m_itemOrder.insert(registration.serial, itemBase);
+		m_itemsByType[registration.itemType].insert(registration.serial, itemBase);
+		if (m_connectivityIndex) {
+			m_connectivityIndex->itemAdded(itemBase);
+		}
+	}
+}
+
+void FGraphicsScene::unindexItem(ItemBase * itemBase) {
+	QHash<long, QPointer<ItemBase> >::iterator it = m_itemIndex.find(itemBase->id());
+	if (it != m_itemIndex.end() && it.value() == itemBase) {
+		m_itemIndex.erase(it);
+	}
+
+	// the type is looked up rather than asked for, since the modelPart may already be gone
+	QHash<ItemBase *, Registration>::iterator rit = m_registrations.find(itemBase);
+	if (rit != m_registrations.end()) {
+		if (m_connectivityIndex) {
+			m_connectivityIndex->itemRemoved(itemBase);
+		}
+		m_itemsByType[rit.value().itemType].remove(rit.value().serial);
+		m_itemOrder.remove(rit.value().serial);
+		m_registrations.erase(rit);
+	}
+}
+
+ItemBase * FGraphicsScene::indexedItem(long id) {
+	QHash<long, QPointer<ItemBase> >::iterator it = m_itemIndex.find(id);
+	if (it == m_itemIndex.end()) return NULL;
+
+	ItemBase * itemBase = it.value();
+	if (itemBase == NULL || itemBase->scene() != this || itemBase->id() != id) {
+		// the item was deleted or renumbered (see ItemBase::resetID) after it was indexed
+		m_itemIndex.erase(it);
+		return NULL;
+	}
+
+	return itemBase;
+}
+
+QList<ItemBase *> FGraphicsScene::itemBases() {
+	// all items, not just topLevel
+	return m_itemOrder.values();
+}
+
+QList<ItemBase *> FGraphicsScene::itemBases(int itemType) {
+	return m_itemsByType.value(itemType).values();
+}
+
+QList<Wire *> FGraphicsScene::wires() {
+	QList<Wire *> wires;
+	foreach (ItemBase * itemBase, m_itemsByType.value(ModelPart::Wire)) {
+		Wire * wire = qobject_cast<Wire *>(itemBase);
+		if (wire) wires.append(wire);
+	}
+
+	return wires;
+}
+
+QList<ItemBase *> FGraphicsScene::boards() {
+	static const int BoardTypes[] = { ModelPart::Board, ModelPart::ResizableBoard, ModelPart::Logo };
+
+	QMap<qint64, ItemBase *> candidates;
+	for (unsigned int i = 0; i < sizeof(BoardTypes) / sizeof(int); i++) {
+		QMap<qint64, ItemBase *> items = m_itemsByType.value(BoardTypes[i]);
+		for (QMap<qint64, ItemBase *>::const_iterator it = items.constBegin(); it != items.constEnd(); ++it) {
+			candidates.insert(it.key(), it.value());
+		}
+	}
+
+	QList<ItemBase *> boards;
+	foreach (ItemBase * itemBase, candidates) {
+		if (!Board::isBoard(itemBase)) continue;
+
+		ItemBase * chief = itemBase->layerKinChief();
+		if (!boards.contains(chief)) boards.append(chief);
+	}
+
+	return boards;
+}
+
+QList<ConnectorItem *> FGraphicsScene::connectorItems() {
+	// connectors are always children of an ItemBase, so this covers every ConnectorItem in the scene
+	QList<ConnectorItem *> connectorItems;
+	foreach (ItemBase * itemBase, m_itemOrder) {
+		connectorItems.append(itemBase->cachedConnectorItems());
+	}
+
+	return connectorItems;
+}
+
+void FGraphicsScene::setConnectivityIndex(ConnectivityIndex * connectivityIndex) {
+	m_connectivityIndex = connectivityIndex;
+}
+
+ConnectivityIndex * FGraphicsScene::connectivityIndex() {
+	return m_connectivityIndex;
+}
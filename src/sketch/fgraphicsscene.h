@@ -24,8 +24,16 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QGraphicsScene>
 #include <QPainter>
 #include <QGraphicsSceneHelpEvent>
+#include <QHash>
+#include <QMap>
+#include <QPointer>
+#include <QSet>
 #include "../items/itembase.h"
 
+class Wire;
+class ConnectorItem;
+class ConnectivityIndex;
+
 class FGraphicsScene : public QGraphicsScene
 {
 	Q_OBJECT
@@ -38,10 +46,31 @@ public:
 	void setDisplayHandles(bool);
 	bool displayHandles();
 	QList<ItemBase *> lockedSelectedItems();
+	void indexItem(ItemBase *);
+	void unindexItem(ItemBase *);
+	ItemBase * indexedItem(long id);
+	QList<ItemBase *> itemBases();
+	QList<ItemBase *> itemBases(int itemType);
+	QList<Wire *> wires();
+	QList<ItemBase *> boards();
+	QList<ConnectorItem *> connectorItems();
+	void setConnectivityIndex(ConnectivityIndex *);
+	ConnectivityIndex * connectivityIndex();
 
 protected:
 	QPointF m_lastContextMenuPos;
 	bool m_displayHandles;
+	QHash<long, QPointer<ItemBase> > m_itemIndex;		// id => item; chiefs and layerkin are entered separately
+	// every ItemBase in the scene, in the order it was indexed, so callers walk the items the same way every time
+	struct Registration {
+		int itemType;					// the ModelPart::ItemType it was registered under
+		qint64 serial;
+	};
+	QHash<ItemBase *, Registration> m_registrations;
+	QMap<qint64, ItemBase *> m_itemOrder;				// serial => item
+	QHash<int, QMap<qint64, ItemBase *> > m_itemsByType;
+	qint64 m_nextSerial;
+	ConnectivityIndex * m_connectivityIndex;			// kept up to date as items come and go
 
 };
 
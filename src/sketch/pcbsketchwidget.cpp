@@ -45,6 +45,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "../autoroute/panelizer.h"
 #include "../autoroute/autoroutersettingsdialog.h"
 #include "../svg/groundplanegenerator.h"
+#include "../svg/pourgeometry.h"
 #include "../items/logoitem.h"
 #include "../dialogs/groundfillseeddialog.h"
 #include "../version/version.h"
@@ -299,7 +300,9 @@ void PCBSketchWidget::selectAllXTraces(bool autoroutable, const QString & cmdTex
 		items = scene()->collidingItems(board);
 	}
 	else {
-		items = scene()->items();
+		foreach (Wire * wire, fgraphicsScene()->wires()) {
+			items.append(wire);
+		}
 	}
 	foreach (QGraphicsItem * item, items) {
 		TraceWire * wire = dynamic_cast<TraceWire *>(item);
@@ -790,17 +793,7 @@ ItemBase * PCBSketchWidget::findSelectedBoard(int & boardCount) {
 }
 
 QList<ItemBase *> PCBSketchWidget::findBoard() {
-	QSet<ItemBase *> boards;
-	foreach (QGraphicsItem * childItem, items()) {
-		Board * board = dynamic_cast<Board *>(childItem);
-		if (board == NULL) continue;
-
-		if (Board::isBoard(board)) {
-			boards.insert(board->layerKinChief());
-		}
-	}
-
-	return boards.toList();
+	return fgraphicsScene()->boards();
 }
 
 void PCBSketchWidget::forwardRoutingStatus(const RoutingStatus & routingStatus)
@@ -864,9 +857,7 @@ void PCBSketchWidget::swapLayers(ItemBase *, int newLayers, QUndoCommand * paren
 	}
 
 	// disconnect and flip smds
-	foreach (QGraphicsItem * item, scene()->items()) {
-		ItemBase * smd = dynamic_cast<ItemBase *>(item);
-		if (smd == NULL) continue;
+	foreach (ItemBase * smd, fgraphicsScene()->itemBases()) {
 		if (smd->moduleID().endsWith(ModuleIDNames::PadModuleIDName)) {
 			pads << smd;
 			continue;
@@ -1041,7 +1032,11 @@ void PCBSketchWidget::changeTraceLayer(ItemBase * itemBase, bool force, QUndoCom
 	TraceWire * sample = NULL;
 	QList<QGraphicsItem *> items;
 	if (itemBase) items << itemBase;
-	else if (force) items = scene()->items();
+	else if (force) {
+		foreach (Wire * wire, fgraphicsScene()->wires()) {
+			items.append(wire);
+		}
+	}
 	else items =  scene()->selectedItems();
 	foreach (QGraphicsItem * item, items) {
 		TraceWire * tw = dynamic_cast<TraceWire *>(item);
@@ -1175,8 +1170,8 @@ bool PCBSketchWidget::resizingJumperItemPress(ItemBase * itemBase) {
 		QHash<long, ItemBase *> savedItems;
 		QHash<Wire *, ConnectorItem *> savedWires;
 		if (board == NULL) {
-			foreach (QGraphicsItem * item, scene()->items()) {
-				PaletteItemBase * itemBase = dynamic_cast<PaletteItemBase *>(item);
+			foreach (ItemBase * item, fgraphicsScene()->itemBases()) {
+				PaletteItemBase * itemBase = qobject_cast<PaletteItemBase *>(item);
 				if (itemBase == NULL) continue;
 				if (itemBase->itemType() == ModelPart::Jumper) continue;
 
@@ -1550,41 +1545,50 @@ bool PCBSketchWidget::groundFill(bool fillGroundTraces, ViewLayer::ViewLayerID v
 	QStringList exceptions;
 	exceptions << "none" << "" << background().name();    // the color of holes in the board
 
+	// both layers are filled at the same time
 	GroundPlaneGenerator gpg0;
+	QFuture<bool> future0;
 	if (!svg0.isEmpty()) {
 		gpg0.setLayerName("groundplane");
 		gpg0.setStrokeWidthIncrement(StrokeWidthIncrement);
 		gpg0.setMinRunSize(10, 10);
 		if (fillGroundTraces) {
-			connect(&gpg0, SIGNAL(postImageSignal(GroundPlaneGenerator *, QImage *, QImage *, QGraphicsItem *, QList<QRectF> *)),
-			        this, SLOT(postImageSlot(GroundPlaneGenerator *, QImage *, QImage *, QGraphicsItem *, QList<QRectF> *)),
+			connect(&gpg0, SIGNAL(postPourSignal(GroundPlaneGenerator *, const PourProbe *, QGraphicsItem *, QList<QRectF> *)),
+			        this, SLOT(postPourSlot(GroundPlaneGenerator *, const PourProbe *, QGraphicsItem *, QList<QRectF> *)),
 			        Qt::DirectConnection);
 		}
 
-		bool result = gpg0.generateGroundPlane(boardSvg, boardImageRect.size(), svg0, copperImageRect.size(), exceptions, board, GraphicsUtils::StandardFritzingDPI / 2.0  /* 2 MIL */,
-		                                       ViewLayer::Copper0Color, getKeepoutMils());
-		if (result == false) {
-			QMessageBox::critical(this, tr("Fritzing"), tr("Fritzing error: unable to write copper fill (1)."));
-			return false;
-		}
+		future0 = gpg0.startGroundPlane(boardSvg, boardImageRect.size(), svg0, copperImageRect.size(), exceptions, board, GraphicsUtils::StandardFritzingDPI / 2.0  /* 2 MIL */,
+		                                ViewLayer::Copper0Color, getKeepoutMils());
 	}
 
 	GroundPlaneGenerator gpg1;
+	QFuture<bool> future1;
 	if (boardLayers() > 1 && !svg1.isEmpty()) {
 		gpg1.setLayerName("groundplane1");
 		gpg1.setStrokeWidthIncrement(StrokeWidthIncrement);
 		gpg1.setMinRunSize(10, 10);
 		if (fillGroundTraces) {
-			connect(&gpg1, SIGNAL(postImageSignal(GroundPlaneGenerator *, QImage *, QImage *, QGraphicsItem *, QList<QRectF> *)),
-			        this, SLOT(postImageSlot(GroundPlaneGenerator *, QImage *, QImage *, QGraphicsItem *, QList<QRectF> *)),
+			connect(&gpg1, SIGNAL(postPourSignal(GroundPlaneGenerator *, const PourProbe *, QGraphicsItem *, QList<QRectF> *)),
+			        this, SLOT(postPourSlot(GroundPlaneGenerator *, const PourProbe *, QGraphicsItem *, QList<QRectF> *)),
 			        Qt::DirectConnection);
 		}
-		bool result = gpg1.generateGroundPlane(boardSvg, boardImageRect.size(), svg1, copperImageRect.size(), exceptions, board, GraphicsUtils::StandardFritzingDPI / 2.0  /* 2 MIL */,
-		                                       ViewLayer::Copper1Color, getKeepoutMils());
-		if (result == false) {
-			QMessageBox::critical(this, tr("Fritzing"), tr("Fritzing error: unable to write copper fill (2)."));
-			return false;
-		}
+		future1 = gpg1.startGroundPlane(boardSvg, boardImageRect.size(), svg1, copperImageRect.size(), exceptions, board, GraphicsUtils::StandardFritzingDPI / 2.0  /* 2 MIL */,
+		                                ViewLayer::Copper1Color, getKeepoutMils());
+	}
+
+	// a default-constructed future counts as finished
+	while (!future0.isFinished() || !future1.isFinished()) {
+		ProcessEventBlocker::processEvents(200);
+	}
+
+	if (!svg0.isEmpty() && future0.result() == false) {
+		QMessageBox::critical(this, tr("Fritzing"), tr("Fritzing error: unable to write copper fill (1)."));
+		return false;
+	}
+	if (boardLayers() > 1 && !svg1.isEmpty() && future1.result() == false) {
+		QMessageBox::critical(this, tr("Fritzing"), tr("Fritzing error: unable to write copper fill (2)."));
+		return false;
 	}
 
 
@@ -1829,8 +1833,8 @@ QString PCBSketchWidget::characterizeGroundFill(ViewLayer::ViewLayerID whichGrou
 
 	if (!gotOne) return result;
 
-	foreach (QGraphicsItem * item, scene()->items()) {
-		GroundPlane * gp = dynamic_cast<GroundPlane *>(item);
+	foreach (ItemBase * itemBase, fgraphicsScene()->itemBases(ModelPart::CopperFill)) {
+		GroundPlane * gp = dynamic_cast<GroundPlane *>(itemBase);
 		if (gp == NULL) continue;
 		if (gp->viewLayerID() != whichGroundPlane) continue;
 
@@ -1881,7 +1885,7 @@ ViewGeometry::WireFlag PCBSketchWidget::getTraceFlag() {
  * Also checks if a seed is already connected with a wire on that layer
  */
 bool PCBSketchWidget::canConnectSeed(QRectF boardRect,
-									 QImage * copperImage,
+									 const QSize & imageSize,
 									 ConnectorItem * connectorItem,
 									 ViewLayer::ViewLayerID viewLayerID,
 									 QRectF s)
@@ -1890,20 +1894,21 @@ bool PCBSketchWidget::canConnectSeed(QRectF boardRect,
 	// with larger keepouts >> 30, most seeds can not be automatically connected anymore
 	// so the workaround would be to set a manual wiretrace.
 
-	QRectF check(boardRect.left() + (s.left()-clear) * boardRect.width()/ copperImage->width(),
-				 boardRect.top() + (s.top()-clear) * boardRect.height() / copperImage->height(),
-				 (s.width()+2*clear) * boardRect.width()/ copperImage->width(),
-				 (s.height()+2*clear) * boardRect.width()/ copperImage->width());
+	QRectF check(boardRect.left() + (s.left()-clear) * boardRect.width()/ imageSize.width(),
+				 boardRect.top() + (s.top()-clear) * boardRect.height() / imageSize.height(),
+				 (s.width()+2*clear) * boardRect.width()/ imageSize.width(),
+				 (s.height()+2*clear) * boardRect.width()/ imageSize.width());
 	return (!hasNeighbor(connectorItem, viewLayerID, check));
 }
 
-void PCBSketchWidget::postImageSlot(GroundPlaneGenerator * gpg, QImage * copperImage, QImage * boardImage, QGraphicsItem * board, QList<QRectF> * rects) {
+void PCBSketchWidget::postPourSlot(GroundPlaneGenerator * gpg, const PourProbe * probe, QGraphicsItem * board, QList<QRectF> * rects) {
 
 	if (m_groundFillSeeds == nullptr) return;
 
 	ViewLayer::ViewLayerID viewLayerID = (gpg->layerName() == "groundplane") ? ViewLayer::Copper0 : ViewLayer::Copper1;
 
 	QRectF boardRect = board->sceneBoundingRect();
+	const QSize & imageSize = probe->size();
 
 	foreach (ConnectorItem * connectorItem, *m_groundFillSeeds) {
 		if (connectorItem->attachedToViewLayerID() != viewLayerID) continue;
@@ -1913,10 +1918,10 @@ void PCBSketchWidget::postImageSlot(GroundPlaneGenerator * gpg, QImage * copperI
 		//connectorItem->debugInfo("post image b");
 		QRectF r = connectorItem->sceneBoundingRect();
 
-		double x1 = (r.left() - boardRect.left()) * copperImage->width() / boardRect.width();
-		double x2 = (r.right() - boardRect.left()) * copperImage->width() / boardRect.width();
-		double y1 = (r.top() - boardRect.top()) * copperImage->height() / boardRect.height();
-		double y2 = (r.bottom() - boardRect.top()) * copperImage->height() / boardRect.height();
+		double x1 = (r.left() - boardRect.left()) * imageSize.width() / boardRect.width();
+		double x2 = (r.right() - boardRect.left()) * imageSize.width() / boardRect.width();
+		double y1 = (r.top() - boardRect.top()) * imageSize.height() / boardRect.height();
+		double y2 = (r.bottom() - boardRect.top()) * imageSize.height() / boardRect.height();
 		double w = x2 - x1;
 		double h = y2 - y1;
 
@@ -1925,18 +1930,18 @@ void PCBSketchWidget::postImageSlot(GroundPlaneGenerator * gpg, QImage * copperI
 		double cx = (x1 + x2) /2;
 		double cy = (y1 + y2) /2;
 
-		double rad = qFloor(connectorItem->calcClipRadius() * copperImage->width() / boardRect.width());
+		double rad = qFloor(connectorItem->calcClipRadius() * imageSize.width() / boardRect.width());
 
 		double borderl = qMax(0.0, x1 - w);
-		double borderr = qMin(x2 + w, copperImage->width());
+		double borderr = qMin(x2 + w, imageSize.width());
 		double bordert = qMax(0.0, y1 - h);
-		double borderb = qMin(y2 + h, copperImage->height());
+		double borderb = qMin(y2 + h, imageSize.height());
 
 		// check left, up, right, down for groundplane, and if it's there draw to it from the connector
 		for (int y = y1; y > bordert; y--) {
-			if ((copperImage->pixel(cx, y) & 0xffffff) || (boardImage->pixel(cx, y) == 0xff000000)) {
+			if (probe->reached(cx, y)) {
 				QRectF s(cx - cw, y - 1, cw + cw, cy - y - rad);
-				if (canConnectSeed(boardRect, copperImage, connectorItem, viewLayerID, s)) {
+				if (canConnectSeed(boardRect, imageSize, connectorItem, viewLayerID, s)) {
 					rects->append(s);
 				}
 				break;
@@ -1945,9 +1950,9 @@ void PCBSketchWidget::postImageSlot(GroundPlaneGenerator * gpg, QImage * copperI
 
 
 		for (int y = y2; y < borderb; y++) {
-			if ((copperImage->pixel(cx, y) & 0xffffff) || (boardImage->pixel(cx, y) == 0xff000000)) {
+			if (probe->reached(cx, y)) {
 				QRectF s(cx - cw, cy + rad, cw + cw, y - cy - rad);
-				if (canConnectSeed(boardRect, copperImage, connectorItem, viewLayerID, s)) {
+				if (canConnectSeed(boardRect, imageSize, connectorItem, viewLayerID, s)) {
 					rects->append(s);
 				}
 				break;
@@ -1956,9 +1961,9 @@ void PCBSketchWidget::postImageSlot(GroundPlaneGenerator * gpg, QImage * copperI
 
 
 		for (int x = x1; x > borderl; x--) {
-			if ((copperImage->pixel(x, cy) & 0xffffff) || (boardImage->pixel(x, cy) == 0xff000000)) {
+			if (probe->reached(x, cy)) {
 				QRectF s(x - 1, cy - ch, cx - x - rad, ch + ch);
-				if (canConnectSeed(boardRect, copperImage, connectorItem, viewLayerID, s)) {
+				if (canConnectSeed(boardRect, imageSize, connectorItem, viewLayerID, s)) {
 					rects->append(s);
 				}
 				break;
@@ -1966,9 +1971,9 @@ void PCBSketchWidget::postImageSlot(GroundPlaneGenerator * gpg, QImage * copperI
 		}
 
 		for (int x = x2; x < borderr; x++) {
-			if ((copperImage->pixel(x, cy) & 0xffffff) || (boardImage->pixel(x, cy) == 0xff000000)) {
+			if (probe->reached(x, cy)) {
 				QRectF s(cx + rad, cy - ch, x - cx - rad, ch + ch);
-				if (canConnectSeed(boardRect, copperImage, connectorItem, viewLayerID, s)) {
+				if (canConnectSeed(boardRect, imageSize, connectorItem, viewLayerID, s)) {
 					rects->append(s);
 				}
 				break;
@@ -2005,9 +2010,7 @@ bool PCBSketchWidget::hasNeighbor(ConnectorItem * connectorItem, ViewLayer::View
 
 void PCBSketchWidget::collectThroughHole(QList<ConnectorItem *> & th, QList<ConnectorItem *> & pads, const LayerList & layerList)
 {
-	foreach (QGraphicsItem * item, scene()->items()) {
-		ConnectorItem * connectorItem = dynamic_cast<ConnectorItem *>(item);
-		if (connectorItem == NULL) continue;
+	foreach (ConnectorItem * connectorItem, fgraphicsScene()->connectorItems()) {
 		if (!connectorItem->attachedTo()->isVisible()) continue;
 		if (!layerList.contains(connectorItem->attachedToViewLayerID())) continue;
 		if (connectorItem->attachedTo()->moduleID().endsWith(ModuleIDNames::PadModuleIDName)) {
@@ -2188,19 +2191,9 @@ void PCBSketchWidget::shiftHoles() {
 	bool doShift = !Version::greaterThan(versionThingOffset, versionThingFz);
 	if (!doShift) return;
 
-	foreach (QGraphicsItem * item, scene()->items()) {
-		ItemBase * itemBase = dynamic_cast<ItemBase *>(item);
-		if (itemBase == NULL) continue;
-
-		switch (itemBase->itemType()) {
-		case ModelPart::Via:
-		case ModelPart::Hole:
-			itemBase->setPos(itemBase->pos().x() - (Hole::OffsetPixels / 2), itemBase->pos().y() - (Hole::OffsetPixels / 2));
-			break;
-
-		default:
-			continue;
-		}
+	QList<ItemBase *> holes = fgraphicsScene()->itemBases(ModelPart::Via) + fgraphicsScene()->itemBases(ModelPart::Hole);
+	foreach (ItemBase * itemBase, holes) {
+		itemBase->setPos(itemBase->pos().x() - (Hole::OffsetPixels / 2), itemBase->pos().y() - (Hole::OffsetPixels / 2));
 	}
 }
 
@@ -2559,9 +2552,7 @@ int PCBSketchWidget::checkLoadedTraces() {
 	scene()->clearSelection();
 	QList<Wire *> wires;
 	QHash<Wire *, QLineF> lines;
-	foreach (QGraphicsItem * item, scene()->items()) {
-		Wire * wire = dynamic_cast<Wire *>(item);
-		if (wire == NULL) continue;
+	foreach (Wire * wire, fgraphicsScene()->wires()) {
 		if (!wire->isTraceType(getTraceFlag())) continue;
 
 		ConnectorItem * c0 = wire->connector0();
@@ -2877,10 +2868,7 @@ void PCBSketchWidget::setViewFromBelow(bool viewFromBelow) {
 	if (m_viewFromBelow == viewFromBelow) return;
 
 	QSet<ItemBase *> chiefs;
-	foreach (QGraphicsItem * item, scene()->items()) {
-		ItemBase * itemBase = dynamic_cast<ItemBase *>(item);
-		if (itemBase == NULL) continue;
-
+	foreach (ItemBase * itemBase, fgraphicsScene()->itemBases()) {
 		ViewLayer * viewLayer = m_viewLayers.value(itemBase->viewLayerID(), NULL);
 		if (viewLayer == NULL) continue;
 
@@ -165,7 +165,7 @@ protected:
 	void rotatePartLabels(double degrees, QTransform &, QPointF center, QUndoCommand * parentCommand);
 	bool hasNeighbor(ConnectorItem * connectorItem, ViewLayer::ViewLayerID viewLayerID, const QRectF & r);	
 	bool canConnectSeed(QRectF boardRect,
-					 QImage * copperImage,
+					 const QSize & imageSize,
 					 ConnectorItem * connectorItem,
 					 ViewLayer::ViewLayerID viewLayerID,
 					 QRectF s);
@@ -201,7 +201,7 @@ protected:
 protected slots:
 	void alignJumperItem(class JumperItem *, QPointF &);
 	void wireSplitSlot(class Wire*, QPointF newPos, QPointF oldPos, const QLineF & oldLine);
-	void postImageSlot(class GroundPlaneGenerator *, QImage * copperImage, QImage * boardImage, QGraphicsItem * board, QList<QRectF> *);
+	void postPourSlot(class GroundPlaneGenerator *, const class PourProbe *, QGraphicsItem * board, QList<QRectF> *);
 	void gotFabQuote(QNetworkReply *);
 	void requestQuoteNow();
 	void getDroppedItemViewLayerPlacement(ModelPart * modelPart, ViewLayer::ViewLayerPlacement &);
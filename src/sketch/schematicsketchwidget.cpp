@@ -205,17 +205,13 @@ bool SchematicSketchWidget::hasBigDots() {
 void SchematicSketchWidget::updateBigDots()
 {
 	QList<ConnectorItem *> connectorItems;
-	foreach (QGraphicsItem * item, scene()->items()) {
-		ConnectorItem * connectorItem = dynamic_cast<ConnectorItem *>(item);
-		if (connectorItem == NULL) continue;
-		if (connectorItem->attachedToItemType() != ModelPart::Wire) continue;
-
-		TraceWire * traceWire = qobject_cast<TraceWire *>(connectorItem->attachedTo());
+	foreach (Wire * wire, fgraphicsScene()->wires()) {
+		TraceWire * traceWire = qobject_cast<TraceWire *>(wire);
 		if (traceWire == NULL) continue;
 
-		//DebugDialog::debug(QString("update big dot %1 %2").arg(traceWire->id()).arg(connectorItem->connectorSharedID()));
+		//DebugDialog::debug(QString("update big dot %1").arg(traceWire->id()));
 
-		connectorItems.append(connectorItem);
+		connectorItems.append(traceWire->cachedConnectorItems());
 	}
 
 	QList<ConnectorItem *> visited;
@@ -550,9 +546,7 @@ void SchematicSketchWidget::setConvertSchematic(bool convert) {
 void SchematicSketchWidget::resizeWires() {
 	double tw = getTraceWidth();
 	double sw = getWireStrokeWidth(NULL, tw);
-	foreach (QGraphicsItem * item, scene()->items()) {
-		Wire * wire = dynamic_cast<Wire *>(item);
-		if (wire == NULL) continue;
+	foreach (Wire * wire, fgraphicsScene()->wires()) {
 		if (!wire->isTraceType(getTraceFlag())) continue;
 
 		wire->setWireWidth(tw, this, sw);
@@ -562,10 +556,7 @@ void SchematicSketchWidget::resizeWires() {
 void SchematicSketchWidget::resizeLabels() {
 
 	double fontSize = getLabelFontSizeSmall();
-	foreach (QGraphicsItem * item, scene()->items()) {
-		ItemBase * itemBase = dynamic_cast<ItemBase *>(item);
-		if (itemBase == NULL) continue;
-
+	foreach (ItemBase * itemBase, fgraphicsScene()->itemBases()) {
 		if (itemBase->hasPartLabel() && itemBase->partLabel()) {
 			itemBase->partLabel()->setFontPointSize(fontSize);
 		}
@@ -164,6 +164,7 @@ SketchWidget::SketchWidget(ViewLayer::ViewID viewID, QWidget *parent, int size,
 	//setTransformationAnchor(QGraphicsView::NoAnchor);
 	FGraphicsScene* scene = new FGraphicsScene(this);
 	this->setScene(scene);
+	m_connectivityIndex.setScene(scene);
 
 	//this->scene()->setSceneRect(0,0, rect().width(), rect().height());
 
@@ -927,33 +928,22 @@ void SketchWidget::addToScene(ItemBase * item, ViewLayer::ViewLayerID viewLayerI
 }
 
 ItemBase * SketchWidget::findItem(long id) {
-	// TODO:  this needs to be optimized: could make a hash table
+	// items index themselves in the scene as they are added and removed (see ItemBase::itemChange)
+	FGraphicsScene * fscene = fgraphicsScene();
+	ItemBase * base = fscene->indexedItem(id);
+	if (base) return base;
 
-	long baseid = id / ModelPart::indexMultiplier;
+	// not an exact match: fall back to the chief, or one of its layerkin
+	long chiefid = (id / ModelPart::indexMultiplier) * ModelPart::indexMultiplier;
+	base = fscene->indexedItem(chiefid);
+	if (base == nullptr) return nullptr;
 
-	foreach (QGraphicsItem * item, this->scene()->items()) {
-		ItemBase* base = dynamic_cast<ItemBase *>(item);
-		if (!base) continue;
-
-		if (base->id() == id) {
-			return base;
-		}
-
-		if (base->id() / ModelPart::indexMultiplier == baseid) {
-			// found chief or layerkin
-			ItemBase * chief = base->layerKinChief();
-			if (chief->id() == id) return chief;
-
-			foreach (ItemBase * lk, chief->layerKin()) {
-				if (lk->id() == id) return lk;
-			}
-
-			return chief;
-
-		}
+	ItemBase * chief = base->layerKinChief();
+	foreach (ItemBase * lk, chief->layerKin()) {
+		if (lk->id() == id) return lk;
 	}
 
-	return nullptr;
+	return chief;
 }
 
 void SketchWidget::deleteItem(long id, bool deleteModelPart, bool doEmit, bool later) {
@@ -4056,8 +4046,6 @@ void SketchWidget::setAllLayersVisible(bool visible) {
 ItemCount SketchWidget::calcItemCount() {
 	ItemCount itemCount;
 
-	// TODO: replace scene()->items()
-	QList<QGraphicsItem *> items = scene()->items();
 	QList<QGraphicsItem *> selItems = scene()->selectedItems();
 
 	itemCount.visLabelCount = itemCount.hasLabelCount = 0;
@@ -4139,8 +4127,8 @@ ItemCount SketchWidget::calcItemCount() {
 		itemCount.selHFlipable = 0;
 	}
 	if (itemCount.selCount > 0) {
-		for (int i = 0; i < items.count(); i++) {
-			if (ItemBase::extractTopLevelItemBase(items[i])) {
+		foreach (ItemBase * itemBase, fgraphicsScene()->itemBases()) {
+			if (itemBase->topLevel()) {
 				itemCount.itemsCount++;
 			}
 		}
@@ -4290,9 +4278,7 @@ void SketchWidget::bringToFront() {
 double SketchWidget::fitInWindow() {
 
 	QRectF itemsRect;
-	foreach(QGraphicsItem * item, scene()->items()) {
-		ItemBase * itemBase = dynamic_cast<ItemBase *>(item);
-		if (!itemBase) continue;
+	foreach (ItemBase * itemBase, fgraphicsScene()->itemBases()) {
 		if (!itemBase->isEverVisible()) continue;
 
 		itemsRect |= itemBase->sceneBoundingRect();
@@ -4446,14 +4432,12 @@ bool SketchWidget::greaterThan(int a, int b) {
 
 void SketchWidget::changeZ(QHash<long, RealPair * > triplets, double (*pairAccessor)(RealPair *) ) {
 
-	// TODO: replace scene->items
-	const QList<QGraphicsItem *> items = scene()->items();
-	for (int i = 0; i < items.size(); i++) {
+	foreach (long id, triplets.keys()) {
 		// want all items, not just topLevel
-		ItemBase * itemBase = dynamic_cast<ItemBase *>(items[i]);
+		ItemBase * itemBase = fgraphicsScene()->indexedItem(id);
 		if (!itemBase) continue;
 
-		RealPair * pair = triplets[itemBase->id()];
+		RealPair * pair = triplets.value(id);
 		if (!pair) continue;
 
 		double newZ = pairAccessor(pair);
@@ -4462,7 +4446,7 @@ void SketchWidget::changeZ(QHash<long, RealPair * > triplets, double (*pairAcces
 			newZ = viewLayer->getZFromBelow(newZ, this->viewFromBelow());
 		}
 		//DebugDialog::debug(QString("change z %1 %2").arg(itemBase->id()).arg(newZ));
-		items[i]->setZValue(newZ);
+		itemBase->setZValue(newZ);
 
 	}
 }
@@ -6532,9 +6516,7 @@ void SketchWidget::setIgnoreSelectionChangeEvents(bool ignore) {
 }
 
 void SketchWidget::hideConnectors(bool hide) {
-	foreach (QGraphicsItem * item, scene()->items()) {
-		ItemBase * itemBase = dynamic_cast<ItemBase *>(item);
-		if (!itemBase) continue;
+	foreach (ItemBase * itemBase, fgraphicsScene()->itemBases()) {
 		if (!itemBase->isVisible()) continue;
 
 		foreach (ConnectorItem * connectorItem, itemBase->cachedConnectorItems()) {
@@ -6629,82 +6611,73 @@ void SketchWidget::updateRoutingStatus(RoutingStatus & routingStatus, bool manua
 	//	.arg(m_ratsnestUpdateDisconnect.count())
 	//	);
 
-	// TODO: think about ways to optimize this...
+	// nets come from the connectivity index, and a net whose serial is unchanged since the last update
+	// reuses its parts and score from m_netStatusCache instead of being walked and scored again
 
 	QList< QPointer<VirtualWire> > ratsToDelete;
+	QSet<VirtualWire *> ratsChecked;
 
-	QList< QList<ConnectorItem *> > ratnestsToUpdate;
-	QList<ConnectorItem *> visited;
-	foreach (QGraphicsItem * item, scene()->items()) {
-		ConnectorItem * connectorItem = dynamic_cast<ConnectorItem *>(item);
-		if (!connectorItem) continue;
-		if (visited.contains(connectorItem)) continue;
-
-		//if (this->viewID() == ViewLayer::SchematicView) {
-		//    connectorItem->debugInfo("testing urs");
-		//}
-
+	// ratsnest wires are skipped by the partition, so this doesn't walk the whole scene
+	foreach (ConnectorItem * connectorItem, m_connectivityIndex.skippedConnectors(true, ViewGeometry::RatsnestFlag)) {
 		VirtualWire * vw = qobject_cast<VirtualWire *>(connectorItem->attachedTo());
-		if (vw) {
-			if (vw->connector0()->connectionsCount() == 0 || vw->connector1()->connectionsCount() == 0) {
-				ratsToDelete.append(vw);
-			}
-			visited << vw->connector0() << vw->connector1();
-			continue;
-		}
-
+		if (vw == nullptr || ratsChecked.contains(vw)) continue;
 
-		QList<ConnectorItem *> connectorItems;
-		connectorItems.append(connectorItem);
-		ConnectorItem::collectEqualPotential(connectorItems, true, ViewGeometry::RatsnestFlag);
-		visited.append(connectorItems);
-
-		//if (this->viewID() == ViewLayer::SchematicView) {
-		//	DebugDialog::debug("________________________");
-		//	foreach (ConnectorItem * ci, connectorItems) ci->debugInfo("cep");
-		//}
-
-		bool doRatsnest = manual || checkUpdateRatsnest(connectorItems);
-		if (!doRatsnest && connectorItems.count() <= 1) continue;
+		ratsChecked.insert(vw);
+		if (vw->connector0()->connectionsCount() == 0 || vw->connector1()->connectionsCount() == 0) {
+			ratsToDelete.append(vw);
+		}
+	}
 
-		QList<ConnectorItem *> partConnectorItems;
-		ConnectorItem::collectParts(connectorItems, partConnectorItems, includeSymbols(), ViewLayer::NewTopAndBottom);
-		if (partConnectorItems.count() < 1) continue;
-		if (!doRatsnest && partConnectorItems.count() <= 1) continue;
+	QSet<int> netsToRatsnest;
+	QList< QPointer<ConnectorItem> > updates = m_ratsnestUpdateConnect;
+	updates.append(m_ratsnestUpdateDisconnect);
+	foreach (ConnectorItem * ci, updates) {
+		if (!ci) continue;
+		netsToRatsnest.insert(m_connectivityIndex.netRoot(ci, true, ViewGeometry::RatsnestFlag));
+	}
 
-		//if (this->viewID() == ViewLayer::SchematicView) {
-		//    DebugDialog::debug("________________________");
-		//    foreach (ConnectorItem * pci, partConnectorItems) {
-		//		pci->debugInfo("pc 1");
-		//	}
-		//}
+	QList< QList<ConnectorItem *> > ratnestsToUpdate;
+	QHash<quint64, NetStatus> netStatusCache;
+	const QMap<int, QList<ConnectorItem *> > & nets = m_connectivityIndex.nets(true, ViewGeometry::RatsnestFlag);
+	for (QMap<int, QList<ConnectorItem *> >::const_iterator it = nets.constBegin(); it != nets.constEnd(); ++it) {
+		const QList<ConnectorItem *> & net = it.value();
 
-		for (int i = partConnectorItems.count() - 1; i >= 0; i--) {
-			ConnectorItem * ci = partConnectorItems[i];
+		bool doRatsnest = manual || netsToRatsnest.contains(it.key());
+		if (!doRatsnest && net.count() <= 1) continue;
 
-			if (!ci->attachedTo()->isEverVisible()) {
-				partConnectorItems.removeAt(i);
+		quint64 serial = m_connectivityIndex.netSerial(it.key(), true, ViewGeometry::RatsnestFlag);
+		NetStatus netStatus;
+		if (m_netStatusCache.contains(serial)) {
+			netStatus = m_netStatusCache.value(serial);
+		}
+		else {
+			netStatus.routingStatus.zero();
+			QList<ConnectorItem *> equi(net);
+			ConnectorItem::collectParts(equi, netStatus.partConnectorItems, includeSymbols(), ViewLayer::NewTopAndBottom);
+			for (int i = netStatus.partConnectorItems.count() - 1; i >= 0; i--) {
+				if (!netStatus.partConnectorItems.at(i)->attachedTo()->isEverVisible()) {
+					netStatus.partConnectorItems.removeAt(i);
+				}
+			}
+			if (netStatus.partConnectorItems.count() > 1) {
+				QList<ConnectorItem *> partConnectorItems(netStatus.partConnectorItems);
+				GraphUtils::scoreOneNet(partConnectorItems, this->getTraceFlag(), netStatus.routingStatus);
 			}
 		}
+		netStatusCache.insert(serial, netStatus);
 
-		if (partConnectorItems.count() < 1) continue;
+		if (netStatus.partConnectorItems.count() < 1) continue;
 
 		if (doRatsnest) {
-			ratnestsToUpdate.append(partConnectorItems);
+			ratnestsToUpdate.append(netStatus.partConnectorItems);
 		}
 
-		if (partConnectorItems.count() <= 1) continue;
-
-		//if (this->viewID() == ViewLayer::SchematicView) {
-		//    DebugDialog::debug("________________________");
-		//    foreach (ConnectorItem * pci, partConnectorItems) {
-		//		pci->debugInfo("pc 2");
-		//	}
-		//}
-
-		GraphUtils::scoreOneNet(partConnectorItems, this->getTraceFlag(), routingStatus);
+		routingStatus += netStatus.routingStatus;
 	}
 
+	// only keep the nets that are still there
+	m_netStatusCache = netStatusCache;
+
 	routingStatus.m_jumperItemCount /= 4;			// since we counted each connector twice on two layers (4 connectors per jumper item)
 
 	// can't do this in the above loop since VirtualWires and ConnectorItems are added and deleted
@@ -7065,8 +7038,8 @@ void SketchWidget::hidePartLabel(ItemBase * item) {
 
 void SketchWidget::collectParts(QList<ItemBase *> & partList) {
 	// using PaletteItem instead of ItemBase ensures layerKinChiefs only
-	foreach (QGraphicsItem * item, scene()->items()) {
-		PaletteItem * pitem = dynamic_cast<PaletteItem *>(item);
+	foreach (ItemBase * itemBase, fgraphicsScene()->itemBases()) {
+		PaletteItem * pitem = qobject_cast<PaletteItem *>(itemBase);
 		if (!pitem) continue;
 		if (pitem->itemType() == ModelPart::Symbol) continue;
 
@@ -7216,6 +7189,51 @@ QString translateSVG(QString & svg, QPointF loc, double dpi, double printerScale
 	return svg;
 }
 
+QString SketchWidget::makeItemSvgFragment(ItemBase * itemBase, RenderThing & renderThing, QHash<QString, QString> & svgHash)
+{
+	double factor;
+	QString itemSvg = itemBase->retrieveSvg(itemBase->viewLayerID(), svgHash, renderThing.blackOnly, renderThing.dpi, factor);
+	if (itemSvg.isEmpty()) return itemSvg;
+
+	TextUtils::fixMuch(itemSvg, false);
+
+	QDomDocument doc;
+	QString errorStr;
+	int errorLine;
+	int errorColumn;
+	if (doc.setContent(itemSvg, &errorStr, &errorLine, &errorColumn)) {
+		bool changed = false;
+		if (renderThing.renderBlocker) {
+			Pad * pad = qobject_cast<Pad *>(itemBase);
+			if (pad && pad->copperBlocker()) {
+				QDomNodeList nodeList = doc.documentElement().elementsByTagName("rect");
+				for (int n = 0; n < nodeList.count(); n++) {
+					QDomElement element = nodeList.at(n).toElement();
+					element.setAttribute("fill-opacity", 1);
+					changed = true;
+				}
+			}
+		}
+
+		foreach (ConnectorItem * ci, itemBase->cachedConnectorItems()) {
+			SvgIdLayer * svgIdLayer = ci->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
+			if (renderThing.hideTerminalPoints && !svgIdLayer->m_terminalId.isEmpty()) {
+				// these tend to be degenerate shapes and can cause trouble at gerber export time
+				if (hideTerminalID(doc, svgIdLayer->m_terminalId)) changed = true;
+			}
+
+			if (ensureStrokeWidth(doc, svgIdLayer->m_svgId, factor)) changed = true;
+		}
+
+		if (changed) {
+			itemSvg = doc.toString(0);
+		}
+	}
+
+	QTransform t = itemBase->transform();
+	return TextUtils::svgTransform(itemSvg, t, false, QString());
+}
+
 QString SketchWidget::renderToSVG(RenderThing & renderThing, QList<QGraphicsItem *> & itemsAndLabels)
 {
 	renderThing.empty = true;
@@ -7257,52 +7275,33 @@ QString SketchWidget::renderToSVG(RenderThing & renderThing, QList<QGraphicsItem
 		}
 
 		if (itemBase->itemType() != ModelPart::Wire) {
-			double factor;
-			QString itemSvg = itemBase->retrieveSvg(itemBase->viewLayerID(), svgHash, renderThing.blackOnly, renderThing.dpi, factor);
+			// everything but the position is cached on the item, since DRC, autorouting, ground fill
+			// and each gerber layer render the same unchanged items over and over
+			QTransform t = itemBase->transform();
+			QString key = QString("%1 %2 %3 %4 %5 %6 %7 %8,%9,%10,%11,%12,%13")
+			              .arg(itemBase->viewLayerID())
+			              .arg(renderThing.dpi)
+			              .arg(renderThing.printerScale)
+			              .arg(renderThing.blackOnly)
+			              .arg(renderThing.renderBlocker)
+			              .arg(renderThing.hideTerminalPoints)
+			              .arg(int(smdOrientation()))
+			              .arg(t.m11()).arg(t.m12()).arg(t.m21()).arg(t.m22()).arg(t.dx()).arg(t.dy());
+
+			QString itemSvg;
+			if (!itemBase->svgFragment(key, itemSvg)) {
+				itemSvg = makeItemSvgFragment(itemBase, renderThing, svgHash);
+				itemBase->cacheSvgFragment(key, itemSvg);
+			}
 			if (itemSvg.isEmpty()) continue;
 
-			TextUtils::fixMuch(itemSvg, false);
-
-			QDomDocument doc;
-			QString errorStr;
-			int errorLine;
-			int errorColumn;
-			if (doc.setContent(itemSvg, &errorStr, &errorLine, &errorColumn)) {
-				bool changed = false;
-				if (renderThing.renderBlocker) {
-					Pad * pad = qobject_cast<Pad *>(itemBase);
-					if (pad && pad->copperBlocker()) {
-						QDomNodeList nodeList = doc.documentElement().elementsByTagName("rect");
-						for (int n = 0; n < nodeList.count(); n++) {
-							QDomElement element = nodeList.at(n).toElement();
-							element.setAttribute("fill-opacity", 1);
-							changed = true;
-						}
-					}
-				}
-
-				foreach (ConnectorItem * ci, itemBase->cachedConnectorItems()) {
-					SvgIdLayer * svgIdLayer = ci->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
-					if (renderThing.hideTerminalPoints && !svgIdLayer->m_terminalId.isEmpty()) {
-						// these tend to be degenerate shapes and can cause trouble at gerber export time
-						if (hideTerminalID(doc, svgIdLayer->m_terminalId)) changed = true;
-					}
-
-					if (ensureStrokeWidth(doc, svgIdLayer->m_svgId, factor)) changed = true;
-
-					if (!ci->hasRubberBandLeg()) continue;
-
-					// at the moment, the legs don't get a partID, but since there are no legs in PCB view, we don't care
-					outputSVG.append(ci->makeLegSvg(offset, renderThing.dpi, renderThing.printerScale, renderThing.blackOnly));
-				}
+			foreach (ConnectorItem * ci, itemBase->cachedConnectorItems()) {
+				if (!ci->hasRubberBandLeg()) continue;
 
-				if (changed) {
-					itemSvg = doc.toString(0);
-				}
+				// at the moment, the legs don't get a partID, but since there are no legs in PCB view, we don't care
+				outputSVG.append(ci->makeLegSvg(offset, renderThing.dpi, renderThing.printerScale, renderThing.blackOnly));
 			}
 
-			QTransform t = itemBase->transform();
-			itemSvg = TextUtils::svgTransform(itemSvg, t, false, QString());
 			itemSvg = translateSVG(itemSvg, itemBase->scenePos() - offset, renderThing.dpi, renderThing.printerScale);
 			itemSvg =  QString("<g partID='%1'>%2</g>").arg(itemBase->id()).arg(itemSvg);
 			outputSVG.append(itemSvg);
@@ -7822,7 +7821,10 @@ bool SketchWidget::createOneTrace(Wire * wire, ViewGeometry::WireFlag flag, bool
 
 void SketchWidget::selectAllWires(ViewGeometry::WireFlag flag)
 {
-	QList<QGraphicsItem *> items = scene()->items();
+	QList<QGraphicsItem *> items;
+	foreach (Wire * wire, fgraphicsScene()->wires()) {
+		items.append(wire);
+	}
 	selectAllWiresFrom(flag, items);
 }
 
@@ -7873,10 +7875,7 @@ void SketchWidget::updateConnectors() {
 	// update issue with 4.5.0?
 
 	QList<ConnectorItem *> visited;
-	foreach (QGraphicsItem* item, scene()->items()) {
-		ConnectorItem * connectorItem = dynamic_cast<ConnectorItem *>(item);
-		if (!connectorItem) continue;
-
+	foreach (ConnectorItem * connectorItem, fgraphicsScene()->connectorItems()) {
 		connectorItem->restoreColor(visited);
 	}
 }
@@ -8121,9 +8120,7 @@ void SketchWidget::resizeJumperItem(long itemID, QPointF pos, QPointF c0, QPoint
 QList<ItemBase *> SketchWidget::selectAllObsolete()
 {
 	QSet<ItemBase *> itemBases;
-	foreach (QGraphicsItem * item, scene()->items()) {
-		ItemBase * itemBase = dynamic_cast<ItemBase *>(item);
-		if (!itemBase) continue;
+	foreach (ItemBase * itemBase, fgraphicsScene()->itemBases()) {
 		if (!itemBase->isObsolete()) continue;
 
 		itemBases.insert(itemBase->layerKinChief());
@@ -8136,9 +8133,7 @@ QList<ItemBase *> SketchWidget::selectAllObsolete()
 int SketchWidget::selectAllMoveLock()
 {
 	QSet<ItemBase *> itemBases;
-	foreach (QGraphicsItem * item, scene()->items()) {
-		ItemBase * itemBase = dynamic_cast<ItemBase *>(item);
-		if (!itemBase) continue;
+	foreach (ItemBase * itemBase, fgraphicsScene()->itemBases()) {
 		if (!itemBase->moveLock()) continue;
 
 		itemBases.insert(itemBase->layerKinChief());
@@ -8192,10 +8187,7 @@ AddItemCommand * SketchWidget::newAddItemCommand(BaseCommand::CrossViewType cros
 }
 
 bool SketchWidget::partLabelsVisible() {
-	foreach (QGraphicsItem * item, scene()->items()) {
-		ItemBase * itemBase = dynamic_cast<ItemBase *>(item);
-		if (!itemBase) continue;
-
+	foreach (ItemBase * itemBase, fgraphicsScene()->itemBases()) {
 		if (itemBase->isPartLabelVisible()) return true;
 
 	}
@@ -8395,31 +8387,25 @@ void SketchWidget::collectAllNets(QHash<ConnectorItem *, int> & indexer, QList<
 {
 	// get the set of all connectors in the sketch
 	QList<ConnectorItem *> allConnectors;
-	foreach (QGraphicsItem * item, scene()->items()) {
-		ConnectorItem * connectorItem = dynamic_cast<ConnectorItem *>(item);
-		if (!connectorItem) continue;
+	foreach (ConnectorItem * connectorItem, fgraphicsScene()->connectorItems()) {
 		if (!bothSides && connectorItem->attachedToViewLayerID() == ViewLayer::Copper1) continue;
 
 		allConnectors.append(connectorItem);
 	}
 
 	// find all the nets and make a list of nodes (i.e. part ConnectorItems) for each net
-	while (allConnectors.count() > 0) {
+	QSet<ConnectorItem *> netted;
+	foreach (ConnectorItem * connectorItem, allConnectors) {
+		if (netted.contains(connectorItem)) continue;
 
-		ConnectorItem * connectorItem = allConnectors.takeFirst();
-		QList<ConnectorItem *> connectorItems;
-		connectorItems.append(connectorItem);
-		ConnectorItem::collectEqualPotential(connectorItems, bothSides, ViewGeometry::NoFlag);
+		QList<ConnectorItem *> connectorItems = m_connectivityIndex.equalPotential(connectorItem, bothSides, ViewGeometry::NoFlag);
 		if (connectorItems.count() <= 0) {
 			continue;
 		}
 
 		foreach (ConnectorItem * ci, connectorItems) {
-			//if (connectorItems.count(ci) > 1) {
-			//DebugDialog::debug("collect equal potential bug");
-			//}
 			//DebugDialog::debug(QString("from in equal potential %1 %2").arg(ci->connectorSharedName()).arg(ci->attachedToInstanceTitle()));
-			allConnectors.removeOne(ci);
+			netted.insert(ci);
 		}
 
 		if (!includeSingletons && (connectorItems.count() <= 1)) {
@@ -8469,6 +8455,15 @@ void SketchWidget::collectAllNets(QHash<ConnectorItem *, int> & indexer, QList<
 	}
 }
 
+ConnectivityIndex & SketchWidget::connectivityIndex() {
+	return m_connectivityIndex;
+}
+
+FGraphicsScene * SketchWidget::fgraphicsScene() {
+	// the scene keeps registries of its ItemBases by type; use them rather than sweeping scene()->items()
+	return static_cast<FGraphicsScene *>(scene());
+}
+
 ViewLayer::ViewLayerPlacement SketchWidget::getViewLayerPlacement(ModelPart * modelPart, QDomElement & instance, QDomElement & view, ViewGeometry & viewGeometry)
 {
 	Q_UNUSED(instance);
@@ -9049,19 +9044,6 @@ void SketchWidget::renamePins(long id, const QStringList & labels, bool singleRo
 	paletteItem->renamePins(labels, singleRow);
 }
 
-bool SketchWidget::checkUpdateRatsnest(QList<ConnectorItem *> & connectorItems) {
-	foreach (ConnectorItem * ci, m_ratsnestUpdateConnect) {
-		if (!ci) continue;
-		if (connectorItems.contains(ci)) return true;
-	}
-	foreach (ConnectorItem * ci, m_ratsnestUpdateDisconnect) {
-		if (!ci) continue;
-		if (connectorItems.contains(ci)) return true;
-	}
-
-	return false;
-}
-
 void SketchWidget::getRatsnestColor(QColor & color)
 {
 	//RatsnestColors::reset(m_viewID);
@@ -9375,9 +9357,8 @@ void SketchWidget::selectItem(ItemBase * itemBase) {
 
 void SketchWidget::selectItemsWithModuleID(ModelPart * modelPart) {
 	QSet<ItemBase *> itemBases;
-	foreach (QGraphicsItem * item, scene()->items()) {
-		ItemBase * itemBase = dynamic_cast<ItemBase *>(item);
-		if (itemBase && itemBase->moduleID() == modelPart->moduleID()) {
+	foreach (ItemBase * itemBase, fgraphicsScene()->itemBases()) {
+		if (itemBase->moduleID() == modelPart->moduleID()) {
 			itemBases.insert(itemBase->layerKinChief());
 		}
 	}
@@ -10058,9 +10039,7 @@ void SketchWidget::testConnectors()
 void SketchWidget::updateWires() {
 	QList<ConnectorItem *> already;
 	ViewGeometry::WireFlag traceFlag = getTraceFlag();
-	foreach (QGraphicsItem * item, scene()->items()) {
-		Wire * wire = dynamic_cast<Wire *>(item);
-		if (!wire) continue;
+	foreach (Wire * wire, fgraphicsScene()->wires()) {
 		if (!wire->isTraceType(traceFlag)) continue;
 
 		ConnectorItem * from = wire->connector0()->firstConnectedToIsh();
@@ -10076,9 +10055,7 @@ void SketchWidget::viewGeometryConversionHack(ViewGeometry &, ModelPart *)  {
 void SketchWidget::checkForReversedWires() {
 	ViewGeometry::WireFlag traceFlag = getTraceFlag();
 	QList<Wire *> toReverse;
-	foreach (QGraphicsItem * item, scene()->items()) {
-		Wire * wire = dynamic_cast<Wire *>(item);
-		if (!wire) continue;
+	foreach (Wire * wire, fgraphicsScene()->wires()) {
 		if (!wire->isTraceType(traceFlag)) continue;
 
 		ConnectorItem * w0 = wire->connector0();
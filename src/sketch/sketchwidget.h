@@ -40,6 +40,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "../viewlayer.h"
 #include "../utils/misc.h"
 #include "../commands.h"
+#include "../connectors/connectivityindex.h"
+#include "fgraphicsscene.h"
 
 #include "renderthing.h"
 
@@ -74,6 +76,11 @@ struct SwapThing {
 	QMap<QString, QString> propsMap;
 };
 
+struct NetStatus {
+	QList<ConnectorItem *> partConnectorItems;      // visible part connectors on the net
+	RoutingStatus routingStatus;                    // what the net adds to the sketch's routing status
+};
+
 class SizeItem : public QObject, public QGraphicsLineItem
 {
 	Q_OBJECT
@@ -264,6 +271,8 @@ public:
 	void clearPasteOffset();
 	virtual ViewLayer::ViewLayerPlacement defaultViewLayerPlacement(ModelPart *);
 	void collectAllNets(QHash<class ConnectorItem *, int> & indexer, QList< QList<class ConnectorItem *>* > & allPartConnectorItems, bool includeSingletons, bool bothSides);
+	ConnectivityIndex & connectivityIndex();
+	FGraphicsScene * fgraphicsScene();
 	virtual bool routeBothSides();
 	virtual void changeLayer(long id, double z, ViewLayer::ViewLayerID viewLayerID);
 	void ratsnestConnect(ConnectorItem * connectorItem, bool connect);
@@ -481,7 +490,6 @@ protected:
 	void moveLegBendpoints(bool undoOnly, QUndoCommand * parentCommand);
 	void moveLegBendpointsAux(ConnectorItem * connectorItem, bool undoOnly, QUndoCommand * parentCommand);
 	virtual void rotatePartLabels(double degrees, QTransform &, QPointF center, QUndoCommand * parentCommand);
-	bool checkUpdateRatsnest(QList<ConnectorItem *> & connectorItems);
 	void makeRatsnestViewGeometry(ViewGeometry & viewGeometry, ConnectorItem * source, ConnectorItem * dest);
 	virtual double getTraceWidth();
 	virtual const QString & traceColor(ViewLayer::ViewLayerPlacement);
@@ -497,6 +505,7 @@ protected:
 	void rotateWire(Wire *, QTransform & rotation, QPointF center, bool undoOnly, QUndoCommand * parentCommand);
 	QString renderToSVG(RenderThing &, const LayerList &);
 	QString renderToSVG(RenderThing &, QList<QGraphicsItem *> & itemsAndLabels);
+	QString makeItemSvgFragment(ItemBase *, RenderThing &, QHash<QString, QString> & svgHash);
 	QList<ItemBase *> collectSuperSubs(ItemBase *);
 	void squashShapes(QPointF scenePos);
 	void unsquashShapes();
@@ -740,6 +749,8 @@ protected:
 	bool m_everZoomed = false;
 	double m_ratsnestOpacity = 0.0;
 	double m_ratsnestWidth = 0.0;
+	ConnectivityIndex m_connectivityIndex;
+	QHash<quint64, NetStatus> m_netStatusCache;		// net serial => status
 
 public:
 	static ViewLayer::ViewLayerID defaultConnectorLayer(ViewLayer::ViewID viewId);
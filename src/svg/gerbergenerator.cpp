@@ -21,6 +21,10 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QSvgRenderer>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrentRun>
 #include <qmath.h>
 
 #include "gerbergenerator.h"
@@ -51,6 +55,9 @@ const QString GerberGenerator::MagicBoardOutlineID = "boardoutline";
 
 const double GerberGenerator::MaskClearanceMils = 5;
 
+static QStringList PendingMessages;
+static QMutex PendingMessagesMutex;
+
 ////////////////////////////////////////////
 
 bool pixelsCollide(QImage * image1, QImage * image2, int x1, int y1, int x2, int y2) {
@@ -73,122 +80,214 @@ bool pixelsCollide(QImage * image1, QImage * image2, int x1, int y1, int x2, int
 
 ////////////////////////////////////////////
 
-void GerberGenerator::exportToGerber(const QString & prefix, const QString & exportDir, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes)
+QStringList GerberGenerator::exportToGerber(const QString & prefix, const QString & exportDir, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes)
 {
+	QStringList written;
 	if (board == nullptr) {
 		int boardCount;
 		board = sketchWidget->findSelectedBoard(boardCount);
 		if (boardCount == 0) {
 			DebugDialog::debug("board not found");
-			return;
+			return written;
 		}
 		if (board == nullptr) {
 			DebugDialog::debug("multiple boards found");
-			return;
+			return written;
 		}
 	}
 
-	exportPickAndPlace(prefix, exportDir, board, sketchWidget, displayMessageBoxes);
+	if (exportPickAndPlace(prefix, exportDir, board, sketchWidget, displayMessageBoxes)) {
+		written << exportDir + "/" + prefix + "_pnp.txt";
+	}
+
+	// only rendering the layers touches the scene, so that happens here on the gui thread;
+	// clipping and gerber conversion run afterwards on the thread pool
+	QList<GerberLayer> layers;
+	int boardLayers = sketchWidget->boardLayers();
 
 	LayerList viewLayerIDs = ViewLayer::copperLayers(ViewLayer::NewBottom);
-	int copperInvalidCount = doCopper(board, sketchWidget, viewLayerIDs, "Copper0", CopperBottomSuffix, prefix, exportDir, displayMessageBoxes);
+	doCopper(board, sketchWidget, viewLayerIDs, "Copper0", CopperBottomSuffix, displayMessageBoxes, layers);
 
-	if (sketchWidget->boardLayers() == 2) {
+	if (boardLayers == 2) {
 		viewLayerIDs = ViewLayer::copperLayers(ViewLayer::NewTop);
-		copperInvalidCount += doCopper(board, sketchWidget, viewLayerIDs, "Copper1", CopperTopSuffix, prefix, exportDir, displayMessageBoxes);
+		doCopper(board, sketchWidget, viewLayerIDs, "Copper1", CopperTopSuffix, displayMessageBoxes, layers);
 	}
 
 	LayerList maskLayerIDs = ViewLayer::maskLayers(ViewLayer::NewBottom);
-	QString maskBottom, maskTop;
-	int maskInvalidCount = doMask(maskLayerIDs, "Mask0", MaskBottomSuffix, board, sketchWidget, prefix, exportDir, displayMessageBoxes, maskBottom);
+	int maskBottom = doMask(maskLayerIDs, "Mask0", MaskBottomSuffix, board, sketchWidget, displayMessageBoxes, layers);
 
-	if (sketchWidget->boardLayers() == 2) {
+	int maskTop = -1;
+	if (boardLayers == 2) {
 		maskLayerIDs = ViewLayer::maskLayers(ViewLayer::NewTop);
-		maskInvalidCount += doMask(maskLayerIDs, "Mask1", MaskTopSuffix, board, sketchWidget, prefix, exportDir, displayMessageBoxes, maskTop);
+		maskTop = doMask(maskLayerIDs, "Mask1", MaskTopSuffix, board, sketchWidget, displayMessageBoxes, layers);
 	}
 
 	maskLayerIDs = ViewLayer::maskLayers(ViewLayer::NewBottom);
-	int pasteMaskInvalidCount = doPasteMask(maskLayerIDs, "PasteMask0", PasteMaskBottomSuffix, board, sketchWidget, prefix, exportDir, displayMessageBoxes);
+	doPasteMask(maskLayerIDs, "PasteMask0", PasteMaskBottomSuffix, board, sketchWidget, displayMessageBoxes, layers);
 
-	if (sketchWidget->boardLayers() == 2) {
+	if (boardLayers == 2) {
 		maskLayerIDs = ViewLayer::maskLayers(ViewLayer::NewTop);
-		pasteMaskInvalidCount += doPasteMask(maskLayerIDs, "PasteMask1", PasteMaskTopSuffix, board, sketchWidget, prefix, exportDir, displayMessageBoxes);
+		doPasteMask(maskLayerIDs, "PasteMask1", PasteMaskTopSuffix, board, sketchWidget, displayMessageBoxes, layers);
 	}
 
 	LayerList silkLayerIDs = ViewLayer::silkLayers(ViewLayer::NewTop);
-	int silkInvalidCount = doSilk(silkLayerIDs, "Silk1", SilkTopSuffix, board, sketchWidget, prefix, exportDir, displayMessageBoxes, maskTop);
+	int silkTop = doSilk(silkLayerIDs, "Silk1", SilkTopSuffix, board, sketchWidget, displayMessageBoxes, layers);
 	silkLayerIDs = ViewLayer::silkLayers(ViewLayer::NewBottom);
-	silkInvalidCount += doSilk(silkLayerIDs, "Silk0", SilkBottomSuffix, board, sketchWidget, prefix, exportDir, displayMessageBoxes, maskBottom);
+	int silkBottom = doSilk(silkLayerIDs, "Silk0", SilkBottomSuffix, board, sketchWidget, displayMessageBoxes, layers);
 
 	// now do it for the outline/contour
 	LayerList outlineLayerIDs = ViewLayer::outlineLayers();
 	bool empty;
 	QString svgOutline = renderTo(outlineLayerIDs, board, sketchWidget, empty);
-	if (empty || svgOutline.isEmpty()) {
+	bool outlineEmpty = empty || svgOutline.isEmpty();
+	if (outlineEmpty) {
 		displayMessage(QObject::tr("outline is empty"), displayMessageBoxes);
-		return;
 	}
+	else {
+		GerberLayer outline = makeLayer(board, boardLayers, "board", "contour", OutlineSuffix, SVG2gerber::ForOutline, GerberLayer::Outline, displayMessageBoxes);
+		// at this point svgOutline must be a single element; a path element may contain cutouts
+		outline.svg = cleanOutline(svgOutline);
+		layers << outline;
 
-	svgOutline = cleanOutline(svgOutline);
-	// at this point svgOutline must be a single element; a path element may contain cutouts
-	QMultiHash<long, ConnectorItem *> treatAsCircle;
-	svgOutline = clipToBoard(svgOutline, board, "board", SVG2gerber::ForOutline, "", displayMessageBoxes, treatAsCircle);
-	QSizeF svgSize = TextUtils::parseForWidthAndHeight(svgOutline);
+		doDrill(board, sketchWidget, displayMessageBoxes, layers);
+	}
 
-	// create outline gerber from svg
-	SVG2gerber outlineGerber;
-	int outlineInvalidCount = outlineGerber.convert(svgOutline, sketchWidget->boardLayers() == 2, "contour", SVG2gerber::ForOutline, svgSize * GraphicsUtils::StandardFritzingDPI);
+	// silk is clipped against the finished mask, so it can only start once the mask is done
+	QList< QFuture<void> > futures;
+	for (int i = 0; i < layers.count(); i++) {
+		if (i == silkTop || i == silkBottom) {
+			futures << QFuture<void>();
+			continue;
+		}
+		futures << QtConcurrent::run(processLayer, &layers[i]);
+	}
 
-	//DebugDialog::debug(QString("outline output: %1").arg(outlineGerber.getGerber()));
-	saveEnd("contour", exportDir, prefix, OutlineSuffix, displayMessageBoxes, outlineGerber);
+	if (silkTop >= 0) {
+		if (maskTop >= 0) {
+			futures[maskTop].waitForFinished();
+			layers[silkTop].clipString = layers.at(maskTop).clipped;
+		}
+		futures[silkTop] = QtConcurrent::run(processLayer, &layers[silkTop]);
+	}
+	if (silkBottom >= 0) {
+		if (maskBottom >= 0) {
+			futures[maskBottom].waitForFinished();
+			layers[silkBottom].clipString = layers.at(maskBottom).clipped;
+		}
+		futures[silkBottom] = QtConcurrent::run(processLayer, &layers[silkBottom]);
+	}
+
+	for (int i = 0; i < futures.count(); i++) {
+		futures[i].waitForFinished();
+	}
 
-	doDrill(board, sketchWidget, prefix, exportDir, displayMessageBoxes);
+	flushMessages();
+
+	int invalidCounts[GerberLayer::GroupCount] = { 0 };
+	foreach (GerberLayer layer, layers) {
+		if (layer.clipped.isEmpty() && layer.forWhy != SVG2gerber::ForOutline) {
+			if (!layer.failureMessage.isEmpty()) {
+				displayMessage(layer.failureMessage, displayMessageBoxes);
+			}
+			continue;
+		}
 
-	if (outlineInvalidCount > 0 || silkInvalidCount > 0 || copperInvalidCount > 0 || maskInvalidCount || pasteMaskInvalidCount) {
+		if (saveEnd(layer.layerName, exportDir, prefix, layer.suffix, displayMessageBoxes, layer.gerber)) {
+			written << exportDir + "/" + prefix + layer.suffix;
+		}
+		invalidCounts[layer.group] += layer.invalidCount;
+	}
+
+	if (outlineEmpty) return written;
+
+	if (invalidCounts[GerberLayer::Outline] > 0 || invalidCounts[GerberLayer::Silk] > 0 || invalidCounts[GerberLayer::Copper] > 0 || invalidCounts[GerberLayer::Mask] || invalidCounts[GerberLayer::PasteMask]) {
 		QString s;
-		if (outlineInvalidCount > 0) s += QObject::tr("the board outline layer, ");
-		if (silkInvalidCount > 0) s += QObject::tr("silkscreen layer(s), ");
-		if (copperInvalidCount > 0) s += QObject::tr("copper layer(s), ");
-		if (maskInvalidCount > 0) s += QObject::tr("mask layer(s), ");
-		if (pasteMaskInvalidCount > 0) s += QObject::tr("paste mask layer(s), ");
+		if (invalidCounts[GerberLayer::Outline] > 0) s += QObject::tr("the board outline layer, ");
+		if (invalidCounts[GerberLayer::Silk] > 0) s += QObject::tr("silkscreen layer(s), ");
+		if (invalidCounts[GerberLayer::Copper] > 0) s += QObject::tr("copper layer(s), ");
+		if (invalidCounts[GerberLayer::Mask] > 0) s += QObject::tr("mask layer(s), ");
+		if (invalidCounts[GerberLayer::PasteMask] > 0) s += QObject::tr("paste mask layer(s), ");
 		s.chop(2);
 		displayMessage(QObject::tr("Unable to translate svg curves in %1").arg(s), displayMessageBoxes);
 	}
 
+	return written;
 }
 
-int GerberGenerator::doCopper(ItemBase * board, PCBSketchWidget * sketchWidget, LayerList & viewLayerIDs, const QString & copperName, const QString & copperSuffix, const QString & filename, const QString & exportDir, bool displayMessageBoxes)
+GerberLayer GerberGenerator::makeLayer(ItemBase * board, int boardLayers, const QString & clipName, const QString & layerName, const QString & suffix, SVG2gerber::ForWhy forWhy, GerberLayer::Group group, bool displayMessageBoxes)
 {
-	bool empty;
-	QString svg = renderTo(viewLayerIDs, board, sketchWidget, empty);
-	if (empty || svg.isEmpty()) {
-		displayMessage(QObject::tr("%1 layer export is empty.").arg(copperName), displayMessageBoxes);
-		return 0;
+	GerberLayer layer;
+	layer.boardRect = board->sceneBoundingRect();
+	layer.boardRect.moveTo(0, 0);
+	layer.boardLayers = boardLayers;
+	layer.clipName = clipName;
+	layer.layerName = layerName;
+	layer.suffix = suffix;
+	layer.forWhy = forWhy;
+	layer.group = group;
+	layer.displayMessageBoxes = displayMessageBoxes;
+	layer.invalidCount = 0;
+	return layer;
+}
+
+void GerberGenerator::processLayer(GerberLayer * layer)
+{
+	// runs on a worker thread: everything it reads was copied out of the scene into the layer
+	if (layer->forWhy != SVG2gerber::ForOutline) {
+		layer->svgSize = TextUtils::parseForWidthAndHeight(layer->svg);
 	}
 
-	QMultiHash<long, ConnectorItem *> treatAsCircle;
+	layer->clipped = clipToBoard(layer->svg, layer->boardRect, layer->clipName, layer->forWhy, layer->clipString, layer->displayMessageBoxes, layer->treatAsCircle);
+	if (layer->clipped.isEmpty() && layer->forWhy != SVG2gerber::ForOutline) return;
+
+	if (layer->forWhy == SVG2gerber::ForOutline) {
+		layer->svgSize = TextUtils::parseForWidthAndHeight(layer->clipped);
+	}
+
+	SVG2gerber gerber;
+	layer->invalidCount = gerber.convert(layer->clipped, layer->boardLayers == 2, layer->layerName, layer->forWhy, layer->svgSize * GraphicsUtils::StandardFritzingDPI);
+	layer->gerber = gerber.getGerber();
+}
+
+void GerberGenerator::collectTreatAsCircle(ItemBase * board, PCBSketchWidget * sketchWidget, QMultiHash<long, DonutConnector> & treatAsCircle)
+{
 	foreach (QGraphicsItem * item, sketchWidget->scene()->collidingItems(board)) {
 		ConnectorItem * connectorItem = dynamic_cast<ConnectorItem *>(item);
 		if (connectorItem == nullptr) continue;
 		if (!connectorItem->isPath()) continue;
 		if (connectorItem->radius() == 0) continue;
 
-		treatAsCircle.insert(connectorItem->attachedToID(), connectorItem);
-	}
+		ItemBase * itemBase = connectorItem->attachedTo();
+		SvgIdLayer * svgIdLayer = connectorItem->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
+		if (svgIdLayer == nullptr) continue;
 
-	QSizeF svgSize = TextUtils::parseForWidthAndHeight(svg);
+		DonutConnector donut;
+		donut.svgID = svgIdLayer->m_svgId;
+		donut.radius = connectorItem->radius();
+		donut.strokeWidth = connectorItem->strokeWidth();
+		treatAsCircle.insert(connectorItem->attachedToID(), donut);
+	}
+}
 
-	svg = clipToBoard(svg, board, copperName, SVG2gerber::ForCopper, "", displayMessageBoxes, treatAsCircle);
-	if (svg.isEmpty()) {
-		displayMessage(QObject::tr("%1 layer export is empty (case 2).").arg(copperName), displayMessageBoxes);
-		return 0;
+int GerberGenerator::doCopper(ItemBase * board, PCBSketchWidget * sketchWidget, LayerList & viewLayerIDs, const QString & copperName, const QString & copperSuffix, bool displayMessageBoxes, QList<GerberLayer> & layers)
+{
+	bool empty;
+	QString svg = renderTo(viewLayerIDs, board, sketchWidget, empty);
+	if (empty || svg.isEmpty()) {
+		displayMessage(QObject::tr("%1 layer export is empty.").arg(copperName), displayMessageBoxes);
+		return -1;
 	}
 
-	return doEnd(svg, sketchWidget->boardLayers(), copperName, SVG2gerber::ForCopper, svgSize * GraphicsUtils::StandardFritzingDPI, exportDir, filename, copperSuffix, displayMessageBoxes);
+	GerberLayer layer = makeLayer(board, sketchWidget->boardLayers(), copperName, copperName, copperSuffix, SVG2gerber::ForCopper, GerberLayer::Copper, displayMessageBoxes);
+	layer.svg = svg;
+	layer.failureMessage = QObject::tr("%1 layer export is empty (case 2).").arg(copperName);
+	collectTreatAsCircle(board, sketchWidget, layer.treatAsCircle);
+	layers << layer;
+	return layers.count() - 1;
 }
 
 
-int GerberGenerator::doSilk(LayerList silkLayerIDs, const QString & silkName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes, const QString & clipString)
+int GerberGenerator::doSilk(LayerList silkLayerIDs, const QString & silkName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes, QList<GerberLayer> & layers)
 {
 
 	bool empty;
@@ -197,7 +296,7 @@ int GerberGenerator::doSilk(LayerList silkLayerIDs, const QString & silkName, co
 		if (silkLayerIDs.contains(ViewLayer::Silkscreen1)) {
 			displayMessage(QObject::tr("silk layer %1 export is empty").arg(silkName), displayMessageBoxes);
 		}
-		return 0;
+		return -1;
 	}
 
 	//QFile f(silkName + "original.svg");
@@ -206,26 +305,15 @@ int GerberGenerator::doSilk(LayerList silkLayerIDs, const QString & silkName, co
 	//fs << svgSilk;
 	//f.close();
 
-	QSizeF svgSize = TextUtils::parseForWidthAndHeight(svgSilk);
-
-	QMultiHash<long, ConnectorItem *> treatAsCircle;
-	svgSilk = clipToBoard(svgSilk, board, silkName, SVG2gerber::ForSilk, clipString, displayMessageBoxes, treatAsCircle);
-	if (svgSilk.isEmpty()) {
-		displayMessage(QObject::tr("silk export failure"), displayMessageBoxes);
-		return 0;
-	}
-
-	//QFile f2(silkName + "clipped.svg");
-	//f2.open(QFile::WriteOnly);
-	//QTextStream fs2(&f2);
-	//fs2 << svgSilk;
-	//f2.close();
-
-	return doEnd(svgSilk, sketchWidget->boardLayers(), silkName, SVG2gerber::ForSilk, svgSize * GraphicsUtils::StandardFritzingDPI, exportDir, filename, gerberSuffix, displayMessageBoxes);
+	GerberLayer layer = makeLayer(board, sketchWidget->boardLayers(), silkName, silkName, gerberSuffix, SVG2gerber::ForSilk, GerberLayer::Silk, displayMessageBoxes);
+	layer.svg = svgSilk;
+	layer.failureMessage = QObject::tr("silk export failure");
+	layers << layer;
+	return layers.count() - 1;
 }
 
 
-int GerberGenerator::doDrill(ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes)
+int GerberGenerator::doDrill(ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes, QList<GerberLayer> & layers)
 {
 	LayerList drillLayerIDs;
 	drillLayerIDs << ViewLayer::drillLayers();
@@ -234,30 +322,18 @@ int GerberGenerator::doDrill(ItemBase * board, PCBSketchWidget * sketchWidget, c
 	QString svgDrill = renderTo(drillLayerIDs, board, sketchWidget, empty);
 	if (empty || svgDrill.isEmpty()) {
 		displayMessage(QObject::tr("exported drill file is empty"), displayMessageBoxes);
-		return 0;
-	}
-
-	QSizeF svgSize = TextUtils::parseForWidthAndHeight(svgDrill);
-	QMultiHash<long, ConnectorItem *> treatAsCircle;
-	foreach (QGraphicsItem * item, sketchWidget->scene()->collidingItems(board)) {
-		ConnectorItem * connectorItem = dynamic_cast<ConnectorItem *>(item);
-		if (connectorItem == nullptr) continue;
-		if (!connectorItem->isPath()) continue;
-		if (connectorItem->radius() == 0) continue;
-
-		treatAsCircle.insert(connectorItem->attachedToID(), connectorItem);
-	}
-
-	svgDrill = clipToBoard(svgDrill, board, "Copper0", SVG2gerber::ForDrill, "", displayMessageBoxes, treatAsCircle);
-	if (svgDrill.isEmpty()) {
-		displayMessage(QObject::tr("drill export failure"), displayMessageBoxes);
-		return 0;
+		return -1;
 	}
 
-	return doEnd(svgDrill, sketchWidget->boardLayers(), "drill", SVG2gerber::ForDrill, svgSize * GraphicsUtils::StandardFritzingDPI, exportDir, filename, DrillSuffix, displayMessageBoxes);
+	GerberLayer layer = makeLayer(board, sketchWidget->boardLayers(), "Copper0", "drill", DrillSuffix, SVG2gerber::ForDrill, GerberLayer::Drill, displayMessageBoxes);
+	layer.svg = svgDrill;
+	layer.failureMessage = QObject::tr("drill export failure");
+	collectTreatAsCircle(board, sketchWidget, layer.treatAsCircle);
+	layers << layer;
+	return layers.count() - 1;
 }
 
-int GerberGenerator::doMask(LayerList maskLayerIDs, const QString &maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes, QString & clipString)
+int GerberGenerator::doMask(LayerList maskLayerIDs, const QString &maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes, QList<GerberLayer> & layers)
 {
 	// don't want these in the mask laqyer
 	QList<ItemBase *> copperLogoItems;
@@ -269,29 +345,23 @@ int GerberGenerator::doMask(LayerList maskLayerIDs, const QString &maskName, con
 
 	if (empty || svgMask.isEmpty()) {
 		displayMessage(QObject::tr("exported mask layer %1 is empty").arg(maskName), displayMessageBoxes);
-		return 0;
+		return -1;
 	}
 
 	svgMask = TextUtils::expandAndFill(svgMask, "black", MaskClearanceMils * 2);
 	if (svgMask.isEmpty()) {
 		displayMessage(QObject::tr("%1 mask export failure (2)").arg(maskName), displayMessageBoxes);
-		return 0;
+		return -1;
 	}
 
-	QSizeF svgSize = TextUtils::parseForWidthAndHeight(svgMask);
-	QMultiHash<long, ConnectorItem *> treatAsCircle;
-	svgMask = clipToBoard(svgMask, board, maskName, SVG2gerber::ForCopper, "", displayMessageBoxes, treatAsCircle);
-	if (svgMask.isEmpty()) {
-		displayMessage(QObject::tr("mask export failure"), displayMessageBoxes);
-		return 0;
-	}
-
-	clipString = svgMask;
-
-	return doEnd(svgMask, sketchWidget->boardLayers(), maskName, SVG2gerber::ForCopper, svgSize * GraphicsUtils::StandardFritzingDPI, exportDir, filename, gerberSuffix, displayMessageBoxes);
+	GerberLayer layer = makeLayer(board, sketchWidget->boardLayers(), maskName, maskName, gerberSuffix, SVG2gerber::ForCopper, GerberLayer::Mask, displayMessageBoxes);
+	layer.svg = svgMask;
+	layer.failureMessage = QObject::tr("mask export failure");
+	layers << layer;
+	return layers.count() - 1;
 }
 
-int GerberGenerator::doPasteMask(LayerList maskLayerIDs, const QString &maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes)
+int GerberGenerator::doPasteMask(LayerList maskLayerIDs, const QString &maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes, QList<GerberLayer> & layers)
 {
 	// don't want these in the mask laqyer
 	QList<ItemBase *> copperLogoItems;
@@ -306,21 +376,17 @@ int GerberGenerator::doPasteMask(LayerList maskLayerIDs, const QString &maskName
 
 	if (empty || svgMask.isEmpty()) {
 		displayMessage(QObject::tr("exported paste mask layer is empty"), displayMessageBoxes);
-		return 0;
+		return -1;
 	}
 
 	svgMask = sketchWidget->makePasteMask(svgMask, board, GraphicsUtils::StandardFritzingDPI, maskLayerIDs);
-	if (svgMask.isEmpty()) return 0;
+	if (svgMask.isEmpty()) return -1;
 
-	QSizeF svgSize = TextUtils::parseForWidthAndHeight(svgMask);
-	QMultiHash<long, ConnectorItem *> treatAsCircle;
-	svgMask = clipToBoard(svgMask, board, maskName, SVG2gerber::ForCopper, "", displayMessageBoxes, treatAsCircle);
-	if (svgMask.isEmpty()) {
-		displayMessage(QObject::tr("mask export failure"), displayMessageBoxes);
-		return 0;
-	}
-
-	return doEnd(svgMask, sketchWidget->boardLayers(), maskName, SVG2gerber::ForCopper, svgSize * GraphicsUtils::StandardFritzingDPI, exportDir, filename, gerberSuffix, displayMessageBoxes);
+	GerberLayer layer = makeLayer(board, sketchWidget->boardLayers(), maskName, maskName, gerberSuffix, SVG2gerber::ForCopper, GerberLayer::PasteMask, displayMessageBoxes);
+	layer.svg = svgMask;
+	layer.failureMessage = QObject::tr("mask export failure");
+	layers << layer;
+	return layers.count() - 1;
 }
 
 int GerberGenerator::doEnd(const QString & svg, int boardLayers, const QString & layerName, SVG2gerber::ForWhy forWhy, QSizeF svgSize,
@@ -330,12 +396,12 @@ int GerberGenerator::doEnd(const QString & svg, int boardLayers, const QString &
 	SVG2gerber gerber;
 	int invalidCount = gerber.convert(svg, boardLayers == 2, layerName, forWhy, svgSize);
 
-	saveEnd(layerName, exportDir, prefix, suffix, displayMessageBoxes, gerber);
+	saveEnd(layerName, exportDir, prefix, suffix, displayMessageBoxes, gerber.getGerber());
 
 	return invalidCount;
 }
 
-bool GerberGenerator::saveEnd(const QString & layerName, const QString & exportDir, const QString & prefix, const QString & suffix, bool displayMessageBoxes, SVG2gerber & gerber)
+bool GerberGenerator::saveEnd(const QString & layerName, const QString & exportDir, const QString & prefix, const QString & suffix, bool displayMessageBoxes, const QString & gerber)
 {
 
 	QString outname = exportDir + "/" +  prefix + suffix;
@@ -346,7 +412,7 @@ bool GerberGenerator::saveEnd(const QString & layerName, const QString & exportD
 	}
 
 	QTextStream stream(&out);
-	stream << gerber.getGerber();
+	stream << gerber;
 	stream.flush();
 	out.close();
 	return true;
@@ -356,6 +422,13 @@ bool GerberGenerator::saveEnd(const QString & layerName, const QString & exportD
 void GerberGenerator::displayMessage(const QString & message, bool displayMessageBoxes) {
 	// don't use QMessageBox if running conversion as a service
 	if (displayMessageBoxes) {
+		if (QThread::currentThread() != QCoreApplication::instance()->thread()) {
+			// message boxes can only be shown from the gui thread; see flushMessages()
+			QMutexLocker locker(&PendingMessagesMutex);
+			PendingMessages << message;
+			return;
+		}
+
 		QMessageBox::warning(nullptr, QObject::tr("Fritzing"), message);
 		return;
 	}
@@ -363,13 +436,25 @@ void GerberGenerator::displayMessage(const QString & message, bool displayMessag
 	DebugDialog::debug(message);
 }
 
-QString GerberGenerator::clipToBoard(QString svgString, ItemBase * board, const QString & layerName, SVG2gerber::ForWhy forWhy, const QString & clipString, bool displayMessageBoxes, QMultiHash<long, ConnectorItem *> & treatAsCircle) {
+void GerberGenerator::flushMessages() {
+	QStringList messages;
+	PendingMessagesMutex.lock();
+	messages = PendingMessages;
+	PendingMessages.clear();
+	PendingMessagesMutex.unlock();
+
+	foreach (QString message, messages) {
+		QMessageBox::warning(nullptr, QObject::tr("Fritzing"), message);
+	}
+}
+
+QString GerberGenerator::clipToBoard(QString svgString, ItemBase * board, const QString & layerName, SVG2gerber::ForWhy forWhy, const QString & clipString, bool displayMessageBoxes, const QMultiHash<long, DonutConnector> & treatAsCircle) {
 	QRectF source = board->sceneBoundingRect();
 	source.moveTo(0, 0);
 	return clipToBoard(svgString, source, layerName, forWhy, clipString, displayMessageBoxes, treatAsCircle);
 }
 
-QString GerberGenerator::clipToBoard(QString svgString, QRectF & boardRect, const QString & layerName, SVG2gerber::ForWhy forWhy, const QString & clipString, bool displayMessageBoxes, QMultiHash<long, ConnectorItem *> & treatAsCircle) {
+QString GerberGenerator::clipToBoard(QString svgString, QRectF & boardRect, const QString & layerName, SVG2gerber::ForWhy forWhy, const QString & clipString, bool displayMessageBoxes, const QMultiHash<long, DonutConnector> & treatAsCircle) {
 	// document 1 will contain svg that is easy to convert to gerber
 	QDomDocument domDocument1;
 	QString errorStr;
@@ -417,26 +502,13 @@ QString GerberGenerator::clipToBoard(QString svgString, QRectF & boardRect, cons
 		anyConverted = true;
 	}
 
-	// gerber can't handle ellipses that are rotated, so cull them all
-	if (TextUtils::squashElement(domDocument1, "ellipse", "", QRegExp())) {
-		anyConverted = true;
-	}
-
-	if (TextUtils::squashElement(domDocument1, "rect", "rx", QRegExp())) {
-		anyConverted = true;
-	}
-
-	if (TextUtils::squashElement(domDocument1, "rect", "ry", QRegExp())) {
-		anyConverted = true;
-	}
-
-	// gerber can't handle paths with curves
-	if (TextUtils::squashElement(domDocument1, "path", "d", AaCc)) {
-		anyConverted = true;
-	}
+	// ellipses, rounded rects and curved paths are converted by SVG2gerber into arcs and flattened curves,
+	// unless they are scaled or rotated (see below)
 
 	// gerber can't handle multiple subpaths if there are intersections
-	if (TextUtils::squashElement(domDocument1, "path", "d", MultipleZs)) {
+	// (local copy of the regexp: QRegExp keeps match state, and layers are clipped concurrently)
+	QRegExp multipleZs(MultipleZs);
+	if (TextUtils::squashElement(domDocument1, "path", "d", multipleZs)) {
 		anyConverted = true;
 	}
 
@@ -446,16 +518,28 @@ QString GerberGenerator::clipToBoard(QString svgString, QRectF & boardRect, cons
 
 	// can't handle scaled paths very well. There is probably a deeper bug that needs to be chased down.
 	// is this only necessary for contour view?
-	QDomNodeList nodeList = root1.elementsByTagName("path");
-	for (int i = 0; i < nodeList.count(); i++) {
-		QDomNode parent = nodeList.at(i);
+	// the same goes for ellipses and rounded rects, which become paths with arcs in SVG2gerber
+	QList<QDomElement> scalable;
+	QStringList scalableTags;
+	scalableTags << "path" << "ellipse" << "rect";
+	foreach (QString tag, scalableTags) {
+		QDomNodeList nodeList = root1.elementsByTagName(tag);
+		for (int i = 0; i < nodeList.count(); i++) {
+			QDomElement element = nodeList.at(i).toElement();
+			if (tag == "rect" && !element.hasAttribute("rx") && !element.hasAttribute("ry")) continue;
+
+			scalable << element;
+		}
+	}
+	foreach (QDomElement element, scalable) {
+		QDomNode parent = element;
 		while (!parent.isNull()) {
 			QString transformString = parent.toElement().attribute("transform");
 			if (!transformString.isNull()) {
 				QMatrix matrix = TextUtils::transformStringToMatrix(transformString);
 				QTransform transform(matrix);
 				if (transform.isScaling()) {
-					nodeList.at(i).toElement().setTagName("g");
+					element.setTagName("g");
 					anyConverted = true;
 					break;
 				}
@@ -825,6 +909,8 @@ QString GerberGenerator::makePath(QImage & image, double unit, const QString & c
 bool GerberGenerator::dealWithMultipleContours(QDomElement & root, bool displayMessageBoxes) {
 	bool multipleContours = false;
 	bool contoursOK = true;
+	QRegExp multipleZs(MultipleZs);
+	QRegExp mFinder(MFinder);
 
 	// split path into multiple contours
 	QDomNodeList paths = root.elementsByTagName("path");
@@ -832,7 +918,7 @@ bool GerberGenerator::dealWithMultipleContours(QDomElement & root, bool displayM
 	for (int p = 0; p < paths.count() && contoursOK; p++) {
 		QDomElement path = paths.at(p).toElement();
 		QString originalPath = path.attribute("d", "").trimmed();
-		if (MultipleZs.indexIn(originalPath) < 0) continue;
+		if (multipleZs.indexIn(originalPath) < 0) continue;
 
 		multipleContours = true;
 		QStringList subpaths = path.attribute("d").split("z", QString::SkipEmptyParts);
@@ -858,22 +944,22 @@ bool GerberGenerator::dealWithMultipleContours(QDomElement & root, bool displayM
 	for (int p = 0; p < paths.count(); p++) {
 		QDomElement path = paths.at(p).toElement();
 		QString originalPath = path.attribute("d", "").trimmed();
-		if (MultipleZs.indexIn(originalPath) >= 0) {
+		if (multipleZs.indexIn(originalPath) >= 0) {
 			QStringList subpaths = path.attribute("d").split("z", QString::SkipEmptyParts, Qt::CaseInsensitive);
-			MFinder.indexIn(subpaths.at(0).trimmed());
-			QString priorM = MFinder.cap(1) + MFinder.cap(2) + "," + MFinder.cap(3) + " ";
+			mFinder.indexIn(subpaths.at(0).trimmed());
+			QString priorM = mFinder.cap(1) + mFinder.cap(2) + "," + mFinder.cap(3) + " ";
 			for (int i = 1; i < subpaths.count(); i++) {
 				QDomElement newPath = path.cloneNode(true).toElement();
 				QString z = ((i < subpaths.count() - 1) || originalPath.endsWith("z", Qt::CaseInsensitive)) ? "z" : "";
 				QString d = subpaths.at(i).trimmed() + z;
-				MFinder.indexIn(d);
+				mFinder.indexIn(d);
 				if (d.startsWith("m", Qt::CaseSensitive)) {
 					d = priorM + d;
 				}
-				if (MFinder.cap(1) == "M") {
-					priorM = MFinder.cap(1) + MFinder.cap(2) + "," + MFinder.cap(3) + " ";
+				if (mFinder.cap(1) == "M") {
+					priorM = mFinder.cap(1) + mFinder.cap(2) + "," + mFinder.cap(3) + " ";
 				} else {
-					priorM += MFinder.cap(1) + MFinder.cap(2) + "," + MFinder.cap(3) + " ";
+					priorM += mFinder.cap(1) + mFinder.cap(2) + "," + mFinder.cap(3) + " ";
 				}
 				newPath.setAttribute("d",  d);
 				path.parentNode().appendChild(newPath);
@@ -885,7 +971,7 @@ bool GerberGenerator::dealWithMultipleContours(QDomElement & root, bool displayM
 	return true;
 }
 
-void GerberGenerator::exportPickAndPlace(const QString & prefix, const QString & exportDir, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes)
+bool GerberGenerator::exportPickAndPlace(const QString & prefix, const QString & exportDir, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes)
 {
 	QPointF bottomLeft = board->sceneBoundingRect().bottomLeft();
 	QSet<ItemBase *> itemBases;
@@ -906,7 +992,7 @@ void GerberGenerator::exportPickAndPlace(const QString & prefix, const QString &
 	QFile out(outname);
 	if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) {
 		displayMessage(QObject::tr("Unable to save pick and place file: %2").arg(outname), displayMessageBoxes);
-		return;
+		return false;
 	}
 
 	QTextStream stream(&out);
@@ -964,9 +1050,10 @@ void GerberGenerator::exportPickAndPlace(const QString & prefix, const QString &
 	}
 
 	out.close();
+	return true;
 }
 
-void GerberGenerator::handleDonuts(QDomElement & root1, QMultiHash<long, ConnectorItem *> & treatAsCircle) {
+void GerberGenerator::handleDonuts(QDomElement & root1, const QMultiHash<long, DonutConnector> & treatAsCircle) {
 	// most of this would not be necessary if we cached cleaned SVGs
 
 	static const QString unique("%%%%%%%%%%%%%%%%%%%%%%%%_________________________________%%%%%%%%%%%%%%%%%%%%%%%%%%%%%");
@@ -974,11 +1061,9 @@ void GerberGenerator::handleDonuts(QDomElement & root1, QMultiHash<long, Connect
 	QDomNodeList nodeList = root1.elementsByTagName("path");
 	if (treatAsCircle.count() > 0) {
 		QStringList ids;
-		foreach (ConnectorItem * connectorItem, treatAsCircle.values()) {
-			ItemBase * itemBase = connectorItem->attachedTo();
-			SvgIdLayer * svgIdLayer = connectorItem->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
-			DebugDialog::debug(QString("treat as circle %1").arg(svgIdLayer->m_svgId));
-			ids << svgIdLayer->m_svgId;
+		foreach (DonutConnector donut, treatAsCircle.values()) {
+			DebugDialog::debug(QString("treat as circle %1").arg(donut.svgID));
+			ids << donut.svgID;
 		}
 
 		for (int n = 0; n < nodeList.count(); n++) {
@@ -990,33 +1075,33 @@ void GerberGenerator::handleDonuts(QDomElement & root1, QMultiHash<long, Connect
 			if (!ids.contains(id)) continue;
 
 			QString pid;
-			ConnectorItem * connectorItem = nullptr;
+			DonutConnector donut;
+			bool found = false;
 			for (QDomElement parent = path.parentNode().toElement(); !parent.isNull(); parent = parent.parentNode().toElement()) {
 				pid = parent.attribute("partID");
 				if (pid.isEmpty()) continue;
 
-				QList<ConnectorItem *> connectorItems = treatAsCircle.values(pid.toLong());
-				if (connectorItems.count() == 0) break;
+				QList<DonutConnector> candidates = treatAsCircle.values(pid.toLong());
+				if (candidates.count() == 0) break;
 
-				foreach (ConnectorItem * candidate, connectorItems) {
-					ItemBase * itemBase = candidate->attachedTo();
-					SvgIdLayer * svgIdLayer = candidate->connector()->fullPinInfo(itemBase->viewID(), itemBase->viewLayerID());
-					if (svgIdLayer->m_svgId == id) {
-						connectorItem = candidate;
+				foreach (DonutConnector candidate, candidates) {
+					if (candidate.svgID == id) {
+						donut = candidate;
+						found = true;
 						break;
 					}
 				}
 
-				if (connectorItem) break;
+				if (found) break;
 			}
-			if (connectorItem == nullptr) continue;
+			if (!found) continue;
 
 			//QString string;
 			//QTextStream stream(&string);
 			//path.save(stream, 0);
 			//DebugDialog::debug("path " + string);
 
-			connectorItem->debugInfo("make path");
+			DebugDialog::debug(QString("make path %1 in %2").arg(id).arg(pid));
 			path.setAttribute("id", unique);
 			QSvgRenderer renderer;
 			renderer.load(root1.ownerDocument().toByteArray());
@@ -1029,8 +1114,8 @@ void GerberGenerator::handleDonuts(QDomElement & root1, QMultiHash<long, Connect
 			QPointF p = bounds.center();
 			circle.setAttribute("cx", QString::number(p.x()));
 			circle.setAttribute("cy", QString::number(p.y()));
-			circle.setAttribute("r", QString::number(connectorItem->radius() * GraphicsUtils::StandardFritzingDPI / GraphicsUtils::SVGDPI));
-			circle.setAttribute("stroke-width", QString::number(connectorItem->strokeWidth() * GraphicsUtils::StandardFritzingDPI / GraphicsUtils::SVGDPI));
+			circle.setAttribute("r", QString::number(donut.radius * GraphicsUtils::StandardFritzingDPI / GraphicsUtils::SVGDPI));
+			circle.setAttribute("stroke-width", QString::number(donut.strokeWidth * GraphicsUtils::StandardFritzingDPI / GraphicsUtils::SVGDPI));
 
 		}
 	}
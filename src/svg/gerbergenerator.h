@@ -22,17 +22,61 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #define GERBERGENERATOR_H
 
 #include <QString>
+#include <QStringList>
+#include <QMultiHash>
+#include <QRectF>
+#include <QSizeF>
 
 #include "../viewlayer.h"
 #include "svg2gerber.h"
 
+// a connector drawn as a circle, read from the scene on the gui thread so layers can be clipped without it
+struct DonutConnector {
+	QString svgID;
+	double radius;
+	double strokeWidth;
+};
+
+// one gerber layer: the svg is rendered from the scene on the gui thread,
+// everything else is filled in by GerberGenerator::processLayer on a worker thread
+struct GerberLayer {
+	enum Group {
+		Copper,
+		Mask,
+		PasteMask,
+		Silk,
+		Outline,
+		Drill,
+		GroupCount
+	};
+
+	QString svg;
+	QString clipName;
+	QString layerName;
+	QString suffix;
+	QString clipString;
+	QString failureMessage;
+	QRectF boardRect;
+	int boardLayers;
+	SVG2gerber::ForWhy forWhy;
+	Group group;
+	bool displayMessageBoxes;
+	QMultiHash<long, DonutConnector> treatAsCircle;
+
+	QSizeF svgSize;
+	QString clipped;
+	QString gerber;
+	int invalidCount;
+};
+
 class GerberGenerator
 {
 
 public:
-	static void exportToGerber(const QString & prefix, const QString & exportDir, class ItemBase * board, class PCBSketchWidget *, bool displayMessageBoxes);
-	static QString clipToBoard(QString svgString, QRectF & boardRect, const QString & layerName, SVG2gerber::ForWhy, const QString & clipString, bool displayMessageBoxes, QMultiHash<long, class ConnectorItem *> & treatAsCircle);
-	static QString clipToBoard(QString svgString, ItemBase * board, const QString & layerName, SVG2gerber::ForWhy, const QString & clipString, bool displayMessageBoxes, QMultiHash<long, class ConnectorItem *> & treatAsCircle);
+	static QStringList exportToGerber(const QString & prefix, const QString & exportDir, class ItemBase * board, class PCBSketchWidget *, bool displayMessageBoxes);		// returns the paths of the files written
+	static QString clipToBoard(QString svgString, QRectF & boardRect, const QString & layerName, SVG2gerber::ForWhy, const QString & clipString, bool displayMessageBoxes, const QMultiHash<long, DonutConnector> & treatAsCircle);
+	static QString clipToBoard(QString svgString, ItemBase * board, const QString & layerName, SVG2gerber::ForWhy, const QString & clipString, bool displayMessageBoxes, const QMultiHash<long, DonutConnector> & treatAsCircle);
+	static void collectTreatAsCircle(ItemBase * board, PCBSketchWidget * sketchWidget, QMultiHash<long, DonutConnector> & treatAsCircle);
 	static int doEnd(const QString & svg, int boardLayers, const QString & layerName, SVG2gerber::ForWhy forWhy, QSizeF svgSize,
 	                 const QString & exportDir, const QString & prefix, const QString & suffix, bool displayMessageBoxes);
 	static QString cleanOutline(const QString & svgOutline);
@@ -53,18 +97,21 @@ public:
 	static const double MaskClearanceMils;
 
 protected:
-	static int doSilk(LayerList silkLayerIDs, const QString & silkName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes, const QString & clipString);
-	static int doMask(LayerList maskLayerIDs, const QString & maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes, QString & clipString);
-	static int doPasteMask(LayerList maskLayerIDs, const QString & maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes);
-	static int doCopper(ItemBase * board, PCBSketchWidget * sketchWidget, LayerList & viewLayerIDs, const QString & copperName, const QString & copperSuffix, const QString & filename, const QString & exportDir, bool displayMessageBoxes);
-	static int doDrill(ItemBase * board, PCBSketchWidget * sketchWidget, const QString & filename, const QString & exportDir, bool displayMessageBoxes);
+	static int doSilk(LayerList silkLayerIDs, const QString & silkName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes, QList<GerberLayer> &);
+	static int doMask(LayerList maskLayerIDs, const QString & maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes, QList<GerberLayer> &);
+	static int doPasteMask(LayerList maskLayerIDs, const QString & maskName, const QString & gerberSuffix, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes, QList<GerberLayer> &);
+	static int doCopper(ItemBase * board, PCBSketchWidget * sketchWidget, LayerList & viewLayerIDs, const QString & copperName, const QString & copperSuffix, bool displayMessageBoxes, QList<GerberLayer> &);
+	static int doDrill(ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes, QList<GerberLayer> &);
+	static GerberLayer makeLayer(ItemBase * board, int boardLayers, const QString & clipName, const QString & layerName, const QString & suffix, SVG2gerber::ForWhy, GerberLayer::Group, bool displayMessageBoxes);
+	static void processLayer(GerberLayer *);
 	static void displayMessage(const QString & message, bool displayMessageBoxes);
-	static bool saveEnd(const QString & layerName, const QString & exportDir, const QString & prefix, const QString & suffix, bool displayMessageBoxes, SVG2gerber & gerber);
+	static void flushMessages();
+	static bool saveEnd(const QString & layerName, const QString & exportDir, const QString & prefix, const QString & suffix, bool displayMessageBoxes, const QString & gerber);
 	static void mergeOutlineElement(QImage & image, QRectF & target, double res, QDomDocument & document, QString & svgString, int ix, const QString & layerName);
 	static QString makePath(QImage & image, double unit, const QString & colorString);
 	static bool dealWithMultipleContours(QDomElement & root, bool displayMessageBoxes);
-	static void exportPickAndPlace(const QString & prefix, const QString & exportDir, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes);
-	static void handleDonuts(QDomElement & root1, QMultiHash<long, ConnectorItem *> & treatAsCircle);
+	static bool exportPickAndPlace(const QString & prefix, const QString & exportDir, ItemBase * board, PCBSketchWidget * sketchWidget, bool displayMessageBoxes);
+	static void handleDonuts(QDomElement & root1, const QMultiHash<long, DonutConnector> & treatAsCircle);
 	static QString renderTo(const LayerList &, ItemBase * board, PCBSketchWidget * sketchWidget, bool & empty);
 
 };
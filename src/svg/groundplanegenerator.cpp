@@ -19,6 +19,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 ********************************************************************/
 
 #include "groundplanegenerator.h"
+#include "pourgeometry.h"
 #include "svgfilesplitter.h"
 #include "../fsvgrenderer.h"
 #include "../debugdialog.h"
@@ -29,18 +30,26 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "../items/wire.h"
 #include "../processeventblocker.h"
 #include "../autoroute/drc.h"
+#include "../autoroute/drcgeometry.h"
 
 #include <QBitArray>
 #include <QPainter>
 #include <QSvgRenderer>
 #include <QDate>
 #include <QTextStream>
+#include <QSettings>
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <qmath.h>
 
 #include <boost/math/special_functions/relative_difference.hpp>
 using boost::math::epsilon_difference;
 
 #include <limits>
+#include <algorithm>
 #include <QtConcurrentRun>
 
 // factor for epsion to compare floating point numbers
@@ -51,6 +60,18 @@ static const double BORDERINCHES = 0.04;
 
 const QString GroundPlaneGenerator::KeepoutSettingName("GPG_Keepout");
 const double GroundPlaneGenerator::KeepoutDefaultMils = 10;
+const QString GroundPlaneGenerator::EngineSettingName("GPG_Engine");
+const QString GroundPlaneGenerator::VectorEngine("vector");
+const QString GroundPlaneGenerator::RasterEngine("raster");
+const double GroundPlaneGenerator::TileSizeMils = 500;
+
+// pours are kept per tile, keyed by a hash of the board and of the copper inside the tile,
+// so a refill only recomputes the tiles whose copper changed since the last one
+static QCache<QByteArray, QPainterPath> PourCache(4096);
+static QMutex PourCacheMutex;
+
+// postPourSlot looks at the scene, so layers filled at the same time take turns
+static QMutex PostPourMutex;
 
 inline int OFFSET(int x, int y, QImage * image) {
 	return (y * image->width()) + x;
@@ -169,13 +190,34 @@ bool GroundPlaneGenerator::generateGroundPlaneUnit(const QString & boardSvg, QSi
 	params.color = color;
 	params.keepoutMils = keepoutMils;
 
+	QRectF bsbr = board->sceneBoundingRect();
+
+	// the raster fill is the fallback whenever the vector pour can't be made
+	QList<QPolygon> pieces;
+	QPainterPath boardPath;
+	if (useVectorFill() && vectorPour(params, pieces, boardPath)) {
+		QPoint s(qRound((whereToStart.x() - bsbr.left()) * GraphicsUtils::StandardFritzingDPI / GraphicsUtils::SVGDPI),
+				 qRound((whereToStart.y() - bsbr.top()) * GraphicsUtils::StandardFritzingDPI / GraphicsUtils::SVGDPI));
+		foreach (QPolygon piece, pieces) {
+			if (!piece.containsPoint(s, Qt::WindingFill)) continue;
+
+			QList<QPolygon> polygons;
+			polygons << piece;
+			double bWidth = res * bsbr.width() / GraphicsUtils::SVGDPI;
+			double bHeight = res * bsbr.height() / GraphicsUtils::SVGDPI;
+			makePolySvg(polygons, res, bWidth, bHeight, GraphicsUtils::StandardFritzingDPI / res, color, true, true, QSizeF(.05, .05), 1 / GraphicsUtils::SVGDPI, QPointF(0,0));
+			return true;
+		}
+
+		// starting off in bad territory
+		return false;
+	}
+
 	double bWidth, bHeight;
 	QList<QRectF> rects;
 	QImage * image = generateGroundPlaneAux(params, bWidth, bHeight, rects);
 	if (image == nullptr) return false;
 
-	QRectF bsbr = board->sceneBoundingRect();
-
 	QPoint s(qRound(res * (whereToStart.x() - bsbr.topLeft().x()) / GraphicsUtils::SVGDPI),
 			 qRound(res * (whereToStart.y() - bsbr.topLeft().y()) / GraphicsUtils::SVGDPI));
 
@@ -246,6 +288,16 @@ bool GroundPlaneGenerator::generateGroundPlaneUnit(const QString & boardSvg, QSi
 
 bool GroundPlaneGenerator::generateGroundPlane(const QString & boardSvg, QSizeF boardImageSize, const QString & svg, QSizeF copperImageSize,
 		QStringList & exceptions, QGraphicsItem * board, double res, const QString & color, double keepoutMils)
+{
+	QFuture<bool> future = startGroundPlane(boardSvg, boardImageSize, svg, copperImageSize, exceptions, board, res, color, keepoutMils);
+	while (!future.isFinished()) {
+		ProcessEventBlocker::processEvents(200);
+	}
+	return future.result();
+}
+
+QFuture<bool> GroundPlaneGenerator::startGroundPlane(const QString & boardSvg, QSizeF boardImageSize, const QString & svg, QSizeF copperImageSize,
+		QStringList & exceptions, QGraphicsItem * board, double res, const QString & color, double keepoutMils)
 {
 	GPGParams params;
 	params.boardSvg = boardSvg;
@@ -257,11 +309,7 @@ bool GroundPlaneGenerator::generateGroundPlane(const QString & boardSvg, QSizeF
 	params.board = board;
 	params.res = res;
 	params.color = color;
-	QFuture<bool> future = QtConcurrent::run(this, &GroundPlaneGenerator::generateGroundPlaneFn, params);
-	while (!future.isFinished()) {
-		ProcessEventBlocker::processEvents(200);
-	}
-	return future.result();
+	return QtConcurrent::run(this, &GroundPlaneGenerator::generateGroundPlaneFn, params);
 }
 
 bool GroundPlaneGenerator::generateGroundPlaneFn(GPGParams & params)
@@ -269,11 +317,35 @@ bool GroundPlaneGenerator::generateGroundPlaneFn(GPGParams & params)
 
 	double bWidth, bHeight;
 	QList<QRectF> rects;
-	QImage * image = generateGroundPlaneAux(params, bWidth, bHeight, rects);
-	if (image == nullptr) return false;
-
 	double pixelFactor = GraphicsUtils::StandardFritzingDPI / params.res;
-	scanImage(*image, bWidth, bHeight, pixelFactor, params.res, params.color, true, true, QSizeF(.05, .05), 1 / GraphicsUtils::SVGDPI, QPointF(0,0));
+	QList<QPolygon> pieces;
+	QPainterPath boardPath;
+	if (useVectorFill() && vectorPour(params, pieces, boardPath)) {
+		QRectF br = params.board->sceneBoundingRect();
+		bWidth = params.res * br.width() / GraphicsUtils::SVGDPI;
+		bHeight = params.res * br.height() / GraphicsUtils::SVGDPI;
+		double svgWidth = params.res * qMax(params.boardImageSize.width(), params.copperImageSize.width()) / GraphicsUtils::SVGDPI;
+		double svgHeight = params.res * qMax(params.boardImageSize.height(), params.copperImageSize.height()) / GraphicsUtils::SVGDPI;
+
+		// ground seeds are connected to the polygons emitted below, at the raster fill's resolution
+		PourProbe probe(pieces, boardPath, pixelFactor, QSize(qMax(svgWidth, bWidth), qMax(svgHeight, bHeight)));
+		PostPourMutex.lock();
+		emit postPourSignal(this, &probe, params.board, &rects);
+		PostPourMutex.unlock();
+
+		foreach (QPolygon piece, pieces) {
+			QList<QPolygon> polygons;
+			polygons << piece;
+			makePolySvg(polygons, params.res, bWidth, bHeight, pixelFactor, params.color, true, true, QSizeF(.05, .05), 1 / GraphicsUtils::SVGDPI, QPointF(0,0));
+		}
+	}
+	else {
+		QImage * image = generateGroundPlaneAux(params, bWidth, bHeight, rects);
+		if (image == nullptr) return false;
+
+		scanImage(*image, bWidth, bHeight, pixelFactor, params.res, params.color, true, true, QSizeF(.05, .05), 1 / GraphicsUtils::SVGDPI, QPointF(0,0));
+		delete image;
+	}
 
 	foreach (QRectF r, rects) {
 		// add the rects separately as tiny SVGs which don't get clipped (since they are connected)
@@ -287,7 +359,122 @@ bool GroundPlaneGenerator::generateGroundPlaneFn(GPGParams & params)
 		makePolySvg(polygons, params.res, bWidth, bHeight, pixelFactor, params.color, false, true, QSizeF(0, 0), 0, QPointF(0, 0));
 	}
 
-	delete image;
+	return true;
+}
+
+bool GroundPlaneGenerator::useVectorFill() {
+	QSettings settings;
+	return settings.value(EngineSettingName, VectorEngine).toString() != RasterEngine;
+}
+
+bool GroundPlaneGenerator::vectorPour(GPGParams & params, QList<QPolygon> & pieces, QPainterPath & board)
+{
+	// the pour is the board, shrunk by the border, minus the copper grown by the keepout;
+	// everything is in mils, the units the board and copper svgs are rendered in
+	double milsPerPixel = GraphicsUtils::StandardFritzingDPI / GraphicsUtils::SVGDPI;
+
+	QList<QRgb> exceptionColors;
+	foreach (QString exception, params.exceptions) {
+		QColor color(exception);
+		if (color.isValid()) exceptionColors << (color.rgb() & 0xffffff);
+	}
+
+	QSizeF size = params.boardImageSize.expandedTo(params.copperImageSize) * milsPerPixel;
+
+	QCryptographicHash boardHash(QCryptographicHash::Sha1);
+	boardHash.addData(params.boardSvg.toUtf8());
+	boardHash.addData(params.exceptions.join(",").toUtf8());
+	boardHash.addData(QString("%1 %2").arg(size.width()).arg(size.height()).toUtf8());
+	QByteArray boardKey = boardHash.result();
+
+	PourCacheMutex.lock();
+	QPainterPath * cachedBoard = PourCache.object(boardKey);
+	if (cachedBoard != nullptr) board = *cachedBoard;
+	PourCacheMutex.unlock();
+
+	if (cachedBoard == nullptr) {
+		foreach (DRCShape shape, ShapeRecorder::record(params.boardSvg.toUtf8(), params.boardImageSize * milsPerPixel)) {
+			// holes in the board are drawn over it in one of the exception colors
+			if (exceptionColors.contains(shape.color & 0xffffff)) board = board.subtracted(shape.path);
+			else board = board.united(shape.path);
+		}
+		if (board.isEmpty()) return false;
+
+		board = PourGeometry::inset(board, BORDERINCHES * GraphicsUtils::StandardFritzingDPI, size);
+
+		QMutexLocker locker(&PourCacheMutex);
+		PourCache.insert(boardKey, new QPainterPath(board));
+	}
+
+	QDomDocument doc;
+	doc.setContent(params.svg);
+	QDomElement root = doc.documentElement();
+	SvgFileSplitter::forceStrokeWidth(root, 2 * params.keepoutMils, "#000000", true, true);
+
+	QList<DRCShape> shapes = ShapeRecorder::record(doc.toByteArray(0), params.copperImageSize * milsPerPixel);
+	QList<QRectF> shapeBounds;
+	foreach (DRCShape shape, shapes) shapeBounds << shape.bounds;
+	ShapeTree tree;
+	tree.build(shapeBounds);
+
+	// fill tile by tile; only tiles which are not in the cache are computed, all at once
+	QList<QPainterPath> tilePours;
+	QList<QByteArray> tileKeys;
+	QList< QFuture<QPainterPath> > futures;
+	QList<int> futureTiles;
+	int computed = 0;
+	for (double y = 0; y < size.height(); y += TileSizeMils) {
+		for (double x = 0; x < size.width(); x += TileSizeMils) {
+			QRectF tile(x, y, TileSizeMils, TileSizeMils);
+			QList<int> candidates = tree.query(tile);
+			std::sort(candidates.begin(), candidates.end());
+
+			QByteArray bytes;
+			QDataStream stream(&bytes, QIODevice::WriteOnly);
+			stream << boardKey << tile;
+			QList<QPainterPath> copper;
+			foreach (int ix, candidates) {
+				if (!shapes.at(ix).bounds.intersects(tile)) continue;
+
+				copper << shapes.at(ix).path;
+				stream << shapes.at(ix).path;
+			}
+			QByteArray key = QCryptographicHash::hash(bytes, QCryptographicHash::Sha1);
+
+			PourCacheMutex.lock();
+			QPainterPath * cached = PourCache.object(key);
+			tilePours << ((cached == nullptr) ? QPainterPath() : *cached);
+			PourCacheMutex.unlock();
+			tileKeys << key;
+			if (cached != nullptr) continue;
+
+			futures << QtConcurrent::run(&PourGeometry::pourTile, board, tile, copper);
+			futureTiles << tilePours.count() - 1;
+			computed++;
+		}
+	}
+
+	for (int i = 0; i < futures.count(); i++) {
+		QPainterPath pour = futures[i].result();
+		int tile = futureTiles.at(i);
+		tilePours[tile] = pour;
+		QMutexLocker locker(&PourCacheMutex);
+		PourCache.insert(tileKeys.at(tile), new QPainterPath(pour));
+	}
+
+	DebugDialog::debug(QString("ground fill tiles: %1 of %2 recomputed").arg(computed).arg(tilePours.count()));
+
+	QList<QPolygonF> polygons;
+	if (!PourGeometry::pieces(tilePours, polygons)) {
+		// a hole which can't be cut out would leave copper over the keepout
+		DebugDialog::debug("ground fill: unable to bridge a hole, using the raster fill");
+		return false;
+	}
+
+	foreach (QPolygonF polygon, polygons) {
+		pieces << polygon.toPolygon();
+	}
+
 	return true;
 }
 
@@ -401,7 +588,10 @@ QImage * GroundPlaneGenerator::generateGroundPlaneAux(GPGParams & params, double
 	image->save(FolderUtils::getTopLevelUserDataStorePath() + "/testGroundFillCopper.png");
 #endif
 
-	emit postImageSignal(this, image, &boardImage, params.board, &rects);
+	PourProbe probe(image, &boardImage);
+	PostPourMutex.lock();
+	emit postPourSignal(this, &probe, params.board, &rects);
+	PostPourMutex.unlock();
 
 	return image;
 }
@@ -28,7 +28,10 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QString>
 #include <QStringList>
 #include <QGraphicsItem>
+#include <QFuture>
+#include <QPainterPath>
 
+class PourProbe;
 
 struct GPGParams {
 	QString boardSvg;
@@ -51,6 +54,8 @@ public:
 
 	bool generateGroundPlane(const QString & boardSvg, QSizeF boardImageSize, const QString & svg, QSizeF copperImageSize, QStringList & exceptions,
 	                         QGraphicsItem * board, double res, const QString & color, double keepoutMils);
+	QFuture<bool> startGroundPlane(const QString & boardSvg, QSizeF boardImageSize, const QString & svg, QSizeF copperImageSize, QStringList & exceptions,
+	                               QGraphicsItem * board, double res, const QString & color, double keepoutMils);
 	bool generateGroundPlaneUnit(const QString & boardSvg, QSizeF boardImageSize, const QString & svg, QSizeF copperImageSize, QStringList & exceptions,
 	                             QGraphicsItem * board, double res, const QString & color, QPointF whereToStart, double keepoutMils);
 	void scanImage(QImage & image, double bWidth, double bHeight, double pixelFactor, double res,
@@ -72,7 +77,7 @@ public:
 	static QString ConnectorName;
 
 signals:
-	void postImageSignal(GroundPlaneGenerator *, QImage * copperImage, QImage * boardImage, QGraphicsItem * board, QList<QRectF> *);
+	void postPourSignal(GroundPlaneGenerator *, const PourProbe *, QGraphicsItem * board, QList<QRectF> *);
 
 protected:
 	void splitScanLines(QList<QRect> & rects, QList< QList<int> * > & pieces);
@@ -91,6 +96,8 @@ protected:
 	bool collectBorderPoints(QImage & image, QList<QPoint> & points);
 	bool try8(int x, int y, QImage & image, QList<QPoint> & points);
 	bool generateGroundPlaneFn(GPGParams &);
+	bool useVectorFill();
+	bool vectorPour(GPGParams &, QList<QPolygon> & pieces, QPainterPath & board);
 
 
 protected:
@@ -105,6 +112,10 @@ protected:
 public:
 	static const QString KeepoutSettingName;
 	static const double KeepoutDefaultMils;
+	static const QString EngineSettingName;
+	static const QString VectorEngine;
+	static const QString RasterEngine;
+	static const double TileSizeMils;
 
 };
 
@@ -0,0 +1,202 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "pourgeometry.h"
+
+#include <QHash>
+#include <QPainterPathStroker>
+#include <QVector>
+#include <qmath.h>
+
+#include <algorithm>
+
+static bool topLess(const QPolygonF & a, const QPolygonF & b) {
+	return a.boundingRect().top() < b.boundingRect().top();
+}
+
+double PourGeometry::signedArea(const QPolygonF & poly) {
+	double total = 0;
+	for (int ix = 0; ix < poly.count(); ix++) {
+		QPointF p0 = poly.at(ix);
+		QPointF p1 = poly.at((ix + 1) % poly.count());
+		total += (p0.x() * p1.y() - p1.x() * p0.y());
+	}
+	return total / 2.0;
+}
+
+QPainterPath PourGeometry::inset(const QPainterPath & board, double border, const QSizeF & size) {
+	QPainterPathStroker stroker;
+	stroker.setWidth(2 * border);
+	QPainterPath inside = board.subtracted(stroker.createStroke(board));
+	QPainterPath frame;
+	frame.addRect(border, border, size.width() - 2 * border, size.height() - 2 * border);
+	return inside.intersected(frame);
+}
+
+QPainterPath PourGeometry::pourTile(QPainterPath board, QRectF tile, QList<QPainterPath> copper) {
+	QPainterPath clip;
+	clip.addRect(tile);
+	QPainterPath pour = board.intersected(clip);
+	if (pour.isEmpty() || copper.isEmpty()) return pour;
+
+	QPainterPath keepout;
+	keepout.setFillRule(Qt::WindingFill);
+	foreach (QPainterPath path, copper) {
+		keepout.addPath(path.simplified());
+	}
+
+	return pour.subtracted(keepout);
+}
+
+bool PourGeometry::bridgeHoles(QPolygonF outer, QList<QPolygonF> holes, QPolygonF & bridged) {
+	// join each hole to the outline with a zero-width cut, so the piece becomes a single polygon;
+	// the hole runs the opposite way round, so it stays empty under the nonzero fill rule.
+	// a hole which can't be joined would be filled over, so then the whole piece fails
+	if (signedArea(outer) < 0) std::reverse(outer.begin(), outer.end());
+
+	// highest hole first: a ray going up from a hole can then only hit the outline or a hole already joined to it
+	std::sort(holes.begin(), holes.end(), topLess);
+	foreach (QPolygonF hole, holes) {
+		if (hole.count() < 3) continue;
+		if (signedArea(hole) > 0) std::reverse(hole.begin(), hole.end());
+
+		int top = 0;
+		for (int i = 1; i < hole.count(); i++) {
+			if (hole.at(i).y() < hole.at(top).y()) top = i;
+		}
+		QPointF p = hole.at(top);
+
+		int best = -1;
+		double bestY = 0;
+		for (int i = 0; i < outer.count(); i++) {
+			QPointF a = outer.at(i);
+			QPointF b = outer.at((i + 1) % outer.count());
+			if ((a.x() <= p.x() && b.x() > p.x()) || (b.x() <= p.x() && a.x() > p.x())) {
+				double y = a.y() + (p.x() - a.x()) * (b.y() - a.y()) / (b.x() - a.x());
+				if (y <= p.y() && (best < 0 || y > bestY)) {
+					best = i;
+					bestY = y;
+				}
+			}
+		}
+		if (best < 0) return false;
+
+		QPointF q(p.x(), bestY);
+		QPolygonF merged = outer.mid(0, best + 1);
+		merged << q;
+		for (int i = 0; i < hole.count(); i++) {
+			merged << hole.at((top + i) % hole.count());
+		}
+		merged << p << q;
+		merged << outer.mid(best + 1);
+		outer = merged;
+	}
+
+	bridged = outer;
+	return true;
+}
+
+bool PourGeometry::pieces(const QList<QPainterPath> & tilePours, QList<QPolygonF> & pieces) {
+	// neighboring tiles share their edges exactly, so simplifying drops the seams
+	QPainterPath pour;
+	pour.setFillRule(Qt::WindingFill);
+	foreach (QPainterPath tilePour, tilePours) {
+		pour.addPath(tilePour);
+	}
+
+	QList<QPolygonF> polygons = pour.simplified().toSubpathPolygons();
+
+	// a polygon inside an odd number of others is a hole in the smallest of them
+	QVector<int> parents(polygons.count(), -1);
+	QVector<int> depths(polygons.count(), 0);
+	QVector<double> areas(polygons.count());
+	QVector<QRectF> bounds(polygons.count());
+	for (int i = 0; i < polygons.count(); i++) {
+		areas[i] = qAbs(signedArea(polygons.at(i)));
+		bounds[i] = polygons.at(i).boundingRect();
+	}
+	for (int i = 0; i < polygons.count(); i++) {
+		if (polygons.at(i).isEmpty()) continue;
+
+		QPointF p = polygons.at(i).first();
+		for (int j = 0; j < polygons.count(); j++) {
+			if (j == i) continue;
+			if (!bounds.at(j).contains(bounds.at(i))) continue;
+			if (!polygons.at(j).containsPoint(p, Qt::OddEvenFill)) continue;
+
+			depths[i]++;
+			if (parents.at(i) < 0 || areas.at(j) < areas.at(parents.at(i))) parents[i] = j;
+		}
+	}
+
+	QHash<int, QList<QPolygonF> > holes;
+	for (int i = 0; i < polygons.count(); i++) {
+		if (depths.at(i) % 2 == 1 && parents.at(i) >= 0) {
+			holes[parents.at(i)].append(polygons.at(i));
+		}
+	}
+	for (int i = 0; i < polygons.count(); i++) {
+		if (depths.at(i) % 2 == 1) continue;
+		if (polygons.at(i).count() < 3) continue;
+
+		QPolygonF bridged;
+		if (!bridgeHoles(polygons.at(i), holes.value(i), bridged)) {
+			pieces.clear();
+			return false;
+		}
+
+		pieces << bridged;
+	}
+
+	return true;
+}
+
+PourProbe::PourProbe(const QImage * copperImage, const QImage * boardImage)
+	: m_copperImage(copperImage), m_boardImage(boardImage), m_pixelFactor(1), m_size(copperImage->size())
+{
+}
+
+PourProbe::PourProbe(const QList<QPolygon> & pieces, const QPainterPath & board, double pixelFactor, const QSize & size)
+	: m_copperImage(nullptr), m_boardImage(nullptr), m_board(board), m_pixelFactor(pixelFactor), m_size(size)
+{
+	foreach (QPolygon piece, pieces) {
+		m_pieces << QPolygonF(piece);
+		m_bounds << m_pieces.last().boundingRect();
+	}
+}
+
+const QSize & PourProbe::size() const {
+	return m_size;
+}
+
+bool PourProbe::reached(int x, int y) const {
+	if (m_copperImage != nullptr) {
+		return (m_copperImage->pixel(x, y) & 0xffffff) || (m_boardImage->pixel(x, y) == 0xff000000);
+	}
+
+	// the pieces and the board are in mils; test the middle of the pixel
+	QPointF p((x + 0.5) * m_pixelFactor, (y + 0.5) * m_pixelFactor);
+	for (int ix = 0; ix < m_pieces.count(); ix++) {
+		if (!m_bounds.at(ix).contains(p)) continue;
+		if (m_pieces.at(ix).containsPoint(p, Qt::WindingFill)) return true;
+	}
+
+	return !m_board.contains(p);
+}
@@ -0,0 +1,66 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef POURGEOMETRY_H
+#define POURGEOMETRY_H
+
+#include <QImage>
+#include <QList>
+#include <QPolygon>
+#include <QPolygonF>
+#include <QPainterPath>
+#include <QRectF>
+#include <QSize>
+#include <QSizeF>
+
+// the geometry of the vector ground fill: the board shrunk by its border, minus the grown copper,
+// poured tile by tile and turned into hole-free polygons
+class PourGeometry
+{
+public:
+	static QPainterPath inset(const QPainterPath & board, double border, const QSizeF & size);
+	static QPainterPath pourTile(QPainterPath board, QRectF tile, QList<QPainterPath> copper);
+	static bool bridgeHoles(QPolygonF outer, QList<QPolygonF> holes, QPolygonF & bridged);
+	static bool pieces(const QList<QPainterPath> & tilePours, QList<QPolygonF> & pieces);
+	static double signedArea(const QPolygonF &);
+};
+
+// tells a ground seed, pixel by pixel, whether it has reached the fill or the board's border;
+// the raster fill asks its images, the vector fill asks the polygons it emits
+class PourProbe
+{
+public:
+	PourProbe(const QImage * copperImage, const QImage * boardImage);
+	PourProbe(const QList<QPolygon> & pieces, const QPainterPath & board, double pixelFactor, const QSize & size);
+
+	const QSize & size() const;
+	bool reached(int x, int y) const;
+
+protected:
+	const QImage * m_copperImage;
+	const QImage * m_boardImage;
+	QList<QPolygonF> m_pieces;
+	QList<QRectF> m_bounds;
+	QPainterPath m_board;
+	double m_pixelFactor;
+	QSize m_size;
+};
+
+#endif
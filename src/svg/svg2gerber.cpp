@@ -27,6 +27,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <qmath.h>
 
 constexpr double MaskClearance = 0.005;  // 5 mils clearance
+constexpr double CurveTolerance = 0.25;  // mils; max deviation of flattened curves from the true curve
+constexpr int MaxCurveDepth = 12;
 
 bool fillNotStroke(QDomElement & element, SVG2gerber::ForWhy forWhy) {
 	if (forWhy == SVG2gerber::ForOutline) return false;
@@ -200,7 +202,12 @@ void SVG2gerber::convertShapes2paths(QDomNode node) {
 			path = element;
 		}
 		else if(tag=="rect") {
-			path = element;
+			if (element.hasAttribute("rx") || element.hasAttribute("ry")) {
+				path = roundedRect2path(element);
+			}
+			else {
+				path = element;
+			}
 		}
 		else if(tag=="circle") {
 			path = element;
@@ -522,18 +529,17 @@ int SVG2gerber::allPaths2gerber(ForWhy forWhy) {
 
 		QString data = path.attribute("d").trimmed();
 
-		const char * slot = SLOT(path2gerbCommandSlot(QChar, bool, QList<double> &, void *));
-
 		PathUserData pathUserData;
 		pathUserData.x = 0;
 		pathUserData.y = 0;
 		pathUserData.pathStarting = true;
 		pathUserData.string = "";
+		m_lastCommand = QChar();
 
 		SvgFlattener flattener;
 		bool invalid = false;
 		try {
-			flattener.parsePath(data, slot, pathUserData, this, true);
+			flattener.parsePath<SVG2gerber, &SVG2gerber::path2gerbCommand>(data, pathUserData, this, true);
 		}
 		catch (const QString & msg) {
 			DebugDialog::debug("flattener.parsePath failed " + msg);
@@ -549,7 +555,7 @@ int SVG2gerber::allPaths2gerber(ForWhy forWhy) {
 		}
 
 
-		// only add paths if they contained gerber-izable path commands (NO CURVES!)
+		// curves and arcs are flattened or emitted as G02/G03; anything else unknown is invalid
 		// TODO: display some informative error for the user
 		if (invalid || pathUserData.string.contains("INVALID")) {
 			invalidPathsCount++;
@@ -739,8 +745,55 @@ void SVG2gerber::handleOblongPath(QDomElement & path, int & dcode_index) {
 }
 
 QDomElement SVG2gerber::ellipse2path(QDomElement ellipseElement) {
-	// TODO
-	return ellipseElement;
+	double cx = ellipseElement.attribute("cx").toDouble();
+	double cy = ellipseElement.attribute("cy").toDouble();
+	double rx = ellipseElement.attribute("rx").toDouble();
+	double ry = ellipseElement.attribute("ry").toDouble();
+	if (rx <= 0 || ry <= 0) return ellipseElement;
+
+	// two half-ellipse arcs; path2gerbCommand turns them into G02/G03 or flattens them
+	QDomElement path = m_SVGDom.createElement("path");
+	path.setAttribute("d", QString("M%1,%2A%3,%4 0 1 0 %5,%2A%3,%4 0 1 0 %1,%2z")
+	                  .arg(cx - rx).arg(cy).arg(rx).arg(ry).arg(cx + rx));
+	QStringList attrList;
+	attrList << "id" << "transform";
+	foreach (QString attr, attrList) {
+		if (ellipseElement.hasAttribute(attr)) {
+			path.setAttribute(attr, ellipseElement.attribute(attr));
+		}
+	}
+
+	return path;
+}
+
+QDomElement SVG2gerber::roundedRect2path(QDomElement rectElement) {
+	double x = rectElement.attribute("x").toDouble();
+	double y = rectElement.attribute("y").toDouble();
+	double width = rectElement.attribute("width").toDouble();
+	double height = rectElement.attribute("height").toDouble();
+	if (width <= 0 || height <= 0) return rectElement;
+
+	// per the svg spec, a missing radius takes the value of the other one
+	double rx = rectElement.attribute("rx", rectElement.attribute("ry", "0")).toDouble();
+	double ry = rectElement.attribute("ry", rectElement.attribute("rx", "0")).toDouble();
+	rx = qMin(rx, width / 2);
+	ry = qMin(ry, height / 2);
+	if (rx <= 0 || ry <= 0) return rectElement;
+
+	QString arc = QString("A%1,%2 0 0 1 ").arg(rx).arg(ry);
+	QDomElement path = m_SVGDom.createElement("path");
+	path.setAttribute("d", QString("M%1,%2L%3,%2%9%4,%5L%4,%6%9%3,%7L%1,%7%9%8,%6L%8,%5%9%1,%2z")
+	                  .arg(x + rx).arg(y).arg(x + width - rx).arg(x + width).arg(y + ry)
+	                  .arg(y + height - ry).arg(y + height).arg(x).arg(arc));
+	QStringList attrList;
+	attrList << "id" << "transform";
+	foreach (QString attr, attrList) {
+		if (rectElement.hasAttribute(attr)) {
+			path.setAttribute(attr, rectElement.attribute(attr));
+		}
+	}
+
+	return path;
 }
 
 QString SVG2gerber::path2gerber(QDomElement pathElement) {
@@ -750,28 +803,81 @@ QString SVG2gerber::path2gerber(QDomElement pathElement) {
 	return d;
 }
 
-void SVG2gerber::path2gerbCommandSlot(QChar command, bool relative, QList<double> & args, void * userData) {
+void SVG2gerber::path2gerbCommand(QChar command, bool relative, const SVGPathArgs & args, void * userData) {
 	QString gerb_path;
 	double x, y;
 
 	PathUserData * pathUserData = (PathUserData *) userData;
 
+	char c = command.toLatin1();
+	if (c == 'z' || c == 'Z') {
+		// closepath has no args, so handle it here rather than in the arg loop below
+		gerb_path = "X" + QString::number(flipx(m_pathstart_x)) + "Y" + QString::number(flipy(m_pathstart_y)) + "D01*\n";
+		gerb_path += "D02*\n";
+		pathUserData->x = m_pathstart_x;
+		pathUserData->y = m_pathstart_y;
+		pathUserData->string.append(gerb_path);
+		m_lastCommand = command;
+		return;
+	}
+
 	int argIndex = 0;
 	while (argIndex < args.count()) {
-		switch(command.toLatin1()) {
+		// offset for relative commands: the current point before this segment
+		double ox = relative ? pathUserData->x : 0;
+		double oy = relative ? pathUserData->y : 0;
+		QPointF current(pathUserData->x, pathUserData->y);
+		QPointF c1, c2, end;
+
+		switch(c) {
 		case 'a':
 		case 'A':
+			end = QPointF(ox + args[argIndex + 5], oy + args[argIndex + 6]);
+			arcTo(pathUserData, args[argIndex], args[argIndex + 1], args[argIndex + 2], args[argIndex + 3] != 0, args[argIndex + 4] != 0, end);
+			argIndex += 7;
+			break;
 		case 'c':
 		case 'C':
-		case 'q':
-		case 'Q':
+			c1 = QPointF(ox + args[argIndex], oy + args[argIndex + 1]);
+			c2 = QPointF(ox + args[argIndex + 2], oy + args[argIndex + 3]);
+			end = QPointF(ox + args[argIndex + 4], oy + args[argIndex + 5]);
+			curveTo(pathUserData, c1, c2, end);
+			m_control = c2;
+			argIndex += 6;
+			break;
 		case 's':
 		case 'S':
+			// first control point is the reflection of the previous curve's second control point
+			c1 = current;
+			if (QString("cCsS").contains(m_lastCommand)) {
+				c1 = 2 * current - m_control;
+			}
+			c2 = QPointF(ox + args[argIndex], oy + args[argIndex + 1]);
+			end = QPointF(ox + args[argIndex + 2], oy + args[argIndex + 3]);
+			curveTo(pathUserData, c1, c2, end);
+			m_control = c2;
+			argIndex += 4;
+			break;
+		case 'q':
+		case 'Q':
 		case 't':
 		case 'T':
-			// TODO: implement elliptical arc, etc.
-			pathUserData->string.append("INVALID");
-			argIndex = args.count();
+			if (c == 'q' || c == 'Q') {
+				c1 = QPointF(ox + args[argIndex], oy + args[argIndex + 1]);
+				end = QPointF(ox + args[argIndex + 2], oy + args[argIndex + 3]);
+				argIndex += 4;
+			}
+			else {
+				c1 = current;
+				if (QString("qQtT").contains(m_lastCommand)) {
+					c1 = 2 * current - m_control;
+				}
+				end = QPointF(ox + args[argIndex], oy + args[argIndex + 1]);
+				argIndex += 2;
+			}
+			// raise the quadratic to a cubic
+			curveTo(pathUserData, current + (c1 - current) * 2 / 3, end + (c1 - end) * 2 / 3, end);
+			m_control = c1;
 			break;
 		case 'm':
 		case 'M':
@@ -801,10 +907,12 @@ void SVG2gerber::path2gerbCommandSlot(QChar command, bool relative, QList<double
 		case 'v':
 		case 'V':
 			DebugDialog::debug("'v' and 'V' are now removed by preprocessing; shouldn't be here");
+			argIndex = args.count();
 			break;
 		case 'h':
 		case 'H':
 			DebugDialog::debug("'h' and 'H' are now removed by preprocessing; shouldn't be here");
+			argIndex = args.count();
 			break;
 		case 'l':
 		case 'L':
@@ -819,22 +927,145 @@ void SVG2gerber::path2gerbCommandSlot(QChar command, bool relative, QList<double
 			pathUserData->string.append(gerb_path);
 			argIndex += 2;
 			break;
-		case 'z':
-		case 'Z':
-			gerb_path = "X" + QString::number(flipx(m_pathstart_x)) + "Y" + QString::number(flipy(m_pathstart_y)) + "D01*\n";
-			gerb_path += "D02*\n";
-			pathUserData->x = m_pathstart_x;
-			pathUserData->y = m_pathstart_y;
-			pathUserData->string.append(gerb_path);
-			break;
 		default:
 			argIndex = args.count();
 			pathUserData->string.append("INVALID");
 			break;
 		}
+
+		// each implicit repeat is its own segment: the next S or T reflects this one's control point
+		m_lastCommand = command;
+	}
+}
+
+void SVG2gerber::lineTo(QString & string, const QPointF & p, QPoint & last)
+{
+	QPoint g(flipx(p.x()), flipy(p.y()));
+	if (g == last) return;			// below gerber resolution
+
+	string += "X" + QString::number(g.x()) + "Y" + QString::number(g.y()) + "D01*\n";
+	last = g;
+}
+
+void SVG2gerber::curveTo(PathUserData * pathUserData, const QPointF & c1, const QPointF & c2, const QPointF & end)
+{
+	QPointF start(pathUserData->x, pathUserData->y);
+	QPoint last(flipx(start.x()), flipy(start.y()));
+	flattenCurve(pathUserData->string, start, c1, c2, end, 0, last);
+
+	// always land exactly on the endpoint, even if it rounds onto the previous segment
+	QString gerb_path = "X" + QString::number(flipx(end.x())) + "Y" + QString::number(flipy(end.y())) + "D01*\n";
+	if (!pathUserData->string.endsWith(gerb_path)) {
+		pathUserData->string.append(gerb_path);
+	}
+
+	pathUserData->x = end.x();
+	pathUserData->y = end.y();
+}
+
+void SVG2gerber::flattenCurve(QString & string, const QPointF & p0, const QPointF & p1, const QPointF & p2, const QPointF & p3, int depth, QPoint & last)
+{
+	// flat enough when both control points are within CurveTolerance of the chord
+	QPointF chord = p3 - p0;
+	double length = qSqrt(QPointF::dotProduct(chord, chord));
+	double d1, d2;
+	if (length < CurveTolerance) {
+		d1 = QLineF(p0, p1).length();
+		d2 = QLineF(p0, p2).length();
 	}
+	else {
+		d1 = qAbs(chord.x() * (p1.y() - p0.y()) - chord.y() * (p1.x() - p0.x())) / length;
+		d2 = qAbs(chord.x() * (p2.y() - p0.y()) - chord.y() * (p2.x() - p0.x())) / length;
+	}
+
+	if (depth >= MaxCurveDepth || qMax(d1, d2) <= CurveTolerance) {
+		lineTo(string, p3, last);
+		return;
+	}
+
+	// de Casteljau split at t = 0.5
+	QPointF p01 = (p0 + p1) / 2;
+	QPointF p12 = (p1 + p2) / 2;
+	QPointF p23 = (p2 + p3) / 2;
+	QPointF p012 = (p01 + p12) / 2;
+	QPointF p123 = (p12 + p23) / 2;
+	QPointF mid = (p012 + p123) / 2;
+	flattenCurve(string, p0, p01, p012, mid, depth + 1, last);
+	flattenCurve(string, mid, p123, p23, p3, depth + 1, last);
 }
 
+void SVG2gerber::arcTo(PathUserData * pathUserData, double rx, double ry, double angle, bool largeArc, bool sweep, const QPointF & end)
+{
+	// endpoint to center parameterization, see the svg 1.1 spec, appendix F.6.5
+	QPointF start(pathUserData->x, pathUserData->y);
+	pathUserData->x = end.x();
+	pathUserData->y = end.y();
+	if (start == end) return;
+
+	rx = qAbs(rx);
+	ry = qAbs(ry);
+	QString gerb_path = "X" + QString::number(flipx(end.x())) + "Y" + QString::number(flipy(end.y())) + "D01*\n";
+	if (rx < CurveTolerance || ry < CurveTolerance) {
+		pathUserData->string.append(gerb_path);
+		return;
+	}
+
+	double phi = qDegreesToRadians(angle);
+	double cosPhi = qCos(phi);
+	double sinPhi = qSin(phi);
+	double dx2 = (start.x() - end.x()) / 2;
+	double dy2 = (start.y() - end.y()) / 2;
+	double x1p = cosPhi * dx2 + sinPhi * dy2;
+	double y1p = -sinPhi * dx2 + cosPhi * dy2;
+
+	// radii too small to reach the endpoint are scaled up
+	double lambda = (x1p * x1p) / (rx * rx) + (y1p * y1p) / (ry * ry);
+	if (lambda > 1) {
+		rx *= qSqrt(lambda);
+		ry *= qSqrt(lambda);
+	}
+
+	double rx2 = rx * rx;
+	double ry2 = ry * ry;
+	double num = rx2 * ry2 - rx2 * y1p * y1p - ry2 * x1p * x1p;
+	double den = rx2 * y1p * y1p + ry2 * x1p * x1p;
+	double coef = (den == 0) ? 0 : qSqrt(qMax(0.0, num / den));
+	if (largeArc == sweep) coef = -coef;
+	double cxp = coef * rx * y1p / ry;
+	double cyp = -coef * ry * x1p / rx;
+	QPointF center(cosPhi * cxp - sinPhi * cyp + (start.x() + end.x()) / 2,
+	               sinPhi * cxp + cosPhi * cyp + (start.y() + end.y()) / 2);
+
+	if (qAbs(rx - ry) <= CurveTolerance) {
+		// circular: emit a real arc.  svg's positive sweep is clockwise on screen, and flipping y
+		// into gerber's coordinate system keeps the picture, so sweep maps to G02
+		pathUserData->string.append(QString("G75*\n%1X%2Y%3I%4J%5D01*\nG01*\n")
+		                            .arg(sweep ? "G02" : "G03")
+		                            .arg(flipx(end.x()))
+		                            .arg(flipy(end.y()))
+		                            .arg(flipx(center.x()) - flipx(start.x()))
+		                            .arg(flipy(center.y()) - flipy(start.y())));
+		return;
+	}
+
+	// elliptical: flatten into segments whose sagitta stays within CurveTolerance
+	double theta1 = qAtan2((y1p - cyp) / ry, (x1p - cxp) / rx);
+	double theta2 = qAtan2((-y1p - cyp) / ry, (-x1p - cxp) / rx);
+	double dtheta = theta2 - theta1;
+	if (sweep && dtheta < 0) dtheta += 2 * M_PI;
+	else if (!sweep && dtheta > 0) dtheta -= 2 * M_PI;
+
+	double step = 2 * qAcos(qMax(0.0, 1 - CurveTolerance / qMax(rx, ry)));
+	int segments = qMax(1, qCeil(qAbs(dtheta) / qMax(step, 0.001)));
+	QPoint last(flipx(start.x()), flipy(start.y()));
+	for (int i = 1; i < segments; i++) {
+		double theta = theta1 + dtheta * i / segments;
+		double ex = rx * qCos(theta);
+		double ey = ry * qSin(theta);
+		lineTo(pathUserData->string, QPointF(cosPhi * ex - sinPhi * ey + center.x(), sinPhi * ex + cosPhi * ey + center.y()), last);
+	}
+	pathUserData->string.append(gerb_path);
+}
 
 int SVG2gerber::flipx(double x)
 {
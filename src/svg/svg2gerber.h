@@ -26,6 +26,10 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QObject>
 #include <QMatrix>
 #include <QMultiHash>
+#include <QPointF>
+
+struct PathUserData;
+class SVGPathArgs;
 
 class SVG2gerber : public QObject
 {
@@ -58,6 +62,8 @@ protected:
 
 	double m_pathstart_x = 0.0;
 	double m_pathstart_y = 0.0;
+	QPointF m_control;				// last control point, for reflecting into S and T
+	QChar m_lastCommand;
 
 protected:
 
@@ -67,6 +73,7 @@ protected:
 	QMatrix parseTransform(QDomElement);
 
 	QDomElement ellipse2path(QDomElement);
+	QDomElement roundedRect2path(QDomElement);
 
 	void copyStyles(QDomElement, QDomElement);
 
@@ -81,12 +88,11 @@ protected:
 	double flipyNoRound(double y);
 	void doPoly(QDomElement & polygon, ForWhy forWhy, bool closedCurve,
 	            QHash<QString, QString> & apertureMap, QString & current_dcode, int & dcode_index);
-
-
-
-protected slots:
-	void path2gerbCommandSlot(QChar command, bool relative, QList<double> & args, void * userData);
-
+	void lineTo(QString & string, const QPointF &, QPoint & last);
+	void curveTo(PathUserData *, const QPointF & c1, const QPointF & c2, const QPointF & end);
+	void flattenCurve(QString & string, const QPointF & p0, const QPointF & p1, const QPointF & p2, const QPointF & p3, int depth, QPoint & last);
+	void arcTo(PathUserData *, double rx, double ry, double angle, bool largeArc, bool sweep, const QPointF & end);
+	void path2gerbCommand(QChar command, bool relative, const SVGPathArgs & args, void * userData);
 
 };
 
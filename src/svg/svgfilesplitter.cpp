@@ -23,9 +23,6 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "../utils/misc.h"
 #include "../utils/textutils.h"
 #include "../debugdialog.h"
-#include "svgpathparser.h"
-#include "svgpathlexer.h"
-#include "svgpathrunner.h"
 
 #include <QDomDocument>
 #include <QFile>
@@ -279,11 +276,10 @@ void SvgFileSplitter::painterPathChild(QDomElement & element, QPainterPath & ppa
 	else if (element.nodeName().compare("polygon") == 0 || element.nodeName().compare("polyline") == 0) {
 		QString data = element.attribute("points");
 		if (!data.isEmpty()) {
-			const char * slot = SLOT(painterPathCommandSlot(QChar, bool, QList<double> &, void *));
 			PathUserData pathUserData;
 			pathUserData.pathStarting = true;
 			pathUserData.painterPath = &ppath;
-			if (parsePath(data, slot, pathUserData, this, false)) {
+			if (parsePath<SvgFileSplitter, &SvgFileSplitter::painterPathCommand>(data, pathUserData, this, false)) {
 			}
 		}
 	}
@@ -291,14 +287,13 @@ void SvgFileSplitter::painterPathChild(QDomElement & element, QPainterPath & ppa
 		/*
 		QString data = element.attribute("d").trimmed();
 		if (!data.isEmpty()) {
-			const char * slot = SLOT(normalizeCommandSlot(QChar, bool, QList<double> &, void *));
 			PathUserData pathUserData;
 			pathUserData.pathStarting = true;
 			pathUserData.sNewHeight = sNewHeight;
 			pathUserData.sNewWidth = sNewWidth;
 			pathUserData.vbHeight = vbHeight;
 			pathUserData.vbWidth = vbWidth;
-		    if (parsePath(data, slot, pathUserData, this, true)) {
+		    if (parsePath<SvgFileSplitter, &SvgFileSplitter::normalizeCommand>(data, pathUserData, this, true)) {
 				element.setAttribute("d", pathUserData.string);
 			}
 		}
@@ -396,14 +391,13 @@ void SvgFileSplitter::normalizeChild(QDomElement & element,
 		normalizeAttribute(element, "stroke-width", sNewWidth, vbWidth);
 		QString data = element.attribute("points");
 		if (!data.isEmpty()) {
-			const char * slot = SLOT(normalizeCommandSlot(QChar, bool, QList<double> &, void *));
 			PathUserData pathUserData;
 			pathUserData.pathStarting = true;
 			pathUserData.sNewHeight = sNewHeight;
 			pathUserData.sNewWidth = sNewWidth;
 			pathUserData.vbHeight = vbHeight;
 			pathUserData.vbWidth = vbWidth;
-			if (parsePath(data, slot, pathUserData, this, false)) {
+			if (parsePath<SvgFileSplitter, &SvgFileSplitter::normalizeCommand>(data, pathUserData, this, false)) {
 				pathUserData.string.remove(0, 1);			// get rid of the "M"
 				element.setAttribute("points", pathUserData.string);
 			}
@@ -416,14 +410,13 @@ void SvgFileSplitter::normalizeChild(QDomElement & element,
 		setStrokeOrFill(element, blackOnly, "black", false);
 		QString data = element.attribute("d").trimmed();
 		if (!data.isEmpty()) {
-			const char * slot = SLOT(normalizeCommandSlot(QChar, bool, QList<double> &, void *));
 			PathUserData pathUserData;
 			pathUserData.pathStarting = true;
 			pathUserData.sNewHeight = sNewHeight;
 			pathUserData.sNewWidth = sNewWidth;
 			pathUserData.vbHeight = vbHeight;
 			pathUserData.vbWidth = vbWidth;
-			if (parsePath(data, slot, pathUserData, this, true)) {
+			if (parsePath<SvgFileSplitter, &SvgFileSplitter::normalizeCommand>(data, pathUserData, this, true)) {
 				element.setAttribute("d", pathUserData.string);
 			}
 		}
@@ -599,12 +592,11 @@ void SvgFileSplitter::shiftChild(QDomElement & element, double x, double y, bool
 	else if (nodeName.compare("polygon") == 0 || nodeName.compare("polyline") == 0) {
 		QString data = element.attribute("points");
 		if (!data.isEmpty()) {
-			const char * slot = SLOT(shiftCommandSlot(QChar, bool, QList<double> &, void *));
 			PathUserData pathUserData;
 			pathUserData.pathStarting = true;
 			pathUserData.x = x;
 			pathUserData.y = y;
-			if (parsePath(data, slot, pathUserData, this, false)) {
+			if (parsePath<SvgFileSplitter, &SvgFileSplitter::shiftCommand>(data, pathUserData, this, false)) {
 				pathUserData.string.remove(0, 1);			// get rid of the "M"
 				element.setAttribute("points", pathUserData.string);
 			}
@@ -613,12 +605,11 @@ void SvgFileSplitter::shiftChild(QDomElement & element, double x, double y, bool
 	else if (nodeName.compare("path") == 0) {
 		QString data = element.attribute("d").trimmed();
 		if (!data.isEmpty()) {
-			const char * slot = SLOT(shiftCommandSlot(QChar, bool, QList<double> &, void *));
 			PathUserData pathUserData;
 			pathUserData.pathStarting = true;
 			pathUserData.x = x;
 			pathUserData.y = y;
-			if (parsePath(data, slot, pathUserData, this, true)) {
+			if (parsePath<SvgFileSplitter, &SvgFileSplitter::shiftCommand>(data, pathUserData, this, true)) {
 				element.setAttribute("d", pathUserData.string);
 			}
 		}
@@ -632,7 +623,7 @@ void SvgFileSplitter::shiftChild(QDomElement & element, double x, double y, bool
 	}
 }
 
-void SvgFileSplitter::normalizeCommandSlot(QChar command, bool relative, QList<double> & args, void * userData) {
+void SvgFileSplitter::normalizeCommand(QChar command, bool relative, const SVGPathArgs & args, void * userData) {
 
 	Q_UNUSED(relative);			// just normalizing here, so relative is not used
 
@@ -689,8 +680,6 @@ void SvgFileSplitter::normalizeCommandSlot(QChar command, bool relative, QList<d
 			}
 		}
 		break;
-	case SVGPathLexer::FakeClosePathChar:
-		break;
 	default:
 		for (int i = 0; i < args.count(); i++) {
 			if (i % 2 == 0) {
@@ -708,10 +697,10 @@ void SvgFileSplitter::normalizeCommandSlot(QChar command, bool relative, QList<d
 	}
 }
 
-void SvgFileSplitter::painterPathCommandSlot(QChar command, bool relative, QList<double> & args, void * userData) {
+void SvgFileSplitter::painterPathCommand(QChar command, bool relative, const SVGPathArgs & args, void * userData) {
 
 	Q_UNUSED(relative);			// just normalizing here, so relative is not used
-	Q_UNUSED(command)			// note: painterPathCommandSlot is only partially implemented
+	Q_UNUSED(command)			// note: painterPathCommand is only partially implemented
 
 	PathUserData * pathUserData = (PathUserData *) userData;
 
@@ -731,7 +720,7 @@ void SvgFileSplitter::painterPathCommandSlot(QChar command, bool relative, QList
 
 }
 
-void SvgFileSplitter::shiftCommandSlot(QChar command, bool relative, QList<double> & args, void * userData) {
+void SvgFileSplitter::shiftCommand(QChar command, bool relative, const SVGPathArgs & args, void * userData) {
 
 	Q_UNUSED(relative);			// just normalizing here, so relative is not used
 
@@ -766,9 +755,6 @@ void SvgFileSplitter::shiftCommandSlot(QChar command, bool relative, QList<doubl
 	case 'Z':
 		pathUserData->pathStarting = true;
 		break;
-	case SVGPathLexer::FakeClosePathChar:
-		pathUserData->pathStarting = true;
-		break;
 	case 'a':
 	case 'A':
 		for (int i = 0; i < args.count(); i++) {
@@ -800,7 +786,7 @@ void SvgFileSplitter::shiftCommandSlot(QChar command, bool relative, QList<doubl
 	}
 }
 
-void SvgFileSplitter::standardArgs(bool relative, bool starting, QList<double> & args, PathUserData * pathUserData) {
+void SvgFileSplitter::standardArgs(bool relative, bool starting, const SVGPathArgs & args, PathUserData * pathUserData) {
 	for (int i = 0; i < args.count(); i++) {
 		double d = args[i];
 		if (i % 2 == 0) {
@@ -820,55 +806,23 @@ void SvgFileSplitter::standardArgs(bool relative, bool starting, QList<double> &
 	}
 }
 
-QVector<QVariant> SvgFileSplitter::simpleParsePath(const QString & data) {
-	static QVector<QVariant> emptyStack;
-
-	QString dataCopy(data);
-
-	if (!dataCopy.startsWith('M', Qt::CaseInsensitive)) {
-		dataCopy.prepend('M');
-	}
-	while (dataCopy.at(dataCopy.length() - 1).isSpace()) {
-		dataCopy.remove(dataCopy.length() - 1, 1);
-	}
-	QChar last = dataCopy.at(dataCopy.length() - 1);
-	if (last != 'z' && last != 'Z' && last != SVGPathLexer::FakeClosePathChar) {
-		dataCopy.append(SVGPathLexer::FakeClosePathChar);
-	}
-
-	SVGPathLexer lexer(dataCopy);
-	SVGPathParser parser;
-	if (!parser.parse(lexer)) {
-		//DebugDialog::debug(QString("svg path parse failed %1").arg(dataCopy));
-		return emptyStack;
+bool SvgFileSplitter::tokenizePath(const QString & data, SVGPathTokenizer & tokenizer, bool convertHV) {
+	if (!tokenizer.tokenize(data)) {
+		//DebugDialog::debug(QString("svg path parse failed %1").arg(data));
+		return false;
 	}
 
-	return parser.symStack();
-}
-
-
-bool SvgFileSplitter::parsePath(const QString & dataString, const char * slot, PathUserData & pathUserData, QObject * slotTarget, bool convertHV) {
-	QVector<QVariant> symStack = simpleParsePath(dataString);
-
-	if (convertHV && (dataString.contains("h", Qt::CaseInsensitive) || dataString.contains("v",  Qt::CaseInsensitive)))
-	{
-		SVGPathRunner svgPathRunner;
-		HVConvertData data;
-		data.x = data.y = data.subX = data.subY = 0;
-		data.path = "";
-		connect(&svgPathRunner, SIGNAL(commandSignal(QChar, bool, QList<double> &, void *)),
-		        this, SLOT(convertHVSlot(QChar, bool, QList<double> &, void *)),
-		        Qt::DirectConnection);
-		svgPathRunner.runPath(symStack, &data);
-		return parsePath(data.path, slot, pathUserData, slotTarget, false);
+	if (convertHV && (tokenizer.contains('H') || tokenizer.contains('h') || tokenizer.contains('V') || tokenizer.contains('v'))) {
+		HVConvertData hvData;
+		hvData.x = hvData.y = hvData.subX = hvData.subY = 0;
+		tokenizer.run<SvgFileSplitter, &SvgFileSplitter::convertHVCommand>(this, &hvData);
+		return tokenizer.tokenize(hvData.path);
 	}
 
-	SVGPathRunner svgPathRunner;
-	connect(&svgPathRunner, SIGNAL(commandSignal(QChar, bool, QList<double> &, void *)), slotTarget, slot, Qt::DirectConnection);
-	return svgPathRunner.runPath(symStack, &pathUserData);
+	return true;
 }
 
-void SvgFileSplitter::convertHVSlot(QChar command, bool /* relative */, QList<double> & args, void * userData) {
+void SvgFileSplitter::convertHVCommand(QChar command, bool /* relative */, const SVGPathArgs & args, void * userData) {
 	HVConvertData * data = (HVConvertData *) userData;
 
 	switch(command.toLatin1()) {
@@ -964,9 +918,6 @@ void SvgFileSplitter::convertHVSlot(QChar command, bool /* relative */, QList<do
 		data->x = data->subX;
 		data->y = data->subY;
 		break;
-	case SVGPathLexer::FakeClosePathChar:
-		data->path.append(command);
-		break;
 	case 'A':
 		data->path.append(command);
 		for (int i = 0; i < args.count(); i += 7) {
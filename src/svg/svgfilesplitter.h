@@ -31,6 +31,8 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QRegExp>
 #include <QFile>
 
+#include "svgpathtokenizer.h"
+
 struct PathUserData {
 	QString string;
 	QMatrix transform;
@@ -56,8 +58,14 @@ public:
 	bool normalize(double dpi, const QString & elementID, bool blackOnly, double & factor);
 	QString shift(double x, double y, const QString & elementID, bool shiftTransforms);
 	QString elementString(const QString & elementID);
-	virtual bool parsePath(const QString & data, const char * slot, PathUserData &, QObject * slotTarget, bool convertHV);
-	QVector<QVariant> simpleParsePath(const QString & data);
+	template <class T, void (T::*Handler)(QChar, bool, const SVGPathArgs &, void *)>
+	bool parsePath(const QString & data, PathUserData & pathUserData, T * target, bool convertHV) {
+		SVGPathTokenizer tokenizer;
+		if (!tokenizePath(data, tokenizer, convertHV)) return false;
+
+		tokenizer.run<T, Handler>(target, &pathUserData);
+		return true;
+	}
 	QPainterPath painterPath(double dpi, const QString & elementID);			// note: only partially implemented
 	void shiftChild(QDomElement & element, double x, double y, bool shiftTransforms);
 	bool load(const QString * filename);
@@ -94,7 +102,12 @@ protected:
 	                          double sNewWidth, double sNewHeight,
 	                          double vbWidth, double vbHeight);
 	bool shiftTranslation(QDomElement & element, double x, double y);
-	void standardArgs(bool relative, bool starting, QList<double> & args, PathUserData * pathUserData);
+	void standardArgs(bool relative, bool starting, const SVGPathArgs & args, PathUserData * pathUserData);
+	bool tokenizePath(const QString & data, SVGPathTokenizer &, bool convertHV);
+	void normalizeCommand(QChar command, bool relative, const SVGPathArgs & args, void * userData);
+	void shiftCommand(QChar command, bool relative, const SVGPathArgs & args, void * userData);
+	void painterPathCommand(QChar command, bool relative, const SVGPathArgs & args, void * userData);
+	void convertHVCommand(QChar command, bool relative, const SVGPathArgs & args, void * userData);
 
 protected:
 	static bool shiftAttribute(QDomElement & element, const char * attributeName, double d);
@@ -102,13 +115,6 @@ protected:
 	static void hideTextAux(QDomElement & parent, bool hideChildren);
 	static void showTextAux(QDomElement & parent, bool & hasText, bool root);
 
-protected slots:
-	void normalizeCommandSlot(QChar command, bool relative, QList<double> & args, void * userData);
-	void shiftCommandSlot(QChar command, bool relative, QList<double> & args, void * userData);
-	virtual void rotateCommandSlot(QChar, bool, QList<double> &, void *) {}
-	void painterPathCommandSlot(QChar command, bool relative, QList<double> & args, void * userData);
-	void convertHVSlot(QChar command, bool relative, QList<double> & args, void * userData);
-
 protected:
 	QByteArray m_byteArray;
 	QDomDocument m_domDocument;
@@ -19,7 +19,6 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 ********************************************************************/
 
 #include "svgflattener.h"
-#include "svgpathlexer.h"
 #include "../utils/graphicsutils.h"
 #include "../utils/textutils.h"
 #include "../debugdialog.h"
@@ -104,10 +103,9 @@ void SvgFlattener::unRotateChild(QDomElement & element, QMatrix transform, const
 		if(tag == "path") {
 			QString data = element.attribute("d").trimmed();
 			if (!data.isEmpty()) {
-				const char * slot = SLOT(rotateCommandSlot(QChar, bool, QList<double> &, void *));
 				PathUserData pathUserData;
 				pathUserData.transform = transform;
-				if (parsePath(data, slot, pathUserData, this, true)) {
+				if (parsePath<SvgFlattener, &SvgFlattener::rotateCommand>(data, pathUserData, this, true)) {
 					element.setAttribute("d", pathUserData.string);
 				}
 			}
@@ -115,10 +113,9 @@ void SvgFlattener::unRotateChild(QDomElement & element, QMatrix transform, const
 		else if ((tag == "polygon") || (tag == "polyline")) {
 			QString data = element.attribute("points");
 			if (!data.isEmpty()) {
-				const char * slot = SLOT(rotateCommandSlot(QChar, bool, QList<double> &, void *));
 				PathUserData pathUserData;
 				pathUserData.transform = transform;
-				if (parsePath(data, slot, pathUserData, this, false)) {
+				if (parsePath<SvgFlattener, &SvgFlattener::rotateCommand>(data, pathUserData, this, false)) {
 					pathUserData.string.remove(0, 1);			// get rid of the "M"
 					element.setAttribute("points", pathUserData.string);
 				}
@@ -218,7 +215,7 @@ bool SvgFlattener::hasOtherTransform(QDomElement & element)
 	return (!transform.contains("translate"));
 }
 
-void SvgFlattener::rotateCommandSlot(QChar command, bool relative, QList<double> & args, void * userData) {
+void SvgFlattener::rotateCommand(QChar command, bool relative, const SVGPathArgs & args, void * userData) {
 
 	Q_UNUSED(relative);			// just normalizing here, so relative is not used
 
@@ -251,17 +248,27 @@ void SvgFlattener::rotateCommandSlot(QChar command, bool relative, QList<double>
 			*/
 			i++;
 			break;
-		case SVGPathLexer::FakeClosePathChar:
-			break;
 		case 'a':
 		case 'A':
-			// TODO: test whether this is correct
-			for (int j = 0; j < 5; j++) {
-				pathUserData->string.append(QString::number(args[j]));
-				pathUserData->string.append(',');
+			{
+				// radii and x-axis rotation are exact for translate/rotate/uniform scale/mirror;
+				// gerber export rasterizes arcs under anything else
+				const QMatrix & t = pathUserData->transform;
+				double det = t.m11() * t.m22() - t.m12() * t.m21();
+				double scale = qSqrt(qAbs(det));
+				double phi = qDegreesToRadians(args[i + 2]);
+				QPointF axis = t.map(QPointF(qCos(phi), qSin(phi))) - t.map(QPointF(0, 0));
+				int sweep = (int) args[i + 4];
+				if (det < 0) sweep = 1 - sweep;
+				pathUserData->string.append(QString("%1,%2,%3,%4,%5,")
+				                            .arg(args[i] * scale)
+				                            .arg(args[i + 1] * scale)
+				                            .arg(qRadiansToDegrees(qAtan2(axis.y(), axis.x())))
+				                            .arg(args[i + 3])
+				                            .arg(sweep));
 			}
-			x = args[5];
-			y = args[6];
+			x = args[i + 5];
+			y = args[i + 6];
 			i += 7;
 			point = pathUserData->transform.map(QPointF(x,y));
 			pathUserData->string.append(QString::number(point.x()));
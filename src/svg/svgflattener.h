@@ -44,10 +44,7 @@ protected:
 	static bool hasOtherTransform(QDomElement & element);
 	static bool hasTranslate(QDomElement & element);
 	static bool loadDocIf(const QString & filename, const QString & svg, QDomDocument & domDocument);
-
-
-protected slots:
-	void rotateCommandSlot(QChar command, bool relative, QList<double> & args, void * userData);
+	void rotateCommand(QChar command, bool relative, const SVGPathArgs & args, void * userData);
 
 };
 
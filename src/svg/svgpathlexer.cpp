@@ -27,7 +27,7 @@ static const QRegExp findWhitespaceAfter("([AaCcEeMmVvTtQqSsLlVvHhZz,]) ");
 static const QRegExp findWhitespaceAtEnd(" $");
 static const QRegExp findMinus("-");
 
-SVGPathLexer::SVGPathLexer(const QString &source)
+SVGPathLexer::SVGPathLexer(const QString &source) : m_floatingPointMatcher(TextUtils::floatingPointMatcher)
 {
 	m_source = clean(source);
 	m_chars = m_source.unicode();
@@ -71,10 +71,10 @@ int SVGPathLexer::lex()
 		// Do this first, to prevent infinite loop when last content of the path data is a number
 		return SVGPathGrammar::EOF_SYMBOL;
 	}
-	if (TextUtils::floatingPointMatcher.indexIn(m_source, m_pos - 1) == m_pos - 1) {
+	if (m_floatingPointMatcher.indexIn(m_source, m_pos - 1) == m_pos - 1) {
 		// sitting at the start of a number: collect and advance past it
-		m_currentNumber = m_source.mid(m_pos - 1, TextUtils::floatingPointMatcher.matchedLength()).toDouble();
-		m_pos += TextUtils::floatingPointMatcher.matchedLength() - 1;
+		m_currentNumber = m_source.mid(m_pos - 1, m_floatingPointMatcher.matchedLength()).toDouble();
+		m_pos += m_floatingPointMatcher.matchedLength() - 1;
 		next();
 		return SVGPathGrammar::NUMBER;
 	}
@@ -51,6 +51,7 @@ protected:
 	QChar m_current = 0;
 	QChar m_currentCommand = 0;
 	double m_currentNumber = 0.0;
+	QRegExp m_floatingPointMatcher;     // per lexer, since QRegExp keeps match state and paths are lexed on several threads
 };
 
 #endif
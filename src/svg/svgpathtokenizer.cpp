@@ -0,0 +1,280 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#include "svgpathtokenizer.h"
+
+#include <QByteArray>
+
+// every power of ten up to 1e22 is exactly representable as a double
+static const double PowersOfTen[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const int MaxExactPower = 22;
+static const int MaxExactDigits = 15;           // any 15 digit integer fits in a double's 53 bit mantissa
+static const int MaxMantissaDigits = 19;        // any 19 digit integer fits in a quint64
+
+static inline bool isDigit(ushort c) {
+	return c >= '0' && c <= '9';
+}
+
+static inline bool isWhitespace(ushort c) {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+static inline void skipWhitespace(const QChar * & p, const QChar * end) {
+	while (p < end && isWhitespace(p->unicode())) p++;
+}
+
+///////////////////////////////////////////////
+
+void SVGPathTokenizer::clear() {
+	// QVarLengthArray::clear keeps the allocated capacity
+	m_commands.clear();
+	m_args.clear();
+}
+
+SVGPathArgs SVGPathTokenizer::args(int index) const {
+	const Command & command = m_commands.at(index);
+	return SVGPathArgs(m_args.constData() + command.first, command.count);
+}
+
+bool SVGPathTokenizer::contains(char command) const {
+	for (int i = 0; i < m_commands.count(); i++) {
+		if (m_commands.at(i).command == QLatin1Char(command)) return true;
+	}
+
+	return false;
+}
+
+int SVGPathTokenizer::argCount(QChar command) {
+	switch (command.unicode()) {
+	case 'M':
+	case 'm':
+	case 'L':
+	case 'l':
+	case 'T':
+	case 't':
+		return 2;
+	case 'H':
+	case 'h':
+	case 'V':
+	case 'v':
+		return 1;
+	case 'C':
+	case 'c':
+		return 6;
+	case 'S':
+	case 's':
+	case 'Q':
+	case 'q':
+		return 4;
+	case 'A':
+	case 'a':
+		return 7;
+	case 'Z':
+	case 'z':
+		return 0;
+	default:
+		return -1;
+	}
+}
+
+bool SVGPathTokenizer::endCommand() const {
+	if (m_commands.isEmpty()) return true;
+
+	const Command & command = m_commands.last();
+	int count = argCount(command.command);
+	if (count == 0) return command.count == 0;
+
+	return command.count > 0 && command.count % count == 0;
+}
+
+/**
+ * Tokenize path data into commands and arguments.  Follows the svg path grammar: numbers may be
+ * separated by whitespace and at most one comma, or by nothing at all when the next number starts
+ * with a sign or a second decimal point; arc flags may be written without separators.  Data which
+ * starts with a number (as in polygon points) is treated as if it started with 'M'.
+ * @brief split svg path data into commands and arguments
+ * @param data the "d" attribute of a path, or the "points" attribute of a polygon or polyline
+ * @return false if the data is not a valid path; the tokenizer is then left empty
+ */
+bool SVGPathTokenizer::tokenize(const QString & data) {
+	clear();
+
+	const QChar * p = data.constData();
+	const QChar * end = p + data.length();
+	int currentArgCount = -1;
+	bool afterComma = false;
+
+	skipWhitespace(p, end);
+	while (p < end) {
+		QChar c = *p;
+		int count = argCount(c);
+		if (count >= 0) {
+			if (afterComma || !endCommand()) break;
+			if (m_commands.isEmpty() && c != QLatin1Char('M') && c != QLatin1Char('m')) break;
+
+			Command command;
+			command.command = c;
+			command.relative = c.isLower();
+			command.first = m_args.count();
+			command.count = 0;
+			m_commands.append(command);
+			currentArgCount = count;
+			p++;
+		}
+		else if (c == QLatin1Char(',')) {
+			if (afterComma || m_commands.isEmpty() || m_commands.last().count == 0) break;
+
+			afterComma = true;
+			p++;
+		}
+		else {
+			if (m_commands.isEmpty()) {
+				Command command;
+				command.command = QLatin1Char('M');
+				command.relative = false;
+				command.first = 0;
+				command.count = 0;
+				m_commands.append(command);
+				currentArgCount = 2;
+			}
+			if (currentArgCount == 0) break;
+
+			double value;
+			Command & command = m_commands.last();
+			int position = command.count % currentArgCount;
+			if (currentArgCount == 7 && (position == 3 || position == 4)) {
+				// large-arc and sweep flags are a single digit, so "a1 1 0 011 1" is legal
+				if (c == QLatin1Char('0')) value = 0;
+				else if (c == QLatin1Char('1')) value = 1;
+				else break;
+				p++;
+			}
+			else if (!parseNumber(p, end, value)) break;
+
+			m_args.append(value);
+			command.count++;
+			afterComma = false;
+		}
+
+		skipWhitespace(p, end);
+	}
+
+	if (p < end || afterComma || m_commands.isEmpty() || !endCommand()) {
+		clear();
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Parse one svg number: an optional sign, digits with an optional decimal point, and an optional
+ * exponent.  The common case (at most 15 significant digits, small exponent) is converted exactly
+ * without allocating; anything longer falls back to QByteArray::toDouble.
+ * @brief parse a number and advance p past it
+ * @return false, with p unchanged, if there is no number at p
+ */
+bool SVGPathTokenizer::parseNumber(const QChar * & p, const QChar * end, double & value) {
+	const QChar * start = p;
+	const QChar * q = p;
+
+	bool negative = false;
+	if (q < end && (q->unicode() == '+' || q->unicode() == '-')) {
+		negative = q->unicode() == '-';
+		q++;
+	}
+
+	quint64 mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool anyDigits = false;
+
+	while (q < end && isDigit(q->unicode())) {
+		anyDigits = true;
+		if (digits < MaxMantissaDigits) {
+			mantissa = (mantissa * 10) + (q->unicode() - '0');
+			if (mantissa != 0) digits++;
+		}
+		else {
+			exponent++;
+		}
+		q++;
+	}
+
+	if (q < end && q->unicode() == '.') {
+		q++;
+		while (q < end && isDigit(q->unicode())) {
+			anyDigits = true;
+			if (digits < MaxMantissaDigits) {
+				mantissa = (mantissa * 10) + (q->unicode() - '0');
+				if (mantissa != 0) digits++;
+				exponent--;
+			}
+			q++;
+		}
+	}
+
+	if (!anyDigits) return false;
+
+	if (q < end && (q->unicode() == 'e' || q->unicode() == 'E')) {
+		// only an exponent if digits follow, though no path command uses 'e' anyway
+		const QChar * e = q + 1;
+		int sign = 1;
+		if (e < end && (e->unicode() == '+' || e->unicode() == '-')) {
+			if (e->unicode() == '-') sign = -1;
+			e++;
+		}
+		if (e < end && isDigit(e->unicode())) {
+			int power = 0;
+			while (e < end && isDigit(e->unicode())) {
+				if (power < 10000) power = (power * 10) + (e->unicode() - '0');
+				e++;
+			}
+			exponent += sign * power;
+			q = e;
+		}
+	}
+
+	p = q;
+
+	if (mantissa == 0) {
+		value = negative ? -0.0 : 0.0;
+		return true;
+	}
+
+	if (digits <= MaxExactDigits && exponent >= -MaxExactPower && exponent <= MaxExactPower) {
+		// both operands are exact, so a single multiply or divide gives the correctly rounded result
+		value = (exponent < 0) ? mantissa / PowersOfTen[-exponent] : mantissa * PowersOfTen[exponent];
+		if (negative) value = -value;
+		return true;
+	}
+
+	QByteArray latin1;
+	latin1.reserve(q - start);
+	for (const QChar * c = start; c < q; c++) {
+		latin1.append(c->toLatin1());
+	}
+	value = latin1.toDouble();
+	return true;
+}
@@ -0,0 +1,89 @@
+/*******************************************************************
+
+Part of the Fritzing project - http://fritzing.org
+Copyright (c) 2007-2019 Fritzing
+
+Fritzing is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fritzing is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
+
+********************************************************************/
+
+#ifndef SVGPATHTOKENIZER_H
+#define SVGPATHTOKENIZER_H
+
+#include <QString>
+#include <QVarLengthArray>
+
+// read-only view of the arguments of one path command; only valid inside the handler call
+class SVGPathArgs
+{
+public:
+	SVGPathArgs(const double * args, int count) : m_args(args), m_count(count) {}
+
+	int count() const noexcept { return m_count; }
+	bool isEmpty() const noexcept { return m_count == 0; }
+	double operator[](int i) const noexcept { return m_args[i]; }
+	double at(int i) const { Q_ASSERT(i >= 0 && i < m_count); return m_args[i]; }
+
+protected:
+	const double * m_args;
+	int m_count;
+};
+
+// Hand-written single pass tokenizer for svg path data (and polygon points), used instead of
+// running SVGPathLexer and SVGPathParser into a QVariant symbol stack.  Commands and arguments go into
+// two flat buffers with inline storage, so typical paths are tokenized without touching the heap;
+// a tokenizer can be reused, and keeps whatever capacity it has grown to.
+class SVGPathTokenizer
+{
+public:
+	struct Command {
+		QChar command;
+		bool relative;
+		int first;          // index of the first argument in m_args
+		int count;          // all the arguments for this command, a multiple of argCount(command)
+	};
+
+public:
+	SVGPathTokenizer() = default;
+
+	bool tokenize(const QString & data);
+	void clear();
+	int count() const noexcept { return m_commands.count(); }
+	const Command & command(int index) const { return m_commands.at(index); }
+	SVGPathArgs args(int index) const;
+	bool contains(char command) const;
+
+	// calls (target->*Handler)(command, relative, args, userData) once per command;
+	// the handler is a template argument, so the dispatch is resolved at compile time
+	template <class T, void (T::*Handler)(QChar, bool, const SVGPathArgs &, void *)>
+	void run(T * target, void * userData) const {
+		for (int i = 0; i < m_commands.count(); i++) {
+			const Command & command = m_commands.at(i);
+			(target->*Handler)(command.command, command.relative, SVGPathArgs(m_args.constData() + command.first, command.count), userData);
+		}
+	}
+
+public:
+	static int argCount(QChar command);             // -1 if command is not a path command
+	static bool parseNumber(const QChar * & p, const QChar * end, double & value);
+
+protected:
+	bool endCommand() const;
+
+protected:
+	QVarLengthArray<Command, 32> m_commands;
+	QVarLengthArray<double, 256> m_args;
+};
+
+#endif // SVGPATHTOKENIZER_H
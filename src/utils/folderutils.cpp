@@ -32,6 +32,7 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDesktopServices>
 #include <QUrl>
 #include <QFileInfo>
+#include <QSaveFile>
 
 #include "../debugdialog.h"
 #ifdef QUAZIP_INSTALLED
@@ -46,6 +47,55 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 
 FolderUtils* FolderUtils::singleton = NULL;
 QString FolderUtils::m_openSaveFolder = "";
+const int FolderUtils::CopyBufferSize = 256 * 1024;
+
+#ifndef QUAZIP_INSTALLED
+// minizip io functions over the QSaveFile passed in as opaque; closing leaves it open for the caller to commit
+static voidpf ZCALLBACK saveFileOpen(voidpf opaque, const char *, int) {
+	return opaque;
+}
+
+static uLong ZCALLBACK saveFileRead(voidpf, voidpf stream, void * buf, uLong size) {
+	qint64 count = static_cast<QIODevice *>(stream)->read(static_cast<char *>(buf), size);
+	return (count < 0) ? 0 : (uLong) count;
+}
+
+static uLong ZCALLBACK saveFileWrite(voidpf, voidpf stream, const void * buf, uLong size) {
+	qint64 count = static_cast<QIODevice *>(stream)->write(static_cast<const char *>(buf), size);
+	return (count < 0) ? 0 : (uLong) count;
+}
+
+static long ZCALLBACK saveFileTell(voidpf, voidpf stream) {
+	return (long) static_cast<QIODevice *>(stream)->pos();
+}
+
+static long ZCALLBACK saveFileSeek(voidpf, voidpf stream, uLong offset, int origin) {
+	QIODevice * device = static_cast<QIODevice *>(stream);
+	qint64 pos;
+	switch (origin) {
+	case ZLIB_FILEFUNC_SEEK_CUR:
+		pos = device->pos() + offset;
+		break;
+	case ZLIB_FILEFUNC_SEEK_END:
+		pos = device->size() + offset;
+		break;
+	case ZLIB_FILEFUNC_SEEK_SET:
+		pos = offset;
+		break;
+	default:
+		return -1;
+	}
+	return device->seek(pos) ? 0 : -1;
+}
+
+static int ZCALLBACK saveFileClose(voidpf, voidpf) {
+	return 0;
+}
+
+static int ZCALLBACK saveFileError(voidpf, voidpf) {
+	return 0;
+}
+#endif
 
 FolderUtils::FolderUtils() {
 	m_openSaveFolder = ___emptyString___;
@@ -442,18 +492,39 @@ bool FolderUtils::createFZAndSaveTo(const QDir &dirToCompress, const QString &fi
 bool FolderUtils::createZipAndSaveTo(const QDir &dirToCompress, const QString &filepath, const QStringList & skipSuffixes) {
 	DebugDialog::debug("zipping "+dirToCompress.path()+" into "+filepath);
 
-	QString tempZipFile = QDir::temp().path()+"/"+TextUtils::getRandText()+".zip";
-	DebugDialog::debug("temp file: "+tempZipFile);
-	QuaZip zip(tempZipFile);
+	// if we're here the user has already accepted to overwrite;
+	// the zip is written straight into a QSaveFile, so the previous file stays intact until the new one is complete
+	QSaveFile saveFile(filepath);
+	if (!saveFile.open(QIODevice::WriteOnly)) {
+		DebugDialog::debug(QString("createZipAndSaveTo: unable to open %1: %2").arg(filepath).arg(saveFile.errorString()));
+		return false;
+	}
+
+#ifdef QUAZIP_INSTALLED
+	QuaZip zip(&saveFile);							// closing the zip commits the QSaveFile
 	if(!zip.open(QuaZip::mdCreate)) {
+#else
+	zlib_filefunc_def ioApi;
+	ioApi.zopen_file = saveFileOpen;
+	ioApi.zread_file = saveFileRead;
+	ioApi.zwrite_file = saveFileWrite;
+	ioApi.ztell_file = saveFileTell;
+	ioApi.zseek_file = saveFileSeek;
+	ioApi.zclose_file = saveFileClose;
+	ioApi.zerror_file = saveFileError;
+	ioApi.opaque = &saveFile;
+	QuaZip zip(filepath);
+	if(!zip.open(QuaZip::mdCreate, &ioApi)) {
+#endif
 		qWarning("zip.open(): %d", zip.getZipError());
+		saveFile.cancelWriting();
 		return false;
 	}
 
 	QFileInfoList files=dirToCompress.entryInfoList();
 	QFile inFile;
 	QuaZipFile outFile(&zip);
-	char c;
+	QByteArray buffer(CopyBufferSize, 0);
 
 	QString currFolderBU = QDir::currentPath();
 	QDir::setCurrent(dirToCompress.path());
@@ -477,22 +548,29 @@ bool FolderUtils::createZipAndSaveTo(const QDir &dirToCompress, const QString &f
 
 		if(!inFile.open(QIODevice::ReadOnly)) {
 			qWarning("inFile.open(): %s", inFile.errorString().toLocal8Bit().constData());
+			saveFile.cancelWriting();
 			return false;
 		}
 		if(!outFile.open(QIODevice::WriteOnly, QuaZipNewInfo(inFile.fileName(), inFile.fileName()))) {
 			qWarning("outFile.open(): %d", outFile.getZipError());
+			saveFile.cancelWriting();
 			return false;
 		}
 
-		while(inFile.getChar(&c)&&outFile.putChar(c)) {}
+		qint64 count;
+		while ((count = inFile.read(buffer.data(), buffer.size())) > 0) {
+			if (outFile.write(buffer.constData(), count) != count) break;
+		}
 
 		if(outFile.getZipError()!=UNZ_OK) {
-			qWarning("outFile.putChar(): %d", outFile.getZipError());
+			qWarning("outFile.write(): %d", outFile.getZipError());
+			saveFile.cancelWriting();
 			return false;
 		}
 		outFile.close();
 		if(outFile.getZipError()!=UNZ_OK) {
 			qWarning("outFile.close(): %d", outFile.getZipError());
+			saveFile.cancelWriting();
 			return false;
 		}
 		inFile.close();
@@ -500,18 +578,38 @@ bool FolderUtils::createZipAndSaveTo(const QDir &dirToCompress, const QString &f
 	zip.close();
 	QDir::setCurrent(currFolderBU);
 
-	if(QFileInfo(filepath).exists()) {
-		// if we're here the usr has already accepted to overwrite
-		QFile::remove(filepath);
-	}
-	QFile file(tempZipFile);
-	FolderUtils::slamCopy(file, filepath);
-	file.remove();
-
 	if(zip.getZipError()!=0) {
 		qWarning("zip.close(): %d", zip.getZipError());
+		saveFile.cancelWriting();
 		return false;
 	}
+
+#ifdef QUAZIP_INSTALLED
+	return true;
+#else
+	return saveFile.commit();
+#endif
+}
+
+bool FolderUtils::saveFile(const QString & dest, const QByteArray & bytes, QString & error) {
+	// safe to call from a worker thread
+	QSaveFile outFile(dest);
+	if (!outFile.open(QIODevice::WriteOnly)) {
+		error = outFile.errorString();
+		DebugDialog::debug(QString("saveFile: unable to open %1: %2").arg(dest).arg(error));
+		return false;
+	}
+
+	if (outFile.write(bytes) != bytes.size()) {
+		error = outFile.errorString();
+		outFile.cancelWriting();
+	}
+
+	if (!outFile.commit()) {
+		if (error.isEmpty()) error = outFile.errorString();
+		return false;
+	}
+
 	return true;
 }
 
@@ -534,7 +632,7 @@ bool FolderUtils::unzipTo(const QString &filepath, const QString &dirToDecompres
 	QuaZipFile file(&zip);
 	QFile out;
 	QString name;
-	char c;
+	QByteArray buffer(CopyBufferSize, 0);
 	for(bool more=zip.goToFirstFile(); more; more=zip.goToNextFile()) {
 		if(!zip.getCurrentFileInfo(&info)) {
 			error = QString("getCurrentFileInfo(): %d\n").arg(zip.getZipError());
@@ -576,23 +674,9 @@ bool FolderUtils::unzipTo(const QString &filepath, const QString &dirToDecompres
 			}
 		}
 
-		// Slow like hell (on GNU/Linux at least), but it is not my fault.
-		// Not ZIP/UNZIP package's fault either.
-		// The slowest thing here is out.putChar(c).
-		// TODO: now that out.putChar has been replaced with a buffered write, is it still slow under Linux?
-
-#define BUFFERSIZE 1024
-		char buffer[BUFFERSIZE];
-		int ix = 0;
-		while(file.getChar(&c)) {
-			buffer[ix++] = c;
-			if (ix == BUFFERSIZE) {
-				out.write(buffer, ix);
-				ix = 0;
-			}
-		}
-		if (ix > 0) {
-			out.write(buffer, ix);
+		qint64 count;
+		while ((count = file.read(buffer.data(), buffer.size())) > 0) {
+			out.write(buffer.constData(), count);
 		}
 
 		out.close();
@@ -62,9 +62,13 @@ public:
 	static void makePartFolderHierarchy(const QString & prefixFolder, const QString & destFolder);
   	static void copyBin(const QString & dest, const QString & source);
 	static bool slamCopy(QFile &, const QString & dest);
+	static bool saveFile(const QString & dest, const QByteArray & bytes, QString & error);
 	static void showInFolder(const QString & path);
 	static void createUserDataStoreFolders();
 
+public:
+	static const int CopyBufferSize;
+
 protected:
 	FolderUtils();
 	~FolderUtils();
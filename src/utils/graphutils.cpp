@@ -44,6 +44,10 @@ along with Fritzing.  If not, see <http://www.gnu.org/licenses/>.
 #include "../items/jumperitem.h"
 #include "../sketch/sketchwidget.h"
 #include "../debugdialog.h"
+#include "../connectors/bus.h"
+
+#include <QSet>
+#include <qmath.h>
 
 
 void ConnectorEdge::setHeadTail(int h, int t) {
@@ -319,11 +323,24 @@ void GraphUtils::minCut(QList<ConnectorItem *> & connectorItems, QList<SketchWid
 }
 
 
-bool GraphUtils::chooseRatsnestGraph(const QList<ConnectorItem *> * partConnectorItems, ViewGeometry::WireFlags flags, ConnectorPairHash & result) {
-	using namespace boost;
-	typedef adjacency_list < vecS, vecS, undirectedS, property<vertex_distance_t, double>, property < edge_weight_t, double > > Graph;
-	typedef std::pair < int, int >E;
+static int findGroup(QVector<int> & parents, int i) {
+	while (parents.at(i) != i) {
+		parents[i] = parents.at(parents.at(i));
+		i = parents.at(i);
+	}
+	return i;
+}
 
+static bool joinGroups(QVector<int> & parents, int i, int j) {
+	i = findGroup(parents, i);
+	j = findGroup(parents, j);
+	if (i == j) return false;
+
+	parents[qMax(i, j)] = qMin(i, j);
+	return true;
+}
+
+bool GraphUtils::chooseRatsnestGraph(const QList<ConnectorItem *> * partConnectorItems, ViewGeometry::WireFlags flags, ConnectorPairHash & result) {
 	if (partConnectorItems->count() < 2) return false;
 
 	QList <ConnectorItem *> temp(*partConnectorItems);
@@ -343,72 +360,214 @@ bool GraphUtils::chooseRatsnestGraph(const QList<ConnectorItem *> * partConnecto
 	}
 
 	QList<QPointF> locs;
+	QHash<ConnectorItem *, int> indexes;
 	foreach (ConnectorItem * connectorItem, temp) {
+		indexes.insert(connectorItem, locs.count());
 		locs << connectorItem->sceneAdjustedTerminalPoint(NULL);
 	}
 
-	QList < QList<ConnectorItem *> > wiredTo;
-
+	// connectors on the same bus of a part, or already wired together, cost nothing to connect
 	int num_nodes = temp.count();
+	QVector<int> parents(num_nodes);
+	for (int i = 0; i < num_nodes; i++) parents[i] = i;
+
+	QHash<QPair<ItemBase *, Bus *>, int> buses;
+	QSet<int> wired;
+	for (int i = 0; i < num_nodes; i++) {
+		ConnectorItem * c1 = temp.at(i);
+		if (c1->bus()) {
+			QPair<ItemBase *, Bus *> key(c1->attachedTo(), c1->bus());
+			if (buses.contains(key)) joinGroups(parents, i, buses.value(key));
+			else buses.insert(key, i);
+		}
+
+		if (wired.contains(i)) continue;
+
+		QList<ConnectorItem *> cwConnectorItems;
+		cwConnectorItems.append(c1);
+		ConnectorItem::collectEqualPotential(cwConnectorItems, true, flags);
+		foreach (ConnectorItem * cx, cwConnectorItems) {
+			int j = indexes.value(cx, -1);
+			if (j < 0) continue;
+
+			wired.insert(j);
+			joinGroups(parents, i, j);
+		}
+	}
+
+	QVector<int> groups(num_nodes);
+	for (int i = 0; i < num_nodes; i++) groups[i] = findGroup(parents, i);
+
+	QList< QPair<int, int> > tree = spanningTree(locs, groups);
+	for (int i = 0; i < tree.count(); i++) {
+		result.insert(temp.at(tree.at(i).first), temp.at(tree.at(i).second));
+	}
+
+	return true;
+}
+
+QList< QPair<int, int> > GraphUtils::spanningTree(const QList<QPointF> & locs, const QVector<int> & groups)
+{
+	// Boruvka's algorithm: each round joins every component to its nearest neighbor,
+	// found by searching outward through a grid of the points, ring by ring, until no closer point is possible.
+	// Points in the same group start out in one component and are never joined by an edge.
+
+	QList< QPair<int, int> > tree;
+	int n = locs.count();
+	if (n < 2) return tree;
+
+	QVector<int> parents(n);
+	for (int i = 0; i < n; i++) parents[i] = i;
+	QHash<int, int> groupFirst;
+	for (int i = 0; i < n; i++) {
+		if (groupFirst.contains(groups.at(i))) joinGroups(parents, i, groupFirst.value(groups.at(i)));
+		else groupFirst.insert(groups.at(i), i);
+	}
+
+	double minX = locs.at(0).x();
+	double maxX = minX;
+	double minY = locs.at(0).y();
+	double maxY = minY;
+	foreach (QPointF loc, locs) {
+		minX = qMin(minX, loc.x());
+		maxX = qMax(maxX, loc.x());
+		minY = qMin(minY, loc.y());
+		maxY = qMax(maxY, loc.y());
+	}
+
+	// about one point per cell
+	double cellSize = qSqrt(qMax((maxX - minX) * (maxY - minY), 0.0) / n);
+	if (cellSize <= 0) cellSize = qMax(maxX - minX, maxY - minY) / n;
+	if (cellSize <= 0) cellSize = 1;
+	int columns = qMin((int) ((maxX - minX) / cellSize) + 1, n);
+	int rows = qMin((int) ((maxY - minY) / cellSize) + 1, n);
+	cellSize = qMax((maxX - minX) / columns, (maxY - minY) / rows) * 1.000001;
+	if (cellSize <= 0) cellSize = 1;
+
+	QVector<int> cellOf(n);
+	QVector<int> cellStart(columns * rows + 1, 0);
+	for (int i = 0; i < n; i++) {
+		int x = qMin((int) ((locs.at(i).x() - minX) / cellSize), columns - 1);
+		int y = qMin((int) ((locs.at(i).y() - minY) / cellSize), rows - 1);
+		cellOf[i] = (y * columns) + x;
+		cellStart[cellOf.at(i) + 1]++;
+	}
+	for (int c = 0; c < columns * rows; c++) cellStart[c + 1] += cellStart.at(c);
+	QVector<int> cellPoints(n);
+	QVector<int> fill(cellStart);
+	for (int i = 0; i < n; i++) cellPoints[fill[cellOf.at(i)]++] = i;
+
+	QVector<int> roots(n);
+	QVector<double> bestDistance(n);
+	QVector<int> bestFrom(n);
+	QVector<int> bestTo(n);
+	int maxRing = qMax(columns, rows);
+
+	while (true) {
+		int components = 0;
+		for (int i = 0; i < n; i++) {
+			roots[i] = findGroup(parents, i);
+			bestFrom[i] = -1;
+			if (roots.at(i) == i) components++;
+		}
+		if (components <= 1) break;
+
+		bool found = false;
+		for (int i = 0; i < n; i++) {
+			int root = roots.at(i);
+			int cx = cellOf.at(i) % columns;
+			int cy = cellOf.at(i) / columns;
+			for (int ring = 0; ring <= maxRing; ring++) {
+				if (bestFrom.at(root) >= 0 && ring > 1) {
+					// everything further out is at least (ring - 1) cells away
+					double reach = (ring - 1) * cellSize;
+					if (reach * reach > bestDistance.at(root)) break;
+				}
+
+				for (int y = cy - ring; y <= cy + ring; y++) {
+					if (y < 0 || y >= rows) continue;
+
+					bool edgeRow = (y == cy - ring || y == cy + ring);
+					for (int x = cx - ring; x <= cx + ring; x += (edgeRow || ring == 0) ? 1 : 2 * ring) {
+						if (x < 0 || x >= columns) continue;
+
+						int cell = (y * columns) + x;
+						for (int k = cellStart.at(cell); k < cellStart.at(cell + 1); k++) {
+							int j = cellPoints.at(k);
+							if (roots.at(j) == root) continue;
+
+							double dx = locs.at(i).x() - locs.at(j).x();
+							double dy = locs.at(i).y() - locs.at(j).y();
+							double d = (dx * dx) + (dy * dy);
+
+							// ties are broken by index, so every component agrees on the same edges
+							int a = qMin(i, j);
+							int b = qMax(i, j);
+							if (bestFrom.at(root) >= 0) {
+								if (d > bestDistance.at(root)) continue;
+								if (d == bestDistance.at(root)) {
+									int ba = qMin(bestFrom.at(root), bestTo.at(root));
+									int bb = qMax(bestFrom.at(root), bestTo.at(root));
+									if (a > ba || (a == ba && b >= bb)) continue;
+								}
+							}
+							bestDistance[root] = d;
+							bestFrom[root] = i;
+							bestTo[root] = j;
+							found = true;
+						}
+					}
+				}
+			}
+		}
+
+		if (!found) break;
+
+		for (int root = 0; root < n; root++) {
+			if (bestFrom.at(root) < 0) continue;
+			if (!joinGroups(parents, bestFrom.at(root), bestTo.at(root))) continue;
+
+			// coincident connectors count as connected, like zero-weight edges
+			if (bestDistance.at(root) > 0) tree << QPair<int, int>(bestFrom.at(root), bestTo.at(root));
+		}
+	}
+
+	return tree;
+}
+
+QList< QPair<int, int> > GraphUtils::denseSpanningTree(const QList<QPointF> & locs, const QVector<int> & groups)
+{
+	// the complete graph and boost's Prim, which chooseRatsnestGraph used before spanningTree; kept for comparison
+	using namespace boost;
+	typedef adjacency_list < vecS, vecS, undirectedS, property<vertex_distance_t, double>, property < edge_weight_t, double > > Graph;
+	typedef std::pair < int, int >E;
+
+	QList< QPair<int, int> > tree;
+	int num_nodes = locs.count();
+	if (num_nodes < 2) return tree;
+
 	int num_edges = num_nodes * (num_nodes - 1) / 2;
 	E * edges = new E[num_edges];
 	double * weights = new double[num_edges];
 	int ix = 0;
 	QVector< QVector<double> > reverseWeights(num_nodes, QVector<double>(num_nodes, 0));
 	for (int i = 0; i < num_nodes; i++) {
-		ConnectorItem * c1 = temp.at(i);
-		//c1->debugInfo("c1");
 		for (int j = i + 1; j < num_nodes; j++) {
 			edges[ix].first = i;
 			edges[ix].second = j;
-			ConnectorItem * c2 = temp.at(j);
-			if ((c1->attachedTo() == c2->attachedTo()) && (c1->bus()) && (c1->bus() == c2->bus())) {
+			if (groups.at(i) == groups.at(j)) {
 				weights[ix++] = 0;
 				continue;
 			}
 
-			bool already = false;
-			bool checkWiredTo = true;
-			foreach (QList<ConnectorItem *> list, wiredTo) {
-				if (list.contains(c1)) {
-					checkWiredTo = false;
-					if (list.contains(c2)) {
-						weights[ix++] = 0;
-						already = true;
-					}
-					break;
-				}
-			}
-			if (already) continue;
-
-			//c2->debugInfo("\tc2");
-
-			if (checkWiredTo) {
-				QList<ConnectorItem *> cwConnectorItems;
-				cwConnectorItems.append(c1);
-				ConnectorItem::collectEqualPotential(cwConnectorItems, true, flags);
-				wiredTo.append(cwConnectorItems);
-				//foreach (ConnectorItem * cx, cwConnectorItems) {
-				//cx->debugInfo("\t\tcx");
-				//}
-				if (cwConnectorItems.contains(c2)) {
-					weights[ix++] = 0;
-					continue;
-				}
-			}
-
-			//DebugDialog::debug("c2 not eliminated");
 			double dx = locs[i].x() - locs[j].x();
 			double dy = locs[i].y() - locs[j].y();
 			weights[ix++] = reverseWeights[i][j] = reverseWeights[j][i] = (dx * dx) + (dy * dy);
 		}
 	}
 
-	bool retval = false;
 	try {
 		Graph g(edges, edges + num_edges, weights, num_nodes);
-		// Warning: weightmap not used?
-//		property_map<Graph, edge_weight_t>::type weightmap = get(edge_weight, g);
 
 		std::vector < graph_traits < Graph >::vertex_descriptor > p(num_vertices(g));
 
@@ -418,9 +577,8 @@ bool GraphUtils::chooseRatsnestGraph(const QList<ConnectorItem *> * partConnecto
 			if (i == p[i]) continue;
 			if (reverseWeights[(int) i][(int) p[i]] == 0) continue;
 
-			result.insert(temp[(int) i], temp[(int) p[i]]);
+			tree << QPair<int, int>((int) i, (int) p[i]);
 		}
-		retval = true;
 	}
 	catch ( const std::exception& e ) {
 		// catch an error in boost 1.54
@@ -430,11 +588,10 @@ bool GraphUtils::chooseRatsnestGraph(const QList<ConnectorItem *> * partConnecto
 		DebugDialog::debug("boost spanning tree failure");
 	}
 
-
 	delete [] edges;
 	delete [] weights;
 
-	return retval;
+	return tree;
 }
 
 #define add_edge_d(i, j, g) \
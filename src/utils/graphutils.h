@@ -41,6 +41,8 @@ class GraphUtils
 
 public:
 	static bool chooseRatsnestGraph(const QList<ConnectorItem *> * equipotentials, ViewGeometry::WireFlags, ConnectorPairHash & result);
+	static QList< QPair<int, int> > spanningTree(const QList<QPointF> & locs, const QVector<int> & groups);
+	static QList< QPair<int, int> > denseSpanningTree(const QList<QPointF> & locs, const QVector<int> & groups);
 	static bool scoreOneNet(QList<ConnectorItem *> & partConnectorItems, ViewGeometry::WireFlags, RoutingStatus & routingStatus);
 	static void minCut(QList<ConnectorItem *> & connectorItems, QList<class SketchWidget *> & foreighSketchWidgets, ConnectorItem * source, ConnectorItem * sink, QList<ConnectorEdge *> & cutSet);
 
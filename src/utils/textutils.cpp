@@ -930,9 +930,10 @@ QList<double> TextUtils::getTransformFloats(const QString & transform) {
 	QList<double> list;
 	int pos = 0;
 
-	while ((pos = TextUtils::floatingPointMatcher.indexIn(transform, pos)) != -1) {
-		list << transform.mid(pos, TextUtils::floatingPointMatcher.matchedLength()).toDouble();
-		pos += TextUtils::floatingPointMatcher.matchedLength();
+	QRegExp matcher(TextUtils::floatingPointMatcher);       // a copy keeps this safe to call from several threads
+	while ((pos = matcher.indexIn(transform, pos)) != -1) {
+		list << transform.mid(pos, matcher.matchedLength()).toDouble();
+		pos += matcher.matchedLength();
 	}
 
 #ifndef QT_NO_DEBUG
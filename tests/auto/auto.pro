@@ -1,4 +1,4 @@
 TEMPLATE = subdirs
 
-SUBDIRS = test_svg test_textutils
+SUBDIRS = test_autoroute test_model test_svg test_textutils
 
@@ -0,0 +1,356 @@
+#include <boost/test/unit_test.hpp>
+
+#include "autoroute/drcgeometry.h"
+
+/*
+Testing the geometry the vector DRC is built on. tooClose and tooCloseToBorder are checked
+against the raster test the DRC used before (grow one shape by the keepout, render both, look
+for shared pixels) on random circles and rectangles, whose exact distances are also known, so
+cases too close to the keepout for the raster to call are skipped.
+*/
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QImage>
+#include <QLineF>
+#include <QList>
+#include <QPainter>
+#include <QPainterPath>
+#include <QRectF>
+#include <QString>
+#include <QSvgRenderer>
+#include <qmath.h>
+
+static const double FieldSize = 100;
+static const double Scale = 4;				// raster pixels per unit
+static const double Ambiguous = 0.5;		// distances this close to the keepout aren't compared
+
+struct TestShape {
+	bool circle;
+	QRectF rect;							// a circle's bounding square
+
+	QString svg(double grow) const {
+		QString stroke = (grow > 0)
+			? QString("stroke='#000000' stroke-width='%1' stroke-linejoin='round'").arg(2 * grow)
+			: QString("stroke='none'");
+		if (circle) {
+			return QString("<circle cx='%1' cy='%2' r='%3' fill='#000000' %4/>")
+				.arg(rect.center().x()).arg(rect.center().y()).arg(rect.width() / 2).arg(stroke);
+		}
+
+		return QString("<rect x='%1' y='%2' width='%3' height='%4' fill='#000000' %5/>")
+			.arg(rect.left()).arg(rect.top()).arg(rect.width()).arg(rect.height()).arg(stroke);
+	}
+
+	// distance from a point to the shape, negative inside a circle
+	double distance(const QPointF & p) const {
+		if (circle) return QLineF(p, rect.center()).length() - rect.width() / 2;
+
+		double dx = qMax(0.0, qMax(rect.left() - p.x(), p.x() - rect.right()));
+		double dy = qMax(0.0, qMax(rect.top() - p.y(), p.y() - rect.bottom()));
+		return qSqrt(dx * dx + dy * dy);
+	}
+};
+
+static QString svgDocument(const QString & elements) {
+	return QString("<svg xmlns='http://www.w3.org/2000/svg' width='%1' height='%1' viewBox='0 0 %1 %1'>%2</svg>")
+		.arg(FieldSize).arg(elements);
+}
+
+static QImage rasterize(const QString & elements) {
+	int pixels = qRound(FieldSize * Scale);
+	QImage image(pixels, pixels, QImage::Format_ARGB32);
+	image.fill(0xffffffff);
+	QSvgRenderer renderer(svgDocument(elements).toUtf8());
+	QPainter painter;
+	painter.begin(&image);
+	renderer.render(&painter, QRectF(0, 0, pixels, pixels));
+	painter.end();
+	return image;
+}
+
+static inline bool covered(const QRgb * line, int x) {
+	return qGray(line[x]) < 128;
+}
+
+static DRCShape record(const TestShape & shape) {
+	QList<DRCShape> shapes = ShapeRecorder::record(svgDocument(shape.svg(0)).toUtf8(), QSizeF(FieldSize, FieldSize));
+	BOOST_REQUIRE_EQUAL(shapes.count(), 1);
+	return shapes.first();
+}
+
+static double exactDistance(const TestShape & a, const TestShape & b) {
+	if (a.circle && b.circle) {
+		return QLineF(a.rect.center(), b.rect.center()).length() - (a.rect.width() + b.rect.width()) / 2;
+	}
+	if (a.circle) return b.distance(a.rect.center()) - a.rect.width() / 2;
+	if (b.circle) return a.distance(b.rect.center()) - b.rect.width() / 2;
+
+	double dx = qMax(0.0, qMax(a.rect.left() - b.rect.right(), b.rect.left() - a.rect.right()));
+	double dy = qMax(0.0, qMax(a.rect.top() - b.rect.bottom(), b.rect.top() - a.rect.bottom()));
+	return qSqrt(dx * dx + dy * dy);
+}
+
+static TestShape randomShape(std::mt19937 & gen, double cx, double cy, double spread) {
+	std::uniform_real_distribution<double> offset(-spread, spread);
+	std::uniform_real_distribution<double> extent(1, 12);
+	std::bernoulli_distribution coin(0.5);
+
+	TestShape shape;
+	shape.circle = coin(gen);
+	double w = extent(gen);
+	double h = shape.circle ? w : extent(gen);
+	shape.rect = QRectF(cx + offset(gen) - w / 2, cy + offset(gen) - h / 2, w, h);
+	return shape;
+}
+
+// brute force distance between two segments, sampling one of them
+static double sampledDistance(const QPointF & p1, const QPointF & p2, const QPointF & q1, const QPointF & q2, int samples) {
+	QLineF q(q1, q2);
+	double best = std::numeric_limits<double>::max();
+	for (int i = 0; i <= samples; i++) {
+		QPointF p = p1 + (p2 - p1) * i / samples;
+		double t = 0;
+		if (q.length() > 0) {
+			t = ((p.x() - q1.x()) * q.dx() + (p.y() - q1.y()) * q.dy()) / (q.length() * q.length());
+			t = qBound(0.0, t, 1.0);
+		}
+		best = qMin(best, QLineF(p, q.pointAt(t)).length());
+	}
+	return best;
+}
+
+BOOST_AUTO_TEST_CASE( drcgeometry_segment_distance )
+{
+	QPointF where;
+
+	// crossing
+	BOOST_CHECK_EQUAL(DRCGeometry::segmentDistance(QPointF(-1, -1), QPointF(1, 1), QPointF(-1, 1), QPointF(1, -1), where), 0);
+	BOOST_CHECK_SMALL(QLineF(where, QPointF(0, 0)).length(), 1e-9);
+
+	// parallel, and collinear with a gap
+	BOOST_CHECK_CLOSE(DRCGeometry::segmentDistance(QPointF(0, 0), QPointF(10, 0), QPointF(2, 3), QPointF(8, 3), where), 3.0, 1e-9);
+	BOOST_CHECK_CLOSE(DRCGeometry::segmentDistance(QPointF(0, 0), QPointF(10, 0), QPointF(12, 0), QPointF(20, 0), where), 2.0, 1e-9);
+	BOOST_CHECK_SMALL(QLineF(where, QPointF(11, 0)).length(), 1e-9);
+
+	// touching at an endpoint
+	BOOST_CHECK_SMALL(DRCGeometry::segmentDistance(QPointF(0, 0), QPointF(10, 0), QPointF(5, 0), QPointF(5, 10), where), 1e-9);
+
+	std::mt19937 gen(20190501);
+	std::uniform_real_distribution<double> coord(0, 20);
+	for (int i = 0; i < 2000; i++) {
+		QPointF p1(coord(gen), coord(gen)), p2(coord(gen), coord(gen));
+		QPointF q1(coord(gen), coord(gen)), q2(coord(gen), coord(gen));
+		int samples = 2000;
+		double d = DRCGeometry::segmentDistance(p1, p2, q1, q2, where);
+		double reference = sampledDistance(p1, p2, q1, q2, samples);
+		double slack = QLineF(p1, p2).length() / samples + 1e-9;
+
+		BOOST_CHECK_LE(d, reference + 1e-9);
+		BOOST_CHECK_GE(d, reference - slack);
+
+		// where is halfway between the nearest points
+		BOOST_CHECK_LE(sampledDistance(where, where, q1, q2, 1), d / 2 + 1e-6);
+		BOOST_CHECK_LE(sampledDistance(where, where, p1, p2, 1), d / 2 + 1e-6);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( drcgeometry_shape_tree )
+{
+	ShapeTree empty;
+	empty.build(QList<QRectF>());
+	BOOST_CHECK(empty.query(QRectF(0, 0, 100, 100)).isEmpty());
+
+	std::mt19937 gen(20190502);
+	std::uniform_real_distribution<double> coord(0, 1000);
+	std::uniform_real_distribution<double> extent(0, 40);
+	QList<QRectF> rects;
+	for (int i = 0; i < 1000; i++) {
+		rects << QRectF(coord(gen), coord(gen), extent(gen), extent(gen));
+	}
+
+	ShapeTree tree;
+	tree.build(rects);
+	for (int i = 0; i < 200; i++) {
+		QRectF query(coord(gen), coord(gen), 4 * extent(gen), 4 * extent(gen));
+		QList<int> candidates = tree.query(query);
+
+		// the tree may return extra candidates but must not miss any
+		for (int j = 0; j < rects.count(); j++) {
+			if (!rects.at(j).intersects(query)) continue;
+			BOOST_CHECK(candidates.contains(j));
+		}
+	}
+
+	// a query covering everything finds every rect exactly once
+	QList<int> all = tree.query(QRectF(-1, -1, 1100, 1100));
+	std::sort(all.begin(), all.end());
+	BOOST_REQUIRE_EQUAL(all.count(), rects.count());
+	for (int j = 0; j < all.count(); j++) {
+		BOOST_CHECK_EQUAL(all.at(j), j);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( drcgeometry_shape_recorder )
+{
+	TestShape rect;
+	rect.circle = false;
+	rect.rect = QRectF(10, 20, 30, 5);
+	DRCShape recorded = record(rect);
+	BOOST_CHECK_SMALL(QLineF(recorded.bounds.topLeft(), rect.rect.topLeft()).length(), 1e-6);
+	BOOST_CHECK_SMALL(QLineF(recorded.bounds.bottomRight(), rect.rect.bottomRight()).length(), 1e-6);
+
+	TestShape circle;
+	circle.circle = true;
+	circle.rect = QRectF(40, 40, 20, 20);
+	recorded = record(circle);
+	BOOST_CHECK(recorded.path.contains(QPointF(50, 50)));
+	BOOST_CHECK(!recorded.path.contains(QPointF(41, 41)));
+	foreach (QPolygonF polygon, recorded.polygons) {
+		foreach (QPointF p, polygon) {
+			BOOST_CHECK_SMALL(circle.distance(p), DRCGeometry::Tolerance);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( drcgeometry_shape_recorder_image )
+{
+	// copper drawn as a bitmap is outlined from the pixels the raster check would count, not dropped
+	QImage image(20, 10, QImage::Format_ARGB32);
+	image.fill(0xffffffff);
+	for (int y = 2; y < 8; y++) {
+		for (int x = 4; x < 16; x++) image.setPixel(x, y, 0xff000000);
+	}
+	image.setPixel(0, 0, 0x00000000);			// transparent, so not copper
+	QByteArray png;
+	QBuffer buffer(&png);
+	buffer.open(QIODevice::WriteOnly);
+	BOOST_REQUIRE(image.save(&buffer, "PNG"));
+
+	// drawn at twice its size
+	QString svg = QString("<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' width='%1' height='%1' viewBox='0 0 %1 %1'>"
+	                      "<image x='10' y='20' width='40' height='20' xlink:href='data:image/png;base64,%2'/></svg>")
+		.arg(FieldSize).arg(QString(png.toBase64()));
+	QList<DRCShape> shapes = ShapeRecorder::record(svg.toUtf8(), QSizeF(FieldSize, FieldSize));
+	BOOST_REQUIRE_EQUAL(shapes.count(), 1);
+	BOOST_CHECK_EQUAL(shapes.first().element, -1);
+	BOOST_CHECK_SMALL(QLineF(shapes.first().bounds.topLeft(), QPointF(18, 24)).length(), 1e-6);
+	BOOST_CHECK_SMALL(QLineF(shapes.first().bounds.bottomRight(), QPointF(42, 36)).length(), 1e-6);
+	BOOST_CHECK(shapes.first().path.contains(QPointF(30, 30)));
+	BOOST_CHECK(!shapes.first().path.contains(QPointF(12, 22)));
+
+	// two blobs with a gap stay two outlines, whose clearance is checked like any other
+	QImage two(10, 10, QImage::Format_ARGB32);
+	two.fill(0xffffffff);
+	for (int y = 0; y < 10; y++) {
+		two.setPixel(1, y, 0xff000000);
+		two.setPixel(2, y, 0xff000000);
+		two.setPixel(7, y, 0xff000000);
+	}
+	QPainterPath path = ShapeRecorderEngine::darkPixels(two);
+	BOOST_CHECK_EQUAL(path.toFillPolygons().count(), 2);
+	BOOST_CHECK(path.contains(QPointF(2, 5)));
+	BOOST_CHECK(!path.contains(QPointF(5, 5)));
+	BOOST_CHECK(path.contains(QPointF(7.5, 9.5)));
+}
+
+BOOST_AUTO_TEST_CASE( drcgeometry_too_close_matches_raster )
+{
+	std::mt19937 gen(20190503);
+	std::uniform_real_distribution<double> keepouts(1, 6);
+	int compared = 0;
+	int close = 0;
+	for (int i = 0; i < 300; i++) {
+		TestShape a = randomShape(gen, FieldSize / 2, FieldSize / 2, 5);
+		TestShape b = randomShape(gen, FieldSize / 2, FieldSize / 2, 25);
+		double keepout = keepouts(gen);
+
+		double exact = exactDistance(a, b);
+		if (qAbs(exact - keepout) < Ambiguous) continue;
+
+		QImage grown = rasterize(a.svg(keepout));
+		QImage other = rasterize(b.svg(0));
+		bool rasterClose = false;
+		for (int y = 0; y < grown.height() && !rasterClose; y++) {
+			const QRgb * grownLine = (const QRgb *) grown.constScanLine(y);
+			const QRgb * otherLine = (const QRgb *) other.constScanLine(y);
+			for (int x = 0; x < grown.width(); x++) {
+				if (covered(grownLine, x) && covered(otherLine, x)) {
+					rasterClose = true;
+					break;
+				}
+			}
+		}
+
+		QPointF where;
+		bool vectorClose = DRCGeometry::tooClose(record(a), record(b), keepout, where);
+		BOOST_CHECK_EQUAL(vectorClose, exact < keepout);
+		BOOST_CHECK_EQUAL(vectorClose, rasterClose);
+		if (vectorClose) {
+			// the reported spot lies between the shapes
+			BOOST_CHECK_LE(a.distance(where), keepout + Ambiguous);
+			BOOST_CHECK_LE(b.distance(where), keepout + Ambiguous);
+			close++;
+		}
+		compared++;
+	}
+
+	// make sure both outcomes were exercised
+	BOOST_CHECK_GT(close, 20);
+	BOOST_CHECK_GT(compared - close, 20);
+}
+
+BOOST_AUTO_TEST_CASE( drcgeometry_too_close_to_border_matches_raster )
+{
+	QRectF boardRect(10, 10, 80, 80);
+	QPainterPath board;
+	board.addRect(boardRect);
+	QList<QPolygonF> boardEdges = board.toSubpathPolygons();
+
+	std::mt19937 gen(20190504);
+	std::uniform_real_distribution<double> keepouts(1, 6);
+	std::uniform_real_distribution<double> coord(12, 88);
+	std::bernoulli_distribution coin(0.5);
+	int compared = 0;
+	int close = 0;
+	for (int i = 0; i < 300; i++) {
+		// keep to one edge or corner, where the shapes can come close
+		double cx = coord(gen), cy = coord(gen);
+		if (coin(gen)) cx = (cx < FieldSize / 2) ? 12 + cx / 5 : 88 - (FieldSize - cx) / 5;
+		else cy = (cy < FieldSize / 2) ? 12 + cy / 5 : 88 - (FieldSize - cy) / 5;
+		TestShape shape = randomShape(gen, cx, cy, 2);
+		double keepout = keepouts(gen);
+
+		QRectF r = shape.rect;
+		double exact = qMin(qMin(r.left() - boardRect.left(), boardRect.right() - r.right()),
+							qMin(r.top() - boardRect.top(), boardRect.bottom() - r.bottom()));
+		if (qAbs(exact - keepout) < Ambiguous) continue;
+
+		QImage grown = rasterize(shape.svg(keepout));
+		bool rasterClose = false;
+		for (int y = 0; y < grown.height() && !rasterClose; y++) {
+			const QRgb * grownLine = (const QRgb *) grown.constScanLine(y);
+			for (int x = 0; x < grown.width(); x++) {
+				if (!covered(grownLine, x)) continue;
+				if (boardRect.contains(QPointF((x + 0.5) / Scale, (y + 0.5) / Scale))) continue;
+
+				rasterClose = true;
+				break;
+			}
+		}
+
+		QPointF where;
+		bool vectorClose = DRCGeometry::tooCloseToBorder(record(shape), board, boardEdges, keepout, where);
+		BOOST_CHECK_EQUAL(vectorClose, exact < keepout);
+		BOOST_CHECK_EQUAL(vectorClose, rasterClose);
+		if (vectorClose) close++;
+		compared++;
+	}
+
+	BOOST_CHECK_GT(close, 20);
+	BOOST_CHECK_GT(compared - close, 20);
+}
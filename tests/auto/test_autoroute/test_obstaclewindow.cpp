@@ -0,0 +1,132 @@
+#include <boost/test/unit_test.hpp>
+
+#include "autoroute/mazerouter/obstaclewindow.h"
+
+/*
+Testing the window MazeRouter redraws when routing a net: starting from every obstacle drawn
+and redrawing only the window around the items the net turned into <g> has to give the same
+image as drawing the whole document again, including a kept trace of the net that runs well
+outside the box around its parts.
+*/
+
+#include <QDomDocument>
+#include <QDomElement>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QRectF>
+#include <QString>
+#include <QStringList>
+
+static const double GridPixels = 4;			// one image pixel per scene pixel
+static const double KeepoutPixels = 2;
+
+static QRectF MaxRect(0, 0, 200, 100);
+
+static const char * Master =
+	"<svg xmlns='http://www.w3.org/2000/svg' width='200px' height='100px' viewBox='0 0 200 100'>"
+	"<g partID='1'><rect x='20' y='20' width='10' height='10'/></g>"
+	"<g partID='2'><rect x='60' y='20' width='10' height='10'/></g>"
+	"<g partID='3'><polyline points='25,30 25,85 150,85' fill='none' stroke='black' stroke-width='4'/></g>"
+	"<g partID='4'><rect x='120' y='20' width='10' height='10'/></g>"
+	"<g><rect x='175' y='70' width='10' height='10'/></g>"
+	"</svg>";
+
+static QImage * newImage() {
+	QImage * image = new QImage(200, 100, QImage::Format_Mono);
+	image->fill(0xffffffff);
+	return image;
+}
+
+static void renderAll(QDomDocument & doc, QImage * image) {
+	ObstacleWindow::render(&doc, image, MaxRect, image->rect());
+}
+
+// what splitNetPrep leaves in the net for the given items, turned into <g> the way MazeRouter::routeNets does
+static QList<QDomElement> clearItems(QDomDocument & doc, const QStringList & partIDs) {
+	QList<QDomElement> cleared;
+	QDomElement g = doc.documentElement().firstChildElement("g");
+	while (!g.isNull()) {
+		if (partIDs.contains(g.attribute("partID"))) {
+			QDomElement element = g.firstChildElement();
+			element.setTagName("g");
+			cleared << element;
+		}
+		g = g.nextSiblingElement("g");
+	}
+	return cleared;
+}
+
+static QHash<QString, QRectF> itemRects(bool withTrace) {
+	QHash<QString, QRectF> rects;
+	rects.insert("1", QRectF(20, 20, 10, 10));
+	rects.insert("2", QRectF(60, 20, 10, 10));
+	if (withTrace) rects.insert("3", QRectF(23, 28, 129, 59));
+	return rects;
+}
+
+BOOST_AUTO_TEST_CASE( obstaclewindow_kept_trace_outside_parts )
+{
+	QDomDocument doc;
+	BOOST_REQUIRE(doc.setContent(QString(Master)));
+	QImage * obstacles = newImage();
+	renderAll(doc, obstacles);
+
+	// the trace is part of the net, so it stops being an obstacle
+	QList<QDomElement> cleared = clearItems(doc, QStringList() << "1" << "2" << "3");
+	BOOST_REQUIRE_EQUAL(cleared.count(), 3);
+	QImage * expected = newImage();
+	renderAll(doc, expected);
+	BOOST_REQUIRE(*expected != *obstacles);
+
+	QRectF sceneRect;
+	BOOST_REQUIRE(ObstacleWindow::elementsRect(cleared, itemRects(true), sceneRect));
+	BOOST_CHECK(sceneRect.contains(QRectF(23, 28, 129, 59)));
+
+	QImage windowed = obstacles->copy();
+	ObstacleWindow::render(&doc, &windowed, MaxRect, ObstacleWindow::imageWindow(sceneRect, MaxRect, GridPixels, KeepoutPixels, &windowed));
+	BOOST_CHECK(windowed == *expected);
+
+	// the other net's part and the untagged element are still obstacles
+	BOOST_CHECK_EQUAL(qGray(windowed.pixel(125, 25)), 0);
+	BOOST_CHECK_EQUAL(qGray(windowed.pixel(180, 75)), 0);
+
+	// a window around the parts alone leaves the far end of the trace behind
+	QRectF partsRect = QRectF(20, 20, 10, 10) | QRectF(60, 20, 10, 10);
+	QImage partsOnly = obstacles->copy();
+	ObstacleWindow::render(&doc, &partsOnly, MaxRect, ObstacleWindow::imageWindow(partsRect, MaxRect, GridPixels, KeepoutPixels, &partsOnly));
+	BOOST_CHECK(partsOnly != *expected);
+
+	// so without the trace's rect there is no window to trust
+	BOOST_CHECK(!ObstacleWindow::elementsRect(cleared, itemRects(false), sceneRect));
+
+	delete obstacles;
+	delete expected;
+}
+
+BOOST_AUTO_TEST_CASE( obstaclewindow_elements_rect )
+{
+	QDomDocument doc;
+	BOOST_REQUIRE(doc.setContent(QString(Master)));
+
+	// nothing cleared: nothing to redraw
+	QRectF sceneRect(1, 1, 1, 1);
+	BOOST_CHECK(ObstacleWindow::elementsRect(QList<QDomElement>(), itemRects(true), sceneRect));
+	BOOST_CHECK(sceneRect.isNull());
+
+	// an element drawn from no item at all
+	QList<QDomElement> orphans;
+	orphans << doc.documentElement().lastChildElement("g").firstChildElement();
+	BOOST_CHECK(!ObstacleWindow::elementsRect(orphans, itemRects(true), sceneRect));
+
+	// the window covers the rect and the keepout, in whole bytes, and stays inside the image
+	QImage * image = newImage();
+	QRect window = ObstacleWindow::imageWindow(QRectF(20, 20, 10, 10), MaxRect, GridPixels, KeepoutPixels, image);
+	BOOST_CHECK(window.contains(QRect(12, 12, 26, 26)));
+	BOOST_CHECK_EQUAL(window.left() % 8, 0);
+	BOOST_CHECK_EQUAL((window.right() + 1) % 8, 0);
+	window = ObstacleWindow::imageWindow(QRectF(150, 60, 100, 100), MaxRect, GridPixels, KeepoutPixels, image);
+	BOOST_CHECK(image->rect().contains(window));
+	BOOST_CHECK(ObstacleWindow::imageWindow(QRectF(300, 300, 10, 10), MaxRect, GridPixels, KeepoutPixels, image).isEmpty());
+	delete image;
+}
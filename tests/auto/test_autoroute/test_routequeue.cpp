@@ -0,0 +1,382 @@
+#define BOOST_TEST_MODULE Autoroute Tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "autoroute/mazerouter/routequeue.h"
+
+/*
+Testing RouteQueue, and comparing the search MazeRouter::route runs on it against the
+search it replaced (first visit wins, keyed on squared distance, on a std::priority_queue).
+The two searches below follow MazeRouter::route/expandOne step for step on a plain grid,
+so a change to either should be mirrored here.
+*/
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <random>
+
+#include <QList>
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+#include <qmath.h>
+
+static const int ViaCost = 2000;
+static const int BoardSize = 40;
+static const int Layers = 2;
+
+struct Board {
+	QVector<bool> obstacle;
+	QList<QPoint> seeds[2];			// source and target pads
+	int seedLayer[2] = { 0, 0 };
+
+	bool blocked(int x, int y, int z) const {
+		if (x < 0 || y < 0 || x >= BoardSize || y >= BoardSize) return true;
+		return obstacle.at((z * BoardSize + y) * BoardSize + x);
+	}
+};
+
+struct SideState {
+	// per side (source = 0, target = 1): cost to reach each cell and where it came from
+	QVector<int> cost;
+	QVector<int> parent;
+	QVector<bool> closed;
+	QVector<bool> seed;
+
+	void init() {
+		int cells = BoardSize * BoardSize * Layers;
+		cost.fill(-1, cells);
+		parent.fill(-1, cells);
+		closed.fill(false, cells);
+		seed.fill(false, cells);
+	}
+};
+
+struct RouteResult {
+	bool routed = false;
+	int steps = 0;
+	int vias = 0;
+
+	int cost() const { return steps + (vias * ViaCost); }
+};
+
+static const uchar Done = 1;
+
+static inline int cellOf(int x, int y, int z) {
+	return (z * BoardSize + y) * BoardSize + x;
+}
+
+static inline GridPoint pointOf(int cell) {
+	GridPoint gp;
+	gp.x = cell % BoardSize;
+	gp.y = (cell / BoardSize) % BoardSize;
+	gp.z = cell / (BoardSize * BoardSize);
+	return gp;
+}
+
+static QRect seedBounds(const Board & board, int side) {
+	QRect r;
+	foreach (QPoint p, board.seeds[side]) r |= QRect(p, QSize(1, 1));
+	return r;
+}
+
+static void walkBack(const SideState & state, int cell, RouteResult & result) {
+	while (state.parent.at(cell) >= 0) {
+		int next = state.parent.at(cell);
+		if (pointOf(next).z != pointOf(cell).z) result.vias++;
+		else result.steps++;
+		cell = next;
+	}
+}
+
+static RouteResult pathThrough(const SideState * states, int side, int fromCell, int meetCell) {
+	// fromCell is the last cell on side's own expansion; meetCell belongs to the other side (or is one of its pads)
+	RouteResult result;
+	result.routed = true;
+	if (pointOf(fromCell).z != pointOf(meetCell).z) result.vias++;
+	else result.steps++;
+	walkBack(states[side], fromCell, result);
+	walkBack(states[1 - side], meetCell, result);
+	return result;
+}
+
+// the neighbors MazeRouter::expand visits, in the same order
+static const int Steps[6][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+
+static bool viaWillFit(const Board & board, int x, int y) {
+	for (int z = 0; z < Layers; z++) {
+		if (board.blocked(x, y, z)) return false;
+	}
+	return true;
+}
+
+//////////////////////////////////////////////////
+
+struct OldEntry {
+	GridPoint gridPoint;
+	int from;
+
+	bool operator<(const OldEntry & other) const { return gridPoint < other.gridPoint; }
+};
+
+static RouteResult oldRoute(const Board & board) {
+	SideState states[2];
+	std::priority_queue<OldEntry> queues[2];
+	QPoint centers[2] = { board.seeds[0].first(), board.seeds[1].first() };
+	for (int side = 0; side < 2; side++) {
+		states[side].init();
+		foreach (QPoint p, board.seeds[side]) {
+			int cell = cellOf(p.x(), p.y(), board.seedLayer[side]);
+			states[side].seed[cell] = true;
+			states[side].cost[cell] = 0;
+			OldEntry entry;
+			entry.gridPoint = pointOf(cell);
+			entry.from = -1;
+			queues[side].push(entry);
+		}
+	}
+
+	while (!queues[0].empty() && !queues[1].empty()) {
+		int side = (queues[1].top().gridPoint.qCost < queues[0].top().gridPoint.qCost) ? 1 : 0;
+		OldEntry entry = queues[side].top();
+		queues[side].pop();
+		GridPoint gp = entry.gridPoint;
+		if (gp.flags & Done) {
+			return pathThrough(states, side, entry.from, cellOf(gp.x, gp.y, gp.z));
+		}
+
+		int from = cellOf(gp.x, gp.y, gp.z);
+		for (int i = 0; i < 6; i++) {
+			int x = gp.x + Steps[i][0];
+			int y = gp.y + Steps[i][1];
+			int z = gp.z + Steps[i][2];
+			if (z < 0 || z >= Layers || board.blocked(x, y, z)) continue;
+
+			int cell = cellOf(x, y, z);
+			if (states[side].cost.at(cell) >= 0) continue;			// own pad or already visited
+
+			GridPoint next = pointOf(cell);
+			bool meet = states[1 - side].cost.at(cell) >= 0;
+			if (meet) next.flags |= Done;
+
+			bool crossLayer = Steps[i][2] != 0;
+			if (crossLayer && !viaWillFit(board, x, y)) continue;
+
+			next.baseCost = gp.baseCost + (crossLayer ? ViaCost : 0) + 1;
+			double dx = x - centers[1 - side].x();
+			double dy = y - centers[1 - side].y();
+			next.qCost = next.baseCost + ((states[1 - side].seed.at(cell)) ? 0 : (dx * dx) + (dy * dy));
+			OldEntry nextEntry;
+			nextEntry.gridPoint = next;
+			nextEntry.from = from;
+			queues[side].push(nextEntry);
+			if (!meet) {
+				states[side].cost[cell] = (int) next.baseCost;
+				states[side].parent[cell] = from;
+			}
+		}
+	}
+
+	return RouteResult();
+}
+
+//////////////////////////////////////////////////
+
+static quint32 heuristic(int x, int y, const QRect & bounds) {
+	int dx = qMax(0, qMax(bounds.left() - x, x - bounds.right()));
+	int dy = qMax(0, qMax(bounds.top() - y, y - bounds.bottom()));
+	return (quint32) qCeil(qSqrt((double) dx * dx + (double) dy * dy));
+}
+
+static RouteResult newRoute(const Board & board) {
+	SideState states[2];
+	RouteQueue queues[2];
+	QRect bounds[2] = { seedBounds(board, 0), seedBounds(board, 1) };
+	QVector<int> meetFrom[2];			// the cheapest way found into each meeting cell
+	QVector<int> meetCost[2];
+	for (int side = 0; side < 2; side++) {
+		states[side].init();
+		meetFrom[side].fill(-1, BoardSize * BoardSize * Layers);
+		meetCost[side].fill(std::numeric_limits<int>::max(), BoardSize * BoardSize * Layers);
+		foreach (QPoint p, board.seeds[side]) {
+			int cell = cellOf(p.x(), p.y(), board.seedLayer[side]);
+			states[side].seed[cell] = true;
+			states[side].cost[cell] = 0;
+			queues[side].push(pointOf(cell), heuristic(p.x(), p.y(), bounds[1 - side]));
+		}
+	}
+
+	while (!queues[0].isEmpty() && !queues[1].isEmpty()) {
+		int side = (queues[1].topKey() < queues[0].topKey()) ? 1 : 0;
+		GridPoint gp = queues[side].pop();
+		int from = cellOf(gp.x, gp.y, gp.z);
+		if (gp.flags & Done) {
+			return pathThrough(states, side, meetFrom[side].at(from), from);
+		}
+
+		if (gp.baseCost > 0) {
+			if (states[side].closed.at(from)) continue;
+			if ((int) gp.baseCost > states[side].cost.at(from)) continue;
+
+			states[side].closed[from] = true;
+		}
+
+		for (int i = 0; i < 6; i++) {
+			int x = gp.x + Steps[i][0];
+			int y = gp.y + Steps[i][1];
+			int z = gp.z + Steps[i][2];
+			if (z < 0 || z >= Layers || board.blocked(x, y, z)) continue;
+
+			int cell = cellOf(x, y, z);
+			if (states[side].seed.at(cell)) continue;
+
+			GridPoint next = pointOf(cell);
+			int otherCost = states[1 - side].cost.at(cell);
+			int ownCost = std::numeric_limits<int>::max();
+			if (otherCost >= 0) next.flags |= Done;
+			else if (states[side].cost.at(cell) >= 0) {
+				if (states[side].closed.at(cell)) continue;
+				ownCost = states[side].cost.at(cell);
+			}
+
+			bool crossLayer = Steps[i][2] != 0;
+			if (crossLayer && !viaWillFit(board, x, y)) continue;
+
+			next.baseCost = gp.baseCost + (crossLayer ? ViaCost : 0) + 1;
+			if ((int) next.baseCost >= ownCost) continue;
+
+			quint32 key;
+			if (next.flags & Done) {
+				key = (quint32) (next.baseCost + otherCost);
+				if ((int) next.baseCost < meetCost[side].at(cell)) {
+					meetCost[side][cell] = (int) next.baseCost;
+					meetFrom[side][cell] = from;
+				}
+			}
+			else {
+				key = (quint32) next.baseCost + heuristic(x, y, bounds[1 - side]);
+				states[side].cost[cell] = (int) next.baseCost;
+				states[side].parent[cell] = from;
+			}
+			queues[side].push(next, key);
+		}
+	}
+
+	return RouteResult();
+}
+
+//////////////////////////////////////////////////
+
+static Board makeBoard(std::mt19937 & random, double density) {
+	std::uniform_real_distribution<double> coin(0.0, 1.0);
+	std::uniform_int_distribution<int> place(2, BoardSize - 4);
+	Board board;
+	board.obstacle.fill(false, BoardSize * BoardSize * Layers);
+	for (int i = 0; i < board.obstacle.count(); i++) {
+		board.obstacle[i] = coin(random) < density;
+	}
+
+	for (int side = 0; side < 2; side++) {
+		int x = place(random);
+		int y = place(random);
+		board.seedLayer[side] = (side == 0) ? 0 : (coin(random) < 0.5 ? 0 : 1);
+		for (int dy = 0; dy < 2; dy++) {
+			for (int dx = 0; dx < 2; dx++) {
+				board.seeds[side] << QPoint(x + dx, y + dy);
+				for (int z = 0; z < Layers; z++) {
+					board.obstacle[cellOf(x + dx, y + dy, z)] = false;
+				}
+			}
+		}
+	}
+
+	// pads that overlap aren't a routing problem
+	foreach (QPoint p, board.seeds[0]) {
+		if (board.seeds[1].contains(p)) board.seeds[1].clear();
+	}
+	return board;
+}
+
+BOOST_AUTO_TEST_CASE( routequeue_order )
+{
+	// keys come out in order, ties come out last in first out, and keys near the 30 bit cost limit don't wrap
+	std::mt19937 random(17);
+	std::uniform_int_distribution<quint32> step(0, 40);
+	RouteQueue queue;
+	std::priority_queue<quint32, std::vector<quint32>, std::greater<quint32> > reference;
+	quint32 base = 0;
+	for (int round = 0; round < 2000; round++) {
+		for (int i = 0; i < 3; i++) {
+			GridPoint gp;
+			gp.x = round;
+			gp.y = i;
+			quint32 key = base + step(random);
+			queue.push(gp, key);
+			reference.push(key);
+		}
+		GridPoint gp = queue.pop();
+		BOOST_REQUIRE_EQUAL((quint32) gp.qCost, reference.top());
+		base = reference.top();
+		reference.pop();
+	}
+	while (!reference.empty()) {
+		BOOST_REQUIRE(!queue.isEmpty());
+		BOOST_REQUIRE_EQUAL((quint32) queue.pop().qCost, reference.top());
+		reference.pop();
+	}
+	BOOST_CHECK(queue.isEmpty());
+
+	queue.clear();
+	for (int i = 0; i < 3; i++) {
+		GridPoint gp;
+		gp.x = i;
+		queue.push(gp, 5);
+	}
+	BOOST_CHECK_EQUAL(queue.pop().x, 2);
+	BOOST_CHECK_EQUAL(queue.pop().x, 1);
+	BOOST_CHECK_EQUAL(queue.pop().x, 0);
+
+	queue.clear();
+	const quint32 maxPathCost = 0x3fffffff;
+	GridPoint far;
+	far.baseCost = maxPathCost;
+	queue.push(far, maxPathCost + maxPathCost);
+	queue.push(GridPoint(), 1);
+	BOOST_CHECK_EQUAL(queue.topKey(), (quint32) 1);
+	queue.pop();
+	BOOST_CHECK_EQUAL(queue.pop().baseCost, (GridValue) maxPathCost);
+}
+
+BOOST_AUTO_TEST_CASE( routequeue_search_matches_old_queue )
+{
+	// the same boards routed both ways: nothing the old search routed may be lost, and no route may get longer or gain vias
+	std::mt19937 random(4242);
+	int oldRouted = 0, newRouted = 0;
+	int oldVias = 0, newVias = 0;
+	qint64 oldCost = 0, newCost = 0;
+	const double densities[] = { 0.1, 0.25, 0.35 };
+	for (double density : densities) {
+		for (int i = 0; i < 60; i++) {
+			Board board = makeBoard(random, density);
+			if (board.seeds[1].isEmpty()) continue;
+
+			RouteResult before = oldRoute(board);
+			RouteResult after = newRoute(board);
+			BOOST_CHECK_EQUAL(before.routed, after.routed);
+			if (!before.routed || !after.routed) continue;
+
+			BOOST_CHECK_LE(after.cost(), before.cost());
+			BOOST_CHECK_LE(after.vias, before.vias);
+			oldRouted++;
+			newRouted++;
+			oldVias += before.vias;
+			newVias += after.vias;
+			oldCost += before.cost();
+			newCost += after.cost();
+		}
+	}
+
+	BOOST_CHECK_GT(newRouted, 0);
+	BOOST_TEST_MESSAGE("old queue: " << oldRouted << " routed, " << oldVias << " vias, total cost " << oldCost);
+	BOOST_TEST_MESSAGE("radix queue: " << newRouted << " routed, " << newVias << " vias, total cost " << newCost);
+}
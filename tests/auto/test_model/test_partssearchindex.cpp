@@ -0,0 +1,191 @@
+#define BOOST_TEST_MODULE Model Tests
+#include <boost/test/included/unit_test.hpp>
+
+#include "model/partssearchindex.h"
+
+/*
+Testing how PartsSearchIndex matches and ranks parts. The index never looks inside a ModelPart,
+so the documents below stand in for parts, and each is told apart by the address it carries.
+*/
+
+#include <algorithm>
+#include <random>
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+static char Parts[1000];
+
+static ModelPart * part(int i) {
+	return reinterpret_cast<ModelPart *>(&Parts[i]);
+}
+
+static int partIndex(ModelPart * modelPart) {
+	return reinterpret_cast<char *>(modelPart) - Parts;
+}
+
+static PartsSearchIndex::Document document(int i, const QString & title) {
+	PartsSearchIndex::Document document;
+	document.modelPart = part(i);
+	document.fields[PartsSearchIndex::Title] = title;
+	document.obsolete = false;
+	return document;
+}
+
+static QList<int> indexes(const QList<ModelPart *> & modelParts) {
+	QList<int> result;
+	foreach (ModelPart * modelPart, modelParts) result << partIndex(modelPart);
+	return result;
+}
+
+static QVector<PartsSearchIndex::Document> resistors() {
+	QVector<PartsSearchIndex::Document> documents;
+	documents << document(0, "Resistor");
+	documents << document(1, "Pin Header");
+	documents[1].fields[PartsSearchIndex::Tags] = "connector\nresistor";
+	documents << document(2, "Network");
+	documents[2].fields[PartsSearchIndex::Description] = "a resistor network";
+	documents << document(3, "Photoresistor");
+	documents << document(4, "Resistor Array");
+	documents[4].fields[PartsSearchIndex::PropertyValues] = "SMD\n0805";
+	documents << document(5, "Old Resistor");
+	documents[5].obsolete = true;
+	documents << document(6, "Capacitor");
+	documents[6].fields[PartsSearchIndex::PropertyKeys] = "capacitance\nvoltage";
+	documents << document(7, "IC");
+	documents[7].fields[PartsSearchIndex::ModuleID] = "generic_ic_dip_8";
+	return documents;
+}
+
+BOOST_AUTO_TEST_CASE( partssearchindex_ranking )
+{
+	PartsSearchIndex index;
+	index.build(resistors());
+
+	// whole word in the title, then a whole word in a tag, then inside a word of the title, then the description;
+	// ties go by title
+	QList<int> expected;
+	expected << 0 << 4 << 1 << 3 << 2;
+	BOOST_CHECK(indexes(index.search("resistor", false)) == expected);
+	BOOST_CHECK(indexes(index.search("RESISTOR", false)) == expected);
+	BOOST_CHECK(indexes(index.search("  resistor  resistor ", false)) == expected);
+
+	// a limit keeps the best matches, in the same order
+	BOOST_CHECK(indexes(index.search("resistor", false, 2)) == expected.mid(0, 2));
+	BOOST_CHECK(indexes(index.search("resistor", false, 0)).isEmpty());
+	BOOST_CHECK(indexes(index.search("resistor", false, 100)) == expected);
+
+	// obsolete parts only when asked for
+	BOOST_CHECK(!indexes(index.search("resistor", false)).contains(5));
+	BOOST_CHECK(indexes(index.search("resistor", true)).contains(5));
+}
+
+BOOST_AUTO_TEST_CASE( partssearchindex_matching )
+{
+	PartsSearchIndex index;
+	index.build(resistors());
+
+	// every term has to match, in any field
+	QList<int> expected;
+	expected << 4;
+	BOOST_CHECK(indexes(index.search("resistor smd", false)) == expected);
+	BOOST_CHECK(indexes(index.search("resistor capacitor", false)).isEmpty());
+
+	// property keys and module ids are searched too
+	expected.clear();
+	expected << 6;
+	BOOST_CHECK(indexes(index.search("voltage", false)) == expected);
+	expected.clear();
+	expected << 7;
+	BOOST_CHECK(indexes(index.search("dip_8", false)) == expected);
+
+	// terms too short for a trigram still match
+	expected.clear();
+	expected << 4 << 7;
+	BOOST_CHECK(indexes(index.search("r 8", false)) == expected);
+	BOOST_CHECK(indexes(index.search("zz", false)).isEmpty());
+
+	// matches is the same test for a single part
+	QVector<PartsSearchIndex::Document> documents = resistors();
+	BOOST_CHECK(PartsSearchIndex::matches(documents.at(4), QStringList() << "RESISTOR" << "0805"));
+	BOOST_CHECK(!PartsSearchIndex::matches(documents.at(4), QStringList() << "resistor" << "0603"));
+	BOOST_CHECK(PartsSearchIndex::matches(documents.at(2), QStringList() << "a resistor"));
+}
+
+BOOST_AUTO_TEST_CASE( partssearchindex_rebuild )
+{
+	PartsSearchIndex index;
+	QVector<PartsSearchIndex::Document> documents = resistors();
+	QList<ModelPart *> modelParts;
+	foreach (PartsSearchIndex::Document document, documents) modelParts << document.modelPart;
+
+	BOOST_CHECK(!index.isBuiltFrom(modelParts));
+	index.build(documents);
+	BOOST_CHECK(index.isBuiltFrom(modelParts));
+	modelParts.removeLast();
+	BOOST_CHECK(!index.isBuiltFrom(modelParts));
+
+	index.clear();
+	BOOST_CHECK(index.search("resistor", true).isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE( partssearchindex_matches_substring_search )
+{
+	// the index only proposes candidates; the results must be exactly what a plain substring search finds
+	static const char * Syllables[] = { "re", "sis", "tor", "ca", "pa", "ci", "led", "dio", "de", "ic", "8", "_", "-" };
+	int syllableCount = sizeof(Syllables) / sizeof(Syllables[0]);
+	std::mt19937 gen(20190506);
+	std::uniform_int_distribution<int> syllable(0, syllableCount - 1);
+	std::uniform_int_distribution<int> wordLength(1, 4);
+	std::uniform_int_distribution<int> wordCount(0, 3);
+	std::uniform_int_distribution<int> field(0, PartsSearchIndex::FieldCount - 1);
+
+	auto word = [&]() {
+		QString w;
+		int n = wordLength(gen);
+		for (int i = 0; i < n; i++) w += Syllables[syllable(gen)];
+		return w;
+	};
+
+	QVector<PartsSearchIndex::Document> documents;
+	for (int i = 0; i < 500; i++) {
+		PartsSearchIndex::Document document;
+		document.modelPart = part(i);
+		document.obsolete = (i % 10 == 0);
+		for (int w = wordCount(gen); w > 0; w--) {
+			QString & text = document.fields[field(gen)];
+			if (!text.isEmpty()) text += (w % 2) ? " " : "\n";
+			text += (w % 3) ? word() : word().toUpper();
+		}
+		documents << document;
+	}
+
+	PartsSearchIndex index;
+	index.build(documents);
+	for (int q = 0; q < 300; q++) {
+		QStringList terms;
+		for (int t = 1 + q % 2; t > 0; t--) terms << word();
+		bool allowObsolete = (q % 3 == 0);
+
+		QList<int> expected;
+		for (int i = 0; i < documents.count(); i++) {
+			if (!allowObsolete && documents.at(i).obsolete) continue;
+
+			bool all = true;
+			foreach (QString term, terms) {
+				bool found = false;
+				for (int f = 0; f < PartsSearchIndex::FieldCount; f++) {
+					if (documents.at(i).fields[f].contains(term, Qt::CaseInsensitive)) found = true;
+				}
+				if (!found) all = false;
+			}
+			if (all) expected << i;
+		}
+
+		QList<int> found = indexes(index.search(terms.join(" "), allowObsolete));
+		std::sort(found.begin(), found.end());
+		BOOST_CHECK(found == expected);
+	}
+}
@@ -0,0 +1,188 @@
+#include "svg/svgpathtokenizer.h"
+#include "svg/svgpathparser.h"
+#include "svg/svgpathlexer.h"
+
+/*
+Testing SVGPathTokenizer against SVGPathParser, which it replaces for path data in
+SvgFileSplitter::parsePath, plus a rough throughput comparison of the two
+*/
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QStringList>
+#include <QVariant>
+
+// flatten the tokenizer output into the same form as SVGPathParser::symStack()
+static QList<QVariant> tokenizerStack(const SVGPathTokenizer & tokenizer)
+{
+	QList<QVariant> stack;
+	for (int i = 0; i < tokenizer.count(); i++) {
+		stack.append(tokenizer.command(i).command);
+		SVGPathArgs args = tokenizer.args(i);
+		for (int j = 0; j < args.count(); j++) {
+			stack.append(args[j]);
+		}
+	}
+	return stack;
+}
+
+static QList<QVariant> parserStack(const QString & data)
+{
+	// the same preparation SvgFileSplitter used to do before handing data to the parser
+	QString dataCopy(data);
+	if (!dataCopy.endsWith('z', Qt::CaseInsensitive)) {
+		dataCopy.append(SVGPathLexer::FakeClosePathChar);
+	}
+	SVGPathLexer lexer(dataCopy);
+	SVGPathParser parser;
+	if (!parser.parse(lexer)) return QList<QVariant>();
+
+	return parser.symStack().toList();
+}
+
+struct CommandCounter {
+	int commands = 0;
+	int args = 0;
+
+	void count(QChar, bool, const SVGPathArgs & a, void *) {
+		commands++;
+		args += a.count();
+	}
+};
+
+BOOST_AUTO_TEST_CASE( pathtokenizer_matches_parser )
+{
+	const QStringList inputs = {
+		"m0,0",
+		"m5,9.9",
+		"m-5,-9.9",
+		"m-4 -9.8",
+		"m-3-9.7",
+		"m0,0z",
+		"m1,-2a2.6,3.5,0,0,1,-5.2,0",
+		"m2 -2a2.6 3.5 0 0 1 -5.2 0",
+		"m3-2a2.6 3.5 0 0 1-5.2 0",
+		"m4-2a2.6-3.5 0 0 1-5.2 0",
+		"m-2+9.7",
+		"M10,10L20,20 30,30H40V50h-5v-5Z",
+		"M0,0C1,2,3,4,5,6S7,8,9,10Q11,12,13,14T15,16z",
+		"M 1.5 2.25 l 3 4 l 5 6 z m 1 1 l 2 2",
+	};
+
+	for (int inp = 0; inp < inputs.size(); ++inp) {
+		SVGPathTokenizer tokenizer;
+		BOOST_CHECK_MESSAGE(tokenizer.tokenize(inputs.at(inp)), "tokenize failed for input " << inp);
+
+		QList<QVariant> expected = parserStack(inputs.at(inp));
+		QList<QVariant> actual = tokenizerStack(tokenizer);
+		BOOST_CHECK_MESSAGE(!expected.isEmpty(), "parser failed for input " << inp);
+		BOOST_CHECK_EQUAL(actual.size(), expected.size());
+		for (int entry = 0; entry < std::min(actual.size(), expected.size()); entry++) {
+			const QVariant & a = actual.at(entry);
+			const QVariant & e = expected.at(entry);
+			if (a.type() != e.type() || a != e) {
+				BOOST_ERROR("for input " << inp << ", entry " << entry << " differs from the parser");
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( pathtokenizer_syntax )
+{
+	SVGPathTokenizer tokenizer;
+
+	// polygon points: no leading command
+	BOOST_REQUIRE(tokenizer.tokenize("10,10 20,20 30,30"));
+	BOOST_CHECK_EQUAL(tokenizer.count(), 1);
+	BOOST_CHECK(tokenizer.command(0).command == QLatin1Char('M'));
+	BOOST_CHECK_EQUAL(tokenizer.args(0).count(), 6);
+
+	// compact arc flags
+	BOOST_REQUIRE(tokenizer.tokenize("M0 0a1 1 0 011 1"));
+	BOOST_CHECK_EQUAL(tokenizer.count(), 2);
+	SVGPathArgs args = tokenizer.args(1);
+	BOOST_REQUIRE_EQUAL(args.count(), 7);
+	BOOST_CHECK_EQUAL(args[3], 0.0);
+	BOOST_CHECK_EQUAL(args[4], 1.0);
+	BOOST_CHECK_EQUAL(args[5], 1.0);
+	BOOST_CHECK_EQUAL(args[6], 1.0);
+
+	// exponents
+	BOOST_REQUIRE(tokenizer.tokenize("M1e-5,2.5E+3"));
+	BOOST_CHECK_EQUAL(tokenizer.args(0)[0], 1e-5);
+	BOOST_CHECK_EQUAL(tokenizer.args(0)[1], 2500.0);
+
+	// long mantissas go through the fallback conversion
+	BOOST_REQUIRE(tokenizer.tokenize("M123456789012345678901234 0.30000000000000004"));
+	BOOST_CHECK_EQUAL(tokenizer.args(0)[0], QByteArray("123456789012345678901234").toDouble());
+	BOOST_CHECK_EQUAL(tokenizer.args(0)[1], QByteArray("0.30000000000000004").toDouble());
+
+	const QStringList badInputs = {
+		"",
+		"L1 2",             // must start with moveto
+		"M1 2 3",           // incomplete coordinate pair
+		"M1 2 z 3",         // closepath takes no arguments
+		"M1,,2",            // two commas
+		"M1 2,",            // trailing comma
+		"M1 2 L",           // command without arguments
+		"M1 2 a1 1 0 2 1 3 3",   // flags must be 0 or 1
+		"M1 2 k3 4",        // not a path command
+		"M1 2 L3 -",        // sign without digits
+	};
+	for (int inp = 0; inp < badInputs.size(); ++inp) {
+		BOOST_CHECK_MESSAGE(!tokenizer.tokenize(badInputs.at(inp)), "tokenize accepted bad input " << inp);
+		BOOST_CHECK_EQUAL(tokenizer.count(), 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( pathtokenizer_run )
+{
+	SVGPathTokenizer tokenizer;
+	BOOST_REQUIRE(tokenizer.tokenize("M10,10L20,20 30,30H40V50Z"));
+
+	CommandCounter counter;
+	tokenizer.run<CommandCounter, &CommandCounter::count>(&counter, nullptr);
+	BOOST_CHECK_EQUAL(counter.commands, 5);
+	BOOST_CHECK_EQUAL(counter.args, 8);
+}
+
+BOOST_AUTO_TEST_CASE( pathtokenizer_throughput )
+{
+	// a copper fill sized path: mostly curves and lines, with some arcs
+	QString data("M0,0");
+	for (int i = 0; i < 2000; i++) {
+		data.append(QString("C%1,%2 %3,%4 %5,%6").arg(i * 0.5).arg(i * 0.25).arg(i * 0.125).arg(-i * 0.5).arg(i).arg(-i));
+		data.append(QString("L%1 %2").arg(i * 1.5).arg(i * 2.5));
+		if (i % 10 == 0) data.append(QString("a2.5,2.5 0 0,1 %1,%2").arg(i).arg(i));
+	}
+	data.append('z');
+
+	const int iterations = 20;
+
+	SVGPathTokenizer tokenizer;
+	CommandCounter counter;
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < iterations; i++) {
+		BOOST_REQUIRE(tokenizer.tokenize(data));
+		tokenizer.run<CommandCounter, &CommandCounter::count>(&counter, nullptr);
+	}
+	qint64 tokenizerMs = std::max<qint64>(timer.elapsed(), 1);
+
+	int parserSymbols = 0;
+	timer.restart();
+	for (int i = 0; i < iterations; i++) {
+		parserSymbols += parserStack(data).count();
+	}
+	qint64 parserMs = std::max<qint64>(timer.elapsed(), 1);
+
+	BOOST_CHECK_EQUAL(counter.commands + counter.args, parserSymbols);
+
+	double megabytes = (double) data.length() * iterations / (1024 * 1024);
+	BOOST_TEST_MESSAGE("path tokenizer: " << tokenizerMs << " ms, " << megabytes * 1000 / tokenizerMs << " MB/s");
+	BOOST_TEST_MESSAGE("lexer and parser: " << parserMs << " ms, " << megabytes * 1000 / parserMs << " MB/s");
+}
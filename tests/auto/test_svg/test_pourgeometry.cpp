@@ -0,0 +1,230 @@
+#include <boost/test/unit_test.hpp>
+
+#include "svg/pourgeometry.h"
+
+/*
+Testing the vector ground fill. The pour is checked point by point against the exact answer
+and against the raster fill it replaced (board filled, grown copper cleared on an image),
+away from the edges where the raster can go either way. The probe ground seeds walk along
+must answer the same from the vector pieces as from the raster fill's images.
+*/
+
+#include <algorithm>
+#include <random>
+
+#include <QImage>
+#include <QLineF>
+#include <QList>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPolygon>
+#include <QPolygonF>
+#include <QRectF>
+#include <QSize>
+#include <qmath.h>
+
+static QPolygonF square(double left, double top, double size) {
+	QPolygonF polygon;
+	polygon << QPointF(left, top) << QPointF(left + size, top) << QPointF(left + size, top + size) << QPointF(left, top + size);
+	return polygon;
+}
+
+struct Disc {
+	QPointF center;
+	double radius;
+
+	double distance(const QPointF & p) const {
+		return QLineF(p, center).length() - radius;
+	}
+};
+
+BOOST_AUTO_TEST_CASE( pourgeometry_bridge_holes )
+{
+	QPolygonF outer = square(0, 0, 100);
+	QList<QPolygonF> holes;
+	holes << square(20, 20, 20);
+	holes << square(60, 50, 20);
+	holes << square(65, 80, 10);			// right below the one above, so its cut runs into it
+	QPolygonF triangle;
+	triangle << QPointF(10, 60) << QPointF(40, 90) << QPointF(10, 90);
+	holes << triangle;
+
+	// either winding of the outline and holes
+	for (int pass = 0; pass < 2; pass++) {
+		QPolygonF bridged;
+		BOOST_REQUIRE(PourGeometry::bridgeHoles(outer, holes, bridged));
+
+		int expected = outer.count();
+		foreach (QPolygonF hole, holes) expected += hole.count() + 3;
+		BOOST_CHECK_EQUAL(bridged.count(), expected);
+
+		for (double y = 0.37; y < 100; y += 1.1) {
+			for (double x = 0.29; x < 100; x += 1.1) {
+				QPointF p(x, y);
+				bool inHole = false;
+				foreach (QPolygonF hole, holes) {
+					if (hole.containsPoint(p, Qt::OddEvenFill)) inHole = true;
+				}
+				BOOST_CHECK_EQUAL(bridged.containsPoint(p, Qt::WindingFill), !inHole);
+			}
+		}
+
+		std::reverse(outer.begin(), outer.end());
+		for (int i = 0; i < holes.count(); i++) {
+			std::reverse(holes[i].begin(), holes[i].end());
+		}
+	}
+
+	// a hole with no outline above it can't be cut out, and must not be dropped
+	QList<QPolygonF> outside;
+	outside << square(120, 20, 10);
+	QPolygonF bridged;
+	BOOST_CHECK(!PourGeometry::bridgeHoles(outer, outside, bridged));
+}
+
+BOOST_AUTO_TEST_CASE( pourgeometry_pour_matches_raster )
+{
+	QSizeF size(2000, 1500);
+	double border = 50;
+	double margin = 8;						// two raster pixels
+	double rasterScale = 0.25;
+
+	Disc cutout;
+	cutout.center = QPointF(1000, 750);
+	cutout.radius = 100;
+	QPainterPath board;
+	board.addRect(QRectF(QPointF(0, 0), size));
+	QPainterPath cutoutPath;
+	cutoutPath.addEllipse(cutout.center, cutout.radius, cutout.radius);
+	board = board.subtracted(cutoutPath);
+
+	// copper, already grown by the keepout: some inside a tile, some across tile edges and the border
+	std::mt19937 gen(20190505);
+	std::uniform_real_distribution<double> xs(0, size.width());
+	std::uniform_real_distribution<double> ys(0, size.height());
+	std::uniform_real_distribution<double> radii(20, 80);
+	QList<Disc> copper;
+	for (int i = 0; i < 40; i++) {
+		Disc disc;
+		disc.center = QPointF(xs(gen), ys(gen));
+		disc.radius = radii(gen);
+		copper << disc;
+	}
+	Disc pinned;
+	pinned.center = QPointF(250, 250);		// in the middle of the first tile
+	pinned.radius = 60;
+	copper << pinned;
+	pinned.center = QPointF(500, 1000);		// across a tile edge
+	copper << pinned;
+
+	QPainterPath inset = PourGeometry::inset(board, border, size);
+	double tileSize = 500;
+	QList<QPainterPath> tilePours;
+	for (double y = 0; y < size.height(); y += tileSize) {
+		for (double x = 0; x < size.width(); x += tileSize) {
+			QRectF tile(x, y, tileSize, tileSize);
+			QList<QPainterPath> paths;
+			foreach (Disc disc, copper) {
+				QPainterPath path;
+				path.addEllipse(disc.center, disc.radius, disc.radius);
+				if (path.boundingRect().intersects(tile)) paths << path;
+			}
+			tilePours << PourGeometry::pourTile(inset, tile, paths);
+		}
+	}
+
+	QList<QPolygonF> pieces;
+	BOOST_REQUIRE(PourGeometry::pieces(tilePours, pieces));
+	BOOST_REQUIRE(!pieces.isEmpty());
+	QPainterPath pour;
+	pour.setFillRule(Qt::WindingFill);
+	foreach (QPolygonF piece, pieces) pour.addPolygon(piece);
+
+	QImage image(qRound(size.width() * rasterScale), qRound(size.height() * rasterScale), QImage::Format_ARGB32);
+	image.fill(0xffffffff);
+	QPainter painter;
+	painter.begin(&image);
+	painter.setRenderHint(QPainter::Antialiasing, false);
+	painter.scale(rasterScale, rasterScale);
+	painter.fillRect(QRectF(border, border, size.width() - 2 * border, size.height() - 2 * border), Qt::black);
+	painter.setPen(Qt::NoPen);
+	painter.setBrush(Qt::white);
+	painter.drawEllipse(cutout.center, cutout.radius + border, cutout.radius + border);
+	foreach (Disc disc, copper) painter.drawEllipse(disc.center, disc.radius, disc.radius);
+	painter.end();
+
+	int compared = 0;
+	int poured = 0;
+	for (double y = 1.7; y < size.height(); y += 13) {
+		for (double x = 2.3; x < size.width(); x += 13) {
+			QPointF p(x, y);
+			double edge = qMin(qMin(x - border, size.width() - border - x), qMin(y - border, size.height() - border - y));
+			edge = qMin(edge, cutout.distance(p) - border);
+			double clear = edge;
+			foreach (Disc disc, copper) clear = qMin(clear, disc.distance(p));
+			if (qAbs(clear) < margin) continue;
+
+			bool exact = clear > 0;
+			bool vector = pour.contains(p);
+			bool raster = qGray(image.pixel(qFloor(x * rasterScale), qFloor(y * rasterScale))) < 128;
+			BOOST_CHECK_EQUAL(vector, exact);
+			BOOST_CHECK_EQUAL(vector, raster);
+			if (exact) poured++;
+			compared++;
+		}
+	}
+
+	BOOST_CHECK_GT(poured, compared / 2);
+	BOOST_CHECK_GT(compared - poured, 100);
+}
+
+BOOST_AUTO_TEST_CASE( pourgeometry_probe_reaches_pour_and_border )
+{
+	// mils, as the pour is made; the probe is asked in pixels of 2 mils
+	double pixelFactor = 2;
+	QPainterPath board;
+	board.addRect(50, 50, 900, 700);
+	QRectF hole(400, 300, 100, 100);
+	QPolygonF bridged;
+	BOOST_REQUIRE(PourGeometry::bridgeHoles(square(100, 100, 600), QList<QPolygonF>() << square(hole.left(), hole.top(), hole.width()), bridged));
+	QList<QPolygon> pieces;
+	pieces << bridged.toPolygon() << square(800, 100, 100).toPolygon();
+
+	PourProbe probe(pieces, board, pixelFactor, QSize(500, 400));
+	BOOST_CHECK(probe.size() == QSize(500, 400));
+
+	// the same pour and board as the raster fill hands over: white where it pours, black off the board
+	QImage copperImage(500, 400, QImage::Format_ARGB32);
+	copperImage.fill(0xff000000);
+	QImage boardImage(500, 400, QImage::Format_ARGB32);
+	boardImage.fill(0xff000000);
+	QPainter painter;
+	painter.begin(&copperImage);
+	painter.scale(1 / pixelFactor, 1 / pixelFactor);
+	painter.fillRect(QRectF(100, 100, 600, 600), Qt::white);
+	painter.fillRect(hole, Qt::black);
+	painter.fillRect(QRectF(800, 100, 100, 100), Qt::white);
+	painter.end();
+	painter.begin(&boardImage);
+	painter.scale(1 / pixelFactor, 1 / pixelFactor);
+	painter.fillRect(board.boundingRect(), Qt::white);
+	painter.end();
+	PourProbe rasterProbe(&copperImage, &boardImage);
+
+	int reached = 0;
+	for (int y = 0; y < 400; y += 3) {
+		for (int x = 0; x < 500; x += 3) {
+			QPointF p((x + 0.5) * pixelFactor, (y + 0.5) * pixelFactor);
+			bool inPour = (QRectF(100, 100, 600, 600).contains(p) && !hole.contains(p)) || QRectF(800, 100, 100, 100).contains(p);
+			bool expected = inPour || !board.contains(p);
+			BOOST_CHECK_EQUAL(probe.reached(x, y), expected);
+			BOOST_CHECK_EQUAL(rasterProbe.reached(x, y), expected);
+			if (expected) reached++;
+		}
+	}
+
+	BOOST_CHECK_GT(reached, 0);
+	BOOST_CHECK(!probe.reached(225, 175));			// in the hole
+	BOOST_CHECK(!probe.reached(30, 30));			// on the board, outside the pour
+	BOOST_CHECK(probe.reached(10, 10));				// off the board
+}
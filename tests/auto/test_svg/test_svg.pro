@@ -17,7 +17,7 @@
 absolute_boost = 1
 include($$absolute_path(../../../pri/boostdetect.pri))
 
-QT += core xml svg
+QT += core gui xml svg widgets
 
 HEADERS += $$files(*.h)
 SOURCES += $$files(*.cpp)
@@ -29,11 +29,23 @@ HEADERS += $$files(../../../src/svg/svgpathlexer.h)
 HEADERS += $$files(../../../src/utils/textutils.h)
 HEADERS += $$files(../../../src/svg/svgpathgrammar_p.h)
 HEADERS += $$files(../../../src/svg/svgpathparser.h)
+HEADERS += $$files(../../../src/svg/svgpathtokenizer.h)
+HEADERS += $$files(../../../src/svg/pourgeometry.h)
+HEADERS += $$files(../../../src/svg/svg2gerber.h)
+HEADERS += $$files(../../../src/svg/svgfilesplitter.h)
+HEADERS += $$files(../../../src/svg/svgflattener.h)
+HEADERS += $$files(../../../src/utils/graphicsutils.h)
 
 SOURCES += $$files(../../../src/svg/svgtext.cpp)
 SOURCES += $$files(../../../src/svg/svgpathlexer.cpp)
 SOURCES += $$files(../../../src/svg/svgpathparser.cpp)
 SOURCES += $$files(../../../src/svg/svgpathgrammar.cpp)
+SOURCES += $$files(../../../src/svg/svgpathtokenizer.cpp)
+SOURCES += $$files(../../../src/svg/pourgeometry.cpp)
+SOURCES += $$files(../../../src/svg/svg2gerber.cpp)
+SOURCES += $$files(../../../src/svg/svgfilesplitter.cpp)
+SOURCES += $$files(../../../src/svg/svgflattener.cpp)
+SOURCES += $$files(../../../src/utils/graphicsutils.cpp)
 SOURCES += $$files(../../../src/utils/textutils.cpp)
 #INCLUDEPATH += $$top_srcdir
 # unix:QMAKE_POST_LINK = $$PWD/generated/test_svg
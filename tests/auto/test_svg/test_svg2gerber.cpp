@@ -0,0 +1,229 @@
+/*
+Testing how SVG2gerber turns curves, arcs, ellipses and rounded rects into Gerber.
+Gerber coordinates are whole mils with y flipped, so points are read back into svg
+coordinates and checked against the exact shape to within the rounding.
+
+Needs access to protected members of SVG2gerber, the same way test_pathlexer_protected does.
+*/
+
+#include <QDomDocument>
+#include <QDomElement>
+#include <QLineF>
+#include <QList>
+#include <QMatrix>
+#include <QMultiHash>
+#include <QObject>
+#include <QPointF>
+#include <QRegExp>
+#include <QString>
+#include <qmath.h>
+
+#include "debugdialog.h"
+#include "svg/svgflattener.h"
+
+#define protected public
+#include "svg/svg2gerber.h"
+#undef protected
+
+#include <boost/test/unit_test.hpp>
+
+// svg2gerber only logs through DebugDialog; the dialog itself isn't linked into the test
+void DebugDialog::debug(QString, const QPointF &, DebugLevel, QObject *) {}
+void DebugDialog::debug(QString, const QRectF &, DebugLevel, QObject *) {}
+void DebugDialog::debug(QString, const QPoint &, DebugLevel, QObject *) {}
+void DebugDialog::debug(QString, const QRect &, DebugLevel, QObject *) {}
+void DebugDialog::debug(QString, DebugLevel, QObject *) {}
+
+static const double BoardHeight = 1000;
+
+static QString gerber(SVG2gerber & converter, const QString & d) {
+	converter.m_boardSize = QSizeF(BoardHeight, BoardHeight);
+	converter.m_lastCommand = QChar();
+
+	PathUserData pathUserData;
+	pathUserData.x = 0;
+	pathUserData.y = 0;
+	pathUserData.pathStarting = true;
+	SvgFlattener flattener;
+	flattener.parsePath<SVG2gerber, &SVG2gerber::path2gerbCommand>(d, pathUserData, &converter, true);
+	return pathUserData.string;
+}
+
+// the straight-line moves and draws, back in svg coordinates; G02/G03 lines carry I and J, so they are left out
+static QList<QPointF> vertices(const QString & gerber) {
+	QList<QPointF> result;
+	QRegExp re("X(-?\\d+)Y(-?\\d+)D0[12]\\*");
+	int pos = 0;
+	while ((pos = re.indexIn(gerber, pos)) >= 0) {
+		result << QPointF(re.cap(1).toDouble(), BoardHeight - re.cap(2).toDouble());
+		pos += re.matchedLength();
+	}
+	return result;
+}
+
+// how far p is from the ellipse centered on center, measured along the smaller radius
+static double ellipseError(const QPointF & p, const QPointF & center, double rx, double ry) {
+	double dx = (p.x() - center.x()) / rx;
+	double dy = (p.y() - center.y()) / ry;
+	return qAbs(qSqrt(dx * dx + dy * dy) - 1) * qMin(rx, ry);
+}
+
+static QPointF bezier(const QPointF & p0, const QPointF & p1, const QPointF & p2, const QPointF & p3, double t) {
+	double u = 1 - t;
+	return u * u * u * p0 + 3 * u * u * t * p1 + 3 * u * t * t * p2 + t * t * t * p3;
+}
+
+static double distance(const QPointF & p, const QList<QPointF> & samples) {
+	double best = -1;
+	foreach (QPointF sample, samples) {
+		double d = QLineF(p, sample).length();
+		if (best < 0 || d < best) best = d;
+	}
+	return best;
+}
+
+BOOST_AUTO_TEST_CASE( svg2gerber_implicit_repeats )
+{
+	// a repeated S reflects the control point of the S just before it, even when the run follows a move
+	SVG2gerber converter;
+	BOOST_CHECK_EQUAL(gerber(converter, "M0,500S100,600 100,500 200,400 200,500 300,600 300,500").toStdString(),
+	                  gerber(converter, "M0,500S100,600 100,500S200,400 200,500S300,600 300,500").toStdString());
+	BOOST_CHECK_EQUAL(gerber(converter, "m0,500s100,100 100,0 100,-100 100,0").toStdString(),
+	                  gerber(converter, "m0,500s100,100 100,0s100,-100 100,0").toStdString());
+	BOOST_CHECK_EQUAL(gerber(converter, "M0,500Q50,600 100,500T200,500 300,500").toStdString(),
+	                  gerber(converter, "M0,500Q50,600 100,500T200,500T300,500").toStdString());
+}
+
+BOOST_AUTO_TEST_CASE( svg2gerber_flatten_curve )
+{
+	SVG2gerber converter;
+	converter.m_boardSize = QSizeF(BoardHeight, BoardHeight);
+	QPointF p0(100, 100);
+	QPointF p1(100, 900);
+	QPointF p2(900, -300);
+	QPointF p3(900, 500);
+
+	QString string;
+	QPoint last(converter.flipx(p0.x()), converter.flipy(p0.y()));
+	converter.flattenCurve(string, p0, p1, p2, p3, 0, last);
+
+	QList<QPointF> points = vertices(string);
+	BOOST_REQUIRE_GT(points.count(), 10);
+	BOOST_CHECK_LT(points.count(), 400);
+	BOOST_CHECK(points.last() == p3);
+
+	QList<QPointF> samples;
+	for (int i = 0; i <= 10000; i++) samples << bezier(p0, p1, p2, p3, i / 10000.0);
+
+	// every vertex is on the curve, and every segment stays close to it, give or take a mil of rounding
+	QPointF previous = p0;
+	foreach (QPointF point, points) {
+		BOOST_CHECK_LT(distance(point, samples), 1.0);
+		for (int k = 1; k < 4; k++) {
+			BOOST_CHECK_LT(distance(previous + (point - previous) * k / 4, samples), 1.5);
+		}
+		BOOST_CHECK(point != previous);
+		previous = point;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( svg2gerber_arc )
+{
+	SVG2gerber converter;
+
+	// circular arcs become G02 (svg's positive sweep) or G03, with the center relative to the start
+	BOOST_CHECK_EQUAL(gerber(converter, "M100,500A200,200 0 0 1 500,500").toStdString(),
+	                  std::string("X100Y500D02*\nG75*\nG02X500Y500I200J0D01*\nG01*\n"));
+	BOOST_CHECK_EQUAL(gerber(converter, "M100,500A200,200 0 0 0 500,500").toStdString(),
+	                  std::string("X100Y500D02*\nG75*\nG03X500Y500I200J0D01*\nG01*\n"));
+	BOOST_CHECK_EQUAL(gerber(converter, "M500,300A200,200 0 0 1 700,500").toStdString(),
+	                  std::string("X500Y700D02*\nG75*\nG02X700Y500I0J-200D01*\nG01*\n"));
+
+	// radii too small to reach the end are scaled up to a half circle
+	BOOST_CHECK_EQUAL(gerber(converter, "M100,500A50,50 0 0 1 500,500").toStdString(),
+	                  std::string("X100Y500D02*\nG75*\nG02X500Y500I200J0D01*\nG01*\n"));
+
+	// elliptical arcs are flattened onto the ellipse: this one runs over the top, from left to right
+	QString string = gerber(converter, "M100,500A400,200 0 0 1 900,500");
+	BOOST_CHECK(!string.contains("G02") && !string.contains("G03"));
+	QList<QPointF> points = vertices(string);
+	BOOST_REQUIRE_GT(points.count(), 10);
+	BOOST_CHECK(points.first() == QPointF(100, 500));
+	BOOST_CHECK(points.last() == QPointF(900, 500));
+	double top = BoardHeight;
+	foreach (QPointF point, points) {
+		BOOST_CHECK_LT(ellipseError(point, QPointF(500, 500), 400, 200), 1.0);
+		BOOST_CHECK_LE(point.y(), 500);
+		top = qMin(top, point.y());
+	}
+	BOOST_CHECK_LT(top, 301);
+}
+
+BOOST_AUTO_TEST_CASE( svg2gerber_ellipse2path )
+{
+	SVG2gerber converter;
+	converter.m_SVGDom.setContent(QString("<svg xmlns='http://www.w3.org/2000/svg'>"
+	                                      "<ellipse id='e' cx='500' cy='400' rx='300' ry='100' transform='rotate(10)'/>"
+	                                      "<ellipse cx='500' cy='400' rx='0' ry='100'/>"
+	                                      "</svg>"));
+	QDomElement ellipse = converter.m_SVGDom.documentElement().firstChildElement("ellipse");
+
+	QDomElement path = converter.ellipse2path(ellipse);
+	BOOST_CHECK_EQUAL(path.tagName().toStdString(), std::string("path"));
+	BOOST_CHECK_EQUAL(path.attribute("d").toStdString(), std::string("M200,400A300,100 0 1 0 800,400A300,100 0 1 0 200,400z"));
+	BOOST_CHECK_EQUAL(path.attribute("id").toStdString(), std::string("e"));
+	BOOST_CHECK_EQUAL(path.attribute("transform").toStdString(), std::string("rotate(10)"));
+
+	// the whole outline comes back, both halves
+	double top = BoardHeight;
+	double bottom = 0;
+	foreach (QPointF point, vertices(gerber(converter, path.attribute("d")))) {
+		BOOST_CHECK_LT(ellipseError(point, QPointF(500, 400), 300, 100), 1.0);
+		top = qMin(top, point.y());
+		bottom = qMax(bottom, point.y());
+	}
+	BOOST_CHECK_LT(top, 301);
+	BOOST_CHECK_GT(bottom, 499);
+
+	// nothing to draw: left as it is
+	QDomElement flat = ellipse.nextSiblingElement("ellipse");
+	BOOST_CHECK(converter.ellipse2path(flat) == flat);
+}
+
+BOOST_AUTO_TEST_CASE( svg2gerber_roundedRect2path )
+{
+	SVG2gerber converter;
+	converter.m_SVGDom.setContent(QString("<svg xmlns='http://www.w3.org/2000/svg'>"
+	                                      "<rect id='r' x='10' y='20' width='100' height='50' rx='5'/>"
+	                                      "<rect x='10' y='20' width='100' height='50' rx='80' ry='10'/>"
+	                                      "<rect x='10' y='20' width='100' height='50' ry='8'/>"
+	                                      "<rect x='10' y='20' width='100' height='50' rx='0'/>"
+	                                      "</svg>"));
+	QDomElement rect = converter.m_SVGDom.documentElement().firstChildElement("rect");
+
+	// a missing ry takes rx
+	QDomElement path = converter.roundedRect2path(rect);
+	BOOST_CHECK_EQUAL(path.tagName().toStdString(), std::string("path"));
+	BOOST_CHECK_EQUAL(path.attribute("d").toStdString(),
+	                  std::string("M15,20L105,20A5,5 0 0 1 110,25L110,65A5,5 0 0 1 105,70L15,70A5,5 0 0 1 10,65L10,25A5,5 0 0 1 15,20z"));
+	BOOST_CHECK_EQUAL(path.attribute("id").toStdString(), std::string("r"));
+
+	// four clockwise corner arcs
+	QString string = gerber(converter, path.attribute("d"));
+	BOOST_CHECK_EQUAL(string.count("G02"), 4);
+	BOOST_CHECK(!string.contains("G03") && !string.contains("INVALID"));
+
+	// radii are clamped to half the size
+	rect = rect.nextSiblingElement("rect");
+	BOOST_CHECK_EQUAL(converter.roundedRect2path(rect).attribute("d").toStdString(),
+	                  std::string("M60,20L60,20A50,10 0 0 1 110,30L110,60A50,10 0 0 1 60,70L60,70A50,10 0 0 1 10,60L10,30A50,10 0 0 1 60,20z"));
+
+	// a missing rx takes ry
+	rect = rect.nextSiblingElement("rect");
+	BOOST_CHECK_EQUAL(converter.roundedRect2path(rect).attribute("d").toStdString(),
+	                  std::string("M18,20L102,20A8,8 0 0 1 110,28L110,62A8,8 0 0 1 102,70L18,70A8,8 0 0 1 10,62L10,28A8,8 0 0 1 18,20z"));
+
+	// square corners: left as it is
+	rect = rect.nextSiblingElement("rect");
+	BOOST_CHECK(converter.roundedRect2path(rect) == rect);
+}